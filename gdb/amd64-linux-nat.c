@@ -25,6 +25,7 @@
 #include "regset.h"
 #include "linux-nat.h"
 #include "amd64-linux-tdep.h"
+#include "linux-record.h"
 
 #include "gdb_assert.h"
 #include "gdb_string.h"
@@ -761,6 +762,68 @@ amd64_linux_read_description (struct target_ops *ops)
     }
 }
 
+/* Make the stopped LWP LWPID call mprotect (ADDR, LEN, PROT), by
+   single-stepping it over a system call instruction written at its
+   PC.  Return 0 on success, or an errno value.  */
+
+static int
+amd64_linux_inferior_mprotect (int lwpid, CORE_ADDR addr, ULONGEST len,
+			       int prot)
+{
+  elf_gregset_t regs, saved_regs;
+  long insn, saved_insn;
+  CORE_ADDR pc;
+  int ret = 0;
+
+  if (ptrace (PTRACE_GETREGS, lwpid, 0, (long) &saved_regs) < 0)
+    return errno;
+  memcpy (&regs, &saved_regs, sizeof (regs));
+  pc = saved_regs[RIP];
+
+  errno = 0;
+  saved_insn = ptrace (PTRACE_PEEKTEXT, lwpid, pc, 0);
+  if (errno != 0)
+    return errno;
+
+  insn = saved_insn;
+  if (gdbarch_ptr_bit (target_gdbarch) == 64)
+    {
+      memcpy (&insn, "\x0f\x05", 2);	/* syscall */
+      regs[RAX] = amd64_sys_mprotect;
+      regs[RDI] = addr;
+      regs[RSI] = len;
+      regs[RDX] = prot;
+    }
+  else
+    {
+      memcpy (&insn, "\xcd\x80", 2);	/* int $0x80 */
+      regs[RAX] = gdb_sys_mprotect;
+      regs[RBX] = addr;
+      regs[RCX] = len;
+      regs[RDX] = prot;
+    }
+
+  /* Don't let the kernel restart a system call the LWP is stopped
+     in, instead of running ours.  */
+  regs[ORIG_RAX] = -1;
+
+  if (ptrace (PTRACE_POKETEXT, lwpid, pc, insn) < 0)
+    return errno;
+
+  if (ptrace (PTRACE_SETREGS, lwpid, 0, (long) &regs) < 0)
+    ret = errno;
+  else if (linux_nat_step_lwp_insn (lwpid) != 0)
+    ret = ESRCH;
+  else if (ptrace (PTRACE_GETREGS, lwpid, 0, (long) &regs) < 0)
+    ret = errno;
+  else if ((long) regs[RAX] < 0 && (long) regs[RAX] > -4096)
+    ret = -(long) regs[RAX];
+
+  ptrace (PTRACE_POKETEXT, lwpid, pc, saved_insn);
+  ptrace (PTRACE_SETREGS, lwpid, 0, (long) &saved_regs);
+  return ret;
+}
+
 /* Provide a prototype to silence -Wmissing-prototypes.  */
 void _initialize_amd64_linux_nat (void);
 
@@ -803,4 +866,7 @@ _initialize_amd64_linux_nat (void)
   linux_nat_add_target (t);
   linux_nat_set_new_thread (t, amd64_linux_new_thread);
   linux_nat_set_siginfo_fixup (t, amd64_linux_siginfo_fixup);
+  linux_nat_set_inferior_mprotect (t, amd64_linux_inferior_mprotect);
+  linux_nat_set_batched_breakpoints (t);
+  linux_nat_set_breakpoint_ignore_counts (t);
 }
@@ -44,6 +44,7 @@
 
 #include "valprint.h"
 #include "c-lang.h"
+#include "format.h"
 
 /* To make sense of this file, you should read doc/agentexpr.texi.
    Then look at the types and enums in ax-gdb.h.  For the code itself,
@@ -2485,6 +2486,80 @@ gen_eval_for_expr (CORE_ADDR scope, struct expression *expr)
   return ax;
 }
 
+/* Given a printf FORMAT, whose escape sequences have been processed,
+   and the NARGS expressions EXPRS of its arguments, return a bytecode
+   sequence that evaluates the arguments and prints them with the
+   printf bytecode.  Only integer, pointer and string arguments can
+   be printed this way.  */
+
+struct agent_expr *
+gen_printf (CORE_ADDR scope, struct gdbarch *gdbarch,
+	    const char *format, int nargs, struct expression **exprs)
+{
+  struct cleanup *old_chain, *pieces_chain;
+  struct agent_expr *ax = new_agent_expr (gdbarch, scope);
+  struct format_piece *fpieces;
+  const char *format_error;
+  union exp_element *pc;
+  struct axs_value value;
+  int i, fr;
+
+  old_chain = make_cleanup_free_agent_expr (ax);
+
+  fpieces = parse_format_string (format, &format_error);
+  if (fpieces == NULL)
+    error ("%s", format_error);
+  pieces_chain = make_cleanup (free_format_pieces_cleanup, fpieces);
+
+  i = 0;
+  for (fr = 0; fpieces[fr].string != NULL; fr++)
+    {
+      struct type *type;
+
+      switch (fpieces[fr].argclass)
+	{
+	case literal_piece:
+	  continue;
+
+	case int_arg:
+	case long_arg:
+	case long_long_arg:
+	case ptr_arg:
+	case string_arg:
+	  break;
+
+	default:
+	  error (_("Format specifier not supported by the agent's printf."));
+	}
+
+      if (i >= nargs)
+	error (_("Wrong number of arguments for specified format-string"));
+
+      pc = exprs[i]->elts;
+      trace_kludge = 0;
+      value.optimized_out = 0;
+      gen_expr (exprs[i], &pc, ax, &value);
+      gen_usual_unary (exprs[i], ax, &value);
+
+      type = check_typedef (value.type);
+      if (TYPE_CODE (type) != TYPE_CODE_PTR && !is_integral_type (type))
+	error (_("Cannot print a value of type `%s' with the agent's printf."),
+	       TYPE_SAFE_NAME (value.type));
+      require_rvalue (ax, &value);
+      i++;
+    }
+
+  if (i != nargs)
+    error (_("Wrong number of arguments for specified format-string"));
+
+  ax_printf (ax, nargs, format);
+  ax_simple (ax, aop_end);
+
+  do_cleanups (pieces_chain);
+  discard_cleanups (old_chain);
+  return ax;
+}
+
 struct agent_expr *
 gen_trace_for_return_address (CORE_ADDR scope, struct gdbarch *gdbarch)
 {
@@ -110,6 +110,10 @@ extern struct agent_expr *gen_trace_for_return_address (CORE_ADDR,
 
 extern struct agent_expr *gen_eval_for_expr (CORE_ADDR, struct expression *);
 
+extern struct agent_expr *gen_printf (CORE_ADDR, struct gdbarch *,
+				      const char *, int,
+				      struct expression **);
+
 extern int trace_kludge;
 extern int trace_string_kludge;
 
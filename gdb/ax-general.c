@@ -330,6 +330,28 @@ ax_tsv (struct agent_expr *x, enum agent_op op, int num)
   x->buf[x->len + 2] = (num) & 0xff;
   x->len += 3;
 }
+
+/* Append a printf operator to EXPR, to print the top NARGS stack
+   entries as specified by FORMAT.  */
+
+void
+ax_printf (struct agent_expr *x, int nargs, const char *format)
+{
+  int slen = strlen (format) + 1;
+
+  if (nargs < 0 || nargs > 255)
+    error (_("Too many arguments for an agent printf."));
+  if (slen > 0xffff)
+    error (_("Format string too long for an agent printf."));
+
+  grow_expr (x, 4 + slen);
+  x->buf[x->len] = aop_printf;
+  x->buf[x->len + 1] = nargs;
+  x->buf[x->len + 2] = (slen >> 8) & 0xff;
+  x->buf[x->len + 3] = slen & 0xff;
+  memcpy (&x->buf[x->len + 4], format, slen);
+  x->len += 4 + slen;
+}
 
 
 
@@ -384,6 +406,25 @@ ax_print (struct ui_file *f, struct agent_expr *x)
 	}
 
       fprintf_filtered (f, "%3d  %s", i, aop_map[op].name);
+      if (op == aop_printf)
+	{
+	  int slen = 0;
+
+	  /* The operands of printf have their own encoding.  */
+	  if (i + 4 <= x->len)
+	    slen = (x->buf[i + 2] << 8) + x->buf[i + 3];
+	  if (i + 4 > x->len || i + 4 + slen > x->len
+	      || slen == 0 || x->buf[i + 3 + slen] != '\0')
+	    {
+	      fprintf_filtered (f, _(" <incomplete>\n"));
+	      break;
+	    }
+	  fprintf_filtered (f, " %d ", x->buf[i + 1]);
+	  fputstr_filtered ((char *) &x->buf[i + 4], '"', f);
+	  fprintf_filtered (f, "\n");
+	  i += 4 + slen;
+	  continue;
+	}
       if (aop_map[op].op_size > 0)
 	{
 	  fputs_filtered (" ", f);
@@ -554,6 +595,32 @@ ax_reqs (struct agent_expr *ax)
 	  height = heights[i + 3];
 	}
 
+      /* The printf instruction consumes its arguments, and is
+	 followed by its format string.  */
+      if (aop_printf == op - aop_map)
+	{
+	  int slen;
+
+	  if (i + 4 > ax->len)
+	    {
+	      ax->flaw = agent_flaw_incomplete_instruction;
+	      return;
+	    }
+	  slen = (ax->buf[i + 2] << 8) + ax->buf[i + 3];
+	  if (i + 4 + slen > ax->len)
+	    {
+	      ax->flaw = agent_flaw_incomplete_instruction;
+	      return;
+	    }
+
+	  height -= ax->buf[i + 1];
+	  if (height < ax->min_height)
+	    ax->min_height = height;
+
+	  /* Skip the operands; the loop accounts for the opcode.  */
+	  i += 3 + slen;
+	}
+
       /* For reg instructions, record the register in the bit mask.  */
       if (aop_reg == op - aop_map)
 	{
@@ -20,6 +20,7 @@
 #define AGENTEXPR_H
 
 #include "doublest.h"		/* For DOUBLEST.  */
+#include "vec.h"
 
 /* It's sometimes useful to be able to debug programs that you can't
    really stop for more than a fraction of a second.  To this end, the
@@ -144,6 +145,9 @@ struct agent_expr
     unsigned char *reg_mask;
   };
 
+typedef struct agent_expr *agent_expr_p;
+DEF_VEC_P (agent_expr_p);
+
 /* The actual values of the various bytecode operations.  */
 
 enum agent_op
@@ -212,6 +216,11 @@ extern void ax_reg_mask (struct agent_expr *ax, int reg);
 
 /* Assemble code to operate on a trace state variable.  */
 extern void ax_tsv (struct agent_expr *expr, enum agent_op op, int num);
+
+/* Append a printf operator to EXPR, to print the top NARGS stack
+   entries as specified by FORMAT.  */
+extern void ax_printf (struct agent_expr *expr, int nargs,
+		       const char *format);
 
 
 /* Functions for printing out expressions, and otherwise debugging
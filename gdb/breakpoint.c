@@ -76,6 +76,10 @@
 
 #include "mi/mi-common.h"
 #include "python/python.h"
+#include "ax-gdb.h"
+#include "format.h"
+#include <sys/time.h>
+#include "timeval-utils.h"
 
 /* Prototypes for local functions.  */
 
@@ -224,6 +228,11 @@ static int is_hardware_watchpoint (const struct breakpoint *bpt);
 
 static void insert_breakpoint_locations (void);
 
+static void force_breakpoint_reinsertion (struct bp_location *bl);
+
+static int breakpoint_locations_match (struct bp_location *loc1,
+				       struct bp_location *loc2);
+
 static int syscall_catchpoint_p (struct breakpoint *b);
 
 static void tracepoints_info (char *, int);
@@ -238,6 +247,12 @@ static void trace_pass_command (char *, int);
 
 static int is_masked_watchpoint (const struct breakpoint *b);
 
+static int bkpt_insert_location (struct bp_location *bl);
+
+static int bkpt_remove_location (struct bp_location *bl);
+
+static void free_re_set_key (struct breakpoint_re_set_key *key);
+
 /* Assuming we're creating a static tracepoint, does S look like a
    static tracepoint marker spec ("-m MARKER_ID")?  */
 #define is_marker_spec(s)						\
@@ -262,6 +277,9 @@ static struct breakpoint_ops momentary_breakpoint_ops;
    breakpoints.  */
 struct breakpoint_ops bkpt_breakpoint_ops;
 
+/* Dynamic printf class type.  */
+static struct breakpoint_ops dprintf_breakpoint_ops;
+
 /* A reference-counted struct command_line.  This lets multiple
    breakpoints share a single command list.  */
 struct counted_command_line
@@ -381,6 +399,94 @@ breakpoints_always_inserted_mode (void)
 	  && !RECORD_IS_USED);
 }
 
+/* Where breakpoint conditions are evaluated.  If host, GDB evaluates
+   them each time a breakpoint is reported.  If target, conditions are
+   compiled to agent expressions and downloaded along with the
+   breakpoint, so that the target only reports hits for which one of
+   them is true; GDB still evaluates the condition of the hits it is
+   told about.  Conditions that can't be compiled, and breakpoints on
+   targets that can't evaluate conditions, fall back to host
+   evaluation.  If auto (the default), GDB behaves as target when the
+   target supports it.  */
+
+static const char condition_evaluation_auto[] = "auto";
+static const char condition_evaluation_host[] = "host";
+static const char condition_evaluation_target[] = "target";
+static const char *condition_evaluation_enums[] = {
+  condition_evaluation_auto,
+  condition_evaluation_host,
+  condition_evaluation_target,
+  NULL
+};
+static const char *condition_evaluation_mode = condition_evaluation_auto;
+
+/* Returns true if breakpoint conditions should be downloaded to the
+   current target.  */
+
+static int
+target_evaluates_conditions_p (void)
+{
+  return (condition_evaluation_mode != condition_evaluation_host
+	  && target_supports_evaluation_of_breakpoint_conditions ());
+}
+
+static void
+set_condition_evaluation_mode (char *args, int from_tty,
+			       struct cmd_list_element *c)
+{
+  if (condition_evaluation_mode == condition_evaluation_target
+      && target_has_execution
+      && !target_supports_evaluation_of_breakpoint_conditions ())
+    warning (_("Target does not support breakpoint condition evaluation.\n"
+	       "Conditions will be evaluated by GDB."));
+
+  force_breakpoint_reinsertion (NULL);
+}
+
+static void
+show_condition_evaluation_mode (struct ui_file *file, int from_tty,
+				struct cmd_list_element *c, const char *value)
+{
+  if (condition_evaluation_mode == condition_evaluation_host)
+    fprintf_filtered (file,
+		      _("Breakpoint condition evaluation mode is %s.\n"),
+		      value);
+  else
+    fprintf_filtered (file,
+		      _("Breakpoint condition evaluation mode is %s "
+			"(currently %s).\n"),
+		      value,
+		      target_evaluates_conditions_p () ? "target" : "host");
+}
+
+/* How dprintf breakpoints print.  With "gdb", GDB formats the output
+   itself each time a dprintf is hit, and resumes the program without
+   stopping it for the user.  With "agent", targets that can run
+   breakpoint commands are given the printf as an agent expression,
+   and don't report the hits at all; dprintfs the target can't handle
+   fall back to "gdb".  */
+
+static const char dprintf_style_gdb[] = "gdb";
+static const char dprintf_style_agent[] = "agent";
+static const char *dprintf_style_enums[] = {
+  dprintf_style_gdb,
+  dprintf_style_agent,
+  NULL
+};
+static const char *dprintf_style = dprintf_style_gdb;
+
+static void
+set_dprintf_style (char *args, int from_tty, struct cmd_list_element *c)
+{
+  if (dprintf_style == dprintf_style_agent
+      && target_has_execution
+      && !target_can_run_breakpoint_commands ())
+    warning (_("Target cannot run dprintf commands.\n"
+	       "Dprintfs will be printed by GDB."));
+
+  force_breakpoint_reinsertion (NULL);
+}
+
 void _initialize_breakpoint (void);
 
 /* Are we executing breakpoint commands?  */
@@ -617,6 +723,10 @@ set_breakpoint_condition (struct breakpoint *b, char *exp,
 	{
 	  xfree (loc->cond);
 	  loc->cond = NULL;
+	  if (loc->cond_bytecode != NULL)
+	    free_agent_expr (loc->cond_bytecode);
+	  loc->cond_bytecode = NULL;
+	  loc->cond_bytecode_failed = 0;
 	}
     }
 
@@ -659,6 +769,16 @@ set_breakpoint_condition (struct breakpoint *b, char *exp,
 	    }
 	}
     }
+
+  /* Let the target know about the new condition.  */
+  if (!is_watchpoint (b) && target_evaluates_conditions_p ())
+    {
+      struct bp_location *loc;
+
+      for (loc = b->loc; loc; loc = loc->next)
+	force_breakpoint_reinsertion (loc);
+    }
+
   breakpoints_changed ();
   observer_notify_breakpoint_modified (b);
 }
@@ -1632,6 +1752,282 @@ unduplicated_should_be_inserted (struct bp_location *bl)
   return result;
 }
 
+/* Return the condition of BL compiled to an agent expression,
+   compiling it the first time round.  Returns NULL if the condition
+   can't be compiled.  */
+
+static struct agent_expr *
+condition_bytecode (struct bp_location *bl)
+{
+  if (bl->cond_bytecode == NULL && !bl->cond_bytecode_failed)
+    {
+      struct agent_expr *aexpr = NULL;
+      volatile struct gdb_exception ex;
+
+      TRY_CATCH (ex, RETURN_MASK_ERROR)
+	{
+	  aexpr = gen_eval_for_expr (bl->address, bl->cond);
+	  ax_reqs (aexpr);
+	}
+
+      if (ex.reason < 0 || aexpr->flaw != agent_flaw_none)
+	{
+	  if (ex.reason >= 0)
+	    free_agent_expr (aexpr);
+	  bl->cond_bytecode_failed = 1;
+	}
+      else
+	bl->cond_bytecode = aexpr;
+    }
+
+  return bl->cond_bytecode;
+}
+
+/* Return the index in BP_LOCATION, which is sorted by address, of
+   the first location at ADDRESS, or of the first location after it
+   if there is none.  */
+
+static unsigned
+first_bp_location_at (CORE_ADDR address)
+{
+  unsigned lo = 0, hi = bp_location_count;
+
+  while (lo < hi)
+    {
+      unsigned mid = (lo + hi) / 2;
+
+      if (bp_location[mid]->address < address)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+
+  return lo;
+}
+
+/* Fill in the conditions the target should evaluate before reporting
+   a hit of the software breakpoint location BL.  Since only one
+   location is inserted for a given address, these are the conditions
+   of all the locations at BL's address; if any of them is
+   unconditional or has a condition that can't be compiled, every hit
+   must be reported, and no condition is sent.  */
+
+static void
+build_target_condition_list (struct bp_location *bl)
+{
+  unsigned i;
+
+  if (bl->loc_type != bp_loc_software_breakpoint
+      || bl->cond == NULL
+      || !target_evaluates_conditions_p ())
+    return;
+
+  for (i = first_bp_location_at (bl->address);
+       i < bp_location_count && bp_location[i]->address == bl->address;
+       i++)
+    {
+      struct bp_location *loc = bp_location[i];
+      struct agent_expr *aexpr;
+
+      if (!breakpoint_locations_match (bl, loc)
+	  || !unduplicated_should_be_inserted (loc))
+	continue;
+
+      aexpr = loc->cond != NULL ? condition_bytecode (loc) : NULL;
+      if (aexpr == NULL)
+	{
+	  VEC_free (agent_expr_p, bl->target_info.conditions);
+	  return;
+	}
+
+      VEC_safe_push (agent_expr_p, bl->target_info.conditions, aexpr);
+    }
+}
+
+/* Compile the printf of the dprintf location BL to an agent
+   expression, parsing its arguments in the scope of BL.  */
+
+static struct agent_expr *
+dprintf_bytecode (struct bp_location *bl)
+{
+  char *args = bl->owner->dprintf_args;
+  char *format;
+  struct expression **exprs = NULL;
+  int nargs = 0;
+  struct agent_expr *aexpr;
+  struct cleanup *old_chain;
+
+  format = extract_printf_format (&args);
+  old_chain = make_cleanup (xfree, format);
+  make_cleanup (free_current_contents, &exprs);
+
+  while (*args != '\0')
+    {
+      struct expression *expr;
+
+      expr = parse_exp_1 (&args, block_for_pc (bl->address), 1);
+      make_cleanup (xfree, expr);
+      exprs = xrealloc (exprs, (nargs + 1) * sizeof (struct expression *));
+      exprs[nargs++] = expr;
+      if (*args == ',')
+	args++;
+      args = skip_spaces (args);
+    }
+
+  aexpr = gen_printf (bl->address, bl->gdbarch, format, nargs, exprs);
+  do_cleanups (old_chain);
+  return aexpr;
+}
+
+/* Return the printf of the dprintf location BL compiled to an agent
+   expression, compiling it the first time round.  Returns NULL if it
+   can't be compiled, e.g. because it prints floating point values.  */
+
+static struct agent_expr *
+command_bytecode (struct bp_location *bl)
+{
+  if (bl->cmd_bytecode == NULL && !bl->cmd_bytecode_failed)
+    {
+      struct agent_expr *aexpr = NULL;
+      volatile struct gdb_exception ex;
+
+      TRY_CATCH (ex, RETURN_MASK_ERROR)
+	{
+	  aexpr = dprintf_bytecode (bl);
+	  ax_reqs (aexpr);
+	}
+
+      if (ex.reason < 0 || aexpr->flaw != agent_flaw_none)
+	{
+	  if (ex.reason >= 0)
+	    free_agent_expr (aexpr);
+	  bl->cmd_bytecode_failed = 1;
+	}
+      else
+	bl->cmd_bytecode = aexpr;
+    }
+
+  return bl->cmd_bytecode;
+}
+
+/* Fill in the commands the target should run instead of reporting a
+   hit of the software breakpoint location BL.  Only the printf of a
+   dprintf is sent, when the user asked for the agent style.  The
+   target runs the commands on every hit it would otherwise report,
+   so they are only sent if BL is the only location at its address,
+   and if BL's condition, if any, was sent along.  */
+
+static void
+build_target_command_list (struct bp_location *bl)
+{
+  unsigned i;
+  struct agent_expr *aexpr;
+
+  if (bl->loc_type != bp_loc_software_breakpoint
+      || bl->owner->type != bp_dprintf
+      || bl->owner->dprintf_args == NULL
+      || dprintf_style != dprintf_style_agent
+      || !target_can_run_breakpoint_commands ())
+    return;
+
+  if (bl->cond != NULL
+      && VEC_empty (agent_expr_p, bl->target_info.conditions))
+    return;
+
+  for (i = first_bp_location_at (bl->address);
+       i < bp_location_count && bp_location[i]->address == bl->address;
+       i++)
+    {
+      struct bp_location *loc = bp_location[i];
+
+      if (loc != bl
+	  && breakpoint_locations_match (bl, loc)
+	  && unduplicated_should_be_inserted (loc))
+	return;
+    }
+
+  aexpr = command_bytecode (bl);
+  if (aexpr != NULL)
+    VEC_safe_push (agent_expr_p, bl->target_info.tcommands, aexpr);
+}
+
+/* Fill in the number of hits of the software breakpoint location BL
+   the target should skip before reporting one, from its owner's
+   ignore count.  The target counts the hits of BL alone, and only
+   those it would otherwise report, so BL must be the only location
+   of its breakpoint and at its address, and the breakpoint must not
+   have conditions GDB evaluates, commands run by the target, a thread
+   or a Python "stop" method.  */
+
+static void
+build_target_ignore_count (struct bp_location *bl)
+{
+  struct breakpoint *b = bl->owner;
+  unsigned i;
+
+  if (bl->loc_type != bp_loc_software_breakpoint
+      || b->ignore_count <= 0
+      || b->loc != bl
+      || bl->next != NULL
+      || b->thread != -1
+      || b->task != 0
+      || frame_id_p (b->frame_id)
+      || (b->py_bp_object != NULL
+	  && (gdbpy_breakpoint_has_py_cond (b->py_bp_object)
+	      || gdbpy_breakpoint_has_fast_stop (b->py_bp_object)))
+      || !VEC_empty (agent_expr_p, bl->target_info.tcommands)
+      || !target_can_ignore_breakpoint_hits ())
+    return;
+
+  if (bl->cond != NULL
+      && VEC_empty (agent_expr_p, bl->target_info.conditions))
+    return;
+
+  for (i = first_bp_location_at (bl->address);
+       i < bp_location_count && bp_location[i]->address == bl->address;
+       i++)
+    {
+      struct bp_location *loc = bp_location[i];
+
+      if (loc != bl
+	  && breakpoint_locations_match (bl, loc)
+	  && unduplicated_should_be_inserted (loc))
+	return;
+    }
+
+  bl->target_info.ignore_count = b->ignore_count;
+}
+
+/* Add the hits of BL the target skipped because of the ignore count
+   BL was inserted with to the hit count of BL's breakpoint, and take
+   them off its ignore count, as if GDB had seen them.  The target
+   reports all hits from then on.  */
+
+static void
+update_ignored_hits_from_target (struct bp_location *bl)
+{
+  struct breakpoint *b = bl->owner;
+  int ignored;
+
+  if (bl->ignore_count_on_target == 0)
+    return;
+
+  ignored = target_breakpoint_ignored_hits (bl->gdbarch, &bl->target_info);
+  if (ignored > bl->ignore_count_on_target)
+    ignored = bl->ignore_count_on_target;
+  bl->ignore_count_on_target = 0;
+
+  if (ignored <= 0)
+    return;
+
+  b->hit_count += ignored;
+  b->ignore_count -= ignored;
+  if (b->ignore_count < 0)
+    b->ignore_count = 0;
+  annotate_ignore_count_change ();
+  observer_notify_breakpoint_modified (b);
+}
+
 /* Insert a low-level "breakpoint" of some type.  BL is the breakpoint
    location.  Any error messages are printed to TMP_ERROR_STREAM; and
    DISABLED_BREAKS, and HW_BREAKPOINT_ERROR are used to report problems.
@@ -1724,7 +2120,23 @@ insert_bp_location (struct bp_location *bl,
 	{
 	  /* No overlay handling: just set the breakpoint.  */
 
+	  build_target_condition_list (bl);
+	  build_target_command_list (bl);
+	  build_target_ignore_count (bl);
 	  val = bl->owner->ops->insert_location (bl);
+
+	  /* The target leaves the commands it didn't take in the
+	     list, and resets the ignore count if it didn't take it.  */
+	  bl->conditions_on_target
+	    = (val == 0
+	       && !VEC_empty (agent_expr_p, bl->target_info.conditions));
+	  bl->commands_on_target
+	    = (val == 0
+	       && !VEC_empty (agent_expr_p, bl->target_info.tcommands));
+	  bl->ignore_count_on_target
+	    = val == 0 ? bl->target_info.ignore_count : 0;
+	  VEC_free (agent_expr_p, bl->target_info.conditions);
+	  VEC_free (agent_expr_p, bl->target_info.tcommands);
 	}
       else
 	{
@@ -1965,6 +2377,173 @@ insert_breakpoints (void)
     insert_breakpoint_locations ();
 }
 
+/* Return non-zero if BL is an ordinary software breakpoint location,
+   which can be inserted or removed along with others through
+   target_insert_breakpoints and target_remove_breakpoints.  Anything
+   else, including locations in overlays and in memory regions that
+   aren't writable, goes through insert_bp_location or
+   remove_breakpoint.  */
+
+static int
+batchable_bp_location_p (struct bp_location *bl)
+{
+  struct mem_region *mr;
+
+  if (bl->loc_type != bp_loc_software_breakpoint
+      || bl->owner->type == bp_hardware_breakpoint
+      || is_tracepoint (bl->owner)
+      || bl->owner->enable_state == bp_permanent
+      || bl->owner->ops->insert_location != bkpt_insert_location
+      || bl->owner->ops->remove_location != bkpt_remove_location)
+    return 0;
+
+  if (overlay_debugging != ovly_off
+      && bl->section != NULL
+      && section_is_overlay (bl->section))
+    return 0;
+
+  mr = lookup_mem_region (bl->address);
+  return mr == NULL || mr->attrib.mode == MEM_RW;
+}
+
+/* A qsort comparison function for batches of bp_location pointers,
+   which groups the locations that can be passed to the target in one
+   call: those of the same program space and architecture.  */
+
+static int
+bp_location_batch_compare (const void *ap, const void *bp)
+{
+  struct bp_location *a = *(struct bp_location **) ap;
+  struct bp_location *b = *(struct bp_location **) bp;
+
+  if (a->pspace->num != b->pspace->num)
+    return a->pspace->num < b->pspace->num ? -1 : 1;
+  if (a->gdbarch != b->gdbarch)
+    return (uintptr_t) a->gdbarch < (uintptr_t) b->gdbarch ? -1 : 1;
+  if (a->address != b->address)
+    return a->address < b->address ? -1 : 1;
+  return 0;
+}
+
+/* Insert or remove (according to INSERT) the COUNT locations in
+   LOCS, which are sorted by bp_location_batch_compare, with one
+   target call per program space and architecture.  The INSERTED flag
+   of the locations the target handled is updated; the others are
+   left for the caller to retry one at a time.  */
+
+static void
+bp_locations_batch (struct bp_location **locs, int count, int insert)
+{
+  struct bp_target_info **tgts;
+  int *results;
+  struct cleanup *old_chain;
+  int start, end, i;
+
+  tgts = xmalloc (count * sizeof (struct bp_target_info *));
+  old_chain = make_cleanup (xfree, tgts);
+  results = xmalloc (count * sizeof (int));
+  make_cleanup (xfree, results);
+  save_current_space_and_thread ();
+
+  for (start = 0; start < count; start = end)
+    {
+      struct gdbarch *gdbarch = locs[start]->gdbarch;
+      struct program_space *pspace = locs[start]->pspace;
+
+      for (end = start;
+	   end < count
+	     && locs[end]->pspace == pspace
+	     && locs[end]->gdbarch == gdbarch;
+	   end++)
+	tgts[end - start] = &locs[end]->target_info;
+
+      switch_to_program_space_and_thread (pspace);
+
+      /* See insert_breakpoint_locations.  */
+      if (insert
+	  && !gdbarch_has_global_breakpoints (target_gdbarch)
+	  && ptid_equal (inferior_ptid, null_ptid))
+	continue;
+
+      if (insert)
+	target_insert_breakpoints (gdbarch, end - start, tgts, results);
+      else
+	target_remove_breakpoints (gdbarch, end - start, tgts, results);
+
+      for (i = start; i < end; i++)
+	if (results[i - start] == 0)
+	  {
+	    locs[i]->inserted = insert;
+	    if (insert)
+	      {
+		locs[i]->conditions_on_target = 0;
+		locs[i]->commands_on_target = 0;
+		locs[i]->ignore_count_on_target = 0;
+	      }
+	  }
+    }
+
+  do_cleanups (old_chain);
+}
+
+/* Insert, in batches, the software breakpoint locations that should
+   be inserted and don't need any per-location handling.  Locations
+   the target fails to insert are left for insert_bp_location, which
+   reports why.  */
+
+static void
+insert_bp_locations_batched (void)
+{
+  struct bp_location *bl, **blp_tmp;
+  struct bp_location **locs;
+  struct cleanup *old_chain;
+  int count = 0;
+
+  locs = xmalloc (bp_location_count * sizeof (struct bp_location *));
+  old_chain = make_cleanup (xfree, locs);
+
+  ALL_BP_LOCATIONS (bl, blp_tmp)
+    {
+      if (!should_be_inserted (bl) || bl->inserted
+	  || !batchable_bp_location_p (bl))
+	continue;
+
+      if (bl->owner->thread != -1
+	  && !valid_thread_id (bl->owner->thread))
+	continue;
+
+      memset (&bl->target_info, 0, sizeof (bl->target_info));
+      bl->target_info.placed_address = bl->address;
+      bl->target_info.placed_address_space = bl->pspace->aspace;
+      bl->target_info.length = bl->length;
+
+      /* Locations with conditions, commands or an ignore count for
+	 the target are rare; send them the usual way.  */
+      build_target_condition_list (bl);
+      build_target_command_list (bl);
+      build_target_ignore_count (bl);
+      if (!VEC_empty (agent_expr_p, bl->target_info.conditions)
+	  || !VEC_empty (agent_expr_p, bl->target_info.tcommands)
+	  || bl->target_info.ignore_count != 0)
+	{
+	  VEC_free (agent_expr_p, bl->target_info.conditions);
+	  VEC_free (agent_expr_p, bl->target_info.tcommands);
+	  continue;
+	}
+
+      locs[count++] = bl;
+    }
+
+  if (count > 1)
+    {
+      qsort (locs, count, sizeof (struct bp_location *),
+	     bp_location_batch_compare);
+      bp_locations_batch (locs, count, 1);
+    }
+
+  do_cleanups (old_chain);
+}
+
 /* Used when starting or continuing the program.  */
 
 static void
@@ -1986,6 +2565,8 @@ insert_breakpoint_locations (void)
 
   save_current_space_and_thread ();
 
+  insert_bp_locations_batched ();
+
   ALL_BP_LOCATIONS (bl, blp_tmp)
     {
       if (!should_be_inserted (bl) || bl->inserted)
@@ -2075,8 +2656,34 @@ int
 remove_breakpoints (void)
 {
   struct bp_location *bl, **blp_tmp;
+  struct bp_location **locs;
+  struct cleanup *old_chain;
+  int count = 0;
   int val = 0;
 
+  /* Remove the ordinary software breakpoints in batches first; any
+     the target failed to remove are retried below, as are those whose
+     hits the target may have skipped, which must be accounted for
+     one at a time.  */
+  locs = xmalloc (bp_location_count * sizeof (struct bp_location *));
+  old_chain = make_cleanup (xfree, locs);
+
+  ALL_BP_LOCATIONS (bl, blp_tmp)
+  {
+    if (bl->inserted && bl->ignore_count_on_target == 0
+	&& batchable_bp_location_p (bl))
+      locs[count++] = bl;
+  }
+
+  if (count > 1)
+    {
+      qsort (locs, count, sizeof (struct bp_location *),
+	     bp_location_batch_compare);
+      bp_locations_batch (locs, count, 0);
+    }
+
+  do_cleanups (old_chain);
+
   ALL_BP_LOCATIONS (bl, blp_tmp)
   {
     if (bl->inserted && !is_tracepoint (bl->owner))
@@ -2614,6 +3221,35 @@ detach_breakpoints (int pid)
   return val;
 }
 
+/* If breakpoints stay inserted, re-insert the breakpoint at BL's
+   address, or all software breakpoints if BL is NULL, so that the
+   target is sent the current conditions of the locations there.
+   Otherwise there is nothing to do; breakpoints are inserted afresh,
+   with their conditions, on the next resume.  */
+
+static void
+force_breakpoint_reinsertion (struct bp_location *bl)
+{
+  struct bp_location *loc, **locp_tmp;
+  int removed = 0;
+
+  if (!breakpoints_always_inserted_mode ())
+    return;
+
+  ALL_BP_LOCATIONS (loc, locp_tmp)
+    if (loc->inserted
+	&& (bl == NULL
+	    ? loc->loc_type == bp_loc_software_breakpoint
+	    : breakpoint_locations_match (loc, bl)))
+      {
+	remove_breakpoint (loc, mark_uninserted);
+	removed = 1;
+      }
+
+  if (removed)
+    insert_breakpoints ();
+}
+
 /* Remove the breakpoint location BL from the current address space.
    Note that this is used to detach breakpoints from a child fork.
    When we get here, the child isn't in the inferior list, and neither
@@ -2648,7 +3284,9 @@ remove_breakpoint_1 (struct bp_location *bl, insertion_state_t is)
 	  || bl->section == NULL
 	  || !(section_is_overlay (bl->section)))
 	{
-	  /* No overlay handling: just remove the breakpoint.  */
+	  /* No overlay handling: just remove the breakpoint, once the
+	     hits the target skipped are accounted for.  */
+	  update_ignored_hits_from_target (bl);
 	  val = bl->owner->ops->remove_location (bl);
 	}
       else
@@ -3015,6 +3653,32 @@ software_breakpoint_inserted_here_p (struct address_space *aspace,
   return 0;
 }
 
+int
+software_breakpoint_inserted_in_range (struct address_space *aspace,
+				       CORE_ADDR addr, ULONGEST len)
+{
+  struct bp_location *bl, **blp_tmp;
+
+  ALL_BP_LOCATIONS (bl, blp_tmp)
+    {
+      CORE_ADDR l, h;
+
+      if (bl->loc_type != bp_loc_software_breakpoint
+	  || !bl->inserted
+	  || bl->pspace->aspace != aspace)
+	continue;
+
+      /* Check for intersection.  */
+      l = max (bl->target_info.placed_address, addr);
+      h = min (bl->target_info.placed_address + bl->target_info.shadow_len,
+	       addr + len);
+      if (l < h)
+	return 1;
+    }
+
+  return 0;
+}
+
 int
 hardware_watchpoint_inserted_in_range (struct address_space *aspace,
 				       CORE_ADDR addr, ULONGEST len)
@@ -3996,6 +4660,15 @@ bpstat_check_breakpoint_conditions (bpstat bs, ptid_t ptid)
   b = bs->breakpoint_at;
   gdb_assert (b != NULL);
 
+  /* Give a Python "fast_stop" method its say before anything here
+     needs a frame, so that the hits it rejects stay cheap.  */
+  if (b->py_bp_object && bs->stop
+      && !gdbpy_fast_stop (b->py_bp_object, ptid))
+    {
+      bs->stop = 0;
+      return;
+    }
+
   if (frame_id_p (b->frame_id)
       && !frame_id_eq (b->frame_id, get_stack_frame_id (get_current_frame ())))
     bs->stop = 0;
@@ -4167,7 +4840,9 @@ bpstat_stop_status (struct address_space *aspace,
 	    continue;
 
 	  /* Come here if it's a watchpoint, or if the break address
-	     matches.  */
+	     matches.  The target may have skipped hits before this
+	     one.  */
+	  update_ignored_hits_from_target (bl);
 
 	  bs = bpstat_alloc (bl, &bs_link);	/* Alloc a bpstat to
 						   explain stop.  */
@@ -4239,6 +4914,9 @@ bpstat_stop_status (struct address_space *aspace,
 	      if (command_line_is_silent (bs->commands
 					  ? bs->commands->commands : NULL))
 		bs->print = 0;
+
+	      if (b->ops->after_condition_true != NULL)
+		b->ops->after_condition_true (bs);
 	    }
 
 	  /* Print nothing for this entry if we don't stop or don't print.  */
@@ -4331,6 +5009,7 @@ bpstat_what (bpstat bs_head)
 	  break;
 	case bp_breakpoint:
 	case bp_hardware_breakpoint:
+	case bp_dprintf:
 	case bp_until:
 	case bp_finish:
 	  if (bs->stop)
@@ -4671,6 +5350,7 @@ bptype_string (enum bptype type)
     {bp_tracepoint, "tracepoint"},
     {bp_fast_tracepoint, "fast tracepoint"},
     {bp_static_tracepoint, "static tracepoint"},
+    {bp_dprintf, "dprintf"},
     {bp_jit_event, "jit events"},
     {bp_gnu_ifunc_resolver, "STT_GNU_IFUNC resolver"},
     {bp_gnu_ifunc_resolver_return, "STT_GNU_IFUNC resolver return"},
@@ -4811,6 +5491,7 @@ print_one_breakpoint_location (struct breakpoint *b,
       case bp_tracepoint:
       case bp_fast_tracepoint:
       case bp_static_tracepoint:
+      case bp_dprintf:
       case bp_jit_event:
       case bp_gnu_ifunc_resolver:
       case bp_gnu_ifunc_resolver_return:
@@ -5298,6 +5979,131 @@ breakpoints_info (char *args, int from_tty)
   default_collect_info ();
 }
 
+/* Return non-zero if BL is a location of a hardware watchpoint or
+   breakpoint that GDB inserts when the program resumes, and store in
+   *REGION the memory it watches.  */
+
+static int
+bp_location_watch_region (struct bp_location *bl,
+			  struct watch_region *region)
+{
+  struct breakpoint *b = bl->owner;
+
+  if (!breakpoint_enabled (b) || !bl->enabled || bl->shlib_disabled)
+    return 0;
+
+  if (b->type == bp_hardware_breakpoint)
+    {
+      region->addr = bl->address;
+      region->len = 1;
+      region->type = hw_execute;
+      return 1;
+    }
+
+  if (bl->loc_type == bp_loc_hardware_watchpoint
+      && !is_masked_watchpoint (b))
+    {
+      region->addr = bl->address;
+      region->len = bl->length;
+      region->type = bl->watchpoint_type;
+      return 1;
+    }
+
+  return 0;
+}
+
+/* Return non-zero if the debug register REG watches for one of the
+   locations of B.  */
+
+static int
+breakpoint_uses_debug_register (struct breakpoint *b,
+				const struct watch_region *reg)
+{
+  struct bp_location *bl;
+  struct watch_region region;
+
+  for (bl = b->loc; bl != NULL; bl = bl->next)
+    if (bp_location_watch_region (bl, &region)
+	&& (region.type == hw_execute) == (reg->type == hw_execute)
+	&& (region.type == hw_write) == (reg->type == hw_write)
+	&& region.addr < reg->addr + reg->len
+	&& reg->addr < region.addr + region.len)
+      return 1;
+
+  return 0;
+}
+
+/* Print how the target uses its debug registers, if it has any, for
+   the hardware watchpoints and breakpoints, and which of them share
+   each register.  */
+
+static void
+print_debug_register_usage (void)
+{
+  struct watch_region regs[16];
+  struct watch_region *wanted;
+  struct bp_location *bl, **blp_tmp;
+  struct cleanup *old_chain;
+  int nwanted = 0, nregs, in_use = 0;
+  int i;
+
+  ALL_BP_LOCATIONS (bl, blp_tmp)
+    if (bp_location_watch_region (bl, &regs[0]))
+      nwanted++;
+  if (nwanted == 0)
+    return;
+
+  wanted = xmalloc (nwanted * sizeof (struct watch_region));
+  old_chain = make_cleanup (xfree, wanted);
+  nwanted = 0;
+  ALL_BP_LOCATIONS (bl, blp_tmp)
+    if (bp_location_watch_region (bl, &wanted[nwanted]))
+      nwanted++;
+
+  nregs = target_debug_registers (wanted, nwanted,
+				  regs, ARRAY_SIZE (regs));
+  do_cleanups (old_chain);
+
+  if (nregs < 0)
+    {
+      printf_filtered (_("\nThe hardware watchpoints and breakpoints "
+			 "need more debug registers than there are.\n"));
+      return;
+    }
+  if (nregs > (int) ARRAY_SIZE (regs))
+    nregs = ARRAY_SIZE (regs);
+
+  for (i = 0; i < nregs; i++)
+    if (regs[i].len != 0)
+      in_use++;
+  if (in_use == 0)
+    return;
+
+  printf_filtered (_("\nDebug registers: %d of %d in use.\n"), in_use, nregs);
+  for (i = 0; i < nregs; i++)
+    {
+      struct breakpoint *b;
+      const char *sep = _(", used by ");
+
+      if (regs[i].len == 0)
+	continue;
+
+      printf_filtered ("%-4d%s, %d byte%s, %s", i,
+		       paddress (target_gdbarch, regs[i].addr),
+		       regs[i].len, regs[i].len == 1 ? "" : "s",
+		       regs[i].type == hw_execute ? "execute"
+		       : regs[i].type == hw_write ? "write" : "access");
+
+      ALL_BREAKPOINTS (b)
+	if (b->number > 0 && breakpoint_uses_debug_register (b, &regs[i]))
+	  {
+	    printf_filtered ("%s%d", sep, b->number);
+	    sep = " ";
+	  }
+      printf_filtered ("\n");
+    }
+}
+
 static void
 watchpoints_info (char *args, int from_tty)
 {
@@ -5311,6 +6117,8 @@ watchpoints_info (char *args, int from_tty)
       else
 	ui_out_message (uiout, 0, "No watchpoint matching '%s'.\n", args);
     }
+  else if ((args == NULL || *args == '\0') && !ui_out_is_mi_like_p (uiout))
+    print_debug_register_usage ();
 }
 
 static void
@@ -5623,6 +6431,7 @@ init_bp_location (struct bp_location *loc, const struct bp_location_ops *ops,
   switch (owner->type)
     {
     case bp_breakpoint:
+    case bp_dprintf:
     case bp_until:
     case bp_finish:
     case bp_longjmp:
@@ -5779,6 +6588,7 @@ set_breakpoint_location_function (struct bp_location *loc, int explicit_loc)
 
   if (loc->owner->type == bp_breakpoint
       || loc->owner->type == bp_hardware_breakpoint
+      || loc->owner->type == bp_dprintf
       || is_tracepoint (loc->owner))
     {
       int is_gnu_ifunc;
@@ -5848,7 +6658,8 @@ init_raw_breakpoint (struct breakpoint *b, struct gdbarch *gdbarch,
   /* Store the program space that was used to set the breakpoint,
      except for ordinary breakpoints, which are independent of the
      program space.  */
-  if (bptype != bp_breakpoint && bptype != bp_hardware_breakpoint)
+  if (bptype != bp_breakpoint && bptype != bp_hardware_breakpoint
+      && bptype != bp_dprintf)
     b->pspace = sal.pspace;
 
   breakpoints_changed ();
@@ -6103,6 +6914,7 @@ disable_breakpoints_in_shlibs (void)
     if (((b->type == bp_breakpoint)
 	 || (b->type == bp_jit_event)
 	 || (b->type == bp_hardware_breakpoint)
+	 || (b->type == bp_dprintf)
 	 || (is_tracepoint (b)))
 	&& loc->pspace == current_program_space
 	&& !loc->shlib_disabled
@@ -6145,7 +6957,8 @@ disable_breakpoints_in_unloaded_shlib (struct so_list *solib)
 	&& !loc->shlib_disabled
 	&& (((b->type == bp_breakpoint
 	      || b->type == bp_jit_event
-	      || b->type == bp_hardware_breakpoint)
+	      || b->type == bp_hardware_breakpoint
+	      || b->type == bp_dprintf)
 	     && (loc->loc_type == bp_loc_hardware_breakpoint
 		 || loc->loc_type == bp_loc_software_breakpoint))
 	    || is_tracepoint (b))
@@ -7942,7 +8755,8 @@ create_breakpoint (struct gdbarch *gdbarch,
       b->condition_not_parsed = 1;
       b->enable_state = enabled ? bp_enabled : bp_disabled;
       if ((type_wanted != bp_breakpoint
-           && type_wanted != bp_hardware_breakpoint) || thread != -1)
+           && type_wanted != bp_hardware_breakpoint
+           && type_wanted != bp_dprintf) || thread != -1)
 	b->pspace = current_program_space;
 
       install_breakpoint (internal, b, 0);
@@ -8319,6 +9133,90 @@ find_breakpoint_range_end (struct symtab_and_line sal)
   return end;
 }
 
+/* Implement the "dprintf" command: "dprintf LOCATION,"FORMAT",ARGS".  */
+
+static void
+dprintf_command (char *arg, int from_tty)
+{
+  char *p, *location, *format_args, *format;
+  int depth = 0, quote = 0;
+  int prev_count = breakpoint_count;
+  struct format_piece *fpieces;
+  const char *format_error;
+  struct breakpoint *b;
+  struct cleanup *old_chain;
+
+  if (arg == NULL)
+    error_no_arg (_("location, format string and arguments"));
+
+  /* The location ends at the first comma that isn't nested in
+     parentheses or quotes, as in "dprintf foo(int, char),...".  */
+  for (p = arg; *p != '\0'; p++)
+    {
+      if (quote != 0)
+	{
+	  if (*p == '\\' && p[1] != '\0')
+	    p++;
+	  else if (*p == quote)
+	    quote = 0;
+	}
+      else if (*p == '"' || *p == '\'')
+	quote = *p;
+      else if (*p == '(' || *p == '[')
+	depth++;
+      else if ((*p == ')' || *p == ']') && depth > 0)
+	depth--;
+      else if (*p == ',' && depth == 0)
+	break;
+    }
+
+  if (*p != ',' || p == arg)
+    error (_("Format string required"));
+
+  location = savestring (arg, p - arg);
+  old_chain = make_cleanup (xfree, location);
+  format_args = skip_spaces (p + 1);
+
+  /* Check the format string now, rather than at the first hit.  */
+  p = format_args;
+  format = extract_printf_format (&p);
+  make_cleanup (xfree, format);
+  fpieces = parse_format_string (format, &format_error);
+  if (fpieces == NULL)
+    error ("%s", format_error);
+  free_format_pieces (fpieces);
+
+  create_breakpoint (get_current_arch (),
+		     location,
+		     NULL, 0, 1 /* parse arg */,
+		     0, bp_dprintf,
+		     0 /* Ignore count */,
+		     pending_break_support,
+		     &dprintf_breakpoint_ops,
+		     from_tty,
+		     1 /* enabled */,
+		     0 /* internal */,
+		     0);
+
+  /* Hand the format and arguments to the dprintfs just created.  */
+  ALL_BREAKPOINTS (b)
+    if (b->number > prev_count && b->type == bp_dprintf
+	&& b->dprintf_args == NULL)
+      {
+	struct bp_location *loc;
+
+	b->dprintf_args = xstrdup (format_args);
+	observer_notify_breakpoint_modified (b);
+
+	/* Breakpoints that stay inserted went in without their
+	   printf; let the target have it.  */
+	for (loc = b->loc; loc != NULL; loc = loc->next)
+	  force_breakpoint_reinsertion (loc);
+      }
+
+  do_cleanups (old_chain);
+}
+
 /* Implement the "break-range" CLI command.  */
 
 static void
@@ -10375,12 +11273,103 @@ swap_insertion (struct bp_location *left, struct bp_location *right)
   if (is_tracepoint (right->owner))
     gdb_assert (!right->duplicate);
 
-  left->inserted = right->inserted;
-  left->duplicate = right->duplicate;
-  left->target_info = right->target_info;
-  right->inserted = left_inserted;
-  right->duplicate = left_duplicate;
-  right->target_info = left_target_info;
+  left->inserted = right->inserted;
+  left->duplicate = right->duplicate;
+  left->target_info = right->target_info;
+  right->inserted = left_inserted;
+  right->duplicate = left_duplicate;
+  right->target_info = left_target_info;
+}
+
+/* Return true if the set of locations that should be inserted at the
+   address of the inserted location BL changed since the last
+   update_global_location_list.  OLD_LOCATION and OLD_LOCATION_COUNT
+   describe the former bp_location array; BP_LOCATION is already the
+   new one.  */
+
+static int
+bp_location_set_changed_p (struct bp_location *bl,
+			   struct bp_location **old_location,
+			   unsigned old_location_count)
+{
+  unsigned i, j;
+
+  /* A location got added, enabled or disabled.  */
+  for (i = first_bp_location_at (bl->address);
+       i < bp_location_count && bp_location[i]->address == bl->address;
+       i++)
+    {
+      struct bp_location *loc = bp_location[i];
+
+      if (breakpoint_locations_match (loc, bl)
+	  && (unduplicated_should_be_inserted (loc)
+	      != loc->was_insertable))
+	return 1;
+    }
+
+  /* A location got deleted.  The old array may no longer be sorted,
+     as locations can move.  */
+  for (i = 0; i < old_location_count; i++)
+    {
+      struct bp_location *old_loc = old_location[i];
+      int found = 0;
+
+      if (!old_loc->was_insertable
+	  || !breakpoint_locations_match (old_loc, bl))
+	continue;
+
+      for (j = first_bp_location_at (old_loc->address);
+	   j < bp_location_count
+	     && bp_location[j]->address == old_loc->address;
+	   j++)
+	if (bp_location[j] == old_loc)
+	  {
+	    found = 1;
+	    break;
+	  }
+
+      if (!found)
+	return 1;
+    }
+
+  return 0;
+}
+
+/* Remove the inserted locations whose target-side conditions,
+   commands or ignore count were built from a set of locations at
+   their address that has since changed, so that they are inserted
+   again, with the current ones, in update_global_location_list.
+   Merely marking a new location at such an address a duplicate would
+   leave the target filtering out, or handling itself, hits that GDB
+   now has to see.  Return the number of locations removed.  */
+
+static int
+remove_stale_target_side_locations (struct bp_location **old_location,
+				    unsigned old_location_count)
+{
+  unsigned i;
+  int removed = 0;
+
+  for (i = 0; i < old_location_count; i++)
+    {
+      struct bp_location *old_loc = old_location[i];
+
+      if (!old_loc->inserted
+	  || old_loc->loc_type != bp_loc_software_breakpoint
+	  || !(old_loc->conditions_on_target
+	       || old_loc->commands_on_target
+	       || old_loc->ignore_count_on_target))
+	continue;
+
+      if (bp_location_set_changed_p (old_loc, old_location,
+				     old_location_count))
+	{
+	  remove_breakpoint (old_loc, mark_uninserted);
+	  removed++;
+	}
+    }
+
+  return removed;
 }
 
 /* If SHOULD_INSERT is false, do not insert any breakpoint locations
@@ -10404,6 +11393,7 @@ update_global_location_list (int should_insert)
   struct breakpoint *b;
   struct bp_location **locp, *loc;
   struct cleanup *cleanups;
+  int stale_removed = 0;
 
   /* Used in the duplicates detection below.  When iterating over all
      bp_locations, points to the first bp_location of a given address.
@@ -10441,6 +11431,16 @@ update_global_location_list (int should_insert)
 
   bp_location_target_extensions_update ();
 
+  /* OLD_LOCATION's owners are all still valid here.  This is done
+     even if SHOULD_INSERT is false, as deleting a breakpoint changes
+     the set of locations at its address too.  */
+  if (breakpoints_always_inserted_mode ()
+      && (have_live_inferiors ()
+	  || (gdbarch_has_global_breakpoints (target_gdbarch))))
+    stale_removed
+      = remove_stale_target_side_locations (old_location,
+					    old_location_count);
+
   /* Identify bp_location instances that are no longer present in the
      new list, and therefore should be freed.  Note that it's not
      necessary that those locations should be removed from inferior --
@@ -10695,7 +11695,13 @@ update_global_location_list (int should_insert)
 			"a permanent breakpoint"));
     }
 
-  if (breakpoints_always_inserted_mode () && should_insert
+  ALL_BP_LOCATIONS (loc, locp)
+    loc->was_insertable = unduplicated_should_be_inserted (loc);
+
+  /* Locations removed above to be resent are inserted again even if
+     SHOULD_INSERT is false; in the tear-down cases described above,
+     nothing is inserted, so there are none.  */
+  if (breakpoints_always_inserted_mode () && (should_insert || stale_removed)
       && (have_live_inferiors ()
 	  || (gdbarch_has_global_breakpoints (target_gdbarch))))
     insert_breakpoint_locations ();
@@ -10812,6 +11818,10 @@ static void
 bp_location_dtor (struct bp_location *self)
 {
   xfree (self->cond);
+  if (self->cond_bytecode != NULL)
+    free_agent_expr (self->cond_bytecode);
+  if (self->cmd_bytecode != NULL)
+    free_agent_expr (self->cmd_bytecode);
   xfree (self->function_name);
   xfree (self->source_file);
 }
@@ -10829,9 +11839,11 @@ base_breakpoint_dtor (struct breakpoint *self)
 {
   decref_counted_command_line (&self->commands);
   xfree (self->cond_string);
+  xfree (self->dprintf_args);
   xfree (self->addr_string);
   xfree (self->filter);
   xfree (self->addr_string_range_end);
+  free_re_set_key (self->re_set_key);
 }
 
 static struct bp_location *
@@ -10937,7 +11949,8 @@ static struct breakpoint_ops base_breakpoint_ops =
   NULL,
   base_breakpoint_print_one_detail,
   base_breakpoint_print_mention,
-  base_breakpoint_print_recreate
+  base_breakpoint_print_recreate,
+  NULL
 };
 
 /* Default breakpoint_ops methods.  */
@@ -11083,6 +12096,70 @@ bkpt_print_recreate (struct breakpoint *tp, struct ui_file *fp)
   print_recreate_thread (tp, fp);
 }
 
+/* Virtual table for dprintf breakpoints.  */
+
+static void
+dprintf_print_one_detail (const struct breakpoint *b, struct ui_out *uiout)
+{
+  ui_out_text (uiout, "        printf ");
+  ui_out_field_string (uiout, "printf", b->dprintf_args);
+  ui_out_text (uiout, "\n");
+}
+
+static void
+dprintf_print_mention (struct breakpoint *b)
+{
+  if (ui_out_is_mi_like_p (current_uiout))
+    return;
+
+  printf_filtered (_("Dprintf %d"), b->number);
+  say_where (b);
+}
+
+static void
+dprintf_print_recreate (struct breakpoint *tp, struct ui_file *fp)
+{
+  fprintf_unfiltered (fp, "dprintf %s", tp->addr_string);
+
+  /* The thread or task goes with the location, before the format.  */
+  if (tp->thread != -1)
+    fprintf_unfiltered (fp, " thread %d", tp->thread);
+  if (tp->task != 0)
+    fprintf_unfiltered (fp, " task %d", tp->task);
+
+  fprintf_unfiltered (fp, ",%s\n", tp->dprintf_args);
+}
+
+/* Print the dprintf of BS, unless the target already did, and let the
+   program continue.  An error while printing stops it instead.  */
+
+static void
+dprintf_after_condition_true (struct bpstats *bs)
+{
+  struct breakpoint *b = bs->breakpoint_at;
+  volatile struct gdb_exception ex;
+
+  bs->stop = 0;
+  bs->print = 0;
+
+  if (bs->bp_location_at->commands_on_target)
+    return;
+
+  TRY_CATCH (ex, RETURN_MASK_ERROR)
+    {
+      ui_printf (b->dprintf_args, gdb_stdout);
+      gdb_flush (gdb_stdout);
+    }
+
+  if (ex.reason < 0)
+    {
+      exception_fprintf (gdb_stderr, ex,
+			 _("Error in dprintf %d:\n"), b->number);
+      bs->stop = 1;
+      bs->print = 1;
+    }
+}
+
 /* Virtual table for internal breakpoints.  */
 
 static void
@@ -12021,14 +13098,366 @@ breakpoint_re_set_one (void *bint)
   return 0;
 }
 
-/* Re-set all breakpoints after symbols have been re-loaded.  */
-void
-breakpoint_re_set (void)
+/* Statistics about breakpoint re-sets, for "maint info
+   breakpoint-re-set-stats".  */
+
+static struct
+{
+  /* The number of re-sets of all the breakpoints, and of re-sets
+     limited to new objfiles.  */
+  unsigned long full;
+  unsigned long incremental;
+
+  /* The number of breakpoints re-set, and of breakpoints left alone
+     by incremental re-sets.  */
+  unsigned long breakpoints_re_set;
+  unsigned long breakpoints_skipped;
+
+  /* The time spent re-setting breakpoints, and the longest re-set.  */
+  struct timeval total_time;
+  struct timeval max_time;
+} re_set_stats;
+
+/* Whether breakpoint_re_set_objfiles only re-sets the breakpoints
+   that may have locations in the new objfiles.  */
+
+static int incremental_breakpoint_re_set = 1;
+
+/* What a breakpoint's location spec can match, as far as deciding
+   whether a new objfile may hold locations for it goes.  */
+
+struct breakpoint_re_set_key
+{
+  /* The ADDR_STRING this was parsed from.  */
+  char *spec;
+
+  /* Zero if the spec is not in one of the forms we understand; the
+     breakpoint may then have locations in any objfile.  */
+  int parsed;
+
+  /* Non-zero if the spec is an address.  */
+  int address;
+
+  /* The base name of the source file the spec names, or NULL.  */
+  char *file;
+
+  /* The function the spec names, or NULL if it names a line.  */
+  char *function;
+};
+
+static void
+free_re_set_key (struct breakpoint_re_set_key *key)
+{
+  if (key != NULL)
+    {
+      xfree (key->spec);
+      xfree (key->file);
+      xfree (key->function);
+      xfree (key);
+    }
+}
+
+/* Return non-zero if C may be part of a C identifier.  */
+
+static int
+re_set_identifier_char_p (int c)
+{
+  return isalnum (c) || c == '_' || c == '$' || c == '.';
+}
+
+/* Parse SPEC, a breakpoint's ADDR_STRING, into a new key.  Only
+   *ADDRESS, FUNCTION, FILE:FUNCTION and FILE:LINE are understood,
+   with plain C identifiers; the spec of a pending breakpoint may be
+   followed by its condition.  */
+
+static struct breakpoint_re_set_key *
+parse_re_set_key (const char *spec)
+{
+  struct breakpoint_re_set_key *key = XZALLOC (struct breakpoint_re_set_key);
+  const char *start, *end, *colon = NULL, *p;
+
+  key->spec = xstrdup (spec);
+
+  start = spec;
+  while (isspace (*start))
+    start++;
+
+  if (*start == '*')
+    {
+      key->parsed = key->address = 1;
+      return key;
+    }
+
+  for (end = start; *end != '\0' && !isspace (*end); end++)
+    if (*end == ':')
+      {
+	/* A scope operator, or a drive letter.  */
+	if (colon != NULL)
+	  return key;
+	colon = end;
+      }
+
+  p = colon != NULL ? colon + 1 : start;
+  if (p == end || colon == start)
+    return key;
+
+  if (isdigit (*p))
+    {
+      /* A line in the default source file depends on what that is.  */
+      if (colon == NULL)
+	return key;
+      for (; p < end; p++)
+	if (!isdigit (*p))
+	  return key;
+    }
+  else
+    {
+      const char *q;
+
+      if (*p == '$')
+	return key;
+      for (q = p; q < end; q++)
+	if (!re_set_identifier_char_p (*q))
+	  return key;
+      key->function = savestring (p, end - p);
+    }
+
+  if (colon != NULL)
+    {
+      char *file = savestring (start, colon - start);
+
+      if (strpbrk (file, "\"'") != NULL)
+	{
+	  xfree (file);
+	  xfree (key->function);
+	  key->function = NULL;
+	  return key;
+	}
+      key->file = xstrdup (lbasename (file));
+      xfree (file);
+    }
+
+  key->parsed = 1;
+  return key;
+}
+
+/* The objfiles an incremental re-set is for.  */
+
+struct re_set_scope
+{
+  struct objfile **objfiles;
+  int count;
+
+  /* The base names of the source files of OBJFILES, built when first
+     needed.  */
+  htab_t file_names;
+};
+
+/* Hash and equality functions for the file_names table of struct
+   re_set_scope, matching file names the way filename_cmp does.  */
+
+static hashval_t
+hash_re_set_file_name (const void *p)
+{
+  const unsigned char *name = p;
+  hashval_t hash = 0;
+
+  for (; *name != '\0'; name++)
+#ifdef HAVE_CASE_INSENSITIVE_FILE_SYSTEM
+    hash = hash * 67 + TOLOWER (*name) - 113;
+#else
+    hash = hash * 67 + *name - 113;
+#endif
+  return hash;
+}
+
+static int
+eq_re_set_file_name (const void *a, const void *b)
+{
+  return filename_cmp (a, b) == 0;
+}
+
+/* Add the base name of FILENAME to the htab_t DATA.  */
+
+static void
+add_re_set_file_name (const char *filename, const char *fullname,
+		      void *data)
+{
+  htab_t names = data;
+  const char *base = lbasename (filename);
+  void **slot = htab_find_slot (names, base, INSERT);
+
+  *slot = (void *) base;
+}
+
+/* Return non-zero if one of the objfiles of SCOPE has a source file
+   whose base name is FILE.  */
+
+static int
+re_set_scope_has_file (struct re_set_scope *scope, const char *file)
+{
+  if (scope->file_names == NULL)
+    {
+      int i;
+
+      scope->file_names = htab_create_alloc (127, hash_re_set_file_name,
+					     eq_re_set_file_name, NULL,
+					     xcalloc, xfree);
+      for (i = 0; i < scope->count; i++)
+	{
+	  struct objfile *parent = scope->objfiles[i], *objfile;
+
+	  for (objfile = parent;
+	       objfile != NULL;
+	       objfile = objfile_separate_debug_iterate (parent, objfile))
+	    {
+	      struct symtab *s;
+
+	      ALL_OBJFILE_SYMTABS (objfile, s)
+		add_re_set_file_name (s->filename, NULL, scope->file_names);
+	      if (objfile->sf != NULL)
+		objfile->sf->qf->map_symbol_filenames (objfile,
+						       add_re_set_file_name,
+						       scope->file_names, 0);
+	    }
+	}
+    }
+
+  return htab_find (scope->file_names, file) != NULL;
+}
+
+/* Return non-zero if PARENT or one of its separate debug objfiles
+   may define a function called NAME.  */
+
+static int
+objfile_may_define_function (struct objfile *parent, const char *name)
+{
+  struct objfile *objfile;
+
+  if (lookup_minimal_symbol (name, NULL, parent) != NULL)
+    return 1;
+
+  for (objfile = parent;
+       objfile != NULL;
+       objfile = objfile_separate_debug_iterate (parent, objfile))
+    {
+      int kind;
+
+      for (kind = GLOBAL_BLOCK; kind <= STATIC_BLOCK; kind++)
+	{
+	  struct symtab *s;
+
+	  if (objfile->sf != NULL)
+	    objfile->sf->qf->pre_expand_symtabs_matching (objfile, kind,
+							  name, VAR_DOMAIN);
+	  ALL_OBJFILE_SYMTABS (objfile, s)
+	    if (s->primary
+		&& lookup_block_symbol (BLOCKVECTOR_BLOCK (BLOCKVECTOR (s),
+							   kind),
+					name, VAR_DOMAIN) != NULL)
+	      return 1;
+	  if (objfile->sf != NULL
+	      && objfile->sf->qf->lookup_symbol (objfile, kind,
+						 name, VAR_DOMAIN) != NULL)
+	    return 1;
+	}
+    }
+
+  return 0;
+}
+
+/* Return non-zero if B may have locations in the objfiles of SCOPE,
+   and so needs re-setting.  Only ordinary breakpoints and tracepoints
+   set on simple C locations are ever left alone.  */
+
+static int
+breakpoint_may_match_scope (struct breakpoint *b, struct re_set_scope *scope)
+{
+  struct breakpoint_re_set_key *key;
+  int i;
+
+  if ((b->ops->re_set != bkpt_re_set && b->ops->re_set != tracepoint_re_set)
+      || b->type == bp_static_tracepoint
+      || b->addr_string == NULL
+      || b->addr_string_range_end != NULL
+      || case_sensitivity != case_sensitive_on
+      || (b->language != language_c && b->language != language_cplus
+	  && b->language != language_asm
+	  && b->language != language_minimal))
+    return 1;
+
+  /* Parse the spec once, and again only if it changes.  */
+  if (b->re_set_key == NULL || strcmp (b->re_set_key->spec,
+				       b->addr_string) != 0)
+    {
+      free_re_set_key (b->re_set_key);
+      b->re_set_key = parse_re_set_key (b->addr_string);
+    }
+  key = b->re_set_key;
+
+  if (!key->parsed)
+    return 1;
+
+  for (i = 0; i < scope->count; i++)
+    {
+      struct objfile *objfile = scope->objfiles[i];
+
+      if (b->pspace != NULL && b->pspace != objfile->pspace)
+	continue;
+
+      if (key->address)
+	{
+	  struct bp_location *loc;
+	  struct obj_section *osect;
+
+	  /* The address doesn't change, but the new objfile may have
+	     the symbols for it.  */
+	  if (b->loc == NULL)
+	    return 1;
+	  for (loc = b->loc; loc != NULL; loc = loc->next)
+	    if (loc->pspace == objfile->pspace)
+	      ALL_OBJFILE_OSECTIONS (objfile, osect)
+		if (loc->address >= obj_section_addr (osect)
+		    && loc->address < obj_section_endaddr (osect))
+		  return 1;
+	  continue;
+	}
+
+      if (key->file != NULL && !re_set_scope_has_file (scope, key->file))
+	continue;
+
+      if (key->function == NULL
+	  || objfile_may_define_function (objfile, key->function))
+	return 1;
+    }
+
+  return 0;
+}
+
+/* A cleanup freeing the file name table of the re_set_scope ARG.  */
+
+static void
+free_re_set_scope (void *arg)
+{
+  struct re_set_scope *scope = arg;
+
+  if (scope->file_names != NULL)
+    htab_delete (scope->file_names);
+}
+
+/* Re-set the breakpoints, all of them if SCOPE is NULL, or those that
+   may have locations in its objfiles.  */
+
+static void
+breakpoint_re_set_1 (struct re_set_scope *scope)
 {
   struct breakpoint *b, *b_tmp;
   enum language save_language;
   int save_input_radix;
   struct cleanup *old_chain;
+  struct timeval start, end, delta;
+
+  gettimeofday (&start, NULL);
 
   save_language = current_language->la_language;
   save_input_radix = input_radix;
@@ -12037,11 +13466,20 @@ breakpoint_re_set (void)
   ALL_BREAKPOINTS_SAFE (b, b_tmp)
   {
     /* Format possible error msg.  */
-    char *message = xstrprintf ("Error in re-setting breakpoint %d: ",
-				b->number);
-    struct cleanup *cleanups = make_cleanup (xfree, message);
+    char *message;
+    struct cleanup *cleanups;
+
+    if (scope != NULL && !breakpoint_may_match_scope (b, scope))
+      {
+	re_set_stats.breakpoints_skipped++;
+	continue;
+      }
+
+    message = xstrprintf ("Error in re-setting breakpoint %d: ", b->number);
+    cleanups = make_cleanup (xfree, message);
     catch_errors (breakpoint_re_set_one, b, message, RETURN_MASK_ALL);
     do_cleanups (cleanups);
+    re_set_stats.breakpoints_re_set++;
   }
   set_language (save_language);
   input_radix = save_input_radix;
@@ -12057,8 +13495,68 @@ breakpoint_re_set (void)
 
   /* While we're at it, reset the skip list too.  */
   skip_re_set ();
+
+  if (scope != NULL)
+    re_set_stats.incremental++;
+  else
+    re_set_stats.full++;
+  gettimeofday (&end, NULL);
+  timeval_sub (&delta, &end, &start);
+  timeval_add (&re_set_stats.total_time, &re_set_stats.total_time, &delta);
+  if (delta.tv_sec > re_set_stats.max_time.tv_sec
+      || (delta.tv_sec == re_set_stats.max_time.tv_sec
+	  && delta.tv_usec > re_set_stats.max_time.tv_usec))
+    re_set_stats.max_time = delta;
 }
-
+
+/* Re-set all breakpoints after symbols have been re-loaded.  */
+void
+breakpoint_re_set (void)
+{
+  breakpoint_re_set_1 (NULL);
+}
+
+/* See breakpoint.h.  */
+
+void
+breakpoint_re_set_objfiles (struct objfile **objfiles, int count)
+{
+  struct re_set_scope scope;
+  struct cleanup *old_chain;
+
+  if (!incremental_breakpoint_re_set)
+    {
+      breakpoint_re_set ();
+      return;
+    }
+
+  scope.objfiles = objfiles;
+  scope.count = count;
+  scope.file_names = NULL;
+  old_chain = make_cleanup (free_re_set_scope, &scope);
+
+  breakpoint_re_set_1 (&scope);
+
+  do_cleanups (old_chain);
+}
+
+/* Implement the "maint info breakpoint-re-set-stats" command.  */
+
+static void
+maintenance_info_breakpoint_re_set_stats (char *args, int from_tty)
+{
+  printf_filtered (_("Breakpoint re-sets: %lu full, %lu incremental.\n"),
+		   re_set_stats.full, re_set_stats.incremental);
+  printf_filtered (_("Breakpoints re-set: %lu, left alone: %lu.\n"),
+		   re_set_stats.breakpoints_re_set,
+		   re_set_stats.breakpoints_skipped);
+  printf_filtered (_("Time spent: %ld.%06lds, longest re-set: %ld.%06lds.\n"),
+		   (long) re_set_stats.total_time.tv_sec,
+		   (long) re_set_stats.total_time.tv_usec,
+		   (long) re_set_stats.max_time.tv_sec,
+		   (long) re_set_stats.max_time.tv_usec);
+}
+
 /* Reset the thread number of this breakpoint:
 
    - If the breakpoint is for all threads, leave it as-is.
@@ -12087,6 +13585,7 @@ void
 set_ignore_count (int bptnum, int count, int from_tty)
 {
   struct breakpoint *b;
+  struct bp_location *bl;
 
   if (count < 0)
     count = 0;
@@ -12101,7 +13600,13 @@ set_ignore_count (int bptnum, int count, int from_tty)
 			     bptnum);
 	  return;
 	}
-      
+
+      /* The target may be skipping hits according to the previous
+	 count; account for those, and let the target have the new
+	 one.  */
+      for (bl = b->loc; bl != NULL; bl = bl->next)
+	update_ignored_hits_from_target (bl);
+
       b->ignore_count = count;
       if (from_tty)
 	{
@@ -12118,6 +13623,8 @@ set_ignore_count (int bptnum, int count, int from_tty)
 			     count, bptnum);
 	}
       breakpoints_changed ();
+      if (b->loc != NULL)
+	force_breakpoint_reinsertion (b->loc);
       observer_notify_breakpoint_modified (b);
       return;
     }
@@ -13469,6 +14976,14 @@ initialize_breakpoint_ops (void)
   ops->print_mention = bkpt_print_mention;
   ops->print_recreate = bkpt_print_recreate;
 
+  /* Dynamic printf breakpoints.  */
+  ops = &dprintf_breakpoint_ops;
+  *ops = bkpt_breakpoint_ops;
+  ops->print_one_detail = dprintf_print_one_detail;
+  ops->print_mention = dprintf_print_mention;
+  ops->print_recreate = dprintf_print_recreate;
+  ops->after_condition_true = dprintf_after_condition_true;
+
   /* Ranged breakpoints.  */
   ops = &ranged_breakpoint_ops;
   *ops = bkpt_breakpoint_ops;
@@ -14106,6 +15621,24 @@ inferior in all-stop mode, gdb behaves as if always-inserted mode is off."),
 			   &breakpoint_set_cmdlist,
 			   &breakpoint_show_cmdlist);
 
+  add_setshow_enum_cmd ("condition-evaluation", class_breakpoint,
+			condition_evaluation_enums,
+			&condition_evaluation_mode, _("\
+Set mode of breakpoint condition evaluation."), _("\
+Show mode of breakpoint condition evaluation."), _("\
+When this mode is host, breakpoint conditions are evaluated by GDB\n\
+each time the target reports a breakpoint hit.  When this mode is\n\
+target, conditions are compiled to agent expressions and sent to the\n\
+target along with the breakpoint, and the target only reports the hits\n\
+for which the condition is true.  Conditions that can't be compiled are\n\
+still evaluated by GDB.  When this mode is auto (which is the default),\n\
+conditions are evaluated by the target if it supports it, and by GDB\n\
+otherwise."),
+			   &set_condition_evaluation_mode,
+			   &show_condition_evaluation_mode,
+			   &breakpoint_set_cmdlist,
+			   &breakpoint_show_cmdlist);
+
   add_com ("break-range", class_breakpoint, break_range_command, _("\
 Set a breakpoint for an address range.\n\
 break-range START-LOCATION, END-LOCATION\n\
@@ -14122,6 +15655,50 @@ The breakpoint will stop execution of the inferior whenever it executes\n\
 an instruction at any address within the [START-LOCATION, END-LOCATION]\n\
 range (including START-LOCATION and END-LOCATION)."));
 
+  c = add_com ("dprintf", class_breakpoint, dprintf_command, _("\
+Set a dynamic printf at specified line or function.\n\
+dprintf location,\"format string\",arg1,arg2,...\n\
+location may be a line number, function name, or \"*\" and an address.\n\
+Each time the program reaches the location, the arguments are printed\n\
+as by the \"printf\" command, and the program continues without\n\
+stopping.  See \"set dprintf-style\" for where the printing happens."));
+  set_cmd_completer (c, location_completer);
+
+  add_setshow_enum_cmd ("dprintf-style", class_support,
+			dprintf_style_enums, &dprintf_style, _("\
+Set the style of usage for dynamic printf."), _("\
+Show the style of usage for dynamic printf."), _("\
+This setting chooses how GDB will do a dynamic printf.\n\
+If the value is \"gdb\", GDB prints the output itself each time a\n\
+dprintf is hit, and then lets the program continue.\n\
+If the value is \"agent\", the printf is compiled to an agent expression\n\
+and sent to targets that can run breakpoint commands, which print it\n\
+without reporting the hits to GDB.  Dprintfs the target can't print\n\
+are printed by GDB."),
+			set_dprintf_style,
+			NULL /* show_dprintf_style */,
+			&setlist, &showlist);
+
+  add_setshow_boolean_cmd ("incremental-breakpoint-re-set", class_maintenance,
+			   &incremental_breakpoint_re_set, _("\
+Set whether loading a shared library only re-sets affected breakpoints."),
+			   _("\
+Show whether loading a shared library only re-sets affected breakpoints."),
+			   _("\
+When on, the breakpoints whose locations can't be in the symbols of a\n\
+newly loaded shared library are left alone, instead of being looked up\n\
+again in all the symbols."),
+			   NULL, NULL,
+			   &maintenance_set_cmdlist,
+			   &maintenance_show_cmdlist);
+
+  add_cmd ("breakpoint-re-set-stats", class_maintenance,
+	   maintenance_info_breakpoint_re_set_stats, _("\
+Display breakpoint re-set statistics.\n\
+Show how many times breakpoints were re-set after symbols changed,\n\
+how many breakpoints were re-set or left alone, and the time it took."),
+	   &maintenanceinfolist);
+
   automatic_hardware_breakpoints = 1;
 
   observer_attach_about_to_proceed (breakpoint_about_to_proceed);
@@ -22,6 +22,7 @@
 #include "frame.h"
 #include "value.h"
 #include "vec.h"
+#include "ax.h"
 
 struct value;
 struct block;
@@ -30,6 +31,8 @@ struct get_number_or_range_state;
 struct thread_info;
 struct bpstats;
 struct bp_location;
+struct objfile;
+struct breakpoint_re_set_key;
 
 /* This is the maximum number of bytes a breakpoint instruction can
    take.  Feel free to increase it.  It's just used in a few places to
@@ -151,6 +154,10 @@ enum bptype
     bp_fast_tracepoint,
     bp_static_tracepoint,
 
+    /* A dynamic printf: a breakpoint that prints its arguments, and
+       then lets the program continue.  */
+    bp_dprintf,
+
     /* Event for JIT compiled code generation or deletion.  */
     bp_jit_event,
 
@@ -247,6 +254,22 @@ struct bp_target_info
      (e.g. if a remote stub handled the details).  We may still need
      the size to remove the breakpoint safely.  */
   int placed_size;
+
+  /* Conditions the target should evaluate when the breakpoint is
+     hit, as agent expressions.  The hit is only reported if one of
+     them is true.  Only set while the breakpoint is being inserted,
+     and left empty if GDB evaluates the conditions itself.  */
+  VEC(agent_expr_p) *conditions;
+
+  /* Commands the target should run when the breakpoint is hit,
+     instead of reporting the hit, as agent expressions.  Only set
+     while the breakpoint is being inserted.  */
+  VEC(agent_expr_p) *tcommands;
+
+  /* The number of hits the target should skip on its own before
+     reporting one.  Only set while the breakpoint is being inserted;
+     a target that can't skip them resets it to zero.  */
+  int ignore_count;
 };
 
 /* GDB maintains two types of information about each breakpoint (or
@@ -313,6 +336,38 @@ struct bp_location
      the owner breakpoint object.  */
   struct expression *cond;
 
+  /* COND compiled to an agent expression, for targets that evaluate
+     breakpoint conditions themselves.  Compiled on demand; NULL if
+     not compiled yet or if COND can't be compiled, in which case
+     COND_BYTECODE_FAILED is set.  */
+  struct agent_expr *cond_bytecode;
+  int cond_bytecode_failed;
+
+  /* For dprintf locations, the printf compiled to an agent
+     expression, for targets that run breakpoint commands themselves.
+     Compiled on demand, as COND_BYTECODE is.  */
+  struct agent_expr *cmd_bytecode;
+  int cmd_bytecode_failed;
+
+  /* Nonzero if the target was given conditions to evaluate when this
+     location was last inserted.  */
+  int conditions_on_target;
+
+  /* Nonzero if the target was given this location's commands when it
+     was last inserted, and so runs them itself instead of reporting
+     hits.  */
+  int commands_on_target;
+
+  /* The number of hits the target was told to skip when this
+     location was last inserted, and that GDB hasn't accounted for in
+     its owner's hit and ignore counts yet.  */
+  int ignore_count_on_target;
+
+  /* Nonzero if this location should have been inserted, duplicates
+     aside, as of the last update_global_location_list.  Used to tell
+     when the set of locations at an inserted address changes.  */
+  int was_insertable;
+
   /* This location's address is in an unloaded solib, and so this
      location should not be inserted.  It will be automatically
      enabled when that solib is loaded.  */
@@ -482,6 +537,11 @@ struct breakpoint_ops
 
   /* Print to FP the CLI command that recreates this breakpoint.  */
   void (*print_recreate) (struct breakpoint *, struct ui_file *fp);
+
+  /* Called after the hit count of the breakpoint was bumped, because
+     it was hit and its condition held.  May clear BS->stop to let
+     the program continue.  May be NULL.  */
+  void (*after_condition_true) (struct bpstats *bs);
 };
 
 /* Helper for breakpoint_ops->print_recreate implementations.  Prints
@@ -582,6 +642,11 @@ struct breakpoint
        the end of the range (malloc'd).  */
     char *addr_string_range_end;
 
+    /* The source file and function names ADDR_STRING can only find
+       locations in, cached for breakpoint_re_set_objfiles; NULL until
+       first needed.  */
+    struct breakpoint_re_set_key *re_set_key;
+
     /* Architecture we used to set the breakpoint.  */
     struct gdbarch *gdbarch;
     /* Language we used to set the breakpoint.  */
@@ -591,6 +656,9 @@ struct breakpoint
     /* String form of the breakpoint condition (malloc'd), or NULL if
        there is no condition.  */
     char *cond_string;
+    /* For dprintf breakpoints, the format string and arguments to
+       print, as given to the "dprintf" command (malloc'd).  */
+    char *dprintf_args;
     /* String form of exp to use for displaying to the user
        (malloc'd), or NULL if none.  */
 
@@ -1003,6 +1071,12 @@ extern int regular_breakpoint_inserted_here_p (struct address_space *,
 extern int software_breakpoint_inserted_here_p (struct address_space *, 
 						CORE_ADDR);
 
+/* Returns true if there's a software breakpoint inserted in the range
+   defined by ADDR and LEN.  */
+extern int software_breakpoint_inserted_in_range (struct address_space *,
+						  CORE_ADDR addr,
+						  ULONGEST len);
+
 /* Returns true if there's a hardware watchpoint or access watchpoint
    inserted in the range defined by ADDR and LEN.  */
 extern int hardware_watchpoint_inserted_in_range (struct address_space *,
@@ -1026,6 +1100,13 @@ extern void update_breakpoint_locations (struct breakpoint *b,
 
 extern void breakpoint_re_set (void);
 
+/* Re-set the breakpoints after the COUNT objfiles in OBJFILES (and
+   their separate debug objfiles) have been added, leaving alone the
+   breakpoints whose location can't be found in them.  */
+
+extern void breakpoint_re_set_objfiles (struct objfile **objfiles,
+					int count);
+
 extern void breakpoint_re_set_thread (struct breakpoint *);
 
 extern struct breakpoint *set_momentary_breakpoint
@@ -0,0 +1,317 @@
+/* Parse a printf-style format string.
+
+   Copyright (C) 1986-2012, 2026 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef GDBSERVER
+#include "server.h"
+#else
+#include "defs.h"
+#endif
+
+#include "format.h"
+
+#include <string.h>
+#include <stdio.h>
+
+/* Holds the messages about format specifiers, which mention the
+   offending character.  */
+static char format_error[80];
+
+struct format_piece *
+parse_format_string (const char *string, const char **error)
+{
+  const char *f, *last_arg;
+  char *substrings, *current_substring;
+  struct format_piece *pieces;
+  int npieces;
+
+  /* There can't be more %-specs than there are '%'s.  */
+  npieces = 0;
+  for (f = string; *f; f++)
+    if (*f == '%')
+      npieces++;
+  pieces = xmalloc ((npieces + 2) * sizeof (struct format_piece));
+
+  /* Each piece gets a terminating '\0', and %lld may become %I64d;
+     doubling the size is sufficient.  */
+  substrings = xmalloc (strlen (string) * 2 + 2);
+  current_substring = substrings;
+
+  npieces = 0;
+  f = string;
+  last_arg = string;
+  while (*f)
+    if (*f++ == '%')
+      {
+	int seen_hash = 0, seen_zero = 0, lcount = 0, seen_prec = 0;
+	int seen_space = 0, seen_plus = 0;
+	int seen_big_l = 0, seen_h = 0, seen_big_h = 0;
+	int seen_big_d = 0, seen_double_big_d = 0;
+	int bad = 0;
+	enum argclass this_argclass = literal_piece;
+
+	/* Check the validity of the format specifier, and work
+	   out what argument it expects.  We only accept C89
+	   format strings, with the exception of long long (which
+	   we autoconf for).  */
+
+	/* Skip over "%%".  */
+	if (*f == '%')
+	  {
+	    f++;
+	    continue;
+	  }
+
+	/* The first part of a format specifier is a set of flag
+	   characters.  */
+	while (*f != '\0' && strchr ("0-+ #", *f))
+	  {
+	    if (*f == '#')
+	      seen_hash = 1;
+	    else if (*f == '0')
+	      seen_zero = 1;
+	    else if (*f == ' ')
+	      seen_space = 1;
+	    else if (*f == '+')
+	      seen_plus = 1;
+	    f++;
+	  }
+
+	/* The next part of a format specifier is a width.  */
+	while (*f != '\0' && strchr ("0123456789", *f))
+	  f++;
+
+	/* The next part of a format specifier is a precision.  */
+	if (*f == '.')
+	  {
+	    seen_prec = 1;
+	    f++;
+	    while (*f != '\0' && strchr ("0123456789", *f))
+	      f++;
+	  }
+
+	/* The next part of a format specifier is a length modifier.  */
+	if (*f == 'h')
+	  {
+	    seen_h = 1;
+	    f++;
+	  }
+	else if (*f == 'l')
+	  {
+	    f++;
+	    lcount++;
+	    if (*f == 'l')
+	      {
+		f++;
+		lcount++;
+	      }
+	  }
+	else if (*f == 'L')
+	  {
+	    seen_big_l = 1;
+	    f++;
+	  }
+	/* Decimal32 modifier.  */
+	else if (*f == 'H')
+	  {
+	    seen_big_h = 1;
+	    f++;
+	  }
+	/* Decimal64 and Decimal128 modifiers.  */
+	else if (*f == 'D')
+	  {
+	    f++;
+
+	    /* Check for a Decimal128.  */
+	    if (*f == 'D')
+	      {
+		f++;
+		seen_double_big_d = 1;
+	      }
+	    else
+	      seen_big_d = 1;
+	  }
+
+	switch (*f)
+	  {
+	  case 'u':
+	    if (seen_hash)
+	      bad = 1;
+	    /* FALLTHROUGH */
+
+	  case 'o':
+	  case 'x':
+	  case 'X':
+	    if (seen_space || seen_plus)
+	      bad = 1;
+	    /* FALLTHROUGH */
+
+	  case 'd':
+	  case 'i':
+	    if (lcount == 0)
+	      this_argclass = int_arg;
+	    else if (lcount == 1)
+	      this_argclass = long_arg;
+	    else
+	      this_argclass = long_long_arg;
+
+	    if (seen_big_l)
+	      bad = 1;
+	    break;
+
+	  case 'c':
+	    this_argclass = lcount == 0 ? int_arg : wide_char_arg;
+	    if (lcount > 1 || seen_h || seen_big_l)
+	      bad = 1;
+	    if (seen_prec || seen_zero || seen_space || seen_plus)
+	      bad = 1;
+	    break;
+
+	  case 'p':
+	    this_argclass = ptr_arg;
+	    if (lcount || seen_h || seen_big_l)
+	      bad = 1;
+	    if (seen_prec || seen_zero || seen_space || seen_plus)
+	      bad = 1;
+	    break;
+
+	  case 's':
+	    this_argclass = lcount == 0 ? string_arg : wide_string_arg;
+	    if (lcount > 1 || seen_h || seen_big_l)
+	      bad = 1;
+	    if (seen_zero || seen_space || seen_plus)
+	      bad = 1;
+	    break;
+
+	  case 'e':
+	  case 'f':
+	  case 'g':
+	  case 'E':
+	  case 'G':
+	    if (seen_big_h || seen_big_d || seen_double_big_d)
+	      this_argclass = decfloat_arg;
+	    else if (seen_big_l)
+	      this_argclass = long_double_arg;
+	    else
+	      this_argclass = double_arg;
+
+	    if (lcount || seen_h)
+	      bad = 1;
+	    break;
+
+	  case '*':
+	    *error = _("`*' not supported for precision or width in printf");
+	    goto fail;
+
+	  case 'n':
+	    *error = _("Format specifier `n' not supported in printf");
+	    goto fail;
+
+	  case '\0':
+	    *error = _("Incomplete format specifier at end of format string");
+	    goto fail;
+
+	  default:
+	    sprintf (format_error,
+		     _("Unrecognized format specifier '%c' in printf"), *f);
+	    *error = format_error;
+	    goto fail;
+	  }
+
+	if (bad)
+	  {
+	    sprintf (format_error,
+		     _("Inappropriate modifiers to "
+		       "format specifier '%c' in printf"),
+		     *f);
+	    *error = format_error;
+	    goto fail;
+	  }
+
+	f++;
+
+	pieces[npieces].string = current_substring;
+	pieces[npieces].argclass = this_argclass;
+	npieces++;
+
+	if (lcount > 1 && USE_PRINTF_I64)
+	  {
+	    /* Windows' printf does support long long, but not the usual way.
+	       Convert %lld to %I64d.  */
+	    int length_before_ll = f - last_arg - 1 - lcount;
+
+	    strncpy (current_substring, last_arg, length_before_ll);
+	    strcpy (current_substring + length_before_ll, "I64");
+	    current_substring[length_before_ll + 3] =
+	      last_arg[length_before_ll + lcount];
+	    current_substring += length_before_ll + 4;
+	  }
+	else if (this_argclass == wide_string_arg
+		 || this_argclass == wide_char_arg)
+	  {
+	    /* Convert %ls or %lc to %s.  */
+	    int length_before_ls = f - last_arg - 2;
+
+	    strncpy (current_substring, last_arg, length_before_ls);
+	    strcpy (current_substring + length_before_ls, "s");
+	    current_substring += length_before_ls + 2;
+	  }
+	else
+	  {
+	    strncpy (current_substring, last_arg, f - last_arg);
+	    current_substring += f - last_arg;
+	  }
+	*current_substring++ = '\0';
+	last_arg = f;
+      }
+
+  /* The portion of the format string after the last argument.  This
+     will not include any ordinary %-specs, but it might include
+     "%%".  */
+  strcpy (current_substring, last_arg);
+  pieces[npieces].string = current_substring;
+  pieces[npieces].argclass = literal_piece;
+  npieces++;
+
+  pieces[npieces].string = NULL;
+  pieces[npieces].argclass = literal_piece;
+
+  return pieces;
+
+ fail:
+  xfree (substrings);
+  xfree (pieces);
+  return NULL;
+}
+
+void
+free_format_pieces (struct format_piece *pieces)
+{
+  if (pieces != NULL)
+    {
+      /* All the pieces live in the buffer of the first one.  */
+      xfree (pieces[0].string);
+      xfree (pieces);
+    }
+}
+
+void
+free_format_pieces_cleanup (void *ptr)
+{
+  free_format_pieces (ptr);
+}
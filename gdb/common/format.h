@@ -0,0 +1,69 @@
+/* Parse a printf-style format string.
+
+   Copyright (C) 1986-2012, 2026 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef COMMON_FORMAT_H
+#define COMMON_FORMAT_H
+
+#if defined(__MINGW32__) && !defined(PRINTF_HAS_LONG_LONG)
+# define USE_PRINTF_I64 1
+# define PRINTF_HAS_LONG_LONG
+#else
+# define USE_PRINTF_I64 0
+#endif
+
+/* The kind of argument a piece of a format string wants.  */
+
+enum argclass
+  {
+    literal_piece,
+    int_arg, long_arg, long_long_arg, ptr_arg,
+    string_arg, wide_string_arg, wide_char_arg,
+    double_arg, long_double_arg, decfloat_arg
+  };
+
+/* A piece of a format string: one %-spec, along with the literal
+   text preceding it, or the literal text after the last %-spec.  The
+   STRING of a piece can be passed to printf along with an argument
+   of class ARGCLASS; %ls and %lc specs are converted to %s, to be
+   passed a host string.  */
+
+struct format_piece
+{
+  char *string;
+  enum argclass argclass;
+};
+
+/* Split the printf format STRING, whose escape sequences have already
+   been processed, into pieces.  There is a piece for each %-spec, in
+   order, followed by a literal_piece, and by an entry whose STRING is
+   NULL.  Only C89 specs are accepted, plus long long and the decimal
+   float modifiers.  Returns NULL and points ERROR at a description of
+   the problem if STRING isn't valid.  The result should be released
+   with free_format_pieces.  */
+
+extern struct format_piece *parse_format_string (const char *string,
+						 const char **error);
+
+extern void free_format_pieces (struct format_piece *pieces);
+
+/* A cleanup version of free_format_pieces.  */
+
+extern void free_format_pieces_cleanup (void *ptr);
+
+#endif /* COMMON_FORMAT_H */
@@ -0,0 +1,216 @@
+/* One-shot coverage points.
+
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+/* Coverage points tell which parts of a program ran, without the cost
+   of a stop per hit: the target removes each point on its first hit,
+   notes the hit, and resumes the inferior on its own.  GDB only keeps
+   the addresses of the points, in the order they were planted, and
+   fetches the hits in bulk as a bitmap when asked.  */
+
+#include "defs.h"
+#include "coverage.h"
+#include "target.h"
+#include "gdbcmd.h"
+#include "symtab.h"
+#include "linespec.h"
+#include "value.h"
+#include "observer.h"
+#include "completer.h"
+#include "gdb_string.h"
+
+/* The addresses of the coverage points planted since the last clear,
+   in the order they were planted.  The I'th one is bit I of the
+   target's hit bitmap.  */
+
+static VEC(CORE_ADDR) *coverage_points;
+
+int
+coverage_insert (int count, const CORE_ADDR *addrs)
+{
+  int *results;
+  int i, planted = 0;
+  struct cleanup *old_chain;
+
+  if (count == 0)
+    return 0;
+
+  results = xmalloc (count * sizeof (int));
+  old_chain = make_cleanup (xfree, results);
+
+  target_insert_coverage_points (count, addrs, results);
+
+  for (i = 0; i < count; i++)
+    if (results[i] == 0)
+      {
+	VEC_safe_push (CORE_ADDR, coverage_points, addrs[i]);
+	planted++;
+      }
+
+  do_cleanups (old_chain);
+  return planted;
+}
+
+void
+coverage_clear (void)
+{
+  target_clear_coverage_points ();
+  VEC_free (CORE_ADDR, coverage_points);
+}
+
+int
+coverage_count (void)
+{
+  return VEC_length (CORE_ADDR, coverage_points);
+}
+
+VEC(CORE_ADDR) *
+coverage_hits (void)
+{
+  VEC(CORE_ADDR) *hits = NULL;
+  gdb_byte *bitmap = NULL;
+  LONGEST len = 0;
+  CORE_ADDR addr;
+  int i;
+
+  if (VEC_empty (CORE_ADDR, coverage_points))
+    return NULL;
+
+  len = target_read_alloc (&current_target, TARGET_OBJECT_COVERAGE,
+			   NULL, &bitmap);
+  if (len < 0)
+    error (_("Could not read the coverage hits from the target."));
+
+  for (i = 0; VEC_iterate (CORE_ADDR, coverage_points, i, addr); i++)
+    if (i / 8 < len && (bitmap[i / 8] & (1 << (i % 8))) != 0)
+      VEC_safe_push (CORE_ADDR, hits, addr);
+
+  xfree (bitmap);
+  return hits;
+}
+
+/* Forget the coverage points of the previous run.  The target clears
+   them when points are next planted in a new process.  */
+
+static void
+coverage_inferior_created (struct target_ops *ops, int from_tty)
+{
+  VEC_free (CORE_ADDR, coverage_points);
+}
+
+/* The "coverage add" command.  */
+
+static void
+coverage_add_command (char *arg, int from_tty)
+{
+  struct symtabs_and_lines sals;
+  struct cleanup *old_chain;
+  CORE_ADDR *addrs;
+  int i, planted;
+
+  if (arg == NULL || *arg == '\0')
+    error_no_arg (_("location"));
+
+  sals = decode_line_spec (arg, DECODE_LINE_FUNFIRSTLINE);
+  old_chain = make_cleanup (xfree, sals.sals);
+
+  addrs = xmalloc (sals.nelts * sizeof (CORE_ADDR));
+  make_cleanup (xfree, addrs);
+  for (i = 0; i < sals.nelts; i++)
+    {
+      resolve_sal_pc (&sals.sals[i]);
+      addrs[i] = sals.sals[i].pc;
+    }
+
+  planted = coverage_insert (sals.nelts, addrs);
+  if (planted < sals.nelts)
+    warning (_("Could not plant %d of %d coverage points."),
+	     sals.nelts - planted, sals.nelts);
+  else if (from_tty && planted == 1)
+    printf_filtered (_("Planted 1 coverage point.\n"));
+  else if (from_tty)
+    printf_filtered (_("Planted %d coverage points.\n"), planted);
+
+  do_cleanups (old_chain);
+}
+
+/* The "coverage clear" command.  */
+
+static void
+coverage_clear_command (char *arg, int from_tty)
+{
+  coverage_clear ();
+}
+
+/* The "info coverage" command.  */
+
+static void
+coverage_info (char *arg, int from_tty)
+{
+  VEC(CORE_ADDR) *hits = coverage_hits ();
+  struct cleanup *old_chain;
+  CORE_ADDR addr;
+  int i;
+
+  old_chain = make_cleanup (VEC_cleanup (CORE_ADDR), &hits);
+
+  printf_filtered (_("%d coverage points, %d hit.\n"),
+		   coverage_count (), VEC_length (CORE_ADDR, hits));
+  for (i = 0; VEC_iterate (CORE_ADDR, hits, i, addr); i++)
+    {
+      print_address (target_gdbarch, addr, gdb_stdout);
+      printf_filtered ("\n");
+    }
+
+  do_cleanups (old_chain);
+}
+
+static struct cmd_list_element *coverage_cmdlist;
+
+/* Provide a prototype to silence -Wmissing-prototypes.  */
+extern initialize_file_ftype _initialize_coverage;
+
+void
+_initialize_coverage (void)
+{
+  struct cmd_list_element *c;
+
+  add_prefix_cmd ("coverage", class_breakpoint, coverage_add_command, _("\
+Record which code runs with one-shot coverage points.\n\
+Usage: coverage LOCATION\n\
+With a location, the same as \"coverage add\"."),
+		  &coverage_cmdlist, "coverage ", 1, &cmdlist);
+
+  c = add_cmd ("add", class_breakpoint, coverage_add_command, _("\
+Plant coverage points at a location.\n\
+Usage: coverage add LOCATION\n\
+A coverage point is removed by the target the first time it is hit,\n\
+and the hit recorded, without stopping the program.  Use \"info coverage\"\n\
+to list the points hit so far."),
+	       &coverage_cmdlist);
+  set_cmd_completer (c, location_completer);
+
+  add_cmd ("clear", class_breakpoint, coverage_clear_command, _("\
+Remove all coverage points, and forget their hits."),
+	   &coverage_cmdlist);
+
+  add_info ("coverage", coverage_info, _("\
+Show the coverage points hit so far."));
+
+  observer_attach_inferior_created (coverage_inferior_created);
+}
@@ -0,0 +1,46 @@
+/* One-shot coverage points.
+
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef COVERAGE_H
+#define COVERAGE_H
+
+#include "symtab.h"
+
+/* Plant coverage points at the COUNT addresses in ADDRS.  Each point
+   is removed by the target the first time it is hit, without stopping
+   the inferior.  Returns the number of points planted.  */
+
+extern int coverage_insert (int count, const CORE_ADDR *addrs);
+
+/* Remove all the coverage points, and forget their hits.  */
+
+extern void coverage_clear (void);
+
+/* Return the number of coverage points planted since the last
+   coverage_clear.  */
+
+extern int coverage_count (void);
+
+/* Return a new vector of the addresses of the coverage points hit so
+   far, in the order they were planted.  The caller owns the
+   vector.  */
+
+extern VEC(CORE_ADDR) *coverage_hits (void);
+
+#endif /* COVERAGE_H */
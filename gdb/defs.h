@@ -313,6 +313,8 @@ extern void set_display_time (int);
 
 extern void set_display_space (int);
 
+extern void set_display_stats (int);
+
 #define	ALL_CLEANUPS	((struct cleanup *)0)
 
 extern void do_cleanups (struct cleanup *);
@@ -649,6 +651,10 @@ extern int build_address_symbolic (struct gdbarch *,
 extern void print_address (struct gdbarch *, CORE_ADDR, struct ui_file *);
 extern const char *pc_prefix (CORE_ADDR);
 
+extern char *extract_printf_format (char **arg);
+
+extern void ui_printf (char *arg, struct ui_file *stream);
+
 /* From source.c */
 
 #define OPF_TRY_CWD_FIRST     0x01
@@ -46,17 +46,20 @@ put_bits (bfd_uint64_t data, char *buf, int bits, bfd_boolean big_p)
 }
 
 /* Subroutine of find_command to simplify it.
-   Parse the arguments of the "find" command.  */
+   Parse the arguments of the "find" command.  The search patterns are
+   added to PATTERNS: one, or with the /m option, one per
+   expression.  */
 
 static void
-parse_find_args (char *args, ULONGEST *max_countp,
-		 char **pattern_bufp, ULONGEST *pattern_lenp,
+parse_find_args (char *args, ULONGEST *max_countp, int *multip,
+		 struct search_patterns *patterns,
 		 CORE_ADDR *start_addrp, ULONGEST *search_space_lenp,
 		 bfd_boolean big_p)
 {
   /* Default to using the specified type.  */
   char size = '\0';
   ULONGEST max_count = ~(ULONGEST) 0;
+  int multi = 0;
   /* Buffer to hold the search pattern.  */
   char *pattern_buf;
   /* Current size of search pattern buffer.
@@ -65,12 +68,13 @@ parse_find_args (char *args, ULONGEST *max_countp,
   ULONGEST pattern_buf_size = INITIAL_PATTERN_BUF_SIZE;
   /* Pointer to one past the last in-use part of pattern_buf.  */
   char *pattern_buf_end;
-  ULONGEST pattern_len;
+  ULONGEST pattern_len, min_pattern_len;
   CORE_ADDR start_addr;
   ULONGEST search_space_len;
   char *s = args;
   struct cleanup *old_cleanups;
   struct value *v;
+  int i;
 
   if (args == NULL)
     error (_("Missing search parameters."));
@@ -104,6 +108,10 @@ parse_find_args (char *args, ULONGEST *max_countp,
 	    case 'g':
 	      size = *s++;
 	      break;
+	    case 'm':
+	      multi = 1;
+	      ++s;
+	      break;
 	    default:
 	      error (_("Invalid size granularity."));
 	    }
@@ -217,29 +225,96 @@ parse_find_args (char *args, ULONGEST *max_countp,
 	  pattern_buf_end += val_bytes;
 	}
 
+      if (multi)
+	{
+	  search_patterns_add (patterns, pattern_buf,
+			       pattern_buf_end - pattern_buf);
+	  pattern_buf_end = pattern_buf;
+	}
+
       if (*s == ',')
 	++s;
       while (isspace (*s))
 	++s;
     }
 
-  if (pattern_buf_end == pattern_buf)
+  if (!multi && pattern_buf_end != pattern_buf)
+    search_patterns_add (patterns, pattern_buf,
+			 pattern_buf_end - pattern_buf);
+
+  if (search_patterns_count (patterns) == 0)
     error (_("Missing search pattern."));
 
-  pattern_len = pattern_buf_end - pattern_buf;
+  min_pattern_len = ~(ULONGEST) 0;
+  for (i = 0; i < search_patterns_count (patterns); i++)
+    {
+      search_patterns_get (patterns, i, &pattern_len);
+      min_pattern_len = min (min_pattern_len, pattern_len);
+    }
 
-  if (search_space_len < pattern_len)
+  if (search_space_len < min_pattern_len)
     error (_("Search space too small to contain pattern."));
 
   *max_countp = max_count;
-  *pattern_bufp = pattern_buf;
-  *pattern_lenp = pattern_len;
+  *multip = multi;
   *start_addrp = start_addr;
   *search_space_lenp = search_space_len;
 
-  /* We successfully parsed the arguments, leave the freeing of PATTERN_BUF
-     to the caller now.  */
-  discard_cleanups (old_cleanups);
+  do_cleanups (old_cleanups);
+}
+
+/* A match found by the "find" command.  */
+
+typedef struct find_match
+{
+  CORE_ADDR addr;
+  int pattern;
+} find_match_s;
+
+DEF_VEC_O (find_match_s);
+
+/* The matches found by the "find" command so far.  */
+
+struct find_matches
+{
+  VEC (find_match_s) *matches;
+
+  /* The number of matches wanted.  */
+  ULONGEST max_count;
+
+  /* Nonzero if the matches come in address order, so that the search
+     can stop as soon as there are enough.  */
+  int ordered;
+};
+
+/* The search_match_ftype callback of the "find" command.  */
+
+static int
+find_match_found (CORE_ADDR addr, int pattern, void *data)
+{
+  struct find_matches *found = data;
+  find_match_s match;
+
+  match.addr = addr;
+  match.pattern = pattern;
+  VEC_safe_push (find_match_s, found->matches, &match);
+
+  return (found->ordered
+	  && VEC_length (find_match_s, found->matches) >= found->max_count);
+}
+
+/* qsort comparison function for matches, by address, then by
+   pattern.  */
+
+static int
+compare_find_matches (const void *ap, const void *bp)
+{
+  const find_match_s *a = ap;
+  const find_match_s *b = bp;
+
+  if (a->addr != b->addr)
+    return a->addr < b->addr ? -1 : 1;
+  return a->pattern - b->pattern;
 }
 
 static void
@@ -250,51 +325,52 @@ find_command (char *args, int from_tty)
   /* Command line parameters.
      These are initialized to avoid uninitialized warnings from -Wall.  */
   ULONGEST max_count = 0;
-  char *pattern_buf = 0;
-  ULONGEST pattern_len = 0;
+  int multi = 0;
+  struct search_patterns *patterns;
   CORE_ADDR start_addr = 0;
   ULONGEST search_space_len = 0;
   /* End of command line parameters.  */
+  struct find_matches found;
   unsigned int found_count;
   CORE_ADDR last_found_addr;
   struct cleanup *old_cleanups;
+  find_match_s *match;
 
-  parse_find_args (args, &max_count, &pattern_buf, &pattern_len, 
+  patterns = search_patterns_new ();
+  old_cleanups = make_cleanup_search_patterns_free (patterns);
+
+  parse_find_args (args, &max_count, &multi, patterns,
 		   &start_addr, &search_space_len, big_p);
 
-  old_cleanups = make_cleanup (free_current_contents, &pattern_buf);
+  /* Perform the search, over all the patterns at once.  */
+
+  found.matches = NULL;
+  found.max_count = max_count;
+  found.ordered = search_patterns_count (patterns) == 1;
+  make_cleanup (VEC_cleanup (find_match_s), &found.matches);
 
-  /* Perform the search.  */
+  target_search_memory_all (start_addr, search_space_len, patterns,
+			    find_match_found, &found);
+
+  qsort (VEC_address (find_match_s, found.matches),
+	 VEC_length (find_match_s, found.matches),
+	 sizeof (find_match_s), compare_find_matches);
 
   found_count = 0;
   last_found_addr = 0;
 
-  while (search_space_len >= pattern_len
-	 && found_count < max_count)
+  for (match = VEC_address (find_match_s, found.matches);
+       match < VEC_address (find_match_s, found.matches)
+	       + VEC_length (find_match_s, found.matches)
+	 && found_count < max_count;
+       match++)
     {
-      /* Offset from start of this iteration to the next iteration.  */
-      ULONGEST next_iter_incr;
-      CORE_ADDR found_addr;
-      int found = target_search_memory (start_addr, search_space_len,
-					pattern_buf, pattern_len, &found_addr);
-
-      if (found <= 0)
-	break;
-
-      print_address (gdbarch, found_addr, gdb_stdout);
+      print_address (gdbarch, match->addr, gdb_stdout);
+      if (multi)
+	printf_filtered (_(" (pattern %d)"), match->pattern + 1);
       printf_filtered ("\n");
       ++found_count;
-      last_found_addr = found_addr;
-
-      /* Begin next iteration at one byte past this match.  */
-      next_iter_incr = (found_addr - start_addr) + 1;
-
-      /* For robustness, we don't let search_space_len go -ve here.  */
-      if (search_space_len >= next_iter_incr)
-	search_space_len -= next_iter_incr;
-      else
-	search_space_len = 0;
-      start_addr += next_iter_incr;
+      last_found_addr = match->addr;
     }
 
   /* Record and print the results.  */
@@ -326,14 +402,17 @@ _initialize_mem_search (void)
   add_cmd ("find", class_vars, find_command, _("\
 Search memory for a sequence of bytes.\n\
 Usage:\nfind \
-[/size-char] [/max-count] start-address, end-address, expr1 [, expr2 ...]\n\
-find [/size-char] [/max-count] start-address, +length, expr1 [, expr2 ...]\n\
+[/size-char] [/max-count] [/m] start-address, end-address, expr1 [, expr2 ...]\n\
+find [/size-char] [/max-count] [/m] start-address, +length, expr1 [, expr2 ...]\n\
 size-char is one of b,h,w,g for 8,16,32,64 bit values respectively,\n\
 and if not specified the size is taken from the type of the expression\n\
 in the current language.\n\
 Note that this means for example that in the case of C-like languages\n\
 a search for an untyped 0x42 will search for \"(int) 0x42\"\n\
 which is typically four bytes.\n\
+With /m, each expression is a separate pattern, and all the patterns\n\
+are searched for at once; each match is shown with the number of its\n\
+pattern.\n\
 \n\
 The address of the last match is stored as the value of \"$_\".\n\
 Convenience variable \"$numfound\" is set to the number of matches."),
@@ -44,6 +44,7 @@
 #include "block.h"
 #include "inline-frame.h"
 #include  "tracepoint.h"
+#include "stats.h"
 
 static struct frame_info *get_prev_frame_1 (struct frame_info *this_frame);
 static struct frame_info *get_prev_frame_raw (struct frame_info *this_frame);
@@ -129,6 +130,9 @@ struct frame_info
   enum unwind_stop_reason stop_reason;
 };
 
+/* Incremented by reinit_frame_cache; see frame_cache_generation.  */
+static unsigned int frame_cache_gen;
+
 /* A frame stash used to speed up frame lookups.  */
 
 /* We currently only stash one frame at a time, as this seems to be
@@ -1528,10 +1532,17 @@ reinit_frame_cache (void)
   current_frame = NULL;		/* Invalidate cache */
   select_frame (NULL);
   frame_stash_invalidate ();
+  frame_cache_gen++;
   if (frame_debug)
     fprintf_unfiltered (gdb_stdlog, "{ reinit_frame_cache () }\n");
 }
 
+unsigned int
+frame_cache_generation (void)
+{
+  return frame_cache_gen;
+}
+
 /* Find where a register is saved (in memory or another register).
    The result of frame_register_unwind is just where it is saved
    relative to this particular frame.  */
@@ -1759,6 +1770,7 @@ get_prev_frame_raw (struct frame_info *this_frame)
      allocation calls.  */
   prev_frame = FRAME_OBSTACK_ZALLOC (struct frame_info);
   prev_frame->level = this_frame->level + 1;
+  stats_count (STATS_FRAME_UNWINDS, 1);
 
   /* For now, assume we don't have frame chains crossing address
      spaces.  */
@@ -250,6 +250,11 @@ extern int has_stack_frames (void);
    modifies the target invalidating the frame cache).  */
 extern void reinit_frame_cache (void);
 
+/* Return a number that changes each time the frame cache is
+   invalidated.  A frame_info pointer obtained while this returned N
+   is valid for as long as it still returns N.  */
+extern unsigned int frame_cache_generation (void);
+
 /* On demand, create the selected frame and then return it.  If the
    selected frame can not be created, this function prints then throws
    an error.  When MESSAGE is non-NULL, use it for the error message,
@@ -846,9 +846,10 @@ extern void gdbarch_displaced_step_free_closure (struct gdbarch *gdbarch, struct
 extern void set_gdbarch_displaced_step_free_closure (struct gdbarch *gdbarch, gdbarch_displaced_step_free_closure_ftype *displaced_step_free_closure);
 
 /* Return the address of an appropriate place to put displaced
-   instructions while we step over them.  There need only be one such
-   place, since we're only stepping one thread over a breakpoint at a
-   time.
+   instructions while we step over them.  When several threads step
+   over breakpoints at once, GDB puts the other copies one after the
+   other from there, gdbarch_max_insn_length bytes apart, as long as
+   they stay within the function holding this address.
   
    For a general explanation of displaced stepping and how GDB uses it,
    see the comments in infrun.c. */
@@ -725,9 +725,10 @@ M:void:displaced_step_fixup:struct displaced_step_closure *closure, CORE_ADDR fr
 m:void:displaced_step_free_closure:struct displaced_step_closure *closure:closure::NULL::(! gdbarch->displaced_step_free_closure) != (! gdbarch->displaced_step_copy_insn)
 
 # Return the address of an appropriate place to put displaced
-# instructions while we step over them.  There need only be one such
-# place, since we're only stepping one thread over a breakpoint at a
-# time.
+# instructions while we step over them.  When several threads step
+# over breakpoints at once, GDB puts the other copies one after the
+# other from there, gdbarch_max_insn_length bytes apart, as long as
+# they stay within the function holding this address.
 #
 # For a general explanation of displaced stepping and how GDB uses it,
 # see the comments in infrun.c.
@@ -0,0 +1,67 @@
+/* Binary remote protocol capture format, shared by gdbserver and
+   gdbreplay.
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+/* A capture file records every chunk of data exchanged between GDB
+   and gdbserver over one connection, with a timestamp, so that
+   gdbreplay can play the session back without parsing a text log.
+
+   All integers are stored little endian, whatever the host.  The
+   file starts with a header:
+
+     CAPTURE_MAGIC            8 bytes
+     start time               8 bytes, microseconds since the epoch
+
+   followed by any number of records:
+
+     kind                     1 byte, CAPTURE_FROM_GDB or CAPTURE_TO_GDB
+     length                   4 bytes
+     time                     8 bytes, microseconds since start time
+     data                     LENGTH bytes
+
+   When the capture is closed cleanly, the records are followed by an
+   index holding the file offset of every CAPTURE_INDEX_INTERVAL'th
+   record, starting with the first, as 8 byte entries, and by a
+   trailer:
+
+     index offset             8 bytes
+     number of records        8 bytes
+     CAPTURE_TRAILER_MAGIC    8 bytes
+
+   A capture without a trailer (e.g., because gdbserver was killed)
+   is still readable up to its last complete record.  */
+
+#define CAPTURE_MAGIC "GDBCAP\0\1"
+#define CAPTURE_TRAILER_MAGIC "GDBCAPIX"
+#define CAPTURE_MAGIC_LEN 8
+
+#define CAPTURE_HEADER_LEN 16
+#define CAPTURE_RECORD_HEADER_LEN 13
+#define CAPTURE_TRAILER_LEN 24
+
+#define CAPTURE_INDEX_INTERVAL 1024
+
+/* Record kinds.  These match the direction letters of "set
+   remotelogfile" logs, from GDB's point of view.  */
+#define CAPTURE_FROM_GDB 'w'
+#define CAPTURE_TO_GDB 'r'
+
+#endif /* CAPTURE_H */
@@ -38,6 +38,20 @@
 #include <unistd.h>
 #endif
 
+#ifdef HAVE_FCNTL_H
+#include <fcntl.h>
+#endif
+
+/* Use epoll instead of select to wait for events when the host
+   supports it.  epoll isn't limited to FD_SETSIZE descriptors, and
+   its cost per wakeup is proportional to the number of ready
+   descriptors rather than to the number of registered ones.  */
+
+#if defined (HAVE_SYS_EPOLL_H) && defined (HAVE_EPOLL_CREATE)
+#define USE_EPOLL 1
+#include <sys/epoll.h>
+#endif
+
 typedef struct gdb_event gdb_event;
 typedef int (event_handler_func) (gdb_fildes_t);
 
@@ -47,6 +61,11 @@ typedef int (event_handler_func) (gdb_fildes_t);
 #define GDB_WRITABLE	(1<<2)
 #define GDB_EXCEPTION	(1<<3)
 
+/* Only report new input on the file descriptor, rather than its
+   readiness.  See add_edge_file_handler.  */
+
+#define GDB_EDGE	(1<<4)
+
 /* Events are queued by calling async_queue_event and serviced later
    on by do_one_event.  An event can be, for instance, a file
    descriptor becoming ready to be read.  Servicing an event simply
@@ -129,6 +148,20 @@ static struct
     /* Ptr to head of file handler list.  */
     file_handler *first_file_handler;
 
+#ifdef USE_EPOLL
+    /* The epoll instance all file handlers are registered with, or -1
+       if it hasn't been created yet.  */
+    int epoll_fd;
+
+    /* Buffer epoll_wait stores the ready events in.  */
+    struct epoll_event *epoll_events;
+
+    /* Number of elements allocated in EPOLL_EVENTS.  */
+    int epoll_events_size;
+
+    /* Number of registered file handlers.  */
+    int num_fds;
+#else
     /* Masks to be used in the next call to select.  Bits are set in
        response to calls to create_file_handler.  */
     fd_set check_masks[3];
@@ -138,8 +171,32 @@ static struct
 
     /* Number of valid bits (highest fd value + 1). (for select) */
     int num_fds;
+#endif
+  }
+gdb_notifier
+#ifdef USE_EPOLL
+  = { NULL, -1 }
+#endif
+  ;
+
+/* Event loop statistics, reported by "monitor show event-loop-stats".  */
+
+static struct
+  {
+    /* Number of times the event loop woke up with events to
+       process.  */
+    unsigned long wakeups;
+
+    /* Number of file events handled.  */
+    unsigned long file_events;
+
+    /* Number of callbacks run.  */
+    unsigned long callbacks;
+
+    /* When the statistics were last reset.  */
+    struct timeval start;
   }
-gdb_notifier;
+event_loop_stats;
 
 /* Callbacks are just routines that are executed before waiting for the
    next event.  In GDB this is struct gdb_timer.  We don't need timers
@@ -239,6 +296,7 @@ process_event (void)
 	    event_queue.last_event = prev_ptr;
 	}
       free (event_ptr);
+      event_loop_stats.file_events++;
 
       /* Now call the procedure associated with the event.  */
       if ((*proc) (fd))
@@ -317,6 +375,7 @@ process_callback (void)
       if (callback_list.first == NULL)
 	callback_list.last = NULL;
       free  (event_ptr);
+      event_loop_stats.callbacks++;
       if ((*proc) (data))
 	return -1;
       return 1;
@@ -325,11 +384,58 @@ process_callback (void)
   return 0;
 }
 
+#ifdef USE_EPOLL
+
+/* Return the epoll instance file handlers are registered with,
+   creating it on first use.  */
+
+static int
+get_epoll_fd (void)
+{
+  if (gdb_notifier.epoll_fd == -1)
+    {
+      gdb_notifier.epoll_fd = epoll_create (1);
+      if (gdb_notifier.epoll_fd == -1)
+	perror_with_name ("epoll_create");
+
+      /* Don't leak the descriptor into the inferiors we spawn.  */
+      fcntl (gdb_notifier.epoll_fd, F_SETFD, FD_CLOEXEC);
+    }
+
+  return gdb_notifier.epoll_fd;
+}
+
+/* Register or update FILE_PTR with the epoll instance.  OP is either
+   EPOLL_CTL_ADD or EPOLL_CTL_MOD.  */
+
+static void
+epoll_update_file_handler (file_handler *file_ptr, int op)
+{
+  struct epoll_event ev;
+
+  memset (&ev, 0, sizeof (ev));
+  if (file_ptr->mask & GDB_READABLE)
+    ev.events |= EPOLLIN;
+  if (file_ptr->mask & GDB_WRITABLE)
+    ev.events |= EPOLLOUT;
+  if (file_ptr->mask & GDB_EXCEPTION)
+    ev.events |= EPOLLPRI;
+  if (file_ptr->mask & GDB_EDGE)
+    ev.events |= EPOLLET;
+  ev.data.ptr = file_ptr;
+
+  if (epoll_ctl (get_epoll_fd (), op, file_ptr->fd, &ev) != 0)
+    perror_with_name ("epoll_ctl");
+}
+
+#endif
+
 /* Add a file handler/descriptor to the list of descriptors we are
    interested in.  FD is the file descriptor for the file/stream to be
    listened to.  MASK is a combination of READABLE, WRITABLE,
-   EXCEPTION.  PROC is the procedure that will be called when an event
-   occurs for FD.  CLIENT_DATA is the argument to pass to PROC.  */
+   EXCEPTION and EDGE.  PROC is the procedure that will be called when
+   an event occurs for FD.  CLIENT_DATA is the argument to pass to
+   PROC.  */
 
 static void
 create_file_handler (gdb_fildes_t fd, int mask, handler_func *proc,
@@ -355,6 +461,11 @@ create_file_handler (gdb_fildes_t fd, int mask, handler_func *proc,
       file_ptr->next_file = gdb_notifier.first_file_handler;
       gdb_notifier.first_file_handler = file_ptr;
 
+#ifdef USE_EPOLL
+      file_ptr->mask = mask;
+      epoll_update_file_handler (file_ptr, EPOLL_CTL_ADD);
+      gdb_notifier.num_fds++;
+#else
       if (mask & GDB_READABLE)
 	FD_SET (fd, &gdb_notifier.check_masks[0]);
       else
@@ -372,7 +483,15 @@ create_file_handler (gdb_fildes_t fd, int mask, handler_func *proc,
 
       if (gdb_notifier.num_fds <= fd)
 	gdb_notifier.num_fds = fd + 1;
+#endif
     }
+#ifdef USE_EPOLL
+  else if (file_ptr->mask != mask)
+    {
+      file_ptr->mask = mask;
+      epoll_update_file_handler (file_ptr, EPOLL_CTL_MOD);
+    }
+#endif
 
   file_ptr->proc = proc;
   file_ptr->client_data = client_data;
@@ -388,6 +507,20 @@ add_file_handler (gdb_fildes_t fd,
   create_file_handler (fd, GDB_READABLE | GDB_EXCEPTION, proc, client_data);
 }
 
+/* Like add_file_handler, but PROC is only guaranteed to be called
+   when new input arrives on FD, not for as long as FD stays readable.
+   PROC, or whatever it schedules, must therefore consume all input
+   available on FD.  When the event loop waits with select, this is
+   the same as add_file_handler.  */
+
+void
+add_edge_file_handler (gdb_fildes_t fd,
+		       handler_func *proc, gdb_client_data client_data)
+{
+  create_file_handler (fd, GDB_READABLE | GDB_EXCEPTION | GDB_EDGE,
+		       proc, client_data);
+}
+
 /* Remove the file descriptor FD from the list of monitored fd's:
    i.e. we don't care anymore about events on the FD.  */
 
@@ -395,7 +528,9 @@ void
 delete_file_handler (gdb_fildes_t fd)
 {
   file_handler *file_ptr, *prev_ptr = NULL;
+#ifndef USE_EPOLL
   int i;
+#endif
 
   /* Find the entry for the given file. */
 
@@ -408,6 +543,12 @@ delete_file_handler (gdb_fildes_t fd)
   if (file_ptr == NULL)
     return;
 
+#ifdef USE_EPOLL
+  /* The descriptor may have been closed already, in which case the
+     kernel has dropped it from the epoll set itself.  */
+  epoll_ctl (get_epoll_fd (), EPOLL_CTL_DEL, fd, NULL);
+  gdb_notifier.num_fds--;
+#else
   if (file_ptr->mask & GDB_READABLE)
     FD_CLR (fd, &gdb_notifier.check_masks[0]);
   if (file_ptr->mask & GDB_WRITABLE)
@@ -429,6 +570,7 @@ delete_file_handler (gdb_fildes_t fd)
 	}
       gdb_notifier.num_fds = i;
     }
+#endif
 
   /* Deactivate the file descriptor, by clearing its mask, so that it
      will not fire again.  */
@@ -513,6 +655,96 @@ create_file_event (gdb_fildes_t fd)
   return file_event_ptr;
 }
 
+/* Record that the events in MASK were seen on FILE_PTR, queueing a
+   file event unless one is already pending for it.  */
+
+static void
+mark_file_ready (file_handler *file_ptr, int mask)
+{
+  /* Enqueue an event only if this is still a new event for this
+     fd.  */
+
+  if (file_ptr->ready_mask == 0)
+    {
+      gdb_event *file_event_ptr = create_file_event (file_ptr->fd);
+
+      async_queue_event (file_event_ptr);
+    }
+  file_ptr->ready_mask = mask;
+}
+
+#ifdef USE_EPOLL
+
+/* Called by do_one_event to wait for new events on the monitored file
+   descriptors.  Queue file events as they are detected by the poll.
+   If there are no events, this function will block in the call to
+   epoll_wait.  Return -1 if there are no files descriptors to
+   monitor, otherwise return 0.  */
+
+static int
+wait_for_event (void)
+{
+  int num_found;
+  int i;
+
+  /* Make sure all output is done before getting another event.  */
+  fflush (stdout);
+  fflush (stderr);
+
+  if (gdb_notifier.num_fds == 0)
+    return -1;
+
+  if (gdb_notifier.epoll_events_size < gdb_notifier.num_fds)
+    {
+      gdb_notifier.epoll_events_size = gdb_notifier.num_fds;
+      gdb_notifier.epoll_events
+	= xrealloc (gdb_notifier.epoll_events,
+		    (gdb_notifier.epoll_events_size
+		     * sizeof (struct epoll_event)));
+    }
+
+  num_found = epoll_wait (get_epoll_fd (), gdb_notifier.epoll_events,
+			  gdb_notifier.epoll_events_size, -1);
+
+  if (num_found == -1)
+    {
+      /* Dont print anything if we got a signal, let gdb handle
+	 it.  */
+      if (errno != EINTR)
+	perror_with_name ("epoll_wait");
+      return 0;
+    }
+
+  if (num_found > 0)
+    event_loop_stats.wakeups++;
+
+  /* Enqueue all detected file events.  */
+
+  for (i = 0; i < num_found; i++)
+    {
+      struct epoll_event *ev = &gdb_notifier.epoll_events[i];
+      file_handler *file_ptr = ev->data.ptr;
+      int mask = 0;
+
+      /* Like select, report hangups and errors as the descriptor
+	 being readable, so that the handler gets to see the EOF or
+	 error from its read call.  */
+      if (ev->events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+	mask |= GDB_READABLE;
+      if (ev->events & EPOLLOUT)
+	mask |= GDB_WRITABLE;
+      if (ev->events & EPOLLPRI)
+	mask |= GDB_EXCEPTION;
+
+      if (mask != 0)
+	mark_file_ready (file_ptr, mask);
+    }
+
+  return 0;
+}
+
+#else
+
 /* Called by do_one_event to wait for new events on the monitored file
    descriptors.  Queue file events as they are detected by the poll.
    If there are no events, this function will block in the call to
@@ -523,7 +755,6 @@ static int
 wait_for_event (void)
 {
   file_handler *file_ptr;
-  gdb_event *file_event_ptr;
   int num_found = 0;
 
   /* Make sure all output is done before getting another event.  */
@@ -555,6 +786,8 @@ wait_for_event (void)
 	perror_with_name ("select");
 #endif
     }
+  else if (num_found > 0)
+    event_loop_stats.wakeups++;
 
   /* Enqueue all detected file events.  */
 
@@ -576,26 +809,73 @@ wait_for_event (void)
       else
 	num_found--;
 
-      /* Enqueue an event only if this is still a new event for this
-	 fd.  */
-
-      if (file_ptr->ready_mask == 0)
-	{
-	  file_event_ptr = create_file_event (file_ptr->fd);
-	  async_queue_event (file_event_ptr);
-	}
-      file_ptr->ready_mask = mask;
+      mark_file_ready (file_ptr, mask);
     }
 
   return 0;
 }
 
+#endif
+
+/* Report the event loop statistics gathered since the last call to
+   reset_event_loop_stats through monitor_output.  The events per
+   second figure is what the event loop managed to dispatch over the
+   wall clock time elapsed, so it is only meaningful as a benchmark
+   while GDB keeps the server busy.  */
+
+void
+show_event_loop_stats (void)
+{
+  struct timeval now;
+  double elapsed;
+  unsigned long events;
+  char buf[128];
+
+  gettimeofday (&now, NULL);
+  elapsed = ((now.tv_sec - event_loop_stats.start.tv_sec)
+	     + (now.tv_usec - event_loop_stats.start.tv_usec) / 1000000.0);
+  events = event_loop_stats.file_events + event_loop_stats.callbacks;
+
+#ifdef USE_EPOLL
+  monitor_output ("Event loop backend: epoll\n");
+#else
+  monitor_output ("Event loop backend: select\n");
+#endif
+  sprintf (buf, "Wakeups: %lu\n", event_loop_stats.wakeups);
+  monitor_output (buf);
+  sprintf (buf, "File events: %lu\n", event_loop_stats.file_events);
+  monitor_output (buf);
+  sprintf (buf, "Callbacks: %lu\n", event_loop_stats.callbacks);
+  monitor_output (buf);
+  sprintf (buf, "Elapsed: %.3f s\n", elapsed);
+  monitor_output (buf);
+  if (elapsed > 0)
+    {
+      sprintf (buf, "Events per second: %.0f\n", events / elapsed);
+      monitor_output (buf);
+    }
+}
+
+/* Reset the event loop statistics.  */
+
+void
+reset_event_loop_stats (void)
+{
+  event_loop_stats.wakeups = 0;
+  event_loop_stats.file_events = 0;
+  event_loop_stats.callbacks = 0;
+  gettimeofday (&event_loop_stats.start, NULL);
+}
+
 /* Start up the event loop.  This is the entry point to the event
    loop.  */
 
 void
 start_event_loop (void)
 {
+  if (event_loop_stats.start.tv_sec == 0)
+    reset_event_loop_stats ();
+
   /* Loop until there is nothing to do.  This is the entry point to
      the event loop engine.  If nothing is ready at this time, wait
      for something to happen (via wait_for_event), then process it.
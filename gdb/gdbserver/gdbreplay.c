@@ -60,10 +60,13 @@
 #if HAVE_MALLOC_H
 #include <malloc.h>
 #endif
+#include <sys/time.h>
 #if USE_WIN32API
 #include <winsock2.h>
 #endif
 
+#include "capture.h"
+
 #ifndef HAVE_SOCKLEN_T
 typedef int socklen_t;
 #endif
@@ -71,6 +74,8 @@ typedef int socklen_t;
 /* Sort of a hack... */
 #define EOL (EOF - 1)
 
+typedef unsigned long long ULONGEST;
+
 /* Version information, from version.c.  */
 extern const char version[];
 extern const char host_name[];
@@ -416,6 +421,657 @@ play (FILE *fp)
     }
 }
 
+static void *
+xrealloc (void *ptr, size_t size)
+{
+  void *val = realloc (ptr, size);
+
+  if (val == NULL)
+    remote_error ("Out of memory");
+  return val;
+}
+
+/* An open binary capture.  See capture.h for the format.  */
+
+struct capture
+{
+  FILE *fp;
+
+  /* When the capture was started, in microseconds since the
+     epoch.  */
+  ULONGEST start;
+
+  /* The offset of the next record, and the offset where the records
+     end.  */
+  ULONGEST offset;
+  ULONGEST end;
+
+  /* If the capture has a trailer, the number of records and their
+     index; otherwise NUM_RECORDS is 0 and INDEX is NULL.  */
+  ULONGEST num_records;
+  ULONGEST *index;
+  size_t index_len;
+};
+
+/* A record read from a capture.  */
+
+struct capture_record
+{
+  int kind;
+  unsigned long len;
+
+  /* When the data was sent, in microseconds since the start of the
+     capture.  */
+  ULONGEST time;
+
+  unsigned char *data;
+  size_t data_size;
+};
+
+/* Return the LEN byte little endian integer at BUF.  */
+
+static ULONGEST
+capture_fetch (const unsigned char *buf, int len)
+{
+  ULONGEST val = 0;
+
+  while (len-- > 0)
+    val = (val << 8) | buf[len];
+  return val;
+}
+
+/* Return true if FP starts with a binary capture header.  Leave FP at
+   its start either way.  */
+
+static int
+capture_file_p (FILE *fp)
+{
+  char magic[CAPTURE_MAGIC_LEN];
+  int found;
+
+  found = (fread (magic, 1, sizeof (magic), fp) == sizeof (magic)
+	   && memcmp (magic, CAPTURE_MAGIC, CAPTURE_MAGIC_LEN) == 0);
+  rewind (fp);
+  return found;
+}
+
+/* Open the binary capture in FP, filling in CAP, and read its index
+   if it has one.  */
+
+static void
+capture_open (FILE *fp, struct capture *cap)
+{
+  unsigned char buf[CAPTURE_TRAILER_LEN];
+  long size;
+  size_t i;
+
+  memset (cap, 0, sizeof (*cap));
+  cap->fp = fp;
+  cap->end = (ULONGEST) -1;
+
+  if (fread (buf, 1, CAPTURE_HEADER_LEN, fp) != CAPTURE_HEADER_LEN)
+    remote_error ("Truncated capture header");
+  cap->start = capture_fetch (buf + CAPTURE_MAGIC_LEN, 8);
+
+  /* Look for the trailer.  */
+  if (fseek (fp, 0, SEEK_END) == 0
+      && (size = ftell (fp)) >= CAPTURE_HEADER_LEN + CAPTURE_TRAILER_LEN
+      && fseek (fp, size - CAPTURE_TRAILER_LEN, SEEK_SET) == 0
+      && fread (buf, 1, CAPTURE_TRAILER_LEN, fp) == CAPTURE_TRAILER_LEN
+      && memcmp (buf + 16, CAPTURE_TRAILER_MAGIC, CAPTURE_MAGIC_LEN) == 0)
+    {
+      ULONGEST index_offset = capture_fetch (buf, 8);
+      ULONGEST num_records = capture_fetch (buf + 8, 8);
+      ULONGEST index_len = ((num_records + CAPTURE_INDEX_INTERVAL - 1)
+			    / CAPTURE_INDEX_INTERVAL);
+
+      if (index_offset >= CAPTURE_HEADER_LEN
+	  && index_offset + index_len * 8 + CAPTURE_TRAILER_LEN == size
+	  && fseek (fp, index_offset, SEEK_SET) == 0)
+	{
+	  cap->index = xrealloc (NULL, (index_len + 1) * sizeof (ULONGEST));
+	  for (i = 0; i < index_len; i++)
+	    {
+	      if (fread (buf, 1, 8, fp) != 8)
+		remote_error ("Truncated capture index");
+	      cap->index[i] = capture_fetch (buf, 8);
+	    }
+	  cap->index_len = index_len;
+	  cap->num_records = num_records;
+	  cap->end = index_offset;
+	}
+    }
+
+  if (fseek (fp, CAPTURE_HEADER_LEN, SEEK_SET) != 0)
+    perror_with_name ("fseek");
+  cap->offset = CAPTURE_HEADER_LEN;
+}
+
+/* Read the next record of CAP into REC.  Return 0 at the end of the
+   records, including when the last one is truncated, 1 otherwise.  */
+
+static int
+capture_read_record (struct capture *cap, struct capture_record *rec)
+{
+  unsigned char header[CAPTURE_RECORD_HEADER_LEN];
+
+  if (cap->offset >= cap->end
+      || fread (header, 1, sizeof (header), cap->fp) != sizeof (header))
+    return 0;
+
+  rec->kind = header[0];
+  rec->len = capture_fetch (header + 1, 4);
+  rec->time = capture_fetch (header + 5, 8);
+
+  if (rec->kind != CAPTURE_FROM_GDB && rec->kind != CAPTURE_TO_GDB)
+    {
+      fprintf (stderr, "\nBad capture record kind 0x%x at offset %llu\n",
+	       rec->kind, cap->offset);
+      exit (1);
+    }
+
+  if (rec->len > rec->data_size)
+    {
+      rec->data_size = rec->len;
+      rec->data = xrealloc (rec->data, rec->data_size);
+    }
+  if (fread (rec->data, 1, rec->len, cap->fp) != rec->len)
+    return 0;
+
+  cap->offset += sizeof (header) + rec->len;
+  return 1;
+}
+
+/* Position CAP at record number N, using the index if there is
+   one.  Return 0 if there are fewer records than that.  */
+
+static int
+capture_seek_record (struct capture *cap, ULONGEST n,
+		     struct capture_record *rec)
+{
+  ULONGEST i = 0;
+
+  if (cap->index != NULL)
+    {
+      if (n >= cap->num_records)
+	return 0;
+
+      i = n - n % CAPTURE_INDEX_INTERVAL;
+      cap->offset = cap->index[n / CAPTURE_INDEX_INTERVAL];
+      if (fseek (cap->fp, cap->offset, SEEK_SET) != 0)
+	perror_with_name ("fseek");
+    }
+
+  for (; i < n; i++)
+    if (!capture_read_record (cap, rec))
+      return 0;
+
+  return 1;
+}
+
+/* Read exactly LEN bytes from GDB into BUF.  */
+
+static void
+gdb_read_fully (unsigned char *buf, unsigned long len)
+{
+  while (len > 0)
+    {
+      int cc = read (remote_desc, buf, len);
+
+      if (cc <= 0)
+	remote_error ("Error during read from gdb");
+      buf += cc;
+      len -= cc;
+    }
+}
+
+/* Return the current time in microseconds.  */
+
+static ULONGEST
+now_usec (void)
+{
+  struct timeval tv;
+
+  gettimeofday (&tv, NULL);
+  return (ULONGEST) tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+/* Wait USEC microseconds.  */
+
+static void
+delay_usec (ULONGEST usec)
+{
+#ifdef USE_WIN32API
+  Sleep (usec / 1000);
+#else
+  struct timeval tv;
+
+  tv.tv_sec = usec / 1000000;
+  tv.tv_usec = usec % 1000000;
+  select (0, NULL, NULL, NULL, &tv);
+#endif
+}
+
+/* Replay the binary capture CAP.  Data from GDB is read in one go and
+   compared with the capture, and data for GDB is written in one go.
+   If TIMING, each reply to GDB is delayed as much as it was in the
+   original session, counting from the data from GDB before it.  */
+
+static void
+replay_capture (struct capture *cap, int timing)
+{
+  struct capture_record rec;
+  unsigned char *buf = NULL;
+  size_t buf_size = 0;
+  ULONGEST n, anchor_time = 0, anchor_local = now_usec ();
+
+  memset (&rec, 0, sizeof (rec));
+  for (n = 0; capture_read_record (cap, &rec); n++)
+    {
+      if (rec.kind == CAPTURE_FROM_GDB)
+	{
+	  unsigned long i;
+
+	  if (rec.len > buf_size)
+	    {
+	      buf_size = rec.len;
+	      buf = xrealloc (buf, buf_size);
+	    }
+	  gdb_read_fully (buf, rec.len);
+
+	  for (i = 0; i < rec.len; i++)
+	    if (buf[i] != rec.data[i])
+	      {
+		fprintf (stderr, "\nSync error during read of gdb data\n");
+		fprintf (stderr,
+			 "At record %llu, byte %lu, expected '0x%x' got '0x%x'\n",
+			 n, i, rec.data[i], buf[i]);
+		fflush (stderr);
+		exit (1);
+	      }
+
+	  anchor_time = rec.time;
+	  anchor_local = now_usec ();
+	}
+      else
+	{
+	  if (timing && rec.time > anchor_time)
+	    {
+	      ULONGEST due = anchor_local + (rec.time - anchor_time);
+	      ULONGEST now = now_usec ();
+
+	      if (due > now)
+		delay_usec (due - now);
+	    }
+
+	  if (write (remote_desc, rec.data, rec.len) != rec.len)
+	    remote_error ("Error during write to gdb");
+	}
+    }
+
+  free (buf);
+  free (rec.data);
+}
+
+/* Print the records of CAP starting with record number FIRST, in the
+   format of a "set remotelogfile" log.  */
+
+static void
+dump_capture (struct capture *cap, ULONGEST first)
+{
+  struct capture_record rec;
+  unsigned long i;
+
+  memset (&rec, 0, sizeof (rec));
+  if (!capture_seek_record (cap, first, &rec))
+    {
+      fprintf (stderr, "Capture has no record %llu\n", first);
+      exit (1);
+    }
+
+  while (capture_read_record (cap, &rec))
+    {
+      printf ("%c ", rec.kind);
+      for (i = 0; i < rec.len; i++)
+	{
+	  int ch = rec.data[i];
+
+	  switch (ch)
+	    {
+	    case '\\':
+	      fputs ("\\\\", stdout);
+	      break;
+	    case '\b':
+	      fputs ("\\b", stdout);
+	      break;
+	    case '\f':
+	      fputs ("\\f", stdout);
+	      break;
+	    case '\n':
+	      fputs ("\\n", stdout);
+	      break;
+	    case '\r':
+	      fputs ("\\r", stdout);
+	      break;
+	    case '\t':
+	      fputs ("\\t", stdout);
+	      break;
+	    case '\v':
+	      fputs ("\\v", stdout);
+	      break;
+	    default:
+	      printf (isprint (ch) ? "%c" : "\\x%02x", ch);
+	      break;
+	    }
+	}
+      putchar ('\n');
+    }
+
+  free (rec.data);
+}
+
+/* Latency histogram buckets.  Bucket 0 counts latencies under 2
+   microseconds, bucket N > 0 latencies in [2^N, 2^(N+1)), and the
+   last bucket everything above.  */
+#define LATENCY_BUCKETS 24
+
+/* Statistics about one type of packet sent by GDB.  */
+
+struct packet_stats
+{
+  struct packet_stats *next;
+
+  /* The packet name: "vCont", "qXfer", "m", etc.  */
+  char name[32];
+
+  /* How many packets of this type GDB sent, and how many bytes they
+     and their replies took, including the framing.  */
+  unsigned long count;
+  ULONGEST bytes_from_gdb;
+  ULONGEST bytes_to_gdb;
+
+  /* How many packets got a reply, and how long the replies took.  */
+  unsigned long replies;
+  ULONGEST total_latency;
+  ULONGEST max_latency;
+  unsigned long histogram[LATENCY_BUCKETS];
+};
+
+/* The state of the packet parser for one direction of a capture.  */
+
+struct packet_parser
+{
+  enum { PARSE_IDLE, PARSE_DATA, PARSE_CSUM1, PARSE_CSUM2 } state;
+
+  /* Whether the packet being parsed is a notification.  */
+  int notif;
+
+  /* The name of the packet being parsed, and whether we have seen all
+     of it.  */
+  char name[32];
+  int name_len;
+  int name_done;
+
+  /* The length of the packet being parsed so far.  */
+  unsigned long len;
+};
+
+/* Feed CH to parser P.  Return 1 if that completes a packet, 0
+   otherwise.  Set *OUTSIDE to CH if it is not part of a packet (an
+   ack or an interrupt request), or to -1.  */
+
+static int
+parse_packet_char (struct packet_parser *p, int ch, int *outside)
+{
+  *outside = -1;
+
+  switch (p->state)
+    {
+    case PARSE_IDLE:
+      if (ch == '$' || ch == '%')
+	{
+	  p->state = PARSE_DATA;
+	  p->notif = (ch == '%');
+	  p->name_len = 0;
+	  p->name_done = 0;
+	  p->len = 1;
+	}
+      else
+	*outside = ch;
+      return 0;
+    case PARSE_DATA:
+      p->len++;
+      if (ch == '#')
+	p->state = PARSE_CSUM1;
+      else if (!p->name_done)
+	{
+	  /* Queries and v packets are named by their first word,
+	     other packets by their first letter.  */
+	  if (p->name_len > 0
+	      && (strchr (":;,?", ch) != NULL
+		  || strchr ("qQv", p->name[0]) == NULL
+		  || p->name_len == sizeof (p->name) - 1))
+	    p->name_done = 1;
+	  else
+	    p->name[p->name_len++] = ch;
+	}
+      return 0;
+    case PARSE_CSUM1:
+      p->len++;
+      p->state = PARSE_CSUM2;
+      return 0;
+    default:
+      p->len++;
+      p->state = PARSE_IDLE;
+      p->name[p->name_len] = '\0';
+      return 1;
+    }
+}
+
+/* Return the statistics entry for packets named NAME in *LIST,
+   creating it if needed.  */
+
+static struct packet_stats *
+lookup_packet_stats (struct packet_stats **list, const char *name)
+{
+  struct packet_stats *ps;
+
+  for (ps = *list; ps != NULL; ps = ps->next)
+    if (strcmp (ps->name, name) == 0)
+      return ps;
+
+  ps = xrealloc (NULL, sizeof (*ps));
+  memset (ps, 0, sizeof (*ps));
+  strcpy (ps->name, name);
+  ps->next = *list;
+  *list = ps;
+  return ps;
+}
+
+/* Return LIST sorted by decreasing packet count.  */
+
+static struct packet_stats *
+sort_packet_stats (struct packet_stats *list)
+{
+  struct packet_stats *sorted = NULL, *ps, **link;
+
+  /* There are few packet types, so an insertion sort does.  */
+  while (list != NULL)
+    {
+      ps = list;
+      list = list->next;
+
+      for (link = &sorted; *link != NULL; link = &(*link)->next)
+	if ((*link)->count < ps->count)
+	  break;
+      ps->next = *link;
+      *link = ps;
+    }
+
+  return sorted;
+}
+
+/* Add LATENCY to the histogram HISTOGRAM.  */
+
+static void
+add_latency (unsigned long *histogram, ULONGEST latency)
+{
+  int bucket = 0;
+
+  while (latency >= 2 && bucket < LATENCY_BUCKETS - 1)
+    {
+      latency >>= 1;
+      bucket++;
+    }
+  histogram[bucket]++;
+}
+
+/* Print the non-empty buckets of HISTOGRAM.  */
+
+static void
+print_histogram (const unsigned long *histogram)
+{
+  int i;
+
+  for (i = 0; i < LATENCY_BUCKETS; i++)
+    {
+      if (histogram[i] == 0)
+	continue;
+
+      if (i == 0)
+	printf ("      < 2us");
+      else if (i == LATENCY_BUCKETS - 1)
+	printf ("      >= %luus", 1UL << i);
+      else
+	printf ("      [%lu, %lu)us", 1UL << i, 1UL << (i + 1));
+      printf (": %lu\n", histogram[i]);
+    }
+}
+
+/* Print a summary of the capture CAP: packet counts, bytes and reply
+   latency histograms by packet type.  The latency of a packet is the
+   time between the end of the packet and the end of the first reply
+   GDB got after it.  */
+
+static void
+summarize_capture (struct capture *cap)
+{
+  struct capture_record rec;
+  struct packet_parser from_gdb, to_gdb;
+  struct packet_stats *stats = NULL, *ps, *pending = NULL;
+  ULONGEST pending_time = 0, first_time = 0, last_time = 0;
+  ULONGEST num_records = 0;
+  ULONGEST bytes_from_gdb = 0, bytes_to_gdb = 0;
+  unsigned long packets = 0, acks = 0, naks = 0, interrupts = 0;
+  unsigned long notifications = 0, replies = 0;
+  unsigned long histogram[LATENCY_BUCKETS];
+  unsigned long i;
+  int outside;
+
+  memset (&rec, 0, sizeof (rec));
+  memset (&from_gdb, 0, sizeof (from_gdb));
+  memset (&to_gdb, 0, sizeof (to_gdb));
+  memset (histogram, 0, sizeof (histogram));
+
+  while (capture_read_record (cap, &rec))
+    {
+      if (num_records++ == 0)
+	first_time = rec.time;
+      last_time = rec.time;
+
+      for (i = 0; i < rec.len; i++)
+	{
+	  if (rec.kind == CAPTURE_FROM_GDB)
+	    {
+	      bytes_from_gdb++;
+	      if (parse_packet_char (&from_gdb, rec.data[i], &outside))
+		{
+		  ps = lookup_packet_stats (&stats, from_gdb.name);
+		  ps->count++;
+		  ps->bytes_from_gdb += from_gdb.len;
+		  packets++;
+
+		  pending = ps;
+		  pending_time = rec.time;
+		}
+	      else if (outside == '\003')
+		interrupts++;
+	      else if (outside == '+')
+		acks++;
+	      else if (outside == '-')
+		naks++;
+	    }
+	  else
+	    {
+	      bytes_to_gdb++;
+	      if (parse_packet_char (&to_gdb, rec.data[i], &outside))
+		{
+		  if (to_gdb.notif)
+		    notifications++;
+		  else
+		    replies++;
+
+		  if (pending != NULL && !to_gdb.notif)
+		    {
+		      ULONGEST latency = rec.time - pending_time;
+
+		      pending->bytes_to_gdb += to_gdb.len;
+		      pending->replies++;
+		      pending->total_latency += latency;
+		      if (latency > pending->max_latency)
+			pending->max_latency = latency;
+		      add_latency (pending->histogram, latency);
+		      add_latency (histogram, latency);
+		      pending = NULL;
+		    }
+		}
+	      else if (outside == '+')
+		acks++;
+	      else if (outside == '-')
+		naks++;
+	    }
+	}
+    }
+  free (rec.data);
+
+  printf ("Records: %llu%s\n", num_records,
+	  cap->index != NULL ? "" : " (capture not closed cleanly)");
+  printf ("Duration: %llu.%06llus\n", (last_time - first_time) / 1000000,
+	  (last_time - first_time) % 1000000);
+  printf ("Bytes from GDB: %llu, to GDB: %llu\n",
+	  bytes_from_gdb, bytes_to_gdb);
+  printf ("Packets from GDB: %lu, replies: %lu, notifications: %lu\n",
+	  packets, replies, notifications);
+  printf ("Acks: %lu, naks: %lu, interrupts: %lu\n",
+	  acks, naks, interrupts);
+
+  /* List the most frequent packets first.  */
+  stats = sort_packet_stats (stats);
+
+  printf ("\n%-24s %10s %12s %12s %10s %10s\n",
+	  "Packet", "Count", "Bytes in", "Bytes out",
+	  "Avg (us)", "Max (us)");
+  for (ps = stats; ps != NULL; ps = ps->next)
+    {
+      printf ("%-24s %10lu %12llu %12llu %10llu %10llu\n",
+	      ps->name[0] != '\0' ? ps->name : "(empty)",
+	      ps->count, ps->bytes_from_gdb, ps->bytes_to_gdb,
+	      ps->replies ? ps->total_latency / ps->replies : 0,
+	      ps->max_latency);
+      print_histogram (ps->histogram);
+    }
+
+  printf ("\nAll packets:\n");
+  print_histogram (histogram);
+
+  while (stats != NULL)
+    {
+      ps = stats->next;
+      free (stats);
+      stats = ps;
+    }
+}
+
 static void
 gdbreplay_version (void)
 {
@@ -430,7 +1086,18 @@ gdbreplay_version (void)
 static void
 gdbreplay_usage (FILE *stream)
 {
-  fprintf (stream, "Usage:\tgdbreplay <logfile> <host:port>\n");
+  fprintf (stream, "Usage:\tgdbreplay [--timing] <logfile> <host:port>\n"
+	   "\tgdbreplay --summary <capture>\n"
+	   "\tgdbreplay --dump[=RECORD] <capture>\n"
+	   "\n"
+	   "LOGFILE is either a \"set remotelogfile\" log, or a binary\n"
+	   "capture made with \"gdbserver --capture\".\n"
+	   "\n"
+	   "Options:\n"
+	   "  --timing          Delay replies as in the captured session.\n"
+	   "  --summary         Print packet counts, sizes and latencies.\n"
+	   "  --dump[=RECORD]   Print the capture as a text log, optionally\n"
+	   "                    starting at record number RECORD.\n");
   if (REPORT_BUGS_TO[0] && stream == stdout)
     fprintf (stream, "Report bugs to \"%s\".\n", REPORT_BUGS_TO);
 }
@@ -440,6 +1107,9 @@ main (int argc, char *argv[])
 {
   FILE *fp;
   int ch;
+  int timing = 0, summary = 0, dump = 0;
+  ULONGEST first = 0;
+  struct capture cap;
 
   if (argc >= 2 && strcmp (argv[1], "--version") == 0)
     {
@@ -452,16 +1122,62 @@ main (int argc, char *argv[])
       exit (0);
     }
 
-  if (argc < 3)
+  while (argc >= 2 && strncmp (argv[1], "--", 2) == 0)
+    {
+      if (strcmp (argv[1], "--timing") == 0)
+	timing = 1;
+      else if (strcmp (argv[1], "--summary") == 0)
+	summary = 1;
+      else if (strcmp (argv[1], "--dump") == 0)
+	dump = 1;
+      else if (strncmp (argv[1], "--dump=", 7) == 0)
+	{
+	  dump = 1;
+	  first = strtoull (argv[1] + 7, NULL, 10);
+	}
+      else
+	{
+	  gdbreplay_usage (stderr);
+	  exit (1);
+	}
+      argv++;
+      argc--;
+    }
+
+  if (argc < ((summary || dump) ? 2 : 3))
     {
       gdbreplay_usage (stderr);
       exit (1);
     }
-  fp = fopen (argv[1], "r");
+  fp = fopen (argv[1], "rb");
   if (fp == NULL)
     {
       perror_with_name (argv[1]);
     }
+
+  if (capture_file_p (fp))
+    {
+      capture_open (fp, &cap);
+      if (summary)
+	summarize_capture (&cap);
+      else if (dump)
+	dump_capture (&cap, first);
+      else
+	{
+	  remote_open (argv[2]);
+	  replay_capture (&cap, timing);
+	  remote_close ();
+	}
+      free (cap.index);
+      exit (0);
+    }
+
+  if (timing || summary || dump)
+    {
+      fprintf (stderr, "%s: Not a binary capture\n", argv[1]);
+      exit (1);
+    }
+
   remote_open (argv[2]);
   while ((ch = logchar (fp)) != EOF)
     {
@@ -19,6 +19,8 @@
    along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
 
 #include <stdlib.h>
+#include <sys/types.h>
+#include <sys/stat.h>
 
 #include "server.h"
 
@@ -32,16 +34,101 @@ struct thread_info *current_inferior;
 #define get_thread(inf) ((struct thread_info *)(inf))
 #define get_dll(inf) ((struct dll_info *)(inf))
 
+/* Initial number of buckets in an inferior_list's ID hash table.  */
+#define INFERIOR_LIST_INITIAL_BUCKETS 64
+
+/* Return the hash table key of ID.  Entries are hashed on the LWP
+   component alone when there is one, so that find_inferior_lwp can
+   find an entry without knowing its process ID.  */
+
+static unsigned long
+inferior_id_hash_key (ptid_t id)
+{
+  long lwp = ptid_get_lwp (id);
+
+  return lwp != 0 ? lwp : ptid_get_pid (id);
+}
+
+/* Return the bucket of LIST's hash table KEY belongs in.  */
+
+static struct inferior_list_entry **
+inferior_list_bucket (struct inferior_list *list, unsigned long key)
+{
+  return &list->buckets[key & (list->num_buckets - 1)];
+}
+
+/* Append ENTRY to the end of its bucket in LIST's hash table, so that
+   entries with equal IDs stay in list order.  */
+
+static void
+inferior_list_hash_insert (struct inferior_list *list,
+			   struct inferior_list_entry *entry)
+{
+  struct inferior_list_entry **slot;
+
+  slot = inferior_list_bucket (list, inferior_id_hash_key (entry->id));
+  while (*slot != NULL)
+    slot = &(*slot)->hash_next;
+  entry->hash_next = NULL;
+  *slot = entry;
+}
+
+/* Remove ENTRY from LIST's hash table.  */
+
+static void
+inferior_list_hash_remove (struct inferior_list *list,
+			   struct inferior_list_entry *entry)
+{
+  struct inferior_list_entry **slot;
+
+  slot = inferior_list_bucket (list, inferior_id_hash_key (entry->id));
+  while (*slot != NULL && *slot != entry)
+    slot = &(*slot)->hash_next;
+  if (*slot != NULL)
+    *slot = entry->hash_next;
+}
+
+/* Make sure LIST's hash table has room for one more entry, growing
+   and rehashing it if the load factor would exceed 2.  */
+
+static void
+inferior_list_hash_reserve (struct inferior_list *list)
+{
+  struct inferior_list_entry *inf;
+
+  if (list->buckets != NULL && list->count < 2 * list->num_buckets)
+    return;
+
+  if (list->buckets == NULL)
+    list->num_buckets = INFERIOR_LIST_INITIAL_BUCKETS;
+  else
+    {
+      free (list->buckets);
+      list->num_buckets *= 2;
+    }
+  list->buckets = xcalloc (list->num_buckets, sizeof (list->buckets[0]));
+
+  /* Walk the list rather than the old buckets, so that entries with
+     equal IDs are reinserted in list order.  */
+  for (inf = list->head; inf != NULL; inf = inf->next)
+    inferior_list_hash_insert (list, inf);
+}
+
 void
 add_inferior_to_list (struct inferior_list *list,
 		      struct inferior_list_entry *new_inferior)
 {
+  inferior_list_hash_reserve (list);
+
   new_inferior->next = NULL;
   if (list->tail != NULL)
     list->tail->next = new_inferior;
   else
     list->head = new_inferior;
   list->tail = new_inferior;
+
+  list->count++;
+  inferior_list_hash_insert (list, new_inferior);
 }
 
 /* Invoke ACTION for each inferior in LIST.  */
@@ -71,6 +158,8 @@ remove_inferior (struct inferior_list *list,
       list->head = entry->next;
       if (list->tail == entry)
 	list->tail = list->head;
+      inferior_list_hash_remove (list, entry);
+      list->count--;
       return;
     }
 
@@ -82,6 +171,8 @@ remove_inferior (struct inferior_list *list,
     return;
 
   (*cur)->next = entry->next;
+  inferior_list_hash_remove (list, entry);
+  list->count--;
 
   if (list->tail == entry)
     list->tail = *cur;
@@ -110,14 +201,8 @@ add_thread (ptid_t thread_id, void *target_data)
 ptid_t
 thread_id_to_gdb_id (ptid_t thread_id)
 {
-  struct inferior_list_entry *inf = all_threads.head;
-
-  while (inf != NULL)
-    {
-      if (ptid_equal (inf->id, thread_id))
-	return thread_id;
-      inf = inf->next;
-    }
+  if (find_inferior_id (&all_threads, thread_id) != NULL)
+    return thread_id;
 
   return null_ptid;
 }
@@ -131,17 +216,7 @@ thread_to_gdb_id (struct thread_info *thread)
 struct thread_info *
 find_thread_ptid (ptid_t ptid)
 {
-  struct inferior_list_entry *inf = all_threads.head;
-
-  while (inf != NULL)
-    {
-      struct thread_info *thread = get_thread (inf);
-      if (ptid_equal (thread->entry.id, ptid))
-	return thread;
-      inf = inf->next;
-    }
-
-  return NULL;
+  return get_thread (find_inferior_id (&all_threads, ptid));
 }
 
 ptid_t
@@ -189,17 +264,42 @@ find_inferior (struct inferior_list *list,
   return NULL;
 }
 
+/* Find the first entry in LIST whose ID is ID.  This is a hash table
+   lookup.  */
+
 struct inferior_list_entry *
 find_inferior_id (struct inferior_list *list, ptid_t id)
 {
-  struct inferior_list_entry *inf = list->head;
+  struct inferior_list_entry *inf;
 
-  while (inf != NULL)
-    {
-      if (ptid_equal (inf->id, id))
-	return inf;
-      inf = inf->next;
-    }
+  if (list->buckets == NULL)
+    return NULL;
+
+  for (inf = *inferior_list_bucket (list, inferior_id_hash_key (id));
+       inf != NULL;
+       inf = inf->hash_next)
+    if (ptid_equal (inf->id, id))
+      return inf;
+
+  return NULL;
+}
+
+/* Find the first entry in LIST whose ID's LWP component is LWP,
+   whatever its process ID.  This is a hash table lookup.  */
+
+struct inferior_list_entry *
+find_inferior_lwp (struct inferior_list *list, long lwp)
+{
+  struct inferior_list_entry *inf;
+
+  if (list->buckets == NULL)
+    return NULL;
+
+  for (inf = *inferior_list_bucket (list, lwp);
+       inf != NULL;
+       inf = inf->hash_next)
+    if (ptid_get_lwp (inf->id) == lwp)
+      return inf;
 
   return NULL;
 }
@@ -308,8 +408,15 @@ unloaded_dll (const char *name, CORE_ADDR base_addr)
     }
 }
 
-#define clear_list(LIST) \
-  do { (LIST)->head = (LIST)->tail = NULL; } while (0)
+#define clear_list(LIST)						\
+  do									\
+    {									\
+      (LIST)->head = (LIST)->tail = NULL;				\
+      free ((LIST)->buckets);						\
+      (LIST)->buckets = NULL;						\
+      (LIST)->num_buckets = (LIST)->count = 0;				\
+    }									\
+  while (0)
 
 void
 clear_inferiors (void)
@@ -352,6 +459,100 @@ pull_pid_from_list (struct inferior_list *list, unsigned long pid)
     }
 }
 
+/* State shared by all the processes we started from the same
+   executable file.  Since we only share it between processes started
+   with address space randomization disabled, these processes have the
+   same memory layout, and so lookups made for one of them are valid
+   for all.  */
+
+struct exec_cache
+{
+  struct exec_cache *next;
+
+  /* Number of processes using this cache.  */
+  int refcount;
+
+  /* Identity of the executable file, as returned by stat.  */
+  dev_t dev;
+  ino_t ino;
+  time_t mtime;
+
+  /* The symbol cache shared by these processes.  See
+     look_up_one_symbol.  */
+  struct sym_cache *symbol_cache;
+};
+
+/* All exec caches in use.  */
+static struct exec_cache *exec_caches;
+
+/* Make PROCESS share the cache of the executable PROGRAM, creating the
+   cache if PROCESS is the first one started from PROGRAM.  */
+
+void
+share_exec_cache (struct process_info *process, const char *program)
+{
+  struct exec_cache *cache;
+  struct stat st;
+
+  if (process->exec_cache != NULL || stat (program, &st) != 0)
+    return;
+
+  for (cache = exec_caches; cache != NULL; cache = cache->next)
+    if (cache->dev == st.st_dev
+	&& cache->ino == st.st_ino
+	&& cache->mtime == st.st_mtime)
+      break;
+
+  if (cache == NULL)
+    {
+      cache = xcalloc (1, sizeof (*cache));
+      cache->dev = st.st_dev;
+      cache->ino = st.st_ino;
+      cache->mtime = st.st_mtime;
+      cache->next = exec_caches;
+      exec_caches = cache;
+    }
+
+  cache->refcount++;
+  process->exec_cache = cache;
+}
+
+/* Drop PROCESS's reference to its exec cache, if any.  */
+
+static void
+release_exec_cache (struct process_info *process)
+{
+  struct exec_cache *cache = process->exec_cache;
+  struct exec_cache **link;
+
+  if (cache == NULL)
+    return;
+
+  process->exec_cache = NULL;
+  if (--cache->refcount > 0)
+    return;
+
+  for (link = &exec_caches; *link != cache; link = &(*link)->next)
+    ;
+  *link = cache->next;
+
+  clear_symbol_cache (&cache->symbol_cache);
+  free (cache);
+}
+
+/* Return the symbol cache to use for PROCESS: the cache shared with
+   the other processes running the same executable, if there is one,
+   or PROCESS's own.  */
+
+struct sym_cache **
+process_symbol_cache (struct process_info *process)
+{
+  if (process->exec_cache != NULL)
+    return &process->exec_cache->symbol_cache;
+
+  return &process->symbol_cache;
+}
+
 struct process_info *
 add_process (int pid, int attached)
 {
@@ -375,6 +576,7 @@ void
 remove_process (struct process_info *process)
 {
   clear_symbol_cache (&process->symbol_cache);
+  release_exec_cache (process);
   free_all_breakpoints (process);
   remove_inferior (&all_processes, &process->head);
   free (process);
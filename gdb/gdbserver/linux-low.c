@@ -1041,10 +1041,9 @@ status_pending_p_callback (struct inferior_list_entry *entry, void *arg)
   return lwp->status_pending_p;
 }
 
-static int
-same_lwp (struct inferior_list_entry *entry, void *data)
+struct lwp_info *
+find_lwp_pid (ptid_t ptid)
 {
-  ptid_t ptid = *(ptid_t *) data;
   int lwp;
 
   if (ptid_get_lwp (ptid) != 0)
@@ -1052,16 +1051,7 @@ same_lwp (struct inferior_list_entry *entry, void *data)
   else
     lwp = ptid_get_pid (ptid);
 
-  if (ptid_get_lwp (entry->id) == lwp)
-    return 1;
-
-  return 0;
-}
-
-struct lwp_info *
-find_lwp_pid (ptid_t ptid)
-{
-  return (struct lwp_info*) find_inferior (&all_lwps, same_lwp, &ptid);
+  return (struct lwp_info *) find_inferior_lwp (&all_lwps, lwp);
 }
 
 static struct lwp_info *
@@ -1512,7 +1502,9 @@ cancel_breakpoint (struct lwp_info *lwp)
   saved_inferior = current_inferior;
   current_inferior = get_lwp_thread (lwp);
 
-  if ((*the_low_target.breakpoint_at) (lwp->stop_pc))
+  /* A coverage point another thread hit first is already gone.  */
+  if ((*the_low_target.breakpoint_at) (lwp->stop_pc)
+      || coverage_point_hit_at (lwp->stop_pc))
     {
       if (debug_threads)
 	fprintf (stderr,
@@ -2061,6 +2053,7 @@ linux_wait_1 (ptid_t ptid,
   int bp_explains_trap;
   int maybe_internal_trap;
   int report_to_gdb;
+  int gdb_bp_hit;
   int trace_event;
 
   /* Translate generic target options into linux options.  */
@@ -2184,7 +2177,8 @@ retry:
 	 breakpoint, or if we should possibly report the event to GDB.
 	 Do this before anything that may remove or insert a
 	 breakpoint.  */
-      bp_explains_trap = breakpoint_inserted_here (event_child->stop_pc);
+      bp_explains_trap = (breakpoint_inserted_here (event_child->stop_pc)
+			  || coverage_point_hit_at (event_child->stop_pc));
 
       /* We have a SIGTRAP, possibly a step-over dance has just
 	 finished.  If so, tweak the state machine accordingly,
@@ -2370,13 +2364,44 @@ Check if we're already there.\n",
      not support Z0 breakpoints.  If we do, we're be able to handle
      GDB breakpoints on top of internal breakpoints, by handling the
      internal breakpoint and still reporting the event to GDB.  If we
-     don't, we're out of luck, GDB won't see the breakpoint hit.  */
+     don't, we're out of luck, GDB won't see the breakpoint hit.  A
+     GDB breakpoint whose conditions we evaluated to false is handled
+     like an internal breakpoint.  */
+  gdb_bp_hit = (maybe_internal_trap
+		&& gdb_breakpoint_here (event_child->stop_pc)
+		&& gdb_condition_true_at_breakpoint (event_child->stop_pc));
+
+  /* A GDB breakpoint may come with commands for us to run when it is
+     hit, instead of reporting the hit to GDB.  */
+  if (gdb_bp_hit && !gdb_no_commands_at_breakpoint (event_child->stop_pc))
+    {
+      if (debug_threads)
+	fprintf (stderr, "Running commands of GDB breakpoint at 0x%s.\n",
+		 paddress (event_child->stop_pc));
+      run_breakpoint_commands (event_child->stop_pc);
+      gdb_bp_hit = 0;
+    }
+
+  /* GDB may also have asked us to skip a number of hits before
+     reporting one.  Hits we would report anyway don't count.  */
+  if (gdb_bp_hit
+      && current_inferior->last_resume_kind != resume_step
+      && !event_child->stopped_by_watchpoint
+      && gdb_breakpoint_hit_ignored (event_child->stop_pc))
+    {
+      if (debug_threads)
+	fprintf (stderr, "Ignoring hit of GDB breakpoint at 0x%s.\n",
+		 paddress (event_child->stop_pc));
+      event_child->skipped_gdb_breakpoint = 1;
+      gdb_bp_hit = 0;
+    }
+
   report_to_gdb = (!maybe_internal_trap
 		   || current_inferior->last_resume_kind == resume_step
 		   || event_child->stopped_by_watchpoint
 		   || (!step_over_finished
 		       && !bp_explains_trap && !trace_event)
-		   || gdb_breakpoint_here (event_child->stop_pc));
+		   || gdb_bp_hit);
 
   /* We found no reason GDB would want us to stop.  We either hit one
      of our own breakpoints, or finished an internal step GDB
@@ -2387,6 +2412,8 @@ Check if we're already there.\n",
 	{
 	  if (bp_explains_trap)
 	    fprintf (stderr, "Hit a gdbserver breakpoint.\n");
+	  if (gdb_breakpoint_here (event_child->stop_pc))
+	    fprintf (stderr, "GDB breakpoint handled here.\n");
 	  if (step_over_finished)
 	    fprintf (stderr, "Step-over finished.\n");
 	  if (trace_event)
@@ -3030,6 +3057,7 @@ lwp %ld wants to get out of fast tracepoint jump pad single-stepping\n",
   errno = 0;
   lwp->stopped = 0;
   lwp->stopped_by_watchpoint = 0;
+  lwp->skipped_gdb_breakpoint = 0;
   lwp->stepping = step;
   ptrace (step ? PTRACE_SINGLESTEP : PTRACE_CONT, lwpid_of (lwp), 0,
 	  /* Coerce to a uintptr_t first to avoid potential gcc warning
@@ -3053,19 +3081,149 @@ lwp %ld wants to get out of fast tracepoint jump pad single-stepping\n",
     }
 }
 
+/* An entry of a resume request index.  See thread_resume_array.  */
+
+struct resume_index_entry
+{
+  /* The process ID the resume request applies to, or -1 if it
+     applies to all processes.  */
+  int pid;
+
+  /* The index of the resume request.  */
+  int ndx;
+};
+
 struct thread_resume_array
 {
   struct thread_resume *resume;
   size_t n;
+
+  /* The resume requests, sorted by process ID and then by index, so
+     that the requests that can apply to a given thread can be found
+     without looking at all of them.  This matters when a client
+     drives many processes with one action per process.  */
+  struct resume_index_entry *index;
 };
 
+/* qsort comparison function for resume_index_entry objects.  */
+
+static int
+compare_resume_index_entries (const void *ap, const void *bp)
+{
+  const struct resume_index_entry *a = ap;
+  const struct resume_index_entry *b = bp;
+
+  if (a->pid != b->pid)
+    return a->pid < b->pid ? -1 : 1;
+  return a->ndx - b->ndx;
+}
+
+/* Build R's resume request index.  */
+
+static void
+build_resume_index (struct thread_resume_array *r)
+{
+  size_t ndx;
+
+  r->index = xmalloc (r->n * sizeof (r->index[0]));
+  for (ndx = 0; ndx < r->n; ndx++)
+    {
+      r->index[ndx].pid = ptid_get_pid (r->resume[ndx].thread);
+      r->index[ndx].ndx = ndx;
+    }
+  qsort (r->index, r->n, sizeof (r->index[0]),
+	 compare_resume_index_entries);
+}
+
+/* Return the position of the first entry of R's index for process
+   PID, or the position PID's entries would be inserted at.  */
+
+static size_t
+resume_index_lower_bound (struct thread_resume_array *r, int pid)
+{
+  size_t lo = 0, hi = r->n;
+
+  while (lo < hi)
+    {
+      size_t mid = lo + (hi - lo) / 2;
+
+      if (r->index[mid].pid < pid)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+
+  return lo;
+}
+
+/* Return true if resume request NDX of R applies to THREAD.  */
+
+static int
+resume_request_matches_p (struct thread_resume_array *r, int ndx,
+			  struct thread_info *thread)
+{
+  ptid_t ptid = r->resume[ndx].thread;
+  int pid = ptid_get_pid (thread->entry.id);
+
+  return (ptid_equal (ptid, minus_one_ptid)
+	  || ptid_equal (ptid, thread->entry.id)
+	  || (ptid_is_pid (ptid)
+	      && (ptid_get_pid (ptid) == pid))
+	  || (ptid_get_lwp (ptid) == -1
+	      && (ptid_get_pid (ptid) == pid)));
+}
+
+/* Return the index of the first resume request of R at or after FROM
+   that applies to THREAD, or -1 if there is none.  Only the requests
+   for THREAD's process and the requests for all processes are
+   considered, in request order.  */
+
+static int
+find_resume_request (struct thread_resume_array *r,
+		     struct thread_info *thread, int from)
+{
+  size_t all = resume_index_lower_bound (r, -1);
+  size_t own = resume_index_lower_bound (r,
+					 ptid_get_pid (thread->entry.id));
+
+  while (1)
+    {
+      int all_ndx = -1, own_ndx = -1, ndx;
+
+      while (all < r->n && r->index[all].pid == -1
+	     && r->index[all].ndx < from)
+	all++;
+      while (own < r->n
+	     && r->index[own].pid == ptid_get_pid (thread->entry.id)
+	     && r->index[own].ndx < from)
+	own++;
+
+      if (all < r->n && r->index[all].pid == -1)
+	all_ndx = r->index[all].ndx;
+      if (own < r->n
+	  && r->index[own].pid == ptid_get_pid (thread->entry.id))
+	own_ndx = r->index[own].ndx;
+
+      if (all_ndx == -1 && own_ndx == -1)
+	return -1;
+      else if (own_ndx == -1 || (all_ndx != -1 && all_ndx < own_ndx))
+	ndx = all_ndx;
+      else
+	ndx = own_ndx;
+
+      if (resume_request_matches_p (r, ndx, thread))
+	return ndx;
+
+      from = ndx + 1;
+    }
+}
+
 /* This function is called once per thread.  We look up the thread
    in RESUME_PTR, and mark the thread with a pointer to the appropriate
    resume request.
 
-   This algorithm is O(threads * resume elements), but resume elements
-   is small (and will remain small at least until GDB supports thread
-   suspension).  */
+   Thanks to the resume request index, this is O(log (resume elements)
+   plus the number of resume elements for this thread's process).  */
 static int
 linux_set_resume_request (struct inferior_list_entry *entry, void *arg)
 {
@@ -3078,50 +3236,43 @@ linux_set_resume_request (struct inferior_list_entry *entry, void *arg)
   lwp = get_thread_lwp (thread);
   r = arg;
 
-  for (ndx = 0; ndx < r->n; ndx++)
+  for (ndx = find_resume_request (r, thread, 0);
+       ndx != -1;
+       ndx = find_resume_request (r, thread, ndx + 1))
     {
-      ptid_t ptid = r->resume[ndx].thread;
-      if (ptid_equal (ptid, minus_one_ptid)
-	  || ptid_equal (ptid, entry->id)
-	  || (ptid_is_pid (ptid)
-	      && (ptid_get_pid (ptid) == pid_of (lwp)))
-	  || (ptid_get_lwp (ptid) == -1
-	      && (ptid_get_pid (ptid) == pid_of (lwp))))
-	{
-	  if (r->resume[ndx].kind == resume_stop
-	      && thread->last_resume_kind == resume_stop)
-	    {
-	      if (debug_threads)
-		fprintf (stderr, "already %s LWP %ld at GDB's request\n",
-			 thread->last_status.kind == TARGET_WAITKIND_STOPPED
-			 ? "stopped"
-			 : "stopping",
-			 lwpid_of (lwp));
-
-	      continue;
-	    }
-
-	  lwp->resume = &r->resume[ndx];
-	  thread->last_resume_kind = lwp->resume->kind;
-
-	  /* If we had a deferred signal to report, dequeue one now.
-	     This can happen if LWP gets more than one signal while
-	     trying to get out of a jump pad.  */
-	  if (lwp->stopped
-	      && !lwp->status_pending_p
-	      && dequeue_one_deferred_signal (lwp, &lwp->status_pending))
-	    {
-	      lwp->status_pending_p = 1;
-
-	      if (debug_threads)
-		fprintf (stderr,
-			 "Dequeueing deferred signal %d for LWP %ld, "
-			 "leaving status pending.\n",
-			 WSTOPSIG (lwp->status_pending), lwpid_of (lwp));
-	    }
-
-	  return 0;
-	}
+	if (r->resume[ndx].kind == resume_stop
+	    && thread->last_resume_kind == resume_stop)
+	  {
+	    if (debug_threads)
+	      fprintf (stderr, "already %s LWP %ld at GDB's request\n",
+		       thread->last_status.kind == TARGET_WAITKIND_STOPPED
+		       ? "stopped"
+		       : "stopping",
+		       lwpid_of (lwp));
+
+	    continue;
+	  }
+
+	lwp->resume = &r->resume[ndx];
+	thread->last_resume_kind = lwp->resume->kind;
+
+	/* If we had a deferred signal to report, dequeue one now.
+	   This can happen if LWP gets more than one signal while
+	   trying to get out of a jump pad.  */
+	if (lwp->stopped
+	    && !lwp->status_pending_p
+	    && dequeue_one_deferred_signal (lwp, &lwp->status_pending))
+	  {
+	    lwp->status_pending_p = 1;
+
+	    if (debug_threads)
+	      fprintf (stderr,
+		       "Dequeueing deferred signal %d for LWP %ld, "
+		       "leaving status pending.\n",
+		       WSTOPSIG (lwp->status_pending), lwpid_of (lwp));
+	  }
+
+	return 0;
     }
 
   /* No resume action for this thread.  */
@@ -3239,8 +3390,13 @@ need_step_over_p (struct inferior_list_entry *entry, void *dummy)
   if (breakpoint_here (pc) || fast_tracepoint_jump_here (pc))
     {
       /* Don't step over a breakpoint that GDB expects to hit
-	 though.  */
-      if (gdb_breakpoint_here (pc))
+	 though.  If its conditions are false, we run its commands
+	 ourselves, or we skipped this hit, GDB doesn't expect to hit
+	 it, so step over it as well.  */
+      if (gdb_breakpoint_here (pc)
+	  && !lwp->skipped_gdb_breakpoint
+	  && gdb_condition_true_at_breakpoint (pc)
+	  && gdb_no_commands_at_breakpoint (pc))
 	{
 	  if (debug_threads)
 	    fprintf (stderr,
@@ -3514,7 +3670,10 @@ linux_resume (struct thread_resume *resume_info, size_t n)
   int any_pending;
   int leave_all_stopped;
 
+  build_resume_index (&array);
   find_inferior (&all_threads, linux_set_resume_request, &array);
+  free (array.index);
+  array.index = NULL;
 
   /* If there is a thread which would otherwise be resumed, which has
      a pending status, then don't resume any threads - we can just
@@ -4694,6 +4853,17 @@ linux_supports_disable_randomization (void)
 #endif
 }
 
+/* Coverage points are internal breakpoints whose hits we don't
+   report; we need to be able to resume from them.  */
+
+static int
+linux_supports_coverage_points (void)
+{
+  return (supports_breakpoints ()
+	  && the_low_target.set_pc != NULL
+	  && the_low_target.breakpoint_at != NULL);
+}
+
 /* Enumerate spufs IDs for process PID.  */
 static int
 spu_enumerate_spu_ids (long pid, unsigned char *buf, CORE_ADDR offset, int len)
@@ -5416,6 +5586,7 @@ static struct target_ops linux_target_ops = {
   linux_supports_disable_randomization,
   linux_get_min_fast_tracepoint_insn_len,
   linux_qxfer_libraries_svr4,
+  linux_supports_coverage_points,
 };
 
 static void
@@ -252,6 +252,11 @@ struct lwp_info
      stepping over later when it is resumed.  */
   int need_step_over;
 
+  /* True if the LWP stopped at a GDB breakpoint whose hit we skipped
+     because of its ignore count, so that it needs stepping over like
+     an internal breakpoint.  */
+  int skipped_gdb_breakpoint;
+
   int thread_known;
 #ifdef HAVE_THREAD_DB_H
   /* The thread handle, used for e.g. TLS access.  Only valid if
@@ -85,6 +85,29 @@ enum bkpt_type
     other_breakpoint,
   };
 
+/* A condition GDB downloaded along with a GDB breakpoint.  */
+struct point_cond_list
+{
+  /* The condition, as an agent expression.  */
+  struct agent_expr *cond;
+
+  struct point_cond_list *next;
+};
+
+/* A command GDB downloaded along with a GDB breakpoint, to run each
+   time the breakpoint is hit.  */
+struct point_command_list
+{
+  /* The command, as an agent expression.  */
+  struct agent_expr *cmd;
+
+  /* Whether GDB asked for the command to keep running after it
+     disconnects.  */
+  int persistence;
+
+  struct point_command_list *next;
+};
+
 /* A high level (in gdbserver's perspective) breakpoint.  */
 struct breakpoint
 {
@@ -93,6 +116,22 @@ struct breakpoint
   /* The breakpoint's type.  */
   enum bkpt_type type;
 
+  /* For GDB breakpoints, the conditions GDB wants evaluated on the
+     target side.  A hit is only reported to GDB if one of them is
+     true; an empty list means the breakpoint is unconditional.  */
+  struct point_cond_list *cond_list;
+
+  /* For GDB breakpoints, the commands GDB wants run on the target
+     side when the breakpoint is hit, in order.  A breakpoint with
+     commands is not reported to GDB.  */
+  struct point_command_list *command_list;
+
+  /* For GDB breakpoints, the number of hits GDB wants skipped before
+     one is reported, and the number skipped since GDB last asked.
+     Only hits that would otherwise be reported count.  */
+  int ignore_count;
+  int ignored_hits;
+
   /* Link to this breakpoint's raw breakpoint.  This is always
      non-NULL.  */
   struct raw_breakpoint *raw;
@@ -571,6 +610,40 @@ delete_raw_breakpoint (struct process_info *proc, struct raw_breakpoint *todel)
   return ENOENT;
 }
 
+/* Release the target-side conditions of breakpoint BP.  */
+
+static void
+clear_breakpoint_conditions (struct breakpoint *bp)
+{
+  struct point_cond_list *cond, *next;
+
+  for (cond = bp->cond_list; cond != NULL; cond = next)
+    {
+      next = cond->next;
+      free_agent_expr (cond->cond);
+      free (cond);
+    }
+
+  bp->cond_list = NULL;
+}
+
+/* Release the target-side commands of breakpoint BP.  */
+
+static void
+clear_breakpoint_commands (struct breakpoint *bp)
+{
+  struct point_command_list *cmd, *next;
+
+  for (cmd = bp->command_list; cmd != NULL; cmd = next)
+    {
+      next = cmd->next;
+      free_agent_expr (cmd->cmd);
+      free (cmd);
+    }
+
+  bp->command_list = NULL;
+}
+
 static int
 release_breakpoint (struct process_info *proc, struct breakpoint *bp)
 {
@@ -587,6 +660,8 @@ release_breakpoint (struct process_info *proc, struct breakpoint *bp)
   else
     bp->raw->refcount = newrefcount;
 
+  clear_breakpoint_conditions (bp);
+  clear_breakpoint_commands (bp);
   free (bp);
 
   return 0;
@@ -707,6 +782,163 @@ gdb_breakpoint_here (CORE_ADDR where)
   return (bp != NULL);
 }
 
+void
+clear_gdb_breakpoint_conditions (CORE_ADDR addr)
+{
+  struct breakpoint *bp = find_gdb_breakpoint_at (addr);
+
+  if (bp != NULL)
+    clear_breakpoint_conditions (bp);
+}
+
+int
+add_breakpoint_condition (CORE_ADDR addr, char **condition)
+{
+  struct breakpoint *bp = find_gdb_breakpoint_at (addr);
+  struct point_cond_list *new_cond;
+  char *p = *condition;
+  ULONGEST len;
+
+  if (bp == NULL || *p != 'X')
+    return 0;
+
+  /* Make sure the whole expression is there before handing it to
+     parse_agent_expr, which trusts its length.  */
+  p = unpack_varlen_hex (p + 1, &len);
+  if (*p != ',' || strlen (p + 1) < 2 * len)
+    return 0;
+
+  new_cond = xmalloc (sizeof (*new_cond));
+  new_cond->cond = parse_agent_expr (condition);
+  new_cond->next = bp->cond_list;
+  bp->cond_list = new_cond;
+
+  return 1;
+}
+
+int
+gdb_condition_true_at_breakpoint (CORE_ADDR where)
+{
+  struct breakpoint *bp = find_gdb_breakpoint_at (where);
+  struct point_cond_list *cond;
+  struct regcache *regcache;
+
+  if (bp == NULL || bp->cond_list == NULL)
+    return 1;
+
+  regcache = get_thread_regcache (current_inferior, 1);
+  for (cond = bp->cond_list; cond != NULL; cond = cond->next)
+    if (breakpoint_condition_true (cond->cond, regcache))
+      return 1;
+
+  return 0;
+}
+
+void
+clear_gdb_breakpoint_commands (CORE_ADDR addr)
+{
+  struct breakpoint *bp = find_gdb_breakpoint_at (addr);
+
+  if (bp != NULL)
+    clear_breakpoint_commands (bp);
+}
+
+int
+add_breakpoint_commands (CORE_ADDR addr, char **command, int persist)
+{
+  struct breakpoint *bp = find_gdb_breakpoint_at (addr);
+  struct point_command_list *new_cmd, **tail;
+  char *p = *command;
+  ULONGEST len;
+
+  if (bp == NULL || *p != 'X')
+    return 0;
+
+  p = unpack_varlen_hex (p + 1, &len);
+  if (*p != ',' || strlen (p + 1) < 2 * len)
+    return 0;
+
+  new_cmd = xmalloc (sizeof (*new_cmd));
+  new_cmd->cmd = parse_agent_expr (command);
+  new_cmd->persistence = persist;
+  new_cmd->next = NULL;
+
+  /* Keep the commands in the order GDB sent them.  */
+  for (tail = &bp->command_list; *tail != NULL; tail = &(*tail)->next)
+    ;
+  *tail = new_cmd;
+
+  return 1;
+}
+
+int
+gdb_no_commands_at_breakpoint (CORE_ADDR where)
+{
+  struct breakpoint *bp = find_gdb_breakpoint_at (where);
+
+  return (bp == NULL || bp->command_list == NULL);
+}
+
+void
+set_gdb_breakpoint_ignore_count (CORE_ADDR addr, int count)
+{
+  struct breakpoint *bp = find_gdb_breakpoint_at (addr);
+
+  if (bp != NULL)
+    {
+      bp->ignore_count = count;
+      bp->ignored_hits = 0;
+    }
+}
+
+int
+gdb_breakpoint_hit_ignored (CORE_ADDR where)
+{
+  struct breakpoint *bp = find_gdb_breakpoint_at (where);
+
+  if (bp == NULL || bp->ignore_count == 0)
+    return 0;
+
+  bp->ignore_count--;
+  bp->ignored_hits++;
+  return 1;
+}
+
+int
+take_gdb_breakpoint_ignored_hits (CORE_ADDR addr)
+{
+  struct breakpoint *bp = find_gdb_breakpoint_at (addr);
+  int ignored;
+
+  if (bp == NULL)
+    return -1;
+
+  ignored = bp->ignored_hits;
+  bp->ignore_count = 0;
+  bp->ignored_hits = 0;
+  return ignored;
+}
+
+void
+run_breakpoint_commands (CORE_ADDR where)
+{
+  struct breakpoint *bp = find_gdb_breakpoint_at (where);
+  struct point_command_list *cmd;
+  struct regcache *regcache;
+
+  if (bp == NULL || bp->command_list == NULL)
+    return;
+
+  regcache = get_thread_regcache (current_inferior, 1);
+  for (cmd = bp->command_list; cmd != NULL; cmd = cmd->next)
+    {
+      /* An error stops the remaining commands, as it would in
+	 GDB.  */
+      if (run_breakpoint_command (cmd->cmd, regcache) != 0)
+	break;
+    }
+}
+
 void
 set_reinsert_breakpoint (CORE_ADDR stop_at)
 {
@@ -1159,6 +1391,215 @@ mark_breakpoints_out (struct process_info *proc)
     raw_bp->inserted = 0;
 }
 
+/* Coverage points are one-shot internal breakpoints planted at GDB's
+   request.  The first hit of each one removes it, and records the hit
+   in a bitmap GDB can fetch, instead of being reported.  The points
+   and their hits belong to one process at a time; the hits are kept
+   after the process exits, until the points are cleared.  */
+
+struct coverage_point
+{
+  CORE_ADDR pc;
+
+  /* The index of the point in the order GDB planted them, which is
+     also its bit in COVERAGE_HITS.  */
+  int index;
+};
+
+/* The coverage points planted since the last clear_coverage_points,
+   and the process they were planted in.  */
+static struct coverage_point *coverage_points;
+static int coverage_count;
+static int coverage_alloc;
+static int coverage_pid;
+
+/* Whether COVERAGE_POINTS is sorted by address.  Points are appended
+   in the order they are planted, and sorted on the first hit
+   after.  */
+static int coverage_sorted;
+
+/* The hit bitmap: bit I, counting from the least significant bit of
+   the first byte, is set if the point with index I was hit.  */
+static unsigned char *coverage_hits;
+
+static int
+coverage_point_compare (const void *ap, const void *bp)
+{
+  const struct coverage_point *a = ap;
+  const struct coverage_point *b = bp;
+
+  if (a->pc != b->pc)
+    return a->pc < b->pc ? -1 : 1;
+  return a->index - b->index;
+}
+
+/* Return the index in COVERAGE_POINTS of the first point at WHERE, or
+   -1 if there's none.  */
+
+static int
+find_coverage_point (CORE_ADDR where)
+{
+  int lo = 0, hi = coverage_count;
+
+  if (!coverage_sorted)
+    {
+      qsort (coverage_points, coverage_count,
+	     sizeof (struct coverage_point), coverage_point_compare);
+      coverage_sorted = 1;
+    }
+
+  while (lo < hi)
+    {
+      int mid = lo + (hi - lo) / 2;
+
+      if (coverage_points[mid].pc < where)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+
+  if (lo < coverage_count && coverage_points[lo].pc == where)
+    return lo;
+  return -1;
+}
+
+/* The handler of coverage point breakpoints: record the hit of all
+   the points at STOP_PC, and have the breakpoint deleted.  */
+
+static int
+coverage_point_hit (CORE_ADDR stop_pc)
+{
+  int i = find_coverage_point (stop_pc);
+
+  for (; i >= 0 && i < coverage_count && coverage_points[i].pc == stop_pc;
+       i++)
+    {
+      int index = coverage_points[i].index;
+
+      coverage_hits[index / 8] |= 1 << (index % 8);
+    }
+
+  return 1;
+}
+
+int
+insert_coverage_point (CORE_ADDR where)
+{
+  struct process_info *proc = current_process ();
+
+  if (ptid_get_pid (proc->head.id) != coverage_pid)
+    {
+      clear_coverage_points ();
+      coverage_pid = ptid_get_pid (proc->head.id);
+    }
+
+  if (set_breakpoint_at (where, coverage_point_hit) == NULL)
+    return -1;
+
+  if (coverage_count == coverage_alloc)
+    {
+      int old_bytes = (coverage_alloc + 7) / 8;
+
+      coverage_alloc = coverage_alloc ? coverage_alloc * 2 : 256;
+      coverage_points = xrealloc (coverage_points,
+				  (coverage_alloc
+				   * sizeof (struct coverage_point)));
+      coverage_hits = xrealloc (coverage_hits, (coverage_alloc + 7) / 8);
+      memset (coverage_hits + old_bytes, 0,
+	      (coverage_alloc + 7) / 8 - old_bytes);
+    }
+
+  coverage_points[coverage_count].pc = where;
+  coverage_points[coverage_count].index = coverage_count;
+  coverage_count++;
+  coverage_sorted = 0;
+  return 0;
+}
+
+/* Callback for find_inferior.  Returns true if ENTRY is a thread of
+   the process whose pid is *PID_P.  */
+
+static int
+thread_of_pid_p (struct inferior_list_entry *entry, void *pid_p)
+{
+  return ptid_get_pid (entry->id) == *(int *) pid_p;
+}
+
+void
+clear_coverage_points (void)
+{
+  struct process_info *proc = find_process_pid (coverage_pid);
+  struct thread_info *thread = NULL;
+
+  if (proc != NULL)
+    thread = (struct thread_info *) find_inferior (&all_threads,
+						   thread_of_pid_p,
+						   &coverage_pid);
+
+  /* Remove the points that weren't hit, from the process they were
+     planted in.  */
+  if (thread != NULL)
+    {
+      struct thread_info *saved_inferior = current_inferior;
+      struct breakpoint *bp, **bp_link;
+
+      current_inferior = thread;
+
+      bp_link = &proc->breakpoints;
+      while ((bp = *bp_link) != NULL)
+	{
+	  if (bp->handler == coverage_point_hit)
+	    {
+	      *bp_link = bp->next;
+	      release_breakpoint (proc, bp);
+	    }
+	  else
+	    bp_link = &bp->next;
+	}
+
+      current_inferior = saved_inferior;
+    }
+
+  xfree (coverage_points);
+  xfree (coverage_hits);
+  coverage_points = NULL;
+  coverage_hits = NULL;
+  coverage_count = coverage_alloc = 0;
+  coverage_pid = 0;
+}
+
+int
+coverage_point_hit_at (CORE_ADDR where)
+{
+  int i;
+
+  if (coverage_count == 0
+      || ptid_get_pid (current_process ()->head.id) != coverage_pid)
+    return 0;
+
+  i = find_coverage_point (where);
+  if (i < 0)
+    return 0;
+
+  i = coverage_points[i].index;
+  return (coverage_hits[i / 8] & (1 << (i % 8))) != 0;
+}
+
+int
+read_coverage_hits (unsigned char *buf, CORE_ADDR offset, int len)
+{
+  int size = (coverage_count + 7) / 8;
+
+  if (offset >= size)
+    return 0;
+
+  if (len > size - offset)
+    len = size - offset;
+
+  memcpy (buf, coverage_hits + offset, len);
+  return len;
+}
+
 /* Release all breakpoints, but do not try to un-insert them from the
    inferior.  */
 
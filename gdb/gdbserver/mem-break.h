@@ -43,6 +43,61 @@ int breakpoint_inserted_here (CORE_ADDR addr);
 
 int gdb_breakpoint_here (CORE_ADDR where);
 
+/* Drop the target-side conditions of the GDB breakpoint at ADDR.  */
+
+void clear_gdb_breakpoint_conditions (CORE_ADDR addr);
+
+/* Add a target-side condition, in the "X<len>,<bytes>" agent
+   expression form of Z packets, to the GDB breakpoint at ADDR.
+   CONDITION is advanced past the parsed expression.  Returns false if
+   there is no GDB breakpoint at ADDR or the expression is
+   malformed.  */
+
+int add_breakpoint_condition (CORE_ADDR addr, char **condition);
+
+/* Returns TRUE if the GDB breakpoint at WHERE has no target-side
+   conditions, or if one of them holds for the current inferior.  */
+
+int gdb_condition_true_at_breakpoint (CORE_ADDR where);
+
+/* Drop the target-side commands of the GDB breakpoint at ADDR.  */
+
+void clear_gdb_breakpoint_commands (CORE_ADDR addr);
+
+/* Add a target-side command, in the "X<len>,<bytes>" agent expression
+   form, to the GDB breakpoint at ADDR.  PERSIST is nonzero if GDB
+   wants the command to outlive its connection.  COMMAND is advanced
+   past the parsed expression.  Returns false if there is no GDB
+   breakpoint at ADDR or the expression is malformed.  */
+
+int add_breakpoint_commands (CORE_ADDR addr, char **command, int persist);
+
+/* Returns TRUE if the GDB breakpoint at WHERE has no target-side
+   commands, and so must be reported to GDB when hit.  */
+
+int gdb_no_commands_at_breakpoint (CORE_ADDR where);
+
+/* Run the target-side commands of the GDB breakpoint at WHERE for the
+   current inferior.  */
+
+void run_breakpoint_commands (CORE_ADDR where);
+
+/* Make the GDB breakpoint at ADDR skip its next COUNT hits instead of
+   reporting them.  */
+
+void set_gdb_breakpoint_ignore_count (CORE_ADDR addr, int count);
+
+/* Returns TRUE if the GDB breakpoint at WHERE has hits left to skip,
+   counting the current hit as skipped.  */
+
+int gdb_breakpoint_hit_ignored (CORE_ADDR where);
+
+/* Return the number of hits the GDB breakpoint at ADDR skipped since
+   the last call, and skip no more.  Returns -1 if there is no GDB
+   breakpoint at ADDR.  */
+
+int take_gdb_breakpoint_ignored_hits (CORE_ADDR addr);
+
 /* Create a new breakpoint at WHERE, and call HANDLER when
    it is hit.  HANDLER should return 1 if the breakpoint
    should be deleted, 0 otherwise.  */
@@ -125,6 +180,33 @@ void mark_breakpoints_out (struct process_info *proc);
 
 void free_all_breakpoints (struct process_info *proc);
 
+/* Plant a coverage point at WHERE in the current process: a
+   breakpoint that deletes itself the first time it is hit, and records
+   the hit instead of having it reported to GDB.  Points planted in
+   another process before are cleared first.  Returns 0 on success.  */
+
+int insert_coverage_point (CORE_ADDR where);
+
+/* Remove the coverage points that weren't hit, and forget the
+   hits.  */
+
+void clear_coverage_points (void);
+
+/* Returns TRUE if there's a coverage point at WHERE in the current
+   process that has already been hit.  A SIGTRAP at WHERE then comes
+   from a thread that hit the point before another thread removed
+   it.  */
+
+int coverage_point_hit_at (CORE_ADDR where);
+
+/* Copy up to LEN bytes of the coverage point hit bitmap, from byte
+   OFFSET, to BUF.  Bit I (counting from the least significant bit of
+   the first byte) is set if the I'th coverage point planted since
+   they were last cleared was hit.  Returns the number of bytes
+   copied.  */
+
+int read_coverage_hits (unsigned char *buf, CORE_ADDR offset, int len);
+
 /* Check if breakpoints still seem to be inserted in the inferior.  */
 
 void validate_breakpoints (void);
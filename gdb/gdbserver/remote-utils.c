@@ -19,6 +19,7 @@
 #include "server.h"
 #include "terminal.h"
 #include "target.h"
+#include "capture.h"
 #include <stdio.h>
 #include <string.h>
 #if HAVE_SYS_IOCTL_H
@@ -122,6 +123,202 @@ int transport_is_reliable = 0;
 # define write(fd, buf, len) send (fd, (char *) buf, len, 0)
 #endif
 
+/* The binary capture of the connection with GDB, if one was
+   requested with --capture.  See capture.h for the format.  */
+static FILE *capture_file;
+
+/* When the capture was started.  Record times are relative to
+   this.  */
+static struct timeval capture_start;
+
+/* The number of records written so far, and the file offset the next
+   one will be written at.  */
+static ULONGEST capture_num_records;
+static ULONGEST capture_offset;
+
+/* The offsets of every CAPTURE_INDEX_INTERVAL'th record.  */
+static ULONGEST *capture_index;
+static size_t capture_index_size;
+
+/* The bytes input_interrupt read from GDB and not recorded yet.  It
+   runs in the SIGIO handler, where writing the capture is not safe,
+   so it only stores them here, and capture_flush_interrupts records
+   them from the main line code.  */
+static char capture_interrupt_buf[16];
+static volatile sig_atomic_t capture_interrupt_count;
+
+static void capture_record (int kind, const void *buf, int len);
+
+/* Store VAL in the LEN bytes at BUF, little endian.  */
+
+static void
+capture_store (unsigned char *buf, ULONGEST val, int len)
+{
+  int i;
+
+  for (i = 0; i < len; i++)
+    {
+      buf[i] = val & 0xff;
+      val >>= 8;
+    }
+}
+
+/* Write the LEN bytes at BUF to the capture file.  If that fails, stop
+   capturing.  */
+
+static void
+capture_write (const void *buf, size_t len)
+{
+  if (capture_file == NULL)
+    return;
+
+  if (fwrite (buf, 1, len, capture_file) != len)
+    {
+      perror ("capture");
+      fclose (capture_file);
+      capture_file = NULL;
+      return;
+    }
+
+  capture_offset += len;
+}
+
+/* Start capturing the connection with GDB to file NAME.  Return 0 on
+   success, -1 on failure.  */
+
+int
+capture_open (const char *name)
+{
+  unsigned char header[CAPTURE_HEADER_LEN];
+
+  capture_file = fopen (name, "wb");
+  if (capture_file == NULL)
+    return -1;
+
+  gettimeofday (&capture_start, NULL);
+  memcpy (header, CAPTURE_MAGIC, CAPTURE_MAGIC_LEN);
+  capture_store (header + CAPTURE_MAGIC_LEN,
+		 (ULONGEST) capture_start.tv_sec * 1000000
+		 + capture_start.tv_usec, 8);
+  capture_write (header, sizeof (header));
+
+  /* Write the index even if we exit without closing the
+     connection.  */
+  atexit (capture_close);
+  return capture_file != NULL ? 0 : -1;
+}
+
+/* Record the bytes input_interrupt stored, if any.  SIGIO is blocked
+   meanwhile, so that the handler can't store more while they are
+   taken.  */
+
+static void
+capture_flush_interrupts (void)
+{
+  char buf[sizeof (capture_interrupt_buf)];
+  int len;
+#ifndef USE_WIN32API
+  sigset_t sigio_set, old_set;
+#endif
+
+  if (capture_interrupt_count == 0)
+    return;
+
+#ifndef USE_WIN32API
+  sigemptyset (&sigio_set);
+  sigaddset (&sigio_set, SIGIO);
+  sigprocmask (SIG_BLOCK, &sigio_set, &old_set);
+#endif
+  len = capture_interrupt_count;
+  memcpy (buf, capture_interrupt_buf, len);
+  capture_interrupt_count = 0;
+#ifndef USE_WIN32API
+  sigprocmask (SIG_SETMASK, &old_set, NULL);
+#endif
+
+  capture_record (CAPTURE_FROM_GDB, buf, len);
+}
+
+/* Record LEN bytes of data at BUF, going in direction KIND.  */
+
+static void
+capture_record (int kind, const void *buf, int len)
+{
+  unsigned char header[CAPTURE_RECORD_HEADER_LEN];
+  struct timeval now;
+  LONGEST usec;
+
+  if (capture_file == NULL || len <= 0)
+    return;
+
+  /* The bytes read by the SIGIO handler came first.  */
+  capture_flush_interrupts ();
+
+  gettimeofday (&now, NULL);
+  usec = ((LONGEST) (now.tv_sec - capture_start.tv_sec) * 1000000
+	  + (now.tv_usec - capture_start.tv_usec));
+
+  if (capture_num_records % CAPTURE_INDEX_INTERVAL == 0)
+    {
+      size_t n = capture_num_records / CAPTURE_INDEX_INTERVAL;
+
+      if (n == capture_index_size)
+	{
+	  capture_index_size = capture_index_size ? capture_index_size * 2 : 64;
+	  capture_index = xrealloc (capture_index,
+				    capture_index_size
+				    * sizeof (capture_index[0]));
+	}
+      capture_index[n] = capture_offset;
+    }
+
+  header[0] = kind;
+  capture_store (header + 1, len, 4);
+  capture_store (header + 5, usec, 8);
+  capture_write (header, sizeof (header));
+  capture_write (buf, len);
+  capture_num_records++;
+}
+
+/* Finish the capture, if there is one: write the record index and the
+   trailer, and close the file.  */
+
+void
+capture_close (void)
+{
+  unsigned char buf[CAPTURE_TRAILER_LEN];
+  ULONGEST index_offset = capture_offset;
+  size_t i, n;
+
+  if (capture_file == NULL)
+    return;
+
+  capture_flush_interrupts ();
+
+  n = ((capture_num_records + CAPTURE_INDEX_INTERVAL - 1)
+       / CAPTURE_INDEX_INTERVAL);
+  for (i = 0; i < n; i++)
+    {
+      capture_store (buf, capture_index[i], 8);
+      capture_write (buf, 8);
+    }
+
+  capture_store (buf, index_offset, 8);
+  capture_store (buf + 8, capture_num_records, 8);
+  memcpy (buf + 16, CAPTURE_TRAILER_MAGIC, CAPTURE_MAGIC_LEN);
+  capture_write (buf, sizeof (buf));
+
+  if (capture_file != NULL)
+    {
+      fclose (capture_file);
+      capture_file = NULL;
+    }
+
+  free (capture_index);
+  capture_index = NULL;
+  capture_index_size = 0;
+}
+
 int
 gdb_connected (void)
 {
@@ -191,8 +388,9 @@ handle_accept_event (int err, gdb_client_data client_data)
 
   enable_async_notification (remote_desc);
 
-  /* Register the event loop handler.  */
-  add_file_handler (remote_desc, handle_serial_event, NULL);
+  /* Register the event loop handler.  We only need to hear about new
+     data on the socket; readchar takes care of draining it.  */
+  add_edge_file_handler (remote_desc, handle_serial_event, NULL);
 
   /* We have a new GDB connection now.  If we were disconnected
      tracing, there's a window where the target could report a stop
@@ -375,6 +573,10 @@ remote_close (void)
   remote_desc = INVALID_DESCRIPTOR;
 
   reset_readchar ();
+
+  /* A capture only holds one connection, which is why --capture
+     requires --once.  */
+  capture_close ();
 }
 
 /* Convert hex digit A to a number.  */
@@ -772,6 +974,7 @@ putpkt_binary_1 (char *buf, int cnt, int is_notif)
 	  free (buf2);
 	  return -1;
 	}
+      capture_record (CAPTURE_TO_GDB, buf2, p - buf2);
 
       if (noack_mode || is_notif)
 	{
@@ -863,6 +1066,15 @@ input_interrupt (int unused)
 
       cc = read (remote_desc, &c, 1);
 
+      /* Writing the capture is not safe in a signal handler; leave
+	 the byte to capture_flush_interrupts.  */
+      if (cc == 1
+	  && capture_interrupt_count < sizeof (capture_interrupt_buf))
+	{
+	  capture_interrupt_buf[capture_interrupt_count] = c;
+	  capture_interrupt_count++;
+	}
+
       if (cc != 1 || c != '\003' || current_inferior == NULL)
 	{
 	  fprintf (stderr, "input_interrupt, count = %d c = %d ('%c')\n",
@@ -980,6 +1192,12 @@ static unsigned char readchar_buf[BUFSIZ];
 static int readchar_bufcnt = 0;
 static unsigned char *readchar_bufp;
 
+/* Nonzero if the last read filled READCHAR_BUF completely, in which
+   case more input may be waiting in the kernel.  The remote socket is
+   registered edge-triggered, so the event loop won't tell us about
+   it.  */
+static int readchar_maybe_pending;
+
 /* Returns next char from remote GDB.  -1 if error.  */
 
 static int
@@ -1002,7 +1220,10 @@ readchar (void)
 	  return -1;
 	}
 
+      capture_record (CAPTURE_FROM_GDB, readchar_buf, readchar_bufcnt);
+
       readchar_bufp = readchar_buf;
+      readchar_maybe_pending = (readchar_bufcnt == sizeof (readchar_buf));
     }
 
   readchar_bufcnt--;
@@ -1017,6 +1238,7 @@ static void
 reset_readchar (void)
 {
   readchar_bufcnt = 0;
+  readchar_maybe_pending = 0;
   if (readchar_callback != NOT_SCHEDULED)
     {
       delete_callback_event (readchar_callback);
@@ -1024,6 +1246,27 @@ reset_readchar (void)
     }
 }
 
+/* Return nonzero if input is waiting to be read from REMOTE_DESC.  */
+
+static int
+readchar_input_pending (void)
+{
+#ifdef USE_WIN32API
+  u_long avail = 0;
+
+  if (ioctlsocket (remote_desc, FIONREAD, &avail) == 0)
+    return avail > 0;
+#elif defined (FIONREAD)
+  int avail = 0;
+
+  if (ioctl (remote_desc, FIONREAD, &avail) == 0)
+    return avail > 0;
+#endif
+  /* We can't tell.  Hosts without FIONREAD wait with select, which
+     will report the descriptor as readable again anyway.  */
+  return 0;
+}
+
 /* Process remaining data in readchar_buf.  */
 
 static int
@@ -1036,19 +1279,28 @@ process_remaining (void *context)
 
   if (readchar_bufcnt > 0)
     res = handle_serial_event (0, NULL);
+  else if (readchar_maybe_pending)
+    {
+      readchar_maybe_pending = 0;
+      if (readchar_input_pending ())
+	res = handle_serial_event (0, NULL);
+      else
+	res = 0;
+    }
   else
     res = 0;
 
   return res;
 }
 
-/* If there is still data in the buffer, queue another event to process it,
-   we can't sleep in select yet.  */
+/* If there is still data in the buffer, or possibly in the kernel,
+   queue another event to process it, we can't sleep in select yet.  */
 
 static void
 reschedule (void)
 {
-  if (readchar_bufcnt > 0 && readchar_callback == NOT_SCHEDULED)
+  if ((readchar_bufcnt > 0 || readchar_maybe_pending)
+      && readchar_callback == NOT_SCHEDULED)
     readchar_callback = append_callback_event (process_remaining, NULL);
 }
 
@@ -1114,6 +1366,7 @@ getpkt (char *buf)
 	       (c1 << 4) + c2, csum, buf);
       if (write (remote_desc, "-", 1) != 1)
 	return -1;
+      capture_record (CAPTURE_TO_GDB, "-", 1);
     }
 
   if (!noack_mode)
@@ -1126,6 +1379,7 @@ getpkt (char *buf)
 
       if (write (remote_desc, "+", 1) != 1)
 	return -1;
+      capture_record (CAPTURE_TO_GDB, "+", 1);
 
       if (remote_debug)
 	{
@@ -1524,13 +1778,12 @@ look_up_one_symbol (const char *name, CORE_ADDR *addrp, int may_ask_gdb)
 {
   char own_buf[266], *p, *q;
   int len;
-  struct sym_cache *sym;
-  struct process_info *proc;
+  struct sym_cache *sym, **symcache_p;
 
-  proc = current_process ();
+  symcache_p = process_symbol_cache (current_process ());
 
   /* Check the cache first.  */
-  for (sym = proc->symbol_cache; sym; sym = sym->next)
+  for (sym = *symcache_p; sym; sym = sym->next)
     if (strcmp (name, sym->name) == 0)
       {
 	*addrp = sym->addr;
@@ -1599,8 +1852,8 @@ look_up_one_symbol (const char *name, CORE_ADDR *addrp, int may_ask_gdb)
   sym = xmalloc (sizeof (*sym));
   sym->name = xstrdup (name);
   sym->addr = *addrp;
-  sym->next = proc->symbol_cache;
-  proc->symbol_cache = sym;
+  sym->next = *symcache_p;
+  *symcache_p = sym;
 
   return 1;
 }
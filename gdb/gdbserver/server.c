@@ -267,6 +267,17 @@ start_inferior (char **argv)
 	   signal_pid);
   fflush (stderr);
 
+  /* Processes started from the same executable without address space
+     randomization have the same memory layout, so they can share
+     symbol lookups.  */
+  if (disable_randomization && target_supports_disable_randomization ())
+    {
+      struct process_info *proc = find_process_pid (signal_pid);
+
+      if (proc != NULL)
+	share_exec_cache (proc, argv[0]);
+    }
+
 #ifdef SIGTTOU
   signal (SIGTTOU, SIG_IGN);
   signal (SIGTTIN, SIG_IGN);
@@ -578,6 +589,10 @@ monitor_show_help (void)
   monitor_output ("    Enable h/w breakpoint/watchpoint debugging messages\n");
   monitor_output ("  set remote-debug <0|1>\n");
   monitor_output ("    Enable remote protocol debugging messages\n");
+  monitor_output ("  show event-loop-stats\n");
+  monitor_output ("    Show event loop wakeups and events per second\n");
+  monitor_output ("  reset event-loop-stats\n");
+  monitor_output ("    Reset the event loop statistics\n");
   monitor_output ("  exit\n");
   monitor_output ("    Quit GDBserver\n");
 }
@@ -797,6 +812,63 @@ handle_search_memory (char *own_buf, int packet_len)
   free (pattern);
 }
 
+/* Handle qThreadRegs packets, which ask for the registers of several
+   threads at once: qThreadRegs:ID[;ID]...  The reply holds, in the
+   same order and separated by semicolons, what a 'g' packet would
+   return for each thread, or an error for a thread that does not
+   exist or is running.  */
+
+static void
+handle_thread_regs (char *own_buf)
+{
+  char *p = own_buf + sizeof ("qThreadRegs:") - 1;
+  char *reply, *out;
+  int size = register_cache_size ();
+
+  /* Build the reply in a separate buffer, since the thread ids are
+     parsed from OWN_BUF.  */
+  reply = xmalloc (PBUFSIZ);
+  out = reply;
+
+  while (*p != '\0')
+    {
+      ptid_t thread_id = gdb_id_to_thread_id (read_ptid (p, &p));
+      struct thread_info *thread = NULL;
+
+      if (*p == ';')
+	p++;
+
+      if (out + 2 * size + 2 > reply + PBUFSIZ)
+	{
+	  /* The reply would not fit; GDB should have asked for fewer
+	     threads.  */
+	  free (reply);
+	  write_enn (own_buf);
+	  return;
+	}
+
+      if (out != reply)
+	*out++ = ';';
+
+      if (!ptid_equal (thread_id, null_ptid))
+	thread = find_thread_ptid (thread_id);
+      if (thread == NULL
+	  || (the_target->thread_stopped != NULL && !thread_stopped (thread)))
+	{
+	  write_enn (out);
+	  out += strlen (out);
+	  continue;
+	}
+
+      registers_to_string (get_thread_regcache (thread, 1), out);
+      out += strlen (out);
+    }
+
+  *out = '\0';
+  strcpy (own_buf, reply);
+  free (reply);
+}
+
 #define require_running(BUF)			\
   if (!target_running ())			\
     {						\
@@ -839,6 +911,13 @@ handle_monitor_command (char *mon)
       remote_debug = 0;
       monitor_output ("Protocol debug output disabled.\n");
     }
+  else if (strcmp (mon, "show event-loop-stats") == 0)
+    show_event_loop_stats ();
+  else if (strcmp (mon, "reset event-loop-stats") == 0)
+    {
+      reset_event_loop_stats ();
+      monitor_output ("Event loop statistics reset.\n");
+    }
   else if (strcmp (mon, "help") == 0)
     monitor_show_help ();
   else if (strcmp (mon, "exit") == 0)
@@ -1230,9 +1309,26 @@ handle_qxfer_fdpic (const char *annex, gdb_byte *readbuf,
   return (*the_target->read_loadmap) (annex, offset, readbuf, len);
 }
 
+/* Handle qXfer:coverage:read.  */
+
+static int
+handle_qxfer_coverage (const char *annex, gdb_byte *readbuf,
+		       const gdb_byte *writebuf, ULONGEST offset, LONGEST len)
+{
+  if (writebuf != NULL || !target_supports_coverage_points ())
+    return -2;
+
+  if (annex[0] != '\0')
+    return -1;
+
+  /* The hits outlive the process.  */
+  return read_coverage_hits (readbuf, offset, len);
+}
+
 static const struct qxfer qxfer_packets[] =
   {
     { "auxv", handle_qxfer_auxv },
+    { "coverage", handle_qxfer_coverage },
     { "fdpic", handle_qxfer_fdpic},
     { "features", handle_qxfer_features },
     { "libraries", handle_qxfer_libraries },
@@ -1578,6 +1674,9 @@ handle_query (char *own_buf, int packet_len, int *new_packet_len_p)
       if (the_target->read_loadmap != NULL)
 	strcat (own_buf, ";qXfer:fdpic:read+");
 
+      if (target_supports_coverage_points ())
+	strcat (own_buf, ";qXfer:coverage:read+");
+
       /* We always report qXfer:features:read, as targets may
 	 install XML files on a subsequent call to arch_setup.
 	 If we reported to GDB on startup that we don't support
@@ -1591,7 +1690,7 @@ handle_query (char *own_buf, int packet_len, int *new_packet_len_p)
 	strcat (own_buf, ";qXfer:osdata:read+");
 
       if (target_supports_multi_process ())
-	strcat (own_buf, ";multiprocess+");
+	strcat (own_buf, ";multiprocess+;vRunBatch+");
 
       if (target_supports_non_stop ())
 	strcat (own_buf, ";QNonStop+");
@@ -1601,6 +1700,12 @@ handle_query (char *own_buf, int packet_len, int *new_packet_len_p)
 
       strcat (own_buf, ";qXfer:threads:read+");
 
+      /* Support target-side breakpoint conditions and commands.  */
+      strcat (own_buf, ";ConditionalBreakpoints+");
+      strcat (own_buf, ";BreakpointCommands+");
+      strcat (own_buf, ";BreakpointIgnoreCounts+");
+      strcat (own_buf, ";qThreadRegs+");
+
       if (target_supports_tracepoints ())
 	{
 	  strcat (own_buf, ";ConditionalTracepoints+");
@@ -1747,6 +1852,20 @@ handle_query (char *own_buf, int packet_len, int *new_packet_len_p)
       return;
     }
 
+  if (strncmp ("qThreadRegs:", own_buf, sizeof ("qThreadRegs:") - 1) == 0)
+    {
+      require_running (own_buf);
+      if (current_traceframe >= 0)
+	{
+	  /* Traceframes only hold the registers of the thread that
+	     collected them; GDB uses 'g' for those.  */
+	  write_enn (own_buf);
+	  return;
+	}
+      handle_thread_regs (own_buf);
+      return;
+    }
+
   if (strcmp (own_buf, "qAttached") == 0
       || strncmp (own_buf, "qAttached:", sizeof ("qAttached:") - 1) == 0)
     {
@@ -1801,6 +1920,23 @@ handle_query (char *own_buf, int packet_len, int *new_packet_len_p)
       return;
     }
 
+  if (strncmp ("qIgnoredHits:", own_buf, 13) == 0)
+    {
+      /* The number of hits of a GDB breakpoint skipped because of its
+	 ignore count.  GDB wants all further hits reported.  */
+      ULONGEST addr;
+      int hits;
+
+      require_running (own_buf);
+      unpack_varlen_hex (own_buf + 13, &addr);
+      hits = take_gdb_breakpoint_ignored_hits (addr);
+      if (hits < 0)
+	write_enn (own_buf);
+      else
+	sprintf (own_buf, "%x", hits);
+      return;
+    }
+
   if (handle_qxfer (own_buf, packet_len, new_packet_len_p))
     return;
 
@@ -1976,29 +2112,29 @@ handle_v_attach (char *own_buf)
     }
 }
 
-/* Run a new program.  Return 1 if successful, 0 if failure.  */
+/* Parse the semicolon-separated, hex-encoded program name and
+   arguments of a vRun-style packet starting at P into a new argument
+   vector, and install it as PROGRAM_ARGV.  An empty program name
+   means to run the program from the last run.  Return 0 on failure,
+   1 otherwise.  */
+
 static int
-handle_v_run (char *own_buf)
+parse_v_run_args (char *p)
 {
-  char *p, *next_p, **new_argv;
+  char *next_p, **new_argv;
   int i, new_argc;
 
-  new_argc = 0;
-  for (p = own_buf + strlen ("vRun;"); p && *p; p = strchr (p, ';'))
-    {
-      p++;
-      new_argc++;
-    }
+  new_argc = 1;
+  for (next_p = strchr (p, ';'); next_p != NULL;
+       next_p = strchr (next_p + 1, ';'))
+    new_argc++;
 
   new_argv = calloc (new_argc + 2, sizeof (char *));
   if (new_argv == NULL)
-    {
-      write_enn (own_buf);
-      return 0;
-    }
+    return 0;
 
   i = 0;
-  for (p = own_buf + strlen ("vRun;"); *p; p = next_p)
+  for (; *p; p = next_p)
     {
       next_p = strchr (p, ';');
       if (next_p == NULL)
@@ -2027,7 +2163,6 @@ handle_v_run (char *own_buf)
 
       if (program_argv == NULL)
 	{
-	  write_enn (own_buf);
 	  freeargv (new_argv);
 	  return 0;
 	}
@@ -2035,7 +2170,6 @@ handle_v_run (char *own_buf)
       new_argv[0] = strdup (program_argv[0]);
       if (new_argv[0] == NULL)
 	{
-	  write_enn (own_buf);
 	  freeargv (new_argv);
 	  return 0;
 	}
@@ -2044,6 +2178,18 @@ handle_v_run (char *own_buf)
   /* Free the old argv and install the new one.  */
   freeargv (program_argv);
   program_argv = new_argv;
+  return 1;
+}
+
+/* Run a new program.  Return 1 if successful, 0 if failure.  */
+static int
+handle_v_run (char *own_buf)
+{
+  if (!parse_v_run_args (own_buf + strlen ("vRun;")))
+    {
+      write_enn (own_buf);
+      return 0;
+    }
 
   start_inferior (program_argv);
   if (last_status.kind == TARGET_WAITKIND_STOPPED)
@@ -2065,6 +2211,59 @@ handle_v_run (char *own_buf)
     }
 }
 
+/* Run several instances of the same program with a single
+   "vRunBatch;COUNT;FILENAME[;ARGUMENT]..." packet.  The program name
+   and arguments are as for vRun.  All the new processes are left
+   stopped at their first instruction, and the reply is "OK" followed
+   by ";PTID" for the main thread of each of them, in the order they
+   were started.  If some process fails to start, the ones already
+   started are kept, and listed after an "E01" reply instead.  Return
+   the number of processes started.  */
+
+static int
+handle_v_run_batch (char *own_buf)
+{
+  /* Each started process adds a ";pPID.LWP" of at most this many
+     characters to the reply, which must fit in a packet along with
+     its "OK" or "E01".  */
+  const int ptid_len = 40;
+  const int max_count = (PBUFSIZ - 3) / ptid_len;
+  char *p = own_buf + strlen ("vRunBatch;");
+  char *ptids, *out;
+  long count;
+  int i;
+
+  /* Check COUNT before starting anything, so that a request too large
+     to answer doesn't leave processes GDB doesn't know about.  */
+  count = strtol (p, &p, 16);
+  if (count <= 0 || count > max_count
+      || *p != ';' || !parse_v_run_args (p + 1))
+    {
+      write_enn (own_buf);
+      return 0;
+    }
+
+  ptids = out = xmalloc (1 + max_count * ptid_len);
+
+  for (i = 0; i < count; i++)
+    {
+      start_inferior (program_argv);
+      if (last_status.kind != TARGET_WAITKIND_STOPPED)
+	break;
+
+      *out++ = ';';
+      out = write_ptid (out, last_ptid);
+    }
+  *out = '\0';
+
+  if (non_stop && i > 0)
+    general_thread = last_ptid;
+
+  sprintf (own_buf, "%s%s", i < count ? "E01" : "OK", ptids);
+  free (ptids);
+  return i;
+}
+
 /* Kill process.  Return 1 if successful, 0 if failure.  */
 int
 handle_v_kill (char *own_buf)
@@ -2114,6 +2313,132 @@ handle_v_stopped (char *own_buf)
   send_next_stop_reply (own_buf);
 }
 
+/* Handle a "vZ0:ADDR,KIND[;ADDR,KIND]..." packet, which inserts
+   several software breakpoints at once, or the "vz0:" packet, which
+   removes them.  The reply holds one character per breakpoint: '0'
+   if it was inserted (or removed), and '1' if not.  Inserting a
+   breakpoint this way clears any conditions and commands an earlier
+   Z0 packet sent for it.  */
+
+static void
+handle_v_breakpoints (char *own_buf)
+{
+  const int insert = own_buf[1] == 'Z';
+  char *p = own_buf + strlen ("vZ0:");
+  char *reply, *q;
+
+  if ((insert && the_target->insert_point == NULL)
+      || (!insert && the_target->remove_point == NULL))
+    {
+      own_buf[0] = '\0';
+      return;
+    }
+
+  /* Each breakpoint takes at least three characters of the request
+     ("A,K") and one of the reply.  */
+  reply = xmalloc (strlen (p) / 3 + 2);
+  q = reply;
+
+  while (*p != '\0')
+    {
+      ULONGEST addr;
+      int len, res;
+
+      p = unpack_varlen_hex (p, &addr);
+      if (*p != ',')
+	break;
+      len = strtol (p + 1, &p, 16);
+      if (*p != ';' && *p != '\0')
+	break;
+
+      if (insert)
+	{
+	  res = (*the_target->insert_point) ('0', addr, len);
+	  if (res == 0)
+	    {
+	      clear_gdb_breakpoint_conditions (addr);
+	      clear_gdb_breakpoint_commands (addr);
+	    }
+	}
+      else
+	res = (*the_target->remove_point) ('0', addr, len);
+
+      *q++ = res == 0 ? '0' : '1';
+
+      if (*p == ';')
+	p++;
+    }
+
+  if (*p != '\0')
+    write_enn (own_buf);
+  else
+    {
+      *q = '\0';
+      strcpy (own_buf, reply);
+    }
+
+  free (reply);
+}
+
+/* Handle "vCoverage:insert:ADDR[;ADDR]...", which plants coverage
+   points, and replies with one character per point as for vZ0, and
+   "vCoverage:clear", which removes the points not hit yet and forgets
+   the hits.  */
+
+static void
+handle_v_coverage (char *own_buf)
+{
+  char *p = own_buf + strlen ("vCoverage:");
+
+  if (!target_supports_coverage_points ())
+    {
+      own_buf[0] = '\0';
+      return;
+    }
+
+  if (strcmp (p, "clear") == 0)
+    {
+      clear_coverage_points ();
+      write_ok (own_buf);
+    }
+  else if (strncmp (p, "insert:", 7) == 0 && target_running ())
+    {
+      char *reply, *q;
+
+      p += 7;
+
+      /* Each point takes at least two characters of the request.  */
+      reply = xmalloc (strlen (p) / 2 + 2);
+      q = reply;
+
+      while (*p != '\0')
+	{
+	  ULONGEST addr;
+
+	  p = unpack_varlen_hex (p, &addr);
+	  if (*p != ';' && *p != '\0')
+	    break;
+
+	  *q++ = insert_coverage_point (addr) == 0 ? '0' : '1';
+
+	  if (*p == ';')
+	    p++;
+	}
+
+      if (*p != '\0')
+	write_enn (own_buf);
+      else
+	{
+	  *q = '\0';
+	  strcpy (own_buf, reply);
+	}
+
+      free (reply);
+    }
+  else
+    write_enn (own_buf);
+}
+
 /* Handle all of the extended 'v' packets.  */
 void
 handle_v_requests (char *own_buf, int packet_len, int *new_packet_len)
@@ -2150,6 +2475,17 @@ handle_v_requests (char *own_buf, int packet_len, int *new_packet_len)
       return;
     }
 
+  if (strncmp (own_buf, "vRunBatch;", 10) == 0)
+    {
+      if (!multi_process)
+	{
+	  write_enn (own_buf);
+	  return;
+	}
+      handle_v_run_batch (own_buf);
+      return;
+    }
+
   if (strncmp (own_buf, "vRun;", 5) == 0)
     {
       if (!multi_process && target_running ())
@@ -2162,6 +2498,20 @@ handle_v_requests (char *own_buf, int packet_len, int *new_packet_len)
       return;
     }
 
+  if (strncmp (own_buf, "vCoverage:", 10) == 0)
+    {
+      handle_v_coverage (own_buf);
+      return;
+    }
+
+  if (strncmp (own_buf, "vZ0:", 4) == 0
+      || strncmp (own_buf, "vz0:", 4) == 0)
+    {
+      require_running (own_buf);
+      handle_v_breakpoints (own_buf);
+      return;
+    }
+
   if (strncmp (own_buf, "vKill;", 6) == 0)
     {
       if (!target_running ())
@@ -2389,6 +2739,8 @@ gdbserver_usage (FILE *stream)
 	   "Options:\n"
 	   "  --debug               Enable general debugging output.\n"
 	   "  --remote-debug        Enable remote protocol debugging output.\n"
+	   "  --capture=FILE        Record the session with GDB to FILE, for\n"
+	   "                        gdbreplay.  Requires --once.\n"
 	   "  --version             Display version information and exit.\n"
 	   "  --wrapper WRAPPER --  Run WRAPPER to start new programs.\n"
 	   "  --once                Exit after the first connection has "
@@ -2527,6 +2879,7 @@ main (int argc, char *argv[])
   int multi_mode = 0;
   int attach = 0;
   int was_running;
+  const char *capture_name = NULL;
 
   while (*next_arg != NULL && **next_arg == '-')
     {
@@ -2565,6 +2918,9 @@ main (int argc, char *argv[])
 	debug_threads = 1;
       else if (strcmp (*next_arg, "--remote-debug") == 0)
 	remote_debug = 1;
+      else if (strncmp (*next_arg, "--capture=",
+			sizeof ("--capture=") - 1) == 0)
+	capture_name = *next_arg + sizeof ("--capture=") - 1;
       else if (strcmp (*next_arg, "--disable-packet") == 0)
 	{
 	  gdbserver_show_disableable (stdout);
@@ -2627,6 +2983,22 @@ main (int argc, char *argv[])
       exit (1);
     }
 
+  /* A capture file holds a single connection with GDB.  */
+  if (capture_name != NULL)
+    {
+      if (!run_once)
+	{
+	  fprintf (stderr, "--capture requires --once.\n");
+	  exit (1);
+	}
+      if (capture_open (capture_name) != 0)
+	{
+	  fprintf (stderr, "Can't open capture file \"%s\": %s\n",
+		   capture_name, strerror (errno));
+	  exit (1);
+	}
+    }
+
   port = *next_arg;
   next_arg++;
   if (port == NULL || (!attach && !multi_mode && *next_arg == NULL))
@@ -3113,7 +3485,69 @@ process_serial_event (void)
 	  case '4': /* access watchpoint */
 	    require_running (own_buf);
 	    if (insert && the_target->insert_point != NULL)
-	      res = (*the_target->insert_point) (type, addr, len);
+	      {
+		res = (*the_target->insert_point) (type, addr, len);
+
+		/* GDB may have sent conditions for a software breakpoint,
+		   to be evaluated here before reporting a hit, and
+		   commands to run here instead of reporting it.  They
+		   replace any sent with an earlier insertion of a
+		   breakpoint at the same address.  */
+		if (res == 0 && type == '0')
+		  {
+		    clear_gdb_breakpoint_conditions (addr);
+		    clear_gdb_breakpoint_commands (addr);
+		    while (*dataptr == ';')
+		      {
+			dataptr++;
+			if (*dataptr == 'X')
+			  {
+			    if (!add_breakpoint_condition (addr, &dataptr))
+			      {
+				/* Report every hit, and let GDB
+				   evaluate the condition.  */
+				clear_gdb_breakpoint_conditions (addr);
+				break;
+			      }
+			  }
+			else if (strncmp (dataptr, "ignore:", 7) == 0)
+			  {
+			    ULONGEST count;
+
+			    /* "ignore:COUNT", the number of hits to skip
+			       before reporting one.  */
+			    dataptr = unpack_varlen_hex (dataptr + 7, &count);
+			    set_gdb_breakpoint_ignore_count (addr, count);
+			  }
+			else if (strncmp (dataptr, "cmds:", 5) == 0)
+			  {
+			    int persist, ok = 0;
+
+			    /* "cmds:PERSIST,X<len>,<bytes>".  */
+			    dataptr += 5;
+			    persist = (*dataptr == '1');
+			    if (*dataptr != '\0' && dataptr[1] == ',')
+			      {
+				dataptr += 2;
+				ok = add_breakpoint_commands (addr, &dataptr,
+							      persist);
+			      }
+			    if (!ok)
+			      {
+				/* Report every hit instead.  */
+				clear_gdb_breakpoint_commands (addr);
+				break;
+			      }
+			  }
+			else
+			  {
+			    /* Skip options we don't know about.  */
+			    while (*dataptr != '\0' && *dataptr != ';')
+			      dataptr++;
+			  }
+		      }
+		  }
+	      }
 	    else if (!insert && the_target->remove_point != NULL)
 	      res = (*the_target->remove_point) (type, addr, len);
 	    break;
@@ -118,16 +118,33 @@ typedef long long LONGEST;
 typedef unsigned long long ULONGEST;
 
 /* Generic information for tracking a list of ``inferiors'' - threads,
-   processes, etc.  */
+   processes, etc.  Besides the list itself, the entries are indexed
+   by ID in a hash table, so that looking an entry up by ID doesn't
+   need to walk the whole list.  */
 struct inferior_list
 {
   struct inferior_list_entry *head;
   struct inferior_list_entry *tail;
+
+  /* The ID hash table.  Each bucket chains its entries through their
+     HASH_NEXT field, in list order.  NULL until the first entry is
+     added.  */
+  struct inferior_list_entry **buckets;
+
+  /* Number of elements allocated in BUCKETS.  Always a power of
+     two.  */
+  int num_buckets;
+
+  /* Number of entries in the list.  */
+  int count;
 };
 struct inferior_list_entry
 {
   ptid_t id;
   struct inferior_list_entry *next;
+
+  /* Next entry in the same bucket of the list's ID hash table.  */
+  struct inferior_list_entry *hash_next;
 };
 
 struct thread_info;
@@ -186,6 +203,7 @@ struct dll_info
 };
 
 struct sym_cache;
+struct exec_cache;
 struct breakpoint;
 struct raw_breakpoint;
 struct fast_tracepoint_jump;
@@ -206,6 +224,10 @@ struct process_info
   /* The symbol cache.  */
   struct sym_cache *symbol_cache;
 
+  /* State shared with the other processes started from the same
+     executable, or NULL.  */
+  struct exec_cache *exec_cache;
+
   /* The list of memory breakpoints.  */
   struct breakpoint *breakpoints;
 
@@ -251,6 +273,8 @@ void add_thread (ptid_t ptid, void *target_data);
 struct process_info *add_process (int pid, int attached);
 void remove_process (struct process_info *process);
 struct process_info *find_process_pid (int pid);
+void share_exec_cache (struct process_info *process, const char *program);
+struct sym_cache **process_symbol_cache (struct process_info *process);
 int have_started_inferiors_p (void);
 int have_attached_inferiors_p (void);
 
@@ -268,6 +292,8 @@ struct inferior_list_entry *find_inferior
       void *arg);
 struct inferior_list_entry *find_inferior_id (struct inferior_list *list,
 					      ptid_t id);
+struct inferior_list_entry *find_inferior_lwp (struct inferior_list *list,
+					       long lwp);
 void *inferior_target_data (struct thread_info *);
 void set_inferior_target_data (struct thread_info *, void *);
 void *inferior_regcache_data (struct thread_info *);
@@ -316,11 +342,15 @@ typedef int (callback_handler_func) (gdb_client_data);
 extern void delete_file_handler (gdb_fildes_t fd);
 extern void add_file_handler (gdb_fildes_t fd, handler_func *proc,
 			      gdb_client_data client_data);
+extern void add_edge_file_handler (gdb_fildes_t fd, handler_func *proc,
+				   gdb_client_data client_data);
 extern int append_callback_event (callback_handler_func *proc,
 				   gdb_client_data client_data);
 extern void delete_callback_event (int id);
 
 extern void start_event_loop (void);
+extern void show_event_loop_stats (void);
+extern void reset_event_loop_stats (void);
 
 /* Functions from server.c.  */
 extern int handle_serial_event (int err, gdb_client_data client_data);
@@ -352,6 +382,8 @@ int getpkt (char *buf);
 void remote_prepare (char *name);
 void remote_open (char *name);
 void remote_close (void);
+int capture_open (const char *name);
+void capture_close (void);
 void write_ok (char *buf);
 void write_enn (char *buf);
 void initialize_async_io (void);
@@ -452,6 +484,14 @@ int tracepoint_was_hit (struct thread_info *tinfo, CORE_ADDR stop_pc);
 
 void release_while_stepping_state_list (struct thread_info *tinfo);
 
+struct agent_expr;
+struct agent_expr *parse_agent_expr (char **actparm);
+void free_agent_expr (struct agent_expr *aexpr);
+int breakpoint_condition_true (struct agent_expr *cond,
+			       struct regcache *regcache);
+int run_breakpoint_command (struct agent_expr *command,
+			    struct regcache *regcache);
+
 extern int current_traceframe;
 
 int in_readonly_region (CORE_ADDR addr, ULONGEST length);
@@ -82,6 +82,10 @@ mywait (ptid_t ptid, struct target_waitstatus *ourstatus, int options,
 
   ret = (*the_target->wait) (ptid, ourstatus, options);
 
+  /* Breakpoint commands print to our standard output while the
+     inferior runs; flush that before the event is reported.  */
+  fflush (stdout);
+
   if (ourstatus->kind == TARGET_WAITKIND_EXITED)
     fprintf (stderr,
 	     "\nChild exited with status %d\n", ourstatus->value.integer);
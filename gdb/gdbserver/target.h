@@ -394,6 +394,10 @@ struct target_ops
   int (*qxfer_libraries_svr4) (const char *annex, unsigned char *readbuf,
 			       unsigned const char *writebuf,
 			       CORE_ADDR offset, int len);
+
+  /* Returns true if the target supports coverage points (see
+     insert_coverage_point).  */
+  int (*supports_coverage_points) (void);
 };
 
 extern struct target_ops *the_target;
@@ -514,6 +518,10 @@ void set_target_ops (struct target_ops *);
   (the_target->supports_disable_randomization ? \
    (*the_target->supports_disable_randomization) () : 0)
 
+#define target_supports_coverage_points() \
+  (the_target->supports_coverage_points ? \
+   (*the_target->supports_coverage_points) () : 0)
+
 /* Start non-stop mode, returns 0 on success, -1 on failure.   */
 
 int start_non_stop (int nonstop);
@@ -25,6 +25,7 @@
 #if HAVE_STDINT_H
 #include <stdint.h>
 #endif
+#include "format.h"
 
 /* This file is built for both GDBserver, and the in-process
    agent (IPA), a shared library that includes a tracing agent that is
@@ -1238,7 +1239,6 @@ struct trap_tracepoint_ctx
 #endif
 
 #ifndef IN_PROCESS_AGENT
-static struct agent_expr *parse_agent_expr (char **actparm);
 static char *unparse_agent_expr (struct agent_expr *aexpr);
 #endif
 static enum eval_result_type eval_agent_expr (struct tracepoint_hit_ctx *ctx,
@@ -4609,7 +4609,7 @@ condition_true_at_tracepoint (struct tracepoint_hit_ctx *ctx,
 /* The packet form of an agent expression consists of an 'X', number
    of bytes in expression, a comma, and then the bytes.  */
 
-static struct agent_expr *
+struct agent_expr *
 parse_agent_expr (char **actparm)
 {
   char *act = *actparm;
@@ -4627,6 +4627,18 @@ parse_agent_expr (char **actparm)
   return aexpr;
 }
 
+/* Release an agent expression built by parse_agent_expr.  */
+
+void
+free_agent_expr (struct agent_expr *aexpr)
+{
+  if (aexpr != NULL)
+    {
+      free (aexpr->bytes);
+      free (aexpr);
+    }
+}
+
 /* Convert the bytes of an agent expression back into hex digits, so
    they can be printed or uploaded.  This allocates the buffer,
    callers should free when they are done with it.  */
@@ -4641,6 +4653,204 @@ unparse_agent_expr (struct agent_expr *aexpr)
   return rslt;
 }
 
+/* Evaluate COND, a breakpoint condition downloaded by GDB, for the
+   current inferior, whose registers are in REGCACHE.  Returns true if
+   the condition holds.  A condition that fails to evaluate is also
+   considered true, so that GDB sees the breakpoint hit and gets to
+   report the error itself.  */
+
+int
+breakpoint_condition_true (struct agent_expr *cond,
+			   struct regcache *regcache)
+{
+  struct trap_tracepoint_ctx ctx;
+  ULONGEST value = 0;
+  enum eval_result_type err;
+
+  ctx.base.type = trap_tracepoint;
+  ctx.regcache = regcache;
+
+  err = eval_agent_expr (&ctx.base, NULL, cond, &value);
+  if (err != expr_eval_no_error)
+    {
+      trace_debug ("Breakpoint condition failed to evaluate, error %d",
+		   (int) err);
+      return 1;
+    }
+
+  return (value ? 1 : 0);
+}
+
+/* Run COMMAND, a breakpoint command downloaded by GDB, for the
+   current inferior, whose registers are in REGCACHE.  Returns 0 on
+   success, or a nonzero error code.  */
+
+int
+run_breakpoint_command (struct agent_expr *command,
+			struct regcache *regcache)
+{
+  struct trap_tracepoint_ctx ctx;
+  ULONGEST value = 0;
+  enum eval_result_type err;
+
+  ctx.base.type = trap_tracepoint;
+  ctx.regcache = regcache;
+
+  err = eval_agent_expr (&ctx.base, NULL, command, &value);
+  if (err != expr_eval_no_error)
+    trace_debug ("Breakpoint command failed to evaluate, error %d",
+		 (int) err);
+
+  return (int) err;
+}
+
+/* The longest string a %s conversion of the printf bytecode will
+   read from the inferior.  */
+#define AX_PRINTF_STRING_MAX 4096
+
+/* Print NARGS ARGS, the values popped off the agent stack, to
+   gdbserver's standard output, as specified by the printf-style
+   FORMAT.  The output stays buffered until the next event is
+   reported to GDB.  Returns 0 on success, and nonzero if FORMAT
+   doesn't match the arguments.  */
+
+static int
+ax_printf (const char *format, int nargs, ULONGEST *args)
+{
+  struct format_piece *fpieces;
+  const char *error;
+  int i, fr, nargs_wanted;
+
+  fpieces = parse_format_string (format, &error);
+  if (fpieces == NULL)
+    {
+      trace_debug ("Bad printf format: %s", error);
+      return 1;
+    }
+
+  nargs_wanted = 0;
+  for (fr = 0; fpieces[fr].string != NULL; fr++)
+    if (fpieces[fr].argclass != literal_piece)
+      ++nargs_wanted;
+
+  if (nargs != nargs_wanted)
+    {
+      trace_debug ("Wrong number of arguments for printf format");
+      free_format_pieces (fpieces);
+      return 1;
+    }
+
+  i = 0;
+  for (fr = 0; fpieces[fr].string != NULL; fr++)
+    {
+      const char *current_substring = fpieces[fr].string;
+
+      switch (fpieces[fr].argclass)
+	{
+	case string_arg:
+	  {
+	    char str[AX_PRINTF_STRING_MAX + 1];
+	    CORE_ADDR tem = args[i];
+	    int j;
+
+	    /* Copy the string into gdbserver, up to its terminating
+	       zero, or the first byte that can't be read.  */
+	    for (j = 0; j < AX_PRINTF_STRING_MAX; j++)
+	      {
+		unsigned char c;
+
+		if (read_inferior_memory (tem + j, &c, 1) != 0 || c == 0)
+		  break;
+		str[j] = c;
+	      }
+	    str[j] = '\0';
+
+	    printf (current_substring, str);
+	  }
+	  break;
+
+	case long_long_arg:
+	  printf (current_substring, (long long) args[i]);
+	  break;
+
+	case int_arg:
+	  printf (current_substring, (int) args[i]);
+	  break;
+
+	case long_arg:
+	  printf (current_substring, (long) args[i]);
+	  break;
+
+	case ptr_arg:
+	  {
+	    /* As GDB does, handle %p as %#llx or a literal "(nil)",
+	       keeping any width.  */
+	    char *fmt, *fmt_p;
+	    const char *p;
+
+	    fmt = alloca (strlen (current_substring) + 5);
+
+	    /* Copy up to the leading %.  */
+	    p = current_substring;
+	    fmt_p = fmt;
+	    while (*p)
+	      {
+		int is_percent = (*p == '%');
+
+		*fmt_p++ = *p++;
+		if (is_percent)
+		  {
+		    if (*p == '%')
+		      *fmt_p++ = *p++;
+		    else
+		      break;
+		  }
+	      }
+
+	    if (args[i] != 0)
+	      *fmt_p++ = '#';
+
+	    /* Copy any width.  */
+	    while (*p >= '0' && *p <= '9')
+	      *fmt_p++ = *p++;
+
+	    if (args[i] != 0)
+	      {
+		strcpy (fmt_p, "llx");
+		printf (fmt, (unsigned long long) args[i]);
+	      }
+	    else
+	      {
+		strcpy (fmt_p, "s");
+		printf (fmt, "(nil)");
+	      }
+	  }
+	  break;
+
+	case literal_piece:
+	  /* Print the portion of the format string after the last
+	     argument, which may still contain "%%".  Pass a dummy
+	     argument, as GDB does.  */
+	  printf (current_substring, 0);
+	  break;
+
+	default:
+	  /* GDB only sends integer, pointer and string arguments to
+	     the agent.  */
+	  trace_debug ("Unsupported printf argument");
+	  free_format_pieces (fpieces);
+	  return 1;
+	}
+
+      /* Maybe advance to the next argument.  */
+      if (fpieces[fr].argclass != literal_piece)
+	++i;
+    }
+
+  free_format_pieces (fpieces);
+  return 0;
+}
+
 #endif
 
 /* A wrapper for gdb_agent_op_names that does some bounds-checking.  */
@@ -5019,6 +5229,64 @@ eval_agent_expr (struct tracepoint_hit_ctx *ctx,
 	    top = stack[sp];
 	  break;
 
+	case gdb_agent_op_printf:
+#ifndef IN_PROCESS_AGENT
+	  {
+	    int nargs, slen;
+	    char *format;
+
+	    /* The bytecode comes from GDB; check that the operands and
+	       the format string are all within it before reading
+	       them.  */
+	    if (pc + 3 > aexpr->length)
+	      {
+		trace_debug ("Malformed printf bytecode");
+		return expr_eval_unrecognized_opcode;
+	      }
+	    nargs = aexpr->bytes[pc++];
+	    slen = aexpr->bytes[pc++];
+	    slen = (slen << 8) + aexpr->bytes[pc++];
+
+	    if (slen == 0 || pc + slen > aexpr->length)
+	      {
+		trace_debug ("Malformed printf bytecode");
+		return expr_eval_unrecognized_opcode;
+	      }
+	    format = (char *) &aexpr->bytes[pc];
+	    pc += slen;
+
+	    if (format[slen - 1] != '\0')
+	      {
+		trace_debug ("Malformed printf bytecode");
+		return expr_eval_unrecognized_opcode;
+	      }
+
+	    if (nargs > sp)
+	      {
+		trace_debug ("Expression stack underflow");
+		return expr_eval_stack_underflow;
+	      }
+
+	    /* Flush the cached stack top, so that the arguments are the
+	       top NARGS stack entries, the first one deepest.  */
+	    stack[sp] = top;
+	    if (ax_printf (format, nargs, &stack[sp - nargs + 1]) != 0)
+	      return expr_eval_unhandled_opcode;
+
+	    if (nargs > 0)
+	      {
+		sp -= nargs;
+		top = stack[sp];
+	      }
+	  }
+	  break;
+#else
+	  /* The in-process agent has nowhere to print to.  */
+	  trace_debug ("Agent expression op 0x%x not handled in the agent",
+		       op);
+	  return expr_eval_unhandled_opcode;
+#endif
+
 	  /* GDB never (currently) generates any of these ops.  */
 	case gdb_agent_op_float:
 	case gdb_agent_op_ref_float:
@@ -6267,6 +6535,12 @@ is_goto_target (struct agent_expr *aexpr, int pc)
 	  if (target == pc)
 	    return 1;
 	}
+      else if (op == gdb_agent_op_printf)
+	{
+	  /* Skip the argument count, the string length and the
+	     format string.  */
+	  i += 3 + (aexpr->bytes[i + 2] << 8) + aexpr->bytes[i + 3];
+	}
     }
 
   return 0;
@@ -33,6 +33,7 @@
 #include <sys/ptrace.h>
 #include <sys/user.h>
 #include <sys/procfs.h>
+#include <sys/syscall.h>
 
 #ifdef HAVE_SYS_REG_H
 #include <sys/reg.h>
@@ -965,6 +966,61 @@ i386_linux_read_description (struct target_ops *ops)
     return tdesc_i386_linux;
 }
 
+#ifdef HAVE_PTRACE_GETREGS
+
+/* Make the stopped LWP LWPID call mprotect (ADDR, LEN, PROT), by
+   single-stepping it over a system call instruction written at its
+   PC.  Return 0 on success, or an errno value.  */
+
+static int
+i386_linux_inferior_mprotect (int lwpid, CORE_ADDR addr, ULONGEST len,
+			      int prot)
+{
+  elf_gregset_t regs, saved_regs;
+  long insn, saved_insn;
+  CORE_ADDR pc;
+  int ret = 0;
+
+  if (ptrace (PTRACE_GETREGS, lwpid, 0, (int) &saved_regs) < 0)
+    return errno;
+  memcpy (&regs, &saved_regs, sizeof (regs));
+  pc = saved_regs[EIP];
+
+  errno = 0;
+  saved_insn = ptrace (PTRACE_PEEKTEXT, lwpid, pc, 0);
+  if (errno != 0)
+    return errno;
+
+  insn = saved_insn;
+  memcpy (&insn, "\xcd\x80", 2);	/* int $0x80 */
+  regs[EAX] = SYS_mprotect;
+  regs[EBX] = addr;
+  regs[ECX] = len;
+  regs[EDX] = prot;
+
+  /* Don't let the kernel restart a system call the LWP is stopped
+     in, instead of running ours.  */
+  regs[ORIG_EAX] = -1;
+
+  if (ptrace (PTRACE_POKETEXT, lwpid, pc, insn) < 0)
+    return errno;
+
+  if (ptrace (PTRACE_SETREGS, lwpid, 0, (int) &regs) < 0)
+    ret = errno;
+  else if (linux_nat_step_lwp_insn (lwpid) != 0)
+    ret = ESRCH;
+  else if (ptrace (PTRACE_GETREGS, lwpid, 0, (int) &regs) < 0)
+    ret = errno;
+  else if ((long) regs[EAX] < 0 && (long) regs[EAX] > -4096)
+    ret = -(long) regs[EAX];
+
+  ptrace (PTRACE_POKETEXT, lwpid, pc, saved_insn);
+  ptrace (PTRACE_SETREGS, lwpid, 0, (int) &saved_regs);
+  return ret;
+}
+
+#endif /* HAVE_PTRACE_GETREGS */
+
 void
 _initialize_i386_linux_nat (void)
 {
@@ -998,4 +1054,9 @@ _initialize_i386_linux_nat (void)
   /* Register the target.  */
   linux_nat_add_target (t);
   linux_nat_set_new_thread (t, i386_linux_new_thread);
+#ifdef HAVE_PTRACE_GETREGS
+  linux_nat_set_inferior_mprotect (t, i386_linux_inferior_mprotect);
+#endif
+  linux_nat_set_batched_breakpoints (t);
+  linux_nat_set_breakpoint_ignore_counts (t);
 }
@@ -34,8 +34,9 @@
    more of the watchpoints triggered and at what address, checking
    whether a given region can be watched, etc.
 
-   The functions below implement debug registers sharing by reference
-   counts, and allow to watch regions up to 16 bytes long.  */
+   The functions below share debug registers between watchpoints that
+   watch the same or neighbouring memory, and allow to watch regions
+   up to 16 bytes long (32 bytes on AMD64).  */
 
 struct i386_dr_low_type i386_dr_low;
 
@@ -84,7 +85,7 @@ struct i386_dr_low_type i386_dr_low;
 
    Currently, all watchpoint are locally enabled.  If you need to
    enable them globally, read the comment which pertains to this in
-   i386_insert_aligned_watchpoint below.  */
+   i386_assign_dregs below.  */
 #define DR_LOCAL_ENABLE_SHIFT	0 /* Extra shift to the local enable bit.  */
 #define DR_GLOBAL_ENABLE_SHIFT	1 /* Extra shift to the global enable bit.  */
 #define DR_ENABLE_SIZE		2 /* Two enable bits per debug register.  */
@@ -171,7 +172,8 @@ struct i386_debug_reg_state
   CORE_ADDR dr_mirror[DR_NADDR];
   unsigned dr_status_mirror, dr_control_mirror;
 
-  /* Reference counts for each debug register.  */
+  /* The number of watchpoint and breakpoint insertions each debug
+     register serves.  */
   int dr_ref_count[DR_NADDR];
 };
 
@@ -197,8 +199,35 @@ static struct i386_debug_reg_state dr_mirror;
 /* Whether or not to print the mirrored debug registers.  */
 static int maint_show_dr;
 
-/* Types of operations supported by i386_handle_nonaligned_watchpoint.  */
-typedef enum { WP_INSERT, WP_REMOVE, WP_COUNT } i386_wp_op_t;
+/* A region that watchpoints or hardware breakpoints asked to watch.
+   Rather than giving each region its own registers as it comes, we
+   keep the list of regions, sorted by address, and recompute the
+   whole set of debug registers from it whenever a region is added or
+   removed.  That way regions of different watchpoints can be merged
+   into one register.  */
+
+typedef struct i386_dr_region
+{
+  CORE_ADDR addr;
+  int len;
+  enum target_hw_bp_type type;
+
+  /* The number of times this same region was inserted.  */
+  int refcount;
+} i386_dr_region_s;
+
+DEF_VEC_O (i386_dr_region_s);
+
+static VEC (i386_dr_region_s) *dr_regions;
+
+/* A region that a single debug register can watch.  */
+
+struct i386_dr_chunk
+{
+  CORE_ADDR addr;
+  int len;
+  enum target_hw_bp_type type;
+};
 
 /* Internal functions.  */
 
@@ -207,34 +236,16 @@ typedef enum { WP_INSERT, WP_REMOVE, WP_COUNT } i386_wp_op_t;
    have the value of 1, 2, or 4.  */
 static unsigned i386_length_and_rw_bits (int len, enum target_hw_bp_type type);
 
-/* Insert a watchpoint at address ADDR, which is assumed to be aligned
-   according to the length of the region to watch.  LEN_RW_BITS is the
-   value of the bit-field from DR7 which describes the length and
-   access type of the region to be watched by this watchpoint.  Return
-   0 on success, -1 on failure.  */
-static int i386_insert_aligned_watchpoint (struct i386_debug_reg_state *state,
-					   CORE_ADDR addr,
-					   unsigned len_rw_bits);
-
-/* Remove a watchpoint at address ADDR, which is assumed to be aligned
-   according to the length of the region to watch.  LEN_RW_BITS is the
-   value of the bits from DR7 which describes the length and access
-   type of the region watched by this watchpoint.  Return 0 on
-   success, -1 on failure.  */
-static int i386_remove_aligned_watchpoint (struct i386_debug_reg_state *state,
-					   CORE_ADDR addr,
-					   unsigned len_rw_bits);
-
-/* Insert or remove a (possibly non-aligned) watchpoint, or count the
-   number of debug registers required to watch a region at address
-   ADDR whose length is LEN for accesses of type TYPE.  Return 0 on
-   successful insertion or removal, a positive number when queried
-   about the number of registers, or -1 on failure.  If WHAT is not a
-   valid value, bombs through internal_error.  */
-static int i386_handle_nonaligned_watchpoint (struct i386_debug_reg_state *state,
-					      i386_wp_op_t what,
-					      CORE_ADDR addr, int len,
-					      enum target_hw_bp_type type);
+/* Add to CHUNKS, which holds *NCHUNKS elements, the aligned chunks
+   needed to watch a region at address ADDR whose length is LEN for
+   accesses of type TYPE.  Chunks already in CHUNKS are not added
+   again.  If WIDEN is non-zero, first widen the region to whole
+   aligned blocks of the largest length a register can watch.  Return
+   0 on success, or -1 if more than DR_NADDR chunks would be
+   needed.  */
+static int i386_add_chunks (struct i386_dr_chunk *chunks, int *nchunks,
+			    CORE_ADDR addr, int len,
+			    enum target_hw_bp_type type, int widen);
 
 /* Implementation.  */
 
@@ -245,6 +256,7 @@ void
 i386_cleanup_dregs (void)
 {
   i386_init_dregs (&dr_mirror);
+  VEC_free (i386_dr_region_s, dr_regions);
 }
 
 /* Print the values of the mirrored debug registers.  This is called
@@ -343,163 +355,318 @@ Invalid hardware breakpoint length %d in i386_length_and_rw_bits.\n"), len);
     }
 }
 
-/* Insert a watchpoint at address ADDR, which is assumed to be aligned
-   according to the length of the region to watch.  LEN_RW_BITS is the
-   value of the bits from DR7 which describes the length and access
-   type of the region to be watched by this watchpoint.  Return 0 on
-   success, -1 on failure.  */
+/* Return the length of the region watched by a debug register whose
+   RW and LEN fields in DR7 are LEN_RW_BITS.  */
 
 static int
-i386_insert_aligned_watchpoint (struct i386_debug_reg_state *state,
-				CORE_ADDR addr, unsigned len_rw_bits)
+i386_length_of_rw_bits (unsigned len_rw_bits)
 {
-  int i;
+  switch (len_rw_bits & (0x3 << 2))
+    {
+      case DR_LEN_1:
+	return 1;
+      case DR_LEN_2:
+	return 2;
+      case DR_LEN_8:
+	return 8;
+      default:
+	return 4;
+    }
+}
 
-  if (!i386_dr_low.set_addr || !i386_dr_low.set_control)
-    return -1;
+/* Return the type of accesses watched by a debug register whose RW
+   and LEN fields in DR7 are LEN_RW_BITS.  */
 
-  /* First, look for an occupied debug register with the same address
-     and the same RW and LEN definitions.  If we find one, we can
-     reuse it for this watchpoint as well (and save a register).  */
-  ALL_DEBUG_REGISTERS(i)
+static enum target_hw_bp_type
+i386_type_of_rw_bits (unsigned len_rw_bits)
+{
+  switch (len_rw_bits & 0x3)
     {
-      if (!I386_DR_VACANT (state, i)
-	  && state->dr_mirror[i] == addr
-	  && I386_DR_GET_RW_LEN (state->dr_control_mirror, i) == len_rw_bits)
-	{
-	  state->dr_ref_count[i]++;
-	  return 0;
-	}
+      case DR_RW_EXECUTE:
+	return hw_execute;
+      case DR_RW_WRITE:
+	return hw_write;
+      default:
+	return hw_access;
     }
+}
 
-  /* Next, look for a vacant debug register.  */
-  ALL_DEBUG_REGISTERS(i)
+/* Each row is a length of region to watch, minus one, and each column
+   an alignment of its address.  An entry is the size of the first
+   chunk to watch, which a single debug register can take.  */
+
+static int size_try_array[8][8] =
+{
+  {1, 1, 1, 1, 1, 1, 1, 1},	/* Trying size one.  */
+  {2, 1, 2, 1, 2, 1, 2, 1},	/* Trying size two.  */
+  {2, 1, 2, 1, 2, 1, 2, 1},	/* Trying size three.  */
+  {4, 1, 2, 1, 4, 1, 2, 1},	/* Trying size four.  */
+  {4, 1, 2, 1, 4, 1, 2, 1},	/* Trying size five.  */
+  {4, 1, 2, 1, 4, 1, 2, 1},	/* Trying size six.  */
+  {4, 1, 2, 1, 4, 1, 2, 1},	/* Trying size seven.  */
+  {8, 1, 2, 1, 4, 1, 2, 1},	/* Trying size eight.  */
+};
+
+/* Add to CHUNKS, which holds *NCHUNKS elements, the aligned chunks
+   needed to watch a region at address ADDR whose length is LEN for
+   accesses of type TYPE.  Chunks already in CHUNKS are not added
+   again.  If WIDEN is non-zero, first widen the region to whole
+   aligned blocks of the largest length a register can watch.  Return
+   0 on success, or -1 if more than DR_NADDR chunks would be
+   needed.  */
+
+static int
+i386_add_chunks (struct i386_dr_chunk *chunks, int *nchunks,
+		 CORE_ADDR addr, int len, enum target_hw_bp_type type,
+		 int widen)
+{
+  int max_wp_len = TARGET_HAS_DR_LEN_8 ? 8 : 4;
+
+  if (widen)
     {
-      if (I386_DR_VACANT (state, i))
-	break;
+      CORE_ADDR end = addr + len;
+
+      addr -= addr % max_wp_len;
+      end += (max_wp_len - end % max_wp_len) % max_wp_len;
+      len = end - addr;
     }
 
-  /* No more debug registers!  */
-  if (i >= DR_NADDR)
-    return -1;
+  while (len > 0)
+    {
+      int align = addr % max_wp_len;
+      /* Four (eight on AMD64) is the maximum length a debug register
+	 can watch.  */
+      int try = (len > max_wp_len ? (max_wp_len - 1) : len - 1);
+      int size = size_try_array[try][align];
+      int i;
 
-  /* Now set up the register I to watch our region.  */
-
-  /* Record the info in our local mirrored array.  */
-  state->dr_mirror[i] = addr;
-  state->dr_ref_count[i] = 1;
-  I386_DR_SET_RW_LEN (state, i, len_rw_bits);
-  /* Note: we only enable the watchpoint locally, i.e. in the current
-     task.  Currently, no i386 target allows or supports global
-     watchpoints; however, if any target would want that in the
-     future, GDB should probably provide a command to control whether
-     to enable watchpoints globally or locally, and the code below
-     should use global or local enable and slow-down flags as
-     appropriate.  */
-  I386_DR_LOCAL_ENABLE (state, i);
-  state->dr_control_mirror |= DR_LOCAL_SLOWDOWN;
-  state->dr_control_mirror &= I386_DR_CONTROL_MASK;
+      /* size_try_array[] is defined such that each iteration through
+	 the loop is guaranteed to produce an address and a size that
+	 can be watched with a single debug register.  */
+      for (i = 0; i < *nchunks; i++)
+	if (chunks[i].addr == addr && chunks[i].len == size
+	    && chunks[i].type == type)
+	  break;
+
+      if (i == *nchunks)
+	{
+	  if (*nchunks == DR_NADDR)
+	    return -1;
+
+	  chunks[i].addr = addr;
+	  chunks[i].len = size;
+	  chunks[i].type = type;
+	  (*nchunks)++;
+	}
+
+      addr += size;
+      len -= size;
+    }
 
   return 0;
 }
 
-/* Remove a watchpoint at address ADDR, which is assumed to be aligned
-   according to the length of the region to watch.  LEN_RW_BITS is the
-   value of the bits from DR7 which describes the length and access
-   type of the region watched by this watchpoint.  Return 0 on
-   success, -1 on failure.  */
+/* Compute in CHUNKS the regions the debug registers must watch for
+   all of DR_REGIONS.  Return their number, or -1 if there are not
+   enough debug registers.
+
+   Regions of write watchpoints are merged: adjacent and overlapping
+   regions are watched as one, and if WIDEN is non-zero, they are
+   widened to whole aligned blocks, which takes fewer registers.  The
+   inferior may then stop for writes to bytes no watchpoint watches,
+   but GDB finds the watched values unchanged and resumes it.  Read
+   and access watchpoints, and hardware breakpoints, report every hit,
+   so their regions are watched exactly, and only share the registers
+   of identical chunks.  */
 
 static int
-i386_remove_aligned_watchpoint (struct i386_debug_reg_state *state,
-				CORE_ADDR addr, unsigned len_rw_bits)
+i386_cover_regions (struct i386_dr_chunk *chunks, int widen)
 {
-  int i, retval = -1;
+  i386_dr_region_s *r;
+  CORE_ADDR start = 0, end = 0;
+  int have_write = 0;
+  int nchunks = 0;
+  int ix;
 
-  ALL_DEBUG_REGISTERS(i)
+  for (ix = 0; VEC_iterate (i386_dr_region_s, dr_regions, ix, r); ix++)
     {
-      if (!I386_DR_VACANT (state, i)
-	  && state->dr_mirror[i] == addr
-	  && I386_DR_GET_RW_LEN (state->dr_control_mirror, i) == len_rw_bits)
+      if (r->type != hw_write)
 	{
-	  if (--state->dr_ref_count[i] == 0) /* no longer in use?  */
-	    {
-	      /* Reset our mirror.  */
-	      state->dr_mirror[i] = 0;
-	      I386_DR_DISABLE (state, i);
-	    }
-	  retval = 0;
+	  if (i386_add_chunks (chunks, &nchunks,
+			       r->addr, r->len, r->type, 0) != 0)
+	    return -1;
+	  continue;
 	}
+
+      /* The regions are sorted by address, so a region that doesn't
+	 touch the current run of write regions starts a new one.  */
+      if (have_write && r->addr <= end)
+	{
+	  if (r->addr + r->len > end)
+	    end = r->addr + r->len;
+	  continue;
+	}
+
+      if (have_write
+	  && i386_add_chunks (chunks, &nchunks,
+			      start, end - start, hw_write, widen) != 0)
+	return -1;
+
+      start = r->addr;
+      end = r->addr + r->len;
+      have_write = 1;
     }
 
-  return retval;
+  if (have_write
+      && i386_add_chunks (chunks, &nchunks,
+			  start, end - start, hw_write, widen) != 0)
+    return -1;
+
+  return nchunks;
 }
 
-/* Insert or remove a (possibly non-aligned) watchpoint, or count the
-   number of debug registers required to watch a region at address
-   ADDR whose length is LEN for accesses of type TYPE.  Return 0 on
-   successful insertion or removal, a positive number when queried
-   about the number of registers, or -1 on failure.  If WHAT is not a
-   valid value, bombs through internal_error.  */
+/* Return the number of insertions of regions that CHUNK watches.  */
 
 static int
-i386_handle_nonaligned_watchpoint (struct i386_debug_reg_state *state,
-				   i386_wp_op_t what, CORE_ADDR addr, int len,
-				   enum target_hw_bp_type type)
+i386_chunk_users (const struct i386_dr_chunk *chunk)
 {
-  int retval = 0;
-  int max_wp_len = TARGET_HAS_DR_LEN_8 ? 8 : 4;
+  i386_dr_region_s *r;
+  int users = 0;
+  int ix;
 
-  static int size_try_array[8][8] =
-  {
-    {1, 1, 1, 1, 1, 1, 1, 1},	/* Trying size one.  */
-    {2, 1, 2, 1, 2, 1, 2, 1},	/* Trying size two.  */
-    {2, 1, 2, 1, 2, 1, 2, 1},	/* Trying size three.  */
-    {4, 1, 2, 1, 4, 1, 2, 1},	/* Trying size four.  */
-    {4, 1, 2, 1, 4, 1, 2, 1},	/* Trying size five.  */
-    {4, 1, 2, 1, 4, 1, 2, 1},	/* Trying size six.  */
-    {4, 1, 2, 1, 4, 1, 2, 1},	/* Trying size seven.  */
-    {8, 1, 2, 1, 4, 1, 2, 1},	/* Trying size eight.  */
-  };
+  for (ix = 0; VEC_iterate (i386_dr_region_s, dr_regions, ix, r); ix++)
+    if (r->type == chunk->type
+	&& r->addr < chunk->addr + chunk->len
+	&& chunk->addr < r->addr + r->len)
+      users += r->refcount;
 
-  while (len > 0)
+  return users;
+}
+
+/* Fill NEW_STATE with debug registers that watch the NCHUNKS regions
+   of CHUNKS.  A chunk the debug registers already watch keeps its
+   register, so that only the registers that change need updating.  */
+
+static void
+i386_assign_dregs (struct i386_debug_reg_state *new_state,
+		   const struct i386_dr_chunk *chunks, int nchunks)
+{
+  int reg_of_chunk[DR_NADDR];
+  int used[DR_NADDR];
+  int c, i;
+
+  i386_init_dregs (new_state);
+  new_state->dr_status_mirror = dr_mirror.dr_status_mirror;
+
+  ALL_DEBUG_REGISTERS (i)
+    used[i] = 0;
+
+  for (c = 0; c < nchunks; c++)
     {
-      int align = addr % max_wp_len;
-      /* Four (eight on AMD64) is the maximum length a debug register
-	 can watch.  */
-      int try = (len > max_wp_len ? (max_wp_len - 1) : len - 1);
-      int size = size_try_array[try][align];
+      unsigned len_rw = i386_length_and_rw_bits (chunks[c].len,
+						 chunks[c].type);
+
+      reg_of_chunk[c] = -1;
+      ALL_DEBUG_REGISTERS (i)
+	if (!used[i]
+	    && !I386_DR_VACANT (&dr_mirror, i)
+	    && dr_mirror.dr_mirror[i] == chunks[c].addr
+	    && I386_DR_GET_RW_LEN (dr_mirror.dr_control_mirror, i) == len_rw)
+	  {
+	    reg_of_chunk[c] = i;
+	    used[i] = 1;
+	    break;
+	  }
+    }
 
-      if (what == WP_COUNT)
-	{
-	  /* size_try_array[] is defined such that each iteration
-	     through the loop is guaranteed to produce an address and a
-	     size that can be watched with a single debug register.
-	     Thus, for counting the registers required to watch a
-	     region, we simply need to increment the count on each
-	     iteration.  */
-	  retval++;
-	}
-      else
-	{
-	  unsigned len_rw = i386_length_and_rw_bits (size, type);
-
-	  if (what == WP_INSERT)
-	    retval = i386_insert_aligned_watchpoint (state, addr, len_rw);
-	  else if (what == WP_REMOVE)
-	    retval = i386_remove_aligned_watchpoint (state, addr, len_rw);
-	  else
-	    internal_error (__FILE__, __LINE__, _("\
-Invalid value %d of operation in i386_handle_nonaligned_watchpoint.\n"),
-			    (int)what);
-	  if (retval)
+  /* Put the new chunks in vacant registers first, then in the ones
+     freed by chunks that went away.  */
+  for (c = 0; c < nchunks; c++)
+    if (reg_of_chunk[c] < 0)
+      {
+	ALL_DEBUG_REGISTERS (i)
+	  if (!used[i] && I386_DR_VACANT (&dr_mirror, i))
 	    break;
-	}
+	if (i == DR_NADDR)
+	  ALL_DEBUG_REGISTERS (i)
+	    if (!used[i])
+	      break;
+	gdb_assert (i < DR_NADDR);
 
-      addr += size;
-      len -= size;
+	reg_of_chunk[c] = i;
+	used[i] = 1;
+      }
+
+  for (c = 0; c < nchunks; c++)
+    {
+      i = reg_of_chunk[c];
+      new_state->dr_mirror[i] = chunks[c].addr;
+      new_state->dr_ref_count[i] = i386_chunk_users (&chunks[c]);
+      I386_DR_SET_RW_LEN (new_state, i,
+			  i386_length_and_rw_bits (chunks[c].len,
+						   chunks[c].type));
+      /* Note: we only enable the watchpoint locally, i.e. in the
+	 current task.  Currently, no i386 target allows or supports
+	 global watchpoints; however, if any target would want that in
+	 the future, GDB should probably provide a command to control
+	 whether to enable watchpoints globally or locally, and the
+	 code below should use global or local enable and slow-down
+	 flags as appropriate.  */
+      I386_DR_LOCAL_ENABLE (new_state, i);
     }
 
-  return retval;
+  if (nchunks > 0)
+    new_state->dr_control_mirror |= DR_LOCAL_SLOWDOWN;
+  new_state->dr_control_mirror &= I386_DR_CONTROL_MASK;
+}
+
+/* Record one more insertion of the region at address ADDR whose
+   length is LEN, for accesses of type TYPE.  */
+
+static void
+i386_add_region (CORE_ADDR addr, int len, enum target_hw_bp_type type)
+{
+  i386_dr_region_s *r;
+  i386_dr_region_s new_region;
+  int ix;
+
+  for (ix = 0; VEC_iterate (i386_dr_region_s, dr_regions, ix, r); ix++)
+    {
+      if (r->addr == addr && r->len == len && r->type == type)
+	{
+	  r->refcount++;
+	  return;
+	}
+      if (r->addr > addr)
+	break;
+    }
+
+  new_region.addr = addr;
+  new_region.len = len;
+  new_region.type = type;
+  new_region.refcount = 1;
+  VEC_safe_insert (i386_dr_region_s, dr_regions, ix, &new_region);
+}
+
+/* Forget one insertion of the region at address ADDR whose length is
+   LEN, for accesses of type TYPE.  Return 0 on success, -1 if there
+   is no such region.  */
+
+static int
+i386_remove_region (CORE_ADDR addr, int len, enum target_hw_bp_type type)
+{
+  i386_dr_region_s *r;
+  int ix;
+
+  for (ix = 0; VEC_iterate (i386_dr_region_s, dr_regions, ix, r); ix++)
+    if (r->addr == addr && r->len == len && r->type == type)
+      {
+	if (--r->refcount == 0)
+	  VEC_ordered_remove (i386_dr_region_s, dr_regions, ix);
+	return 0;
+      }
+
+  return -1;
 }
 
 /* Update the inferior's debug registers with the new debug registers
@@ -512,9 +679,10 @@ i386_update_inferior_debug_regs (struct i386_debug_reg_state *new_state)
 
   ALL_DEBUG_REGISTERS (i)
     {
-      if (I386_DR_VACANT (new_state, i) != I386_DR_VACANT (&dr_mirror, i))
+      if (!I386_DR_VACANT (new_state, i))
 	{
-	  if (!I386_DR_VACANT (new_state, i))
+	  if (I386_DR_VACANT (&dr_mirror, i)
+	      || new_state->dr_mirror[i] != dr_mirror.dr_mirror[i])
 	    {
 	      i386_dr_low.set_addr (i, new_state->dr_mirror[i]);
 
@@ -523,14 +691,12 @@ i386_update_inferior_debug_regs (struct i386_debug_reg_state *new_state)
 	      if (i386_dr_low.unset_status)
 		i386_dr_low.unset_status (I386_DR_WATCH_MASK (i));
 	    }
-	  else
-	    {
-	      if (i386_dr_low.reset_addr)
-		i386_dr_low.reset_addr (i);
-	    }
 	}
-      else
-	gdb_assert (new_state->dr_mirror[i] == dr_mirror.dr_mirror[i]);
+      else if (!I386_DR_VACANT (&dr_mirror, i))
+	{
+	  if (i386_dr_low.reset_addr)
+	    i386_dr_low.reset_addr (i);
+	}
     }
 
   if (new_state->dr_control_mirror != dr_mirror.dr_control_mirror)
@@ -539,6 +705,45 @@ i386_update_inferior_debug_regs (struct i386_debug_reg_state *new_state)
   dr_mirror = *new_state;
 }
 
+/* Fill NEW_STATE with debug registers that watch all of DR_REGIONS.
+   Return 0 on success, or -1 if the regions can't all be watched with
+   the debug registers.  */
+
+static int
+i386_layout_dregs (struct i386_debug_reg_state *new_state)
+{
+  struct i386_dr_chunk chunks[DR_NADDR];
+  int nchunks;
+
+  nchunks = i386_cover_regions (chunks, 0);
+  if (nchunks < 0)
+    nchunks = i386_cover_regions (chunks, 1);
+  if (nchunks < 0)
+    return -1;
+
+  i386_assign_dregs (new_state, chunks, nchunks);
+  return 0;
+}
+
+/* Recompute the debug registers from DR_REGIONS, and update the
+   inferior's to match.  Return 0 on success, or -1 if the regions
+   can't all be watched with the debug registers.  */
+
+static int
+i386_update_dregs (void)
+{
+  struct i386_debug_reg_state new_state;
+
+  if (!i386_dr_low.set_addr || !i386_dr_low.set_control)
+    return -1;
+
+  if (i386_layout_dregs (&new_state) != 0)
+    return -1;
+
+  i386_update_inferior_debug_regs (&new_state);
+  return 0;
+}
+
 /* Insert a watchpoint to watch a memory region which starts at
    address ADDR and whose length is LEN bytes.  Watch memory accesses
    of the type TYPE.  Return 0 on success, -1 on failure.  */
@@ -548,27 +753,14 @@ i386_insert_watchpoint (CORE_ADDR addr, int len, int type,
 			struct expression *cond)
 {
   int retval;
-  /* Work on a local copy of the debug registers, and on success,
-     commit the change back to the inferior.  */
-  struct i386_debug_reg_state local_state = dr_mirror;
 
   if (type == hw_read)
     return 1; /* unsupported */
 
-  if (((len != 1 && len !=2 && len !=4) && !(TARGET_HAS_DR_LEN_8 && len == 8))
-      || addr % len != 0)
-    retval = i386_handle_nonaligned_watchpoint (&local_state,
-						WP_INSERT, addr, len, type);
-  else
-    {
-      unsigned len_rw = i386_length_and_rw_bits (len, type);
-
-      retval = i386_insert_aligned_watchpoint (&local_state,
-					       addr, len_rw);
-    }
-
-  if (retval == 0)
-    i386_update_inferior_debug_regs (&local_state);
+  i386_add_region (addr, len, type);
+  retval = i386_update_dregs ();
+  if (retval != 0)
+    i386_remove_region (addr, len, type);
 
   if (maint_show_dr)
     i386_show_dr (&dr_mirror, "insert_watchpoint", addr, len, type);
@@ -583,25 +775,12 @@ static int
 i386_remove_watchpoint (CORE_ADDR addr, int len, int type,
 			struct expression *cond)
 {
-  int retval;
-  /* Work on a local copy of the debug registers, and on success,
-     commit the change back to the inferior.  */
-  struct i386_debug_reg_state local_state = dr_mirror;
-
-  if (((len != 1 && len !=2 && len !=4) && !(TARGET_HAS_DR_LEN_8 && len == 8))
-      || addr % len != 0)
-    retval = i386_handle_nonaligned_watchpoint (&local_state,
-						WP_REMOVE, addr, len, type);
-  else
-    {
-      unsigned len_rw = i386_length_and_rw_bits (len, type);
-
-      retval = i386_remove_aligned_watchpoint (&local_state,
-					       addr, len_rw);
-    }
+  /* Removing a region never needs more registers, so updating the
+     registers can't fail.  */
+  int retval = i386_remove_region (addr, len, type);
 
   if (retval == 0)
-    i386_update_inferior_debug_regs (&local_state);
+    retval = i386_update_dregs ();
 
   if (maint_show_dr)
     i386_show_dr (&dr_mirror, "remove_watchpoint", addr, len, type);
@@ -610,18 +789,25 @@ i386_remove_watchpoint (CORE_ADDR addr, int len, int type,
 }
 
 /* Return non-zero if we can watch a memory region that starts at
-   address ADDR and whose length is LEN bytes.  */
+   address ADDR and whose length is LEN bytes.  This only considers
+   the region alone; whether it fits with the regions already watched
+   is found when inserting it.  */
 
 static int
 i386_region_ok_for_watchpoint (CORE_ADDR addr, int len)
 {
-  int nregs;
-
-  /* Compute how many aligned watchpoints we would need to cover this
-     region.  */
-  nregs = i386_handle_nonaligned_watchpoint (&dr_mirror,
-					     WP_COUNT, addr, len, hw_write);
-  return nregs <= DR_NADDR ? 1 : 0;
+  struct i386_dr_chunk chunks[DR_NADDR];
+  int nchunks = 0;
+
+  /* See if the aligned chunks that cover this region fit in the debug
+     registers.  */
+  if (i386_add_chunks (chunks, &nchunks, addr, len, hw_write, 0) == 0)
+    return 1;
+
+  /* A write watchpoint may also be watched with whole aligned blocks
+     around the region.  */
+  nchunks = 0;
+  return i386_add_chunks (chunks, &nchunks, addr, len, hw_write, 1) == 0;
 }
 
 /* If the inferior has some watchpoint that triggered, set the
@@ -676,22 +862,46 @@ i386_stopped_by_watchpoint (void)
   return i386_stopped_data_address (&current_target, &addr);
 }
 
+/* Return non-zero if a watchpoint hit that i386_stopped_data_address
+   reported at ADDR may be for the region of LENGTH bytes at START.
+   The debug register of a write watchpoint may watch more than one
+   region, or bytes around them, so in that case any region that
+   overlaps the register's may have been written.  */
+
+static int
+i386_watchpoint_addr_within_range (struct target_ops *target,
+				   CORE_ADDR addr,
+				   CORE_ADDR start, int length)
+{
+  int i;
+
+  ALL_DEBUG_REGISTERS (i)
+    {
+      unsigned len_rw = I386_DR_GET_RW_LEN (dr_mirror.dr_control_mirror, i);
+
+      if (!I386_DR_VACANT (&dr_mirror, i)
+	  && dr_mirror.dr_mirror[i] == addr
+	  && i386_type_of_rw_bits (len_rw) == hw_write)
+	return (addr < start + length
+		&& start < addr + i386_length_of_rw_bits (len_rw));
+    }
+
+  return addr >= start && addr < start + length;
+}
+
 /* Insert a hardware-assisted breakpoint at BP_TGT->placed_address.
    Return 0 on success, EBUSY on failure.  */
 static int
 i386_insert_hw_breakpoint (struct gdbarch *gdbarch,
 			   struct bp_target_info *bp_tgt)
 {
-  unsigned len_rw = i386_length_and_rw_bits (1, hw_execute);
   CORE_ADDR addr = bp_tgt->placed_address;
-  /* Work on a local copy of the debug registers, and on success,
-     commit the change back to the inferior.  */
-  struct i386_debug_reg_state local_state = dr_mirror;
-  int retval = i386_insert_aligned_watchpoint (&local_state,
-					       addr, len_rw) ? EBUSY : 0;
+  int retval;
 
-  if (retval == 0)
-    i386_update_inferior_debug_regs (&local_state);
+  i386_add_region (addr, 1, hw_execute);
+  retval = i386_update_dregs () ? EBUSY : 0;
+  if (retval != 0)
+    i386_remove_region (addr, 1, hw_execute);
 
   if (maint_show_dr)
     i386_show_dr (&dr_mirror, "insert_hwbp", addr, 1, hw_execute);
@@ -706,16 +916,11 @@ static int
 i386_remove_hw_breakpoint (struct gdbarch *gdbarch,
 			   struct bp_target_info *bp_tgt)
 {
-  unsigned len_rw = i386_length_and_rw_bits (1, hw_execute);
   CORE_ADDR addr = bp_tgt->placed_address;
-  /* Work on a local copy of the debug registers, and on success,
-     commit the change back to the inferior.  */
-  struct i386_debug_reg_state local_state = dr_mirror;
-  int retval = i386_remove_aligned_watchpoint (&local_state,
-					       addr, len_rw);
+  int retval = i386_remove_region (addr, 1, hw_execute);
 
   if (retval == 0)
-    i386_update_inferior_debug_regs (&local_state);
+    retval = i386_update_dregs ();
 
   if (maint_show_dr)
     i386_show_dr (&dr_mirror, "remove_hwbp", addr, 1, hw_execute);
@@ -723,6 +928,46 @@ i386_remove_hw_breakpoint (struct gdbarch *gdbarch,
   return retval;
 }
 
+/* Describe in REGS, which has room for MAX entries, the debug
+   registers that would watch the NWANTED regions of WANTED, and
+   return their number, or -1 if the regions don't fit.  */
+
+static int
+i386_debug_registers (const struct watch_region *wanted, int nwanted,
+		      struct watch_region *regs, int max)
+{
+  VEC (i386_dr_region_s) *saved_regions = dr_regions;
+  struct i386_debug_reg_state state;
+  int retval, i;
+
+  /* Lay out the wanted regions as if they were the ones inserted.  */
+  dr_regions = NULL;
+  for (i = 0; i < nwanted; i++)
+    if (wanted[i].type != hw_read)
+      i386_add_region (wanted[i].addr, wanted[i].len, wanted[i].type);
+  retval = i386_layout_dregs (&state);
+  VEC_free (i386_dr_region_s, dr_regions);
+  dr_regions = saved_regions;
+
+  if (retval != 0)
+    return -1;
+
+  ALL_DEBUG_REGISTERS (i)
+    {
+      unsigned len_rw = I386_DR_GET_RW_LEN (state.dr_control_mirror, i);
+
+      if (i >= max)
+	break;
+
+      regs[i].addr = state.dr_mirror[i];
+      regs[i].len = (I386_DR_VACANT (&state, i)
+		     ? 0 : i386_length_of_rw_bits (len_rw));
+      regs[i].type = i386_type_of_rw_bits (len_rw);
+    }
+
+  return DR_NADDR;
+}
+
 /* Returns the number of hardware watchpoints of type TYPE that we can
    set.  Value is positive if we can set CNT watchpoints, zero if
    setting watchpoints of type TYPE is not supported, and negative if
@@ -738,7 +983,7 @@ i386_remove_hw_breakpoint (struct gdbarch *gdbarch,
    extreme example, consider the case where all the watchpoints watch
    the same address and the same region length: then we can handle a
    virtually unlimited number of watchpoints, due to debug register
-   sharing implemented via reference counts in i386-nat.c.  */
+   sharing implemented by i386_cover_regions.  */
 
 static int
 i386_can_use_hw_breakpoint (int type, int cnt, int othertype)
@@ -779,10 +1024,12 @@ i386_use_watchpoints (struct target_ops *t)
   t->to_region_ok_for_hw_watchpoint = i386_region_ok_for_watchpoint;
   t->to_stopped_by_watchpoint = i386_stopped_by_watchpoint;
   t->to_stopped_data_address = i386_stopped_data_address;
+  t->to_watchpoint_addr_within_range = i386_watchpoint_addr_within_range;
   t->to_insert_watchpoint = i386_insert_watchpoint;
   t->to_remove_watchpoint = i386_remove_watchpoint;
   t->to_insert_hw_breakpoint = i386_insert_hw_breakpoint;
   t->to_remove_hw_breakpoint = i386_remove_hw_breakpoint;
+  t->to_debug_registers = i386_debug_registers;
 }
 
 void
@@ -539,23 +539,44 @@ i386_displaced_step_copy_insn (struct gdbarch *gdbarch,
 			       struct regcache *regs)
 {
   size_t len = gdbarch_max_insn_length (gdbarch);
-  gdb_byte *buf = xmalloc (len);
-
-  read_memory (from, buf, len);
+  gdb_byte *buf = xcalloc (1, len);
+  LONGEST got;
+
+  /* The instruction may be among the last bytes of its segment, as
+     happens at the end of the text of small static programs, like
+     those run by DECREE.  Copy what can be read; the rest of the
+     copy area is never executed.  */
+  got = target_read (current_target.beneath, TARGET_OBJECT_MEMORY, NULL,
+		     buf, from, len);
+  if (got <= 0)
+    {
+      xfree (buf);
+      memory_error (EIO, from);
+    }
 
   /* GDB may get control back after the insn after the syscall.
      Presumably this is a kernel bug.
-     If this is a syscall, make sure there's a nop afterwards.  */
+     If this is a syscall, make sure there's a nop afterwards, if
+     there's room for one.  */
   {
     int syscall_length;
     gdb_byte *insn;
 
     insn = i386_skip_prefixes (buf, len);
-    if (insn != NULL && i386_syscall_p (insn, &syscall_length))
+    if (insn != NULL && i386_syscall_p (insn, &syscall_length)
+	&& insn - buf + syscall_length < len)
       insn[syscall_length] = NOP_OPCODE;
   }
 
-  write_memory (to, buf, len);
+  /* Breakpoints inserted in the copy area would corrupt the copy, and
+     the entry point function holding it is small in DECREE programs;
+     write over them.  Restoring the area with write_memory once the
+     step is done puts them back.  */
+  if (target_write_raw_memory (to, buf, len) != 0)
+    {
+      xfree (buf);
+      memory_error (EIO, to);
+    }
 
   if (debug_displaced)
     {
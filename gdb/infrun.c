@@ -1029,15 +1029,19 @@ static ptid_t deferred_step_ptid;
 
    In non-stop mode, we can have independent and simultaneous step
    requests, so more than one thread may need to simultaneously step
-   over a breakpoint.  The current implementation assumes there is
-   only one scratch space per process.  In this case, we have to
-   serialize access to the scratch space.  If thread A wants to step
-   over a breakpoint, but we are currently waiting for some other
-   thread to complete a displaced step, we leave thread A stopped and
-   place it in the displaced_step_request_queue.  Whenever a displaced
-   step finishes, we pick the next thread in the queue and start a new
-   displaced step operation on it.  See displaced_step_prepare and
-   displaced_step_fixup for details.  */
+   over a breakpoint.  The scratch space of a process is divided into
+   slots of gdbarch_max_insn_length bytes each, laid out one after the
+   other from gdbarch_displaced_step_location, and each slot can hold
+   the copy of one thread.  So that the slots never spill over into
+   code other threads may be running, they are confined to the
+   function holding the scratch space; there is always at least one.
+   If thread A wants to step over a breakpoint, but all the slots are
+   in use by threads waiting to complete a displaced step, we leave
+   thread A stopped and place it in the displaced_step_request_queue.
+   Whenever a displaced step finishes, we pick the next thread in the
+   queue and start a new displaced step operation on it, in the slot
+   just freed.  See displaced_step_prepare and displaced_step_fixup
+   for details.  */
 
 struct displaced_step_request
 {
@@ -1045,21 +1049,15 @@ struct displaced_step_request
   struct displaced_step_request *next;
 };
 
-/* Per-inferior displaced stepping state.  */
-struct displaced_step_inferior_state
-{
-  /* Pointer to next in linked list.  */
-  struct displaced_step_inferior_state *next;
-
-  /* The process this displaced step state refers to.  */
-  int pid;
-
-  /* A queue of pending displaced stepping requests.  One entry per
-     thread that needs to do a displaced step.  */
-  struct displaced_step_request *step_request_queue;
+/* The most scratch space slots a process can have.  */
+#define MAX_DISPLACED_STEP_SLOTS 16
 
+/* A slot of a process's scratch space, in which one thread at a time
+   steps a displaced instruction.  */
+struct displaced_step_slot
+{
   /* If this is not null_ptid, this is the thread carrying out a
-     displaced single-step in process PID.  This thread's state will
+     displaced single-step in this slot.  This thread's state will
      require fixing up once it has completed its step.  */
   ptid_t step_ptid;
 
@@ -1078,6 +1076,23 @@ struct displaced_step_inferior_state
   gdb_byte *step_saved_copy;
 };
 
+/* Per-inferior displaced stepping state.  */
+struct displaced_step_inferior_state
+{
+  /* Pointer to next in linked list.  */
+  struct displaced_step_inferior_state *next;
+
+  /* The process this displaced step state refers to.  */
+  int pid;
+
+  /* A queue of pending displaced stepping requests.  One entry per
+     thread that needs to do a displaced step.  */
+  struct displaced_step_request *step_request_queue;
+
+  /* The slots of the process's scratch space.  */
+  struct displaced_step_slot slots[MAX_DISPLACED_STEP_SLOTS];
+};
+
 /* The list of states of processes involved in displaced stepping
    presently.  */
 static struct displaced_step_inferior_state *displaced_step_inferior_states;
@@ -1121,8 +1136,46 @@ add_displaced_stepping_state (int pid)
   return state;
 }
 
+/* Return the slot in which thread PTID is doing a displaced step in
+   the process whose state is DISPLACED, or NULL if it isn't doing
+   one.  */
+
+static struct displaced_step_slot *
+get_displaced_step_slot (struct displaced_step_inferior_state *displaced,
+			 ptid_t ptid)
+{
+  int i;
+
+  if (displaced == NULL || ptid_equal (ptid, null_ptid))
+    return NULL;
+
+  for (i = 0; i < MAX_DISPLACED_STEP_SLOTS; i++)
+    if (ptid_equal (displaced->slots[i].step_ptid, ptid))
+      return &displaced->slots[i];
+
+  return NULL;
+}
+
+/* Return non-zero if any thread of the process whose state is
+   DISPLACED is doing a displaced step.  */
+
+static int
+displaced_step_in_progress (struct displaced_step_inferior_state *displaced)
+{
+  int i;
+
+  if (displaced == NULL)
+    return 0;
+
+  for (i = 0; i < MAX_DISPLACED_STEP_SLOTS; i++)
+    if (!ptid_equal (displaced->slots[i].step_ptid, null_ptid))
+      return 1;
+
+  return 0;
+}
+
 /* If inferior is in displaced stepping, and ADDR equals to starting address
-   of copy area, return corresponding displaced_step_closure.  Otherwise,
+   of a copy area, return corresponding displaced_step_closure.  Otherwise,
    return NULL.  */
 
 struct displaced_step_closure*
@@ -1130,11 +1183,16 @@ get_displaced_step_closure_by_addr (CORE_ADDR addr)
 {
   struct displaced_step_inferior_state *displaced
     = get_displaced_stepping_state (ptid_get_pid (inferior_ptid));
+  int i;
+
+  if (displaced == NULL)
+    return NULL;
 
   /* If checking the mode of displaced instruction in copy area.  */
-  if (displaced && !ptid_equal (displaced->step_ptid, null_ptid)
-     && (displaced->step_copy == addr))
-    return displaced->step_closure;
+  for (i = 0; i < MAX_DISPLACED_STEP_SLOTS; i++)
+    if (!ptid_equal (displaced->slots[i].step_ptid, null_ptid)
+	&& displaced->slots[i].step_copy == addr)
+      return displaced->slots[i].step_closure;
 
   return NULL;
 }
@@ -1154,7 +1212,11 @@ remove_displaced_stepping_state (int pid)
     {
       if (it->pid == pid)
 	{
+	  int i;
+
 	  *prev_next_p = it->next;
+	  for (i = 0; i < MAX_DISPLACED_STEP_SLOTS; i++)
+	    xfree (it->slots[i].step_saved_copy);
 	  xfree (it);
 	  return;
 	}
@@ -1223,27 +1285,91 @@ use_displaced_stepping (struct gdbarch *gdbarch)
 	  && !RECORD_IS_USED);
 }
 
+/* The number of scratch space slots each process may use at most, as
+   set by "set displaced-stepping-slots".  */
+
+static unsigned int displaced_step_slots = 4;
+
+/* The value the user last gave to "set displaced-stepping-slots",
+   before it is checked.  */
+
+static unsigned int displaced_step_slots_1 = 4;
+
+static void
+set_displaced_step_slots (char *args, int from_tty,
+			  struct cmd_list_element *c)
+{
+  if (displaced_step_slots_1 < 1
+      || displaced_step_slots_1 > MAX_DISPLACED_STEP_SLOTS)
+    {
+      unsigned int slots = displaced_step_slots_1;
+
+      displaced_step_slots_1 = displaced_step_slots;
+      error (_("The number of displaced stepping slots must be "
+	       "between 1 and %d, not %u."),
+	     MAX_DISPLACED_STEP_SLOTS, slots);
+    }
+
+  displaced_step_slots = displaced_step_slots_1;
+}
+
+static void
+show_displaced_step_slots (struct ui_file *file, int from_tty,
+			   struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file,
+		    _("The number of displaced stepping slots "
+		      "per process is %s.\n"),
+		    value);
+}
+
+/* Return the number of scratch space slots that can be used in the
+   process, given that the first one starts at COPY and that GDBARCH
+   uses slots of LEN bytes.  The slots must stay within the function
+   holding COPY, if it is known; other threads of the process may run
+   any code past it while steps are in progress.  */
+
+static int
+displaced_step_slot_count (struct gdbarch *gdbarch, CORE_ADDR copy,
+			   ULONGEST len)
+{
+  CORE_ADDR func_end;
+  ULONGEST room;
+
+  if (displaced_step_slots == 1 || len == 0)
+    return 1;
+
+  if (!find_pc_partial_function (copy, NULL, NULL, &func_end)
+      || func_end <= copy)
+    return 1;
+
+  room = func_end - copy;
+  if (room / len < 1)
+    return 1;
+  return min (displaced_step_slots, room / len);
+}
+
 /* Clean out any stray displaced stepping state.  */
 static void
-displaced_step_clear (struct displaced_step_inferior_state *displaced)
+displaced_step_clear (struct displaced_step_slot *slot)
 {
   /* Indicate that there is no cleanup pending.  */
-  displaced->step_ptid = null_ptid;
+  slot->step_ptid = null_ptid;
 
-  if (displaced->step_closure)
+  if (slot->step_closure)
     {
-      gdbarch_displaced_step_free_closure (displaced->step_gdbarch,
-                                           displaced->step_closure);
-      displaced->step_closure = NULL;
+      gdbarch_displaced_step_free_closure (slot->step_gdbarch,
+                                           slot->step_closure);
+      slot->step_closure = NULL;
     }
 }
 
 static void
 displaced_step_clear_cleanup (void *arg)
 {
-  struct displaced_step_inferior_state *state = arg;
+  struct displaced_step_slot *slot = arg;
 
-  displaced_step_clear (state);
+  displaced_step_clear (slot);
 }
 
 /* Dump LEN bytes at BUF in hex to FILE, followed by a newline.  */
@@ -1283,20 +1409,52 @@ displaced_step_prepare (ptid_t ptid)
   ULONGEST len;
   struct displaced_step_closure *closure;
   struct displaced_step_inferior_state *displaced;
+  struct displaced_step_slot *slot = NULL;
+  int i, count;
 
   /* We should never reach this function if the architecture does not
      support displaced stepping.  */
   gdb_assert (gdbarch_displaced_step_copy_insn_p (gdbarch));
 
-  /* We have to displaced step one thread at a time, as we only have
-     access to a single scratch space per inferior.  */
+  /* We can only have as many threads displaced stepping at a time as
+     there are slots in the scratch space of the inferior.  */
 
   displaced = add_displaced_stepping_state (ptid_get_pid (ptid));
 
-  if (!ptid_equal (displaced->step_ptid, null_ptid))
+  old_cleanups = save_inferior_ptid ();
+  inferior_ptid = ptid;
+
+  copy = gdbarch_displaced_step_location (gdbarch);
+  len = gdbarch_max_insn_length (gdbarch);
+
+  /* Prefer a slot with no breakpoint inserted in it.  Writing the
+     copy leaves inserted breakpoints in place, which would corrupt
+     it.  With a small entry point function, as in DECREE programs,
+     breakpoints near the start of the program often share the
+     scratch space.  */
+  count = displaced_step_slot_count (gdbarch, copy, len);
+  for (i = 0; i < count; i++)
+    if (ptid_equal (displaced->slots[i].step_ptid, null_ptid)
+	&& !software_breakpoint_inserted_in_range
+	      (get_regcache_aspace (regcache), copy + i * len, len))
+      {
+	slot = &displaced->slots[i];
+	break;
+      }
+  if (slot == NULL)
+    for (i = 0; i < count; i++)
+      if (ptid_equal (displaced->slots[i].step_ptid, null_ptid))
+	{
+	  slot = &displaced->slots[i];
+	  break;
+	}
+  if (slot != NULL)
+    copy += i * len;
+
+  if (slot == NULL)
     {
-      /* Already waiting for a displaced step to finish.  Defer this
-	 request and place in queue.  */
+      /* Already waiting for displaced steps to finish in all the
+	 slots.  Defer this request and place in queue.  */
       struct displaced_step_request *req, *new_req;
 
       if (debug_displaced)
@@ -1319,37 +1477,33 @@ displaced_step_prepare (ptid_t ptid)
       else
 	displaced->step_request_queue = new_req;
 
+      do_cleanups (old_cleanups);
       return 0;
     }
   else
     {
       if (debug_displaced)
 	fprintf_unfiltered (gdb_stdlog,
-			    "displaced: stepping %s now\n",
-			    target_pid_to_str (ptid));
+			    "displaced: stepping %s now in slot %d\n",
+			    target_pid_to_str (ptid), i);
     }
 
-  displaced_step_clear (displaced);
-
-  old_cleanups = save_inferior_ptid ();
-  inferior_ptid = ptid;
+  displaced_step_clear (slot);
 
   original = regcache_read_pc (regcache);
 
-  copy = gdbarch_displaced_step_location (gdbarch);
-  len = gdbarch_max_insn_length (gdbarch);
-
   /* Save the original contents of the copy area.  */
-  displaced->step_saved_copy = xmalloc (len);
+  xfree (slot->step_saved_copy);
+  slot->step_saved_copy = xmalloc (len);
   ignore_cleanups = make_cleanup (free_current_contents,
-				  &displaced->step_saved_copy);
-  read_memory (copy, displaced->step_saved_copy, len);
+				  &slot->step_saved_copy);
+  read_memory (copy, slot->step_saved_copy, len);
   if (debug_displaced)
     {
       fprintf_unfiltered (gdb_stdlog, "displaced: saved %s: ",
 			  paddress (gdbarch, copy));
       displaced_step_dump_bytes (gdb_stdlog,
-				 displaced->step_saved_copy,
+				 slot->step_saved_copy,
 				 len);
     };
 
@@ -1361,13 +1515,13 @@ displaced_step_prepare (ptid_t ptid)
 
   /* Save the information we need to fix things up if the step
      succeeds.  */
-  displaced->step_ptid = ptid;
-  displaced->step_gdbarch = gdbarch;
-  displaced->step_closure = closure;
-  displaced->step_original = original;
-  displaced->step_copy = copy;
+  slot->step_ptid = ptid;
+  slot->step_gdbarch = gdbarch;
+  slot->step_closure = closure;
+  slot->step_original = original;
+  slot->step_copy = copy;
 
-  make_cleanup (displaced_step_clear_cleanup, displaced);
+  make_cleanup (displaced_step_clear_cleanup, slot);
 
   /* Resume execution at the copy.  */
   regcache_write_pc (regcache, copy);
@@ -1394,21 +1548,20 @@ write_memory_ptid (ptid_t ptid, CORE_ADDR memaddr,
   do_cleanups (ptid_cleanup);
 }
 
-/* Restore the contents of the copy area for thread PTID.  */
+/* Restore the contents of the copy area of SLOT for thread PTID.  */
 
 static void
-displaced_step_restore (struct displaced_step_inferior_state *displaced,
-			ptid_t ptid)
+displaced_step_restore (struct displaced_step_slot *slot, ptid_t ptid)
 {
-  ULONGEST len = gdbarch_max_insn_length (displaced->step_gdbarch);
+  ULONGEST len = gdbarch_max_insn_length (slot->step_gdbarch);
 
-  write_memory_ptid (ptid, displaced->step_copy,
-		     displaced->step_saved_copy, len);
+  write_memory_ptid (ptid, slot->step_copy,
+		     slot->step_saved_copy, len);
   if (debug_displaced)
     fprintf_unfiltered (gdb_stdlog, "displaced: restored %s %s\n",
 			target_pid_to_str (ptid),
-			paddress (displaced->step_gdbarch,
-				  displaced->step_copy));
+			paddress (slot->step_gdbarch,
+				  slot->step_copy));
 }
 
 static void
@@ -1417,29 +1570,26 @@ displaced_step_fixup (ptid_t event_ptid, enum target_signal signal)
   struct cleanup *old_cleanups;
   struct displaced_step_inferior_state *displaced
     = get_displaced_stepping_state (ptid_get_pid (event_ptid));
+  struct displaced_step_slot *slot;
 
-  /* Was any thread of this process doing a displaced step?  */
-  if (displaced == NULL)
-    return;
-
-  /* Was this event for the pid we displaced?  */
-  if (ptid_equal (displaced->step_ptid, null_ptid)
-      || ! ptid_equal (displaced->step_ptid, event_ptid))
+  /* Was this event for a thread of this process we displaced?  */
+  slot = get_displaced_step_slot (displaced, event_ptid);
+  if (slot == NULL)
     return;
 
-  old_cleanups = make_cleanup (displaced_step_clear_cleanup, displaced);
+  old_cleanups = make_cleanup (displaced_step_clear_cleanup, slot);
 
-  displaced_step_restore (displaced, displaced->step_ptid);
+  displaced_step_restore (slot, slot->step_ptid);
 
   /* Did the instruction complete successfully?  */
   if (signal == TARGET_SIGNAL_TRAP)
     {
       /* Fix up the resulting state.  */
-      gdbarch_displaced_step_fixup (displaced->step_gdbarch,
-                                    displaced->step_closure,
-                                    displaced->step_original,
-                                    displaced->step_copy,
-                                    get_thread_regcache (displaced->step_ptid));
+      gdbarch_displaced_step_fixup (slot->step_gdbarch,
+                                    slot->step_closure,
+                                    slot->step_original,
+                                    slot->step_copy,
+                                    get_thread_regcache (slot->step_ptid));
     }
   else
     {
@@ -1448,13 +1598,13 @@ displaced_step_fixup (ptid_t event_ptid, enum target_signal signal)
       struct regcache *regcache = get_thread_regcache (event_ptid);
       CORE_ADDR pc = regcache_read_pc (regcache);
 
-      pc = displaced->step_original + (pc - displaced->step_copy);
+      pc = slot->step_original + (pc - slot->step_copy);
       regcache_write_pc (regcache, pc);
     }
 
   do_cleanups (old_cleanups);
 
-  displaced->step_ptid = null_ptid;
+  slot->step_ptid = null_ptid;
 
   /* Are there any pending displaced stepping requests?  If so, run
      one now.  Leave the state object around, since we're likely to
@@ -1486,7 +1636,12 @@ displaced_step_fixup (ptid_t event_ptid, enum target_signal signal)
 				"displaced: stepping queued %s now\n",
 				target_pid_to_str (ptid));
 
-	  displaced_step_prepare (ptid);
+	  if (!displaced_step_prepare (ptid))
+	    {
+	      /* Fewer slots are usable now than before; wait for
+		 another one to free up.  */
+	      break;
+	    }
 
 	  gdbarch = get_regcache_arch (regcache);
 
@@ -1501,8 +1656,9 @@ displaced_step_fixup (ptid_t event_ptid, enum target_signal signal)
 	      displaced_step_dump_bytes (gdb_stdlog, buf, sizeof (buf));
 	    }
 
+	  slot = get_displaced_step_slot (displaced, ptid);
 	  if (gdbarch_displaced_step_hw_singlestep (gdbarch,
-						    displaced->step_closure))
+						    slot->step_closure))
 	    target_resume (ptid, 1, TARGET_SIGNAL_0);
 	  else
 	    target_resume (ptid, 0, TARGET_SIGNAL_0);
@@ -1557,8 +1713,11 @@ infrun_thread_ptid_changed (ptid_t old_ptid, ptid_t new_ptid)
        displaced;
        displaced = displaced->next)
     {
-      if (ptid_equal (displaced->step_ptid, old_ptid))
-	displaced->step_ptid = new_ptid;
+      int i;
+
+      for (i = 0; i < MAX_DISPLACED_STEP_SLOTS; i++)
+	if (ptid_equal (displaced->slots[i].step_ptid, old_ptid))
+	  displaced->slots[i].step_ptid = new_ptid;
 
       for (it = displaced->step_request_queue; it; it = it->next)
 	if (ptid_equal (it->ptid, old_ptid))
@@ -1771,8 +1930,9 @@ a command like `return' or `jump' to continue execution."));
 	}
 
       displaced = get_displaced_stepping_state (ptid_get_pid (inferior_ptid));
-      step = gdbarch_displaced_step_hw_singlestep (gdbarch,
-						   displaced->step_closure);
+      step = gdbarch_displaced_step_hw_singlestep
+	(gdbarch, get_displaced_step_slot (displaced,
+					   inferior_ptid)->step_closure);
     }
 
   /* Do we need to do it the hard way, w/temp breakpoints?  */
@@ -2596,7 +2756,7 @@ prepare_for_detach (void)
 
   /* Is any thread of this process displaced stepping?  If not,
      there's nothing else to do.  */
-  if (displaced == NULL || ptid_equal (displaced->step_ptid, null_ptid))
+  if (!displaced_step_in_progress (displaced))
     return;
 
   if (debug_infrun)
@@ -2606,7 +2766,7 @@ prepare_for_detach (void)
   old_chain_1 = make_cleanup_restore_integer (&inf->detaching);
   inf->detaching = 1;
 
-  while (!ptid_equal (displaced->step_ptid, null_ptid))
+  while (displaced_step_in_progress (displaced))
     {
       struct cleanup *old_chain_2;
       struct execution_control_state ecss;
@@ -3446,10 +3606,12 @@ handle_inferior_event (struct execution_control_state *ecs)
 	struct gdbarch *gdbarch = get_regcache_arch (regcache);
 	struct displaced_step_inferior_state *displaced
 	  = get_displaced_stepping_state (ptid_get_pid (ecs->ptid));
+	struct displaced_step_slot *slot
+	  = get_displaced_step_slot (displaced, ecs->ptid);
 
 	/* If checking displaced stepping is supported, and thread
 	   ecs->ptid is displaced stepping.  */
-	if (displaced && ptid_equal (displaced->step_ptid, ecs->ptid))
+	if (slot != NULL)
 	  {
 	    struct inferior *parent_inf
 	      = find_inferior_pid (ptid_get_pid (ecs->ptid));
@@ -3465,8 +3627,16 @@ handle_inferior_event (struct execution_control_state *ecs)
 
 	    if (ecs->ws.kind == TARGET_WAITKIND_FORKED)
 	      {
-		/* Restore scratch pad for child process.  */
-		displaced_step_restore (displaced, ecs->ws.value.related_pid);
+		int i;
+
+		/* Restore scratch pad for child process.  The child
+		   also got the copies of the other threads still
+		   displaced stepping in the parent.  */
+		displaced_step_restore (slot, ecs->ws.value.related_pid);
+		for (i = 0; i < MAX_DISPLACED_STEP_SLOTS; i++)
+		  if (!ptid_equal (displaced->slots[i].step_ptid, null_ptid))
+		    displaced_step_restore (&displaced->slots[i],
+					    ecs->ws.value.related_pid);
 	      }
 
 	    /* Since the vfork/fork syscall instruction was executed in the scratchpad,
@@ -4000,9 +4170,11 @@ handle_inferior_event (struct execution_control_state *ecs)
 	deprecated_context_hook (pid_to_thread_id (ecs->ptid));
     }
 
-  /* At this point, get hold of the now-current thread's frame.  */
-  frame = get_current_frame ();
-  gdbarch = get_frame_arch (frame);
+  /* At this point, get hold of the now-current thread's architecture.
+     Its frames are only built if something asks for them: most
+     breakpoint hits whose condition or Python "stop" method says not
+     to stop are resumed without any.  */
+  gdbarch = get_regcache_arch (get_current_regcache ());
 
   if (singlestep_breakpoints_inserted_p)
     {
@@ -4113,7 +4285,7 @@ handle_inferior_event (struct execution_control_state *ecs)
 	 with a delay slot.  It needs to be stepped twice, once for
 	 the instruction and once for the delay slot.  */
       int step_through_delay
-	= gdbarch_single_step_through_delay (gdbarch, frame);
+	= gdbarch_single_step_through_delay (gdbarch, get_current_frame ());
 
       if (debug_infrun && step_through_delay)
 	fprintf_unfiltered (gdb_stdlog, "infrun: step through delay\n");
@@ -4271,10 +4443,9 @@ handle_inferior_event (struct execution_control_state *ecs)
 
 process_event_stop_test:
 
-  /* Re-fetch current thread's frame in case we did a
+  /* Re-fetch current thread's architecture in case we did a
      "goto process_event_stop_test" above.  */
-  frame = get_current_frame ();
-  gdbarch = get_frame_arch (frame);
+  gdbarch = get_regcache_arch (get_current_regcache ());
 
   /* For the program's own signals, act according to
      the signal handling tables.  */
@@ -4337,7 +4508,7 @@ process_event_stop_test:
                                 "infrun: signal arrived while stepping over "
                                 "breakpoint\n");
 
-	  insert_hp_step_resume_breakpoint_at_frame (frame);
+	  insert_hp_step_resume_breakpoint_at_frame (get_current_frame ());
 	  ecs->event_thread->step_after_step_resume_breakpoint = 1;
 	  /* Reset trap_expected to ensure breakpoints are re-inserted.  */
 	  ecs->event_thread->control.trap_expected = 0;
@@ -4349,7 +4520,7 @@ process_event_stop_test:
 	  && ecs->event_thread->suspend.stop_signal != TARGET_SIGNAL_0
 	  && (ecs->event_thread->control.step_range_start <= stop_pc
 	      && stop_pc < ecs->event_thread->control.step_range_end)
-	  && frame_id_eq (get_stack_frame_id (frame),
+	  && frame_id_eq (get_stack_frame_id (get_current_frame ()),
 			  ecs->event_thread->control.step_stack_frame_id)
 	  && ecs->event_thread->control.step_resume_breakpoint == NULL)
 	{
@@ -4367,7 +4538,7 @@ process_event_stop_test:
                                 "infrun: signal may take us out of "
                                 "single-step range\n");
 
-	  insert_hp_step_resume_breakpoint_at_frame (frame);
+	  insert_hp_step_resume_breakpoint_at_frame (get_current_frame ());
 	  /* Reset trap_expected to ensure breakpoints are re-inserted.  */
 	  ecs->event_thread->control.trap_expected = 0;
 	  keep_going (ecs);
@@ -4398,9 +4569,9 @@ process_event_stop_test:
 
     /* If we hit an internal event that triggers symbol changes, the
        current frame will be invalidated within bpstat_what (e.g., if
-       we hit an internal solib event).  Re-fetch it.  */
-    frame = get_current_frame ();
-    gdbarch = get_frame_arch (frame);
+       we hit an internal solib event).  Re-fetch its architecture;
+       the cases that need the frame itself fetch it.  */
+    gdbarch = get_regcache_arch (get_current_regcache ());
 
     switch (what.main_action)
       {
@@ -4413,6 +4584,7 @@ process_event_stop_test:
 	  fprintf_unfiltered (gdb_stdlog,
 			      "infrun: BPSTAT_WHAT_SET_LONGJMP_RESUME\n");
 
+	frame = get_current_frame ();
 	ecs->event_thread->stepping_over_breakpoint = 1;
 
 	if (what.is_longjmp)
@@ -7304,6 +7476,21 @@ use it in all-stop mode (see help set non-stop)."),
 			show_can_use_displaced_stepping,
 			&setlist, &showlist);
 
+  add_setshow_zuinteger_cmd ("displaced-stepping-slots", class_run,
+			     &displaced_step_slots_1, _("\
+Set the number of threads of a process that can displaced step at once."),
+			     _("\
+Show the number of threads of a process that can displaced step at once."),
+			     _("\
+Each thread stepping over a breakpoint with displaced stepping uses its own\n\
+slot of the process's scratch space.  The slots are placed one after the\n\
+other, and stay within the function holding the scratch space, so fewer may\n\
+be used than set here.  Threads find a slot free or wait their turn.\n\
+The default is 4, and at most 16 slots can be used."),
+			     set_displaced_step_slots,
+			     show_displaced_step_slots,
+			     &setlist, &showlist);
+
   add_setshow_enum_cmd ("exec-direction", class_run, exec_direction_names,
 			&exec_direction, _("Set direction of execution.\n\
 Options are 'forward' or 'reverse'."),
@@ -53,6 +53,10 @@ struct inline_state
      of the outermost skipped inline function.  It's used to find the
      call site of the current frame.  */
   struct symbol *skipped_symbol;
+
+  /* Non-zero if SKIPPED_FRAMES and SKIPPED_SYMBOL have yet to be
+     worked out from SAVED_PC.  See skip_inline_frames.  */
+  int pending;
 };
 
 typedef struct inline_state inline_state_s;
@@ -60,6 +64,8 @@ DEF_VEC_O(inline_state_s);
 
 static VEC(inline_state_s) *inline_states;
 
+static void compute_skipped_frames (struct inline_state *state);
+
 /* Locate saved inlined frame state for PTID, if it exists
    and is valid.  */
 
@@ -83,8 +89,10 @@ find_inline_frame_state (ptid_t ptid)
 	      VEC_unordered_remove (inline_state_s, inline_states, ix);
 	      return NULL;
 	    }
-	  else
-	    return state;
+
+	  if (state->pending)
+	    compute_skipped_frames (state);
+	  return state;
 	}
     }
 
@@ -294,23 +302,17 @@ block_starting_point_at (CORE_ADDR pc, struct block *block)
   return 1;
 }
 
-/* Skip all inlined functions whose call sites are at the current PC.
-   Frames for the hidden functions will not appear in the backtrace until the
-   user steps into them.  */
+/* Work out which inlined functions STATE->SAVED_PC is the call site
+   of, and so should be hidden.  */
 
-void
-skip_inline_frames (ptid_t ptid)
+static void
+compute_skipped_frames (struct inline_state *state)
 {
-  CORE_ADDR this_pc;
+  CORE_ADDR this_pc = state->saved_pc;
   struct block *frame_block, *cur_block;
   struct symbol *last_sym = NULL;
   int skip_count = 0;
-  struct inline_state *state;
 
-  /* This function is called right after reinitializing the frame
-     cache.  We try not to do more unwinding than absolutely
-     necessary, for performance.  */
-  this_pc = get_frame_pc (get_current_frame ());
   frame_block = block_for_pc (this_pc);
 
   if (frame_block != NULL)
@@ -335,14 +337,31 @@ skip_inline_frames (ptid_t ptid)
 	}
     }
 
-  gdb_assert (find_inline_frame_state (ptid) == NULL);
-  state = allocate_inline_frame_state (ptid);
   state->skipped_frames = skip_count;
-  state->saved_pc = this_pc;
   state->skipped_symbol = last_sym;
+  state->pending = 0;
+}
 
-  if (skip_count != 0)
-    reinit_frame_cache ();
+/* Skip all inlined functions whose call sites are at the current PC.
+   Frames for the hidden functions will not appear in the backtrace until the
+   user steps into them.  */
+
+void
+skip_inline_frames (ptid_t ptid)
+{
+  struct inline_state *state;
+
+  gdb_assert (find_inline_frame_state (ptid) == NULL);
+  state = allocate_inline_frame_state (ptid);
+  state->saved_pc = regcache_read_pc (get_thread_regcache (ptid));
+
+  /* Looking up the blocks at the PC is expensive, and most stops,
+     such as those at breakpoints whose condition fails, resume
+     without ever building a frame.  So the functions to hide are
+     only worked out when a frame or the state is first asked for.
+     Any frames built so far didn't hide them; rebuild them.  */
+  state->pending = 1;
+  reinit_frame_cache ();
 }
 
 /* Step into an inlined function by unhiding it.  */
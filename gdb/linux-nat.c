@@ -56,9 +56,11 @@
 #include "xml-support.h"
 #include "terminal.h"
 #include <sys/vfs.h>
+#include <sys/mman.h>
 #include "solib.h"
 #include "linux-osdata.h"
 #include "cli/cli-utils.h"
+#include "breakpoint.h"
 
 #ifndef SPUFS_MAGIC
 #define SPUFS_MAGIC 0x23c9b64e
@@ -287,6 +289,14 @@ static struct lwp_info *add_lwp (ptid_t ptid);
 static void purge_lwp_list (int pid);
 static struct lwp_info *find_lwp_pid (ptid_t ptid);
 
+static void forget_page_watches (int pid);
+static void forget_ignored_breakpoints (int pid);
+static int skip_ignored_breakpoint_hit (struct lwp_info *lp);
+static void clone_page_watches (int parent_pid, int child_pid);
+static int read_mapping (FILE *mapfile, long long *addr, long long *endaddr,
+			 char *permissions, long long *offset, char *device,
+			 long long *inode, char *filename);
+
 
 /* Trivial list manipulation functions to keep track of a list of
    new stopped processes.  */
@@ -2208,6 +2218,9 @@ linux_handle_extended_wait (struct lwp_info *lp, int status,
 	  return 0;
 	}
 
+      if (event == PTRACE_EVENT_FORK)
+	clone_page_watches (GET_PID (lp->ptid), new_pid);
+
       if (event == PTRACE_EVENT_FORK)
 	ourstatus->kind = TARGET_WAITKIND_FORKED;
       else if (event == PTRACE_EVENT_VFORK)
@@ -2353,6 +2366,11 @@ linux_handle_extended_wait (struct lwp_info *lp, int status,
       ourstatus->value.execd_pathname
 	= xstrdup (linux_child_pid_to_exec_file (pid));
 
+      /* The new program doesn't have the old one's pages, or
+	 breakpoints.  */
+      forget_page_watches (GET_PID (lp->ptid));
+      forget_ignored_breakpoints (GET_PID (lp->ptid));
+
       return 0;
     }
 
@@ -2718,6 +2736,704 @@ linux_nat_stopped_data_address (struct target_ops *ops, CORE_ADDR *addr_p)
   return lp->stopped_data_address_p;
 }
 
+/* Page-protection watchpoints.
+
+   Watchpoints the debug registers can't handle, e.g. because they
+   cover a large buffer, or because all the registers are in use, can
+   be implemented by taking away the write permission (or, for read
+   and access watchpoints, all permissions) of the pages holding the
+   watched region.  Each access to those pages then faults.  When an
+   LWP faults, we restore the page's original protection, single-step
+   the LWP over the faulting instruction, and protect the page again.
+   The stop is reported as a watchpoint trap if the access was to a
+   watched region, and otherwise the LWP is silently resumed.  The
+   cost of such a watchpoint is thus proportional to the number of
+   accesses to the pages it covers, instead of to the number of
+   instructions executed, as with software watchpoints.
+
+   The architecture provides the method that makes an LWP call
+   mprotect; see linux_nat_set_inferior_mprotect.  Note that system
+   calls which write to a protected page fail with EFAULT instead of
+   faulting, and that accesses made by other threads while an LWP is
+   single-stepped over its access are not reported, and that read and
+   access watchpoints may report accesses just before the watched
+   region; see PAGE_WATCH_MAX_ACCESS.  This is why the feature must be
+   enabled with "set page-protection-watchpoints".  */
+
+/* Whether page protection may be used for watchpoints the debug
+   registers can't handle.  */
+static int page_protection_watchpoints = 0;
+
+/* The architecture's method to make an LWP call mprotect, or NULL.  */
+static int (*linux_nat_inferior_mprotect) (int lwpid, CORE_ADDR addr,
+					   ULONGEST len, int prot);
+
+/* The largest memory access a single instruction can make.  A fault
+   at an address up to this many bytes before a watched region may be
+   an access that overlaps the region.  The fault only tells where the
+   access starts, not its size, so all such accesses are reported as
+   hits.  For write watchpoints, the core then finds the value didn't
+   change and carries on, but read and access watchpoints report reads
+   of up to this many bytes before the region that don't touch it.  */
+#define PAGE_WATCH_MAX_ACCESS 32
+
+/* A region watched through page protection.  */
+
+struct page_watch
+{
+  int pid;
+  CORE_ADDR addr;
+  int len;
+
+  /* One of hw_write, hw_read and hw_access.  */
+  int type;
+
+  struct page_watch *next;
+};
+
+/* A page protected for page watchpoints.  */
+
+struct protected_page
+{
+  int pid;
+  CORE_ADDR addr;
+
+  /* The protection of the page before we changed it.  */
+  int orig_prot;
+
+  /* The protection we gave it.  */
+  int prot;
+
+  struct protected_page *next;
+};
+
+static struct page_watch *page_watches;
+static struct protected_page *protected_pages;
+
+static void
+show_page_protection_watchpoints (struct ui_file *file, int from_tty,
+				  struct cmd_list_element *c,
+				  const char *value)
+{
+  fprintf_filtered (file, _("Use of page protection for watchpoints "
+			    "is %s.\n"), value);
+}
+
+static CORE_ADDR
+page_watch_page_size (void)
+{
+  static CORE_ADDR page_size;
+
+  if (page_size == 0)
+    page_size = sysconf (_SC_PAGESIZE);
+  return page_size;
+}
+
+/* Return non-zero if page protection can be used for watchpoints in
+   the current inferior.  */
+
+static int
+page_protection_watchpoints_p (void)
+{
+  if (!page_protection_watchpoints || linux_nat_inferior_mprotect == NULL)
+    return 0;
+
+  /* DECREE, the kernel CGC binaries run on, has no mprotect system
+     call.  */
+  if (exec_bfd != NULL
+      && bfd_get_flavour (exec_bfd) == bfd_target_elf_flavour
+      && elf_elfheader (exec_bfd)->e_ident[EI_OSABI] == ELFOSABI_CGC)
+    return 0;
+
+  return 1;
+}
+
+/* Return non-zero if SIGNO is raised by the instruction that caused
+   it, and so can't be deferred: the instruction would just raise it
+   again.  */
+
+static int
+synchronous_signal_p (int signo)
+{
+  return (signo == SIGSEGV || signo == SIGBUS
+	  || signo == SIGILL || signo == SIGFPE);
+}
+
+/* Single-step the stopped LWP LWPID over one instruction, and wait
+   for the step to finish.  This is used to run code behind the core's
+   back, so signals that arrive meanwhile are queued again once the
+   step is done.  Returns 0 on success, or -1 if the LWP didn't
+   complete the step (e.g., because it was killed).  If the
+   instruction faults instead, return the signal it raised; the LWP is
+   left stopped with it, and it is up to the caller to report it.  */
+
+int
+linux_nat_step_lwp_insn (int lwpid)
+{
+  sigset_t deferred;
+  int status, signo, ret = 0;
+
+  sigemptyset (&deferred);
+  for (;;)
+    {
+      if (ptrace (PTRACE_SINGLESTEP, lwpid, 0, 0) != 0
+	  || my_waitpid (lwpid, &status, __WALL) != lwpid
+	  || !WIFSTOPPED (status))
+	{
+	  ret = -1;
+	  break;
+	}
+
+      if (WSTOPSIG (status) == SIGTRAP)
+	break;
+
+      if (synchronous_signal_p (WSTOPSIG (status)))
+	{
+	  ret = WSTOPSIG (status);
+	  break;
+	}
+
+      /* A signal got in the way; deliver it later.  */
+      sigaddset (&deferred, WSTOPSIG (status));
+    }
+
+  for (signo = 1; signo < NSIG; signo++)
+    if (sigismember (&deferred, signo))
+      kill_lwp (lwpid, signo);
+
+  return ret;
+}
+
+/* Return the protected page at PAGE in process PID, or NULL.  */
+
+static struct protected_page *
+find_protected_page (int pid, CORE_ADDR page)
+{
+  struct protected_page *pp;
+
+  for (pp = protected_pages; pp != NULL; pp = pp->next)
+    if (pp->pid == pid && pp->addr == page)
+      return pp;
+  return NULL;
+}
+
+/* Find the protection of the pages in [START, END) of process PID in
+   /proc/PID/maps, and store it in PROTS, one entry per page.  Return
+   0 on success, or -1 if some page isn't mapped.  */
+
+static int
+read_page_protections (int pid, CORE_ADDR start, CORE_ADDR end, int *prots)
+{
+  char mapsfilename[MAXPATHLEN];
+  FILE *mapsfile;
+  long long addr, endaddr, offset, inode;
+  char permissions[8], device[8], filename[MAXPATHLEN];
+  CORE_ADDR page_size = page_watch_page_size ();
+  CORE_ADDR page;
+  int npages = (end - start) / page_size;
+  int i, found = 0;
+
+  for (i = 0; i < npages; i++)
+    prots[i] = -1;
+
+  sprintf (mapsfilename, "/proc/%d/maps", pid);
+  mapsfile = fopen (mapsfilename, "r");
+  if (mapsfile == NULL)
+    return -1;
+
+  while (read_mapping (mapsfile, &addr, &endaddr, &permissions[0],
+		       &offset, &device[0], &inode, &filename[0]))
+    for (page = max (start, (CORE_ADDR) addr);
+	 page < min (end, (CORE_ADDR) endaddr);
+	 page += page_size)
+      {
+	int prot = 0;
+
+	if (strchr (permissions, 'r') != NULL)
+	  prot |= PROT_READ;
+	if (strchr (permissions, 'w') != NULL)
+	  prot |= PROT_WRITE;
+	if (strchr (permissions, 'x') != NULL)
+	  prot |= PROT_EXEC;
+	prots[(page - start) / page_size] = prot;
+	found++;
+      }
+
+  fclose (mapsfile);
+  return found == npages ? 0 : -1;
+}
+
+/* Return the LWP of process PID that should run the mprotect calls
+   for page watchpoints: any stopped LWP, or the process itself if we
+   don't know about its LWPs yet, as with a fork child.  Return -1 if
+   all the LWPs are running.  */
+
+static int
+page_watch_lwp (int pid)
+{
+  struct lwp_info *lp;
+
+  for (lp = lwp_list; lp != NULL; lp = lp->next)
+    if (GET_PID (lp->ptid) == pid && lp->stopped)
+      return GET_LWP (lp->ptid);
+
+  if (find_lwp_pid (pid_to_ptid (pid)) == NULL)
+    return pid;
+
+  return -1;
+}
+
+/* Change the protection of the pages in [START, END) of process PID
+   to match the page watchpoints covering them.  Return 0 on success,
+   and -1 on failure.  */
+
+static int
+update_page_protections (int pid, CORE_ADDR start, CORE_ADDR end)
+{
+  CORE_ADDR page_size = page_watch_page_size ();
+  CORE_ADDR page;
+  int lwpid = page_watch_lwp (pid);
+  int *prots = NULL;
+  int ret = 0;
+
+  if (lwpid == -1)
+    return -1;
+
+  start &= ~(page_size - 1);
+  end = (end + page_size - 1) & ~(page_size - 1);
+
+  for (page = start; page < end; page += page_size)
+    {
+      struct protected_page *pp = find_protected_page (pid, page);
+      struct page_watch *w;
+      int watched = 0, prot;
+
+      for (w = page_watches; w != NULL; w = w->next)
+	if (w->pid == pid
+	    && w->addr < page + page_size && w->addr + w->len > page)
+	  watched |= (w->type == hw_write ? PROT_WRITE : PROT_READ);
+
+      if (watched == 0)
+	{
+	  if (pp != NULL)
+	    {
+	      struct protected_page **ppp;
+
+	      if (linux_nat_inferior_mprotect (lwpid, page, page_size,
+					       pp->orig_prot) != 0)
+		ret = -1;
+
+	      for (ppp = &protected_pages; *ppp != pp; ppp = &(*ppp)->next)
+		;
+	      *ppp = pp->next;
+	      xfree (pp);
+	    }
+	  continue;
+	}
+
+      if (pp == NULL)
+	{
+	  if (prots == NULL)
+	    {
+	      prots = xmalloc ((end - start) / page_size * sizeof (int));
+	      if (read_page_protections (pid, start, end, prots) != 0)
+		{
+		  ret = -1;
+		  break;
+		}
+	    }
+
+	  pp = XZALLOC (struct protected_page);
+	  pp->pid = pid;
+	  pp->addr = page;
+	  pp->orig_prot = prots[(page - start) / page_size];
+	  pp->prot = pp->orig_prot;
+	  pp->next = protected_pages;
+	  protected_pages = pp;
+	}
+
+      /* Write watchpoints only need writes to fault, but any access
+	 faults once reads are denied.  */
+      if ((watched & PROT_READ) != 0)
+	prot = PROT_NONE;
+      else
+	prot = pp->orig_prot & ~PROT_WRITE;
+
+      if (prot != pp->prot)
+	{
+	  if (linux_nat_inferior_mprotect (lwpid, page, page_size, prot) != 0)
+	    {
+	      ret = -1;
+	      break;
+	    }
+	  pp->prot = prot;
+	}
+    }
+
+  xfree (prots);
+  return ret;
+}
+
+/* Return the page watchpoint of process PID watching ADDR, LEN and
+   TYPE, or NULL.  Unlink it if UNLINK is non-zero.  */
+
+static struct page_watch *
+find_page_watch (int pid, CORE_ADDR addr, int len, int type, int unlink)
+{
+  struct page_watch **wp;
+
+  for (wp = &page_watches; *wp != NULL; wp = &(*wp)->next)
+    if ((*wp)->pid == pid && (*wp)->addr == addr
+	&& (*wp)->len == len && (*wp)->type == type)
+      {
+	struct page_watch *w = *wp;
+
+	if (unlink)
+	  *wp = w->next;
+	return w;
+      }
+
+  return NULL;
+}
+
+static int
+insert_page_watch (int pid, CORE_ADDR addr, int len, int type)
+{
+  struct page_watch *w = XZALLOC (struct page_watch);
+
+  w->pid = pid;
+  w->addr = addr;
+  w->len = len;
+  w->type = type;
+  w->next = page_watches;
+  page_watches = w;
+
+  if (update_page_protections (pid, addr, addr + len) != 0)
+    {
+      find_page_watch (pid, addr, len, type, 1);
+      xfree (w);
+      update_page_protections (pid, addr, addr + len);
+      return -1;
+    }
+
+  if (debug_linux_nat)
+    fprintf_unfiltered (gdb_stdlog,
+			"PW: Watching %s, %d bytes, of process %d with "
+			"page protection\n",
+			paddress (target_gdbarch, addr), len, pid);
+  return 0;
+}
+
+/* Forget the page watchpoints of process PID, which has exited or
+   exec'd.  */
+
+static void
+forget_page_watches (int pid)
+{
+  struct page_watch **wp = &page_watches;
+  struct protected_page **ppp = &protected_pages;
+
+  while (*wp != NULL)
+    if ((*wp)->pid == pid)
+      {
+	struct page_watch *w = *wp;
+
+	*wp = w->next;
+	xfree (w);
+      }
+    else
+      wp = &(*wp)->next;
+
+  while (*ppp != NULL)
+    if ((*ppp)->pid == pid)
+      {
+	struct protected_page *pp = *ppp;
+
+	*ppp = pp->next;
+	xfree (pp);
+      }
+    else
+      ppp = &(*ppp)->next;
+}
+
+/* The fork child CHILD_PID of PARENT_PID inherited its parent's
+   protected pages; record them, so that removing the watchpoints from
+   the child (e.g. when detaching from it) restores them.  */
+
+static void
+clone_page_watches (int parent_pid, int child_pid)
+{
+  struct page_watch *w;
+  struct protected_page *pp;
+
+  for (w = page_watches; w != NULL; w = w->next)
+    if (w->pid == parent_pid)
+      {
+	struct page_watch *copy = XZALLOC (struct page_watch);
+
+	*copy = *w;
+	copy->pid = child_pid;
+	copy->next = page_watches;
+	page_watches = copy;
+      }
+
+  for (pp = protected_pages; pp != NULL; pp = pp->next)
+    if (pp->pid == parent_pid)
+      {
+	struct protected_page *copy = XZALLOC (struct protected_page);
+
+	*copy = *pp;
+	copy->pid = child_pid;
+	copy->next = protected_pages;
+	protected_pages = copy;
+      }
+}
+
+/* Implement the to_can_use_hw_breakpoint target method.  */
+
+static int
+linux_nat_can_use_hw_breakpoint (int type, int cnt, int othertype)
+{
+  int ret = 0;
+
+  if (linux_ops->to_can_use_hw_breakpoint != NULL)
+    ret = linux_ops->to_can_use_hw_breakpoint (type, cnt, othertype);
+
+  if (ret <= 0
+      && (type == bp_hardware_watchpoint || type == bp_read_watchpoint
+	  || type == bp_access_watchpoint)
+      && page_protection_watchpoints_p ())
+    ret = 1;
+
+  return ret;
+}
+
+/* Implement the to_region_ok_for_hw_watchpoint target method.  */
+
+static int
+linux_nat_region_ok_for_hw_watchpoint (CORE_ADDR addr, int len)
+{
+  if (page_protection_watchpoints_p ())
+    return 1;
+
+  if (linux_ops->to_region_ok_for_hw_watchpoint != NULL)
+    return linux_ops->to_region_ok_for_hw_watchpoint (addr, len);
+
+  return len <= gdbarch_ptr_bit (target_gdbarch) / TARGET_CHAR_BIT;
+}
+
+/* Implement the to_insert_watchpoint target method.  Use the debug
+   registers if they can take the region, and page protection
+   otherwise.  */
+
+static int
+linux_nat_insert_watchpoint (CORE_ADDR addr, int len, int type,
+			     struct expression *cond)
+{
+  if (linux_ops->to_insert_watchpoint != NULL
+      && (linux_ops->to_region_ok_for_hw_watchpoint == NULL
+	  || linux_ops->to_region_ok_for_hw_watchpoint (addr, len))
+      && linux_ops->to_insert_watchpoint (addr, len, type, cond) == 0)
+    return 0;
+
+  if (!page_protection_watchpoints_p ())
+    return 1;
+
+  return insert_page_watch (ptid_get_pid (inferior_ptid), addr, len, type);
+}
+
+/* Implement the to_remove_watchpoint target method.  */
+
+static int
+linux_nat_remove_watchpoint (CORE_ADDR addr, int len, int type,
+			     struct expression *cond)
+{
+  int pid = ptid_get_pid (inferior_ptid);
+  struct page_watch *w = find_page_watch (pid, addr, len, type, 1);
+
+  if (w == NULL)
+    {
+      if (linux_ops->to_remove_watchpoint == NULL)
+	return 1;
+      return linux_ops->to_remove_watchpoint (addr, len, type, cond);
+    }
+
+  xfree (w);
+  return update_page_protections (pid, addr, addr + len) == 0 ? 0 : 1;
+}
+
+/* Implement the to_debug_registers target method.  Leave out the
+   regions that linux_nat_insert_watchpoint would watch with page
+   protection: those the debug registers can't take, and those that
+   don't fit in them any more, in the order they are inserted.  */
+
+static int
+linux_nat_debug_registers (const struct watch_region *wanted, int nwanted,
+			   struct watch_region *regs, int max)
+{
+  struct watch_region *used, *scratch;
+  struct cleanup *old_chain;
+  int nused = 0, i, ret;
+
+  if (!page_protection_watchpoints_p ())
+    return linux_ops->to_debug_registers (wanted, nwanted, regs, max);
+
+  used = xmalloc (nwanted * sizeof (struct watch_region));
+  old_chain = make_cleanup (xfree, used);
+  scratch = xmalloc (max * sizeof (struct watch_region));
+  make_cleanup (xfree, scratch);
+
+  /* Hardware breakpoints always take a debug register.  */
+  for (i = 0; i < nwanted; i++)
+    if (wanted[i].type == hw_execute)
+      used[nused++] = wanted[i];
+
+  for (i = 0; i < nwanted; i++)
+    {
+      if (wanted[i].type == hw_execute
+	  || (linux_ops->to_region_ok_for_hw_watchpoint != NULL
+	      && !linux_ops->to_region_ok_for_hw_watchpoint (wanted[i].addr,
+							      wanted[i].len)))
+	continue;
+
+      used[nused] = wanted[i];
+      if (linux_ops->to_debug_registers (used, nused + 1, scratch, max) >= 0)
+	nused++;
+    }
+
+  ret = linux_ops->to_debug_registers (used, nused, regs, max);
+  do_cleanups (old_chain);
+  return ret;
+}
+
+/* Return the page of LP's process protected for page watchpoints that
+   made LP stop with STATUS, or NULL if STATUS isn't such a fault.
+   Store the faulting address in *FAULT_ADDR.  */
+
+static struct protected_page *
+page_watch_fault (struct lwp_info *lp, int status, CORE_ADDR *fault_addr)
+{
+  struct siginfo siginfo;
+
+  if (protected_pages == NULL
+      || !WIFSTOPPED (status) || WSTOPSIG (status) != SIGSEGV)
+    return NULL;
+
+  errno = 0;
+  ptrace (PTRACE_GETSIGINFO, GET_LWP (lp->ptid), 0, &siginfo);
+  if (errno != 0 || siginfo.si_code != SEGV_ACCERR)
+    return NULL;
+
+  *fault_addr = (CORE_ADDR) (unsigned long) siginfo.si_addr;
+  return find_protected_page (GET_PID (lp->ptid),
+			      *fault_addr & ~(page_watch_page_size () - 1));
+}
+
+enum page_fault_action
+{
+  /* Not a page watchpoint fault.  */
+  page_fault_not_ours,
+
+  /* Report the event, which is now a SIGTRAP.  */
+  page_fault_report,
+
+  /* The access didn't hit a watched region; resume the LWP.  */
+  page_fault_resume,
+
+  /* Letting the access through raised a signal; report LP's status,
+     which is now that signal.  */
+  page_fault_signal
+};
+
+/* If LP stopped with STATUS because of a page watchpoint fault, let
+   the access through, and tell the caller what to do next.  */
+
+static enum page_fault_action
+handle_page_watch_fault (struct lwp_info *lp, int status)
+{
+  CORE_ADDR page_size = page_watch_page_size ();
+  int lwpid = GET_LWP (lp->ptid);
+  struct protected_page *pages[2];
+  struct page_watch *w;
+  CORE_ADDR fault_addr;
+  int i, npages, stepped;
+
+  pages[0] = page_watch_fault (lp, status, &fault_addr);
+  if (pages[0] == NULL)
+    return page_fault_not_ours;
+
+  /* An access that crosses into the next page faults again there if
+     that page is protected too.  */
+  pages[1] = find_protected_page (GET_PID (lp->ptid),
+				  pages[0]->addr + page_size);
+  npages = pages[1] != NULL ? 2 : 1;
+
+  for (i = 0; i < npages; i++)
+    if (linux_nat_inferior_mprotect (lwpid, pages[i]->addr, page_size,
+				     pages[i]->orig_prot) != 0)
+      break;
+  if (i == npages)
+    stepped = linux_nat_step_lwp_insn (lwpid);
+  else
+    stepped = -1;
+  while (i-- > 0)
+    if (linux_nat_inferior_mprotect (lwpid, pages[i]->addr, page_size,
+				     pages[i]->prot) != 0)
+      warning (_("Could not protect page %s again; "
+		 "watchpoints there may be missed."),
+	       paddress (target_gdbarch, pages[i]->addr));
+
+  registers_changed ();
+
+  if (stepped < 0)
+    return page_fault_not_ours;
+
+  /* The instruction faulted for another reason.  */
+  if (stepped > 0)
+    {
+      if (debug_linux_nat)
+	fprintf_unfiltered (gdb_stdlog,
+			    "PW: Access to %s by %s raised %s\n",
+			    paddress (target_gdbarch, fault_addr),
+			    target_pid_to_str (lp->ptid),
+			    strsignal (stepped));
+
+      save_siginfo (lp);
+      lp->stopped_by_watchpoint = 0;
+      lp->status = W_STOPCODE (stepped);
+      return page_fault_signal;
+    }
+
+  for (w = page_watches; w != NULL; w = w->next)
+    if (w->pid == GET_PID (lp->ptid)
+	&& fault_addr < w->addr + w->len
+	&& fault_addr + PAGE_WATCH_MAX_ACCESS > w->addr)
+      break;
+
+  if (debug_linux_nat)
+    fprintf_unfiltered (gdb_stdlog,
+			"PW: Access to %s by %s %s a watched region\n",
+			paddress (target_gdbarch, fault_addr),
+			target_pid_to_str (lp->ptid),
+			w != NULL ? "hit" : "missed");
+
+  save_siginfo (lp);
+  if (w != NULL)
+    {
+      lp->stopped_by_watchpoint = 1;
+      lp->stopped_data_address_p = 1;
+      lp->stopped_data_address = max (fault_addr, w->addr);
+      return page_fault_report;
+    }
+
+  /* The step we did completes a step the core asked for.  */
+  lp->stopped_by_watchpoint = 0;
+  if (lp->step)
+    return page_fault_report;
+
+  return page_fault_resume;
+}
+
 /* Commonly any breakpoint / watchpoint generate only SIGTRAP.  */
 
 static int
@@ -2769,6 +3485,7 @@ stop_wait_callback (struct lwp_info *lp, void *data)
 
   if (!lp->stopped)
     {
+      CORE_ADDR fault_addr;
       int status;
 
       status = wait_lwp (lp);
@@ -2851,6 +3568,23 @@ stop_wait_callback (struct lwp_info *lp, void *data)
 	      lp->status = status;
 	      return 0;
 	    }
+	  else if (page_watch_fault (lp, status, &fault_addr) != NULL)
+	    {
+	      /* Like a breakpoint hit, an access to a page protected
+		 for watchpoints faults again when the LWP is resumed,
+		 if the watchpoint is still there.  Discard it, and get
+		 the SIGSTOP event.  */
+	      errno = 0;
+	      ptrace (PTRACE_CONT, GET_LWP (lp->ptid), 0, 0);
+	      if (debug_linux_nat)
+		fprintf_unfiltered (gdb_stdlog,
+				    "SWC: PTRACE_CONT %s, 0, 0 (%s) "
+				    "(discarding page watchpoint fault)\n",
+				    target_pid_to_str (lp->ptid),
+				    errno ? safe_strerror (errno) : "OK");
+
+	      return stop_wait_callback (lp, NULL);
+	    }
 	  else
 	    {
 	      /* The thread was stopped with a signal other than
@@ -3248,12 +3982,53 @@ linux_nat_filter_event (int lwpid, int status, int *new_pending_p)
 	return NULL;
     }
 
+  /* Let accesses to pages protected for watchpoints through, and
+     only report those that hit a watched region.  */
+  if (WIFSTOPPED (status) && WSTOPSIG (status) == SIGSEGV)
+    switch (handle_page_watch_fault (lp, status))
+      {
+      case page_fault_report:
+	lp->status = W_STOPCODE (SIGTRAP);
+	return lp;
+
+      case page_fault_signal:
+	return lp;
+
+      case page_fault_resume:
+	linux_ops->to_resume (linux_ops, pid_to_ptid (GET_LWP (lp->ptid)),
+			      lp->step, TARGET_SIGNAL_0);
+	if (debug_linux_nat)
+	  fprintf_unfiltered (gdb_stdlog,
+			      "LLW: %s PTRACE_CONT, 0, 0 "
+			      "(page watchpoint miss)\n",
+			      target_pid_to_str (lp->ptid));
+	lp->stopped = 0;
+	return NULL;
+
+      case page_fault_not_ours:
+	break;
+      }
+
   if (linux_nat_status_is_event (status))
     {
       /* Save the trap's siginfo in case we need it later.  */
       save_siginfo (lp);
 
       save_sigtrap (lp);
+
+      /* Skip the hits of breakpoints GDB told us to ignore.  */
+      if (WSTOPSIG (status) == SIGTRAP && skip_ignored_breakpoint_hit (lp))
+	{
+	  linux_ops->to_resume (linux_ops, pid_to_ptid (GET_LWP (lp->ptid)),
+				lp->step, TARGET_SIGNAL_0);
+	  if (debug_linux_nat)
+	    fprintf_unfiltered (gdb_stdlog,
+				"LLW: %s PTRACE_CONT, 0, 0 "
+				"(ignored breakpoint hit)\n",
+				target_pid_to_str (lp->ptid));
+	  lp->stopped = 0;
+	  return NULL;
+	}
     }
 
   /* Check if the thread has exited.  */
@@ -3898,11 +4673,10 @@ retry:
       ourstatus->value.sig = TARGET_SIGNAL_0;
     }
 
-  if (ourstatus->kind == TARGET_WAITKIND_EXITED
-      || ourstatus->kind == TARGET_WAITKIND_SIGNALLED)
-    lp->core = -1;
-  else
-    lp->core = linux_nat_core_of_thread_1 (lp->ptid);
+  /* Reading the core from /proc costs more than the rest of a stop
+     that is resumed at once; it is only done when asked for, by
+     linux_nat_core_of_thread.  */
+  lp->core = -1;
 
   return lp->ptid;
 }
@@ -4123,6 +4897,8 @@ static void
 linux_nat_mourn_inferior (struct target_ops *ops)
 {
   purge_lwp_list (ptid_get_pid (inferior_ptid));
+  forget_page_watches (ptid_get_pid (inferior_ptid));
+  forget_ignored_breakpoints (ptid_get_pid (inferior_ptid));
 
   if (! forks_exist_p ())
     /* Normal case, no other forks available.  */
@@ -4570,6 +5346,413 @@ linux_nat_corefile_thread_callback (struct lwp_info *ti, void *data)
   return 0;
 }
 
+/* Breakpoints whose addresses are at most this many bytes apart have
+   their memory read and written together by linux_nat_breakpoints.  */
+#define BREAKPOINT_BATCH_GAP 64
+
+/* A breakpoint being inserted or removed by linux_nat_breakpoints,
+   and its index in the caller's arrays.  */
+
+struct batch_breakpoint
+{
+  struct bp_target_info *bp_tgt;
+  const gdb_byte *insn;
+  int index;
+};
+
+static int
+batch_breakpoint_compare (const void *ap, const void *bp)
+{
+  const struct batch_breakpoint *a = ap;
+  const struct batch_breakpoint *b = bp;
+
+  if (a->bp_tgt->placed_address != b->bp_tgt->placed_address)
+    return a->bp_tgt->placed_address < b->bp_tgt->placed_address ? -1 : 1;
+  return a->index - b->index;
+}
+
+/* Read or write LEN bytes at OFFSET of the /proc/PID/mem file open as
+   FD.  Returns non-zero on success.  */
+
+static int
+linux_proc_mem_xfer (int fd, gdb_byte *readbuf, const gdb_byte *writebuf,
+		     ULONGEST offset, LONGEST len)
+{
+  /* pwrite64 comes along with pread64.  */
+#ifdef HAVE_PREAD64
+  if (readbuf != NULL)
+    return pread64 (fd, readbuf, len, offset) == len;
+  return pwrite64 (fd, writebuf, len, offset) == len;
+#else
+  if (lseek (fd, offset, SEEK_SET) == -1)
+    return 0;
+  if (readbuf != NULL)
+    return read (fd, readbuf, len) == len;
+  return write (fd, writebuf, len) == len;
+#endif
+}
+
+/* Insert or remove (according to INSERT) the COUNT breakpoints in
+   BP_TGTS, the way default_memory_insert_breakpoint and
+   default_memory_remove_breakpoint would, but reading and writing the
+   memory of neighbouring breakpoints in one go through /proc/PID/mem.
+   Breakpoints whose memory can't be accessed that way are handed to
+   memory_insert_breakpoint or memory_remove_breakpoint.  */
+
+static void
+linux_nat_breakpoints (struct gdbarch *gdbarch, int count,
+		       struct bp_target_info **bp_tgts, int *results,
+		       int insert)
+{
+  struct batch_breakpoint *bps;
+  struct cleanup *old_chain;
+  gdb_byte *buf = NULL;
+  char filename[64];
+  int fd = -1;
+  int i, start, end;
+
+  if (!ptid_equal (inferior_ptid, null_ptid))
+    {
+      sprintf (filename, "/proc/%d/mem", PIDGET (inferior_ptid));
+      fd = open (filename, O_RDWR | O_LARGEFILE);
+    }
+
+  if (fd == -1)
+    {
+      for (i = 0; i < count; i++)
+	results[i] = (insert
+		      ? memory_insert_breakpoint (gdbarch, bp_tgts[i])
+		      : memory_remove_breakpoint (gdbarch, bp_tgts[i]));
+      return;
+    }
+
+  bps = xmalloc (count * sizeof (struct batch_breakpoint));
+  old_chain = make_cleanup (xfree, bps);
+  make_cleanup (free_current_contents, &buf);
+
+  for (i = 0; i < count; i++)
+    {
+      struct bp_target_info *bp_tgt = bp_tgts[i];
+
+      bps[i].bp_tgt = bp_tgt;
+      bps[i].index = i;
+      bps[i].insn = NULL;
+      if (insert)
+	{
+	  CORE_ADDR addr = bp_tgt->placed_address;
+	  int len;
+
+	  bps[i].insn = gdbarch_breakpoint_from_pc (gdbarch, &addr, &len);
+	  bp_tgt->placed_address = addr;
+	  bp_tgt->placed_size = bp_tgt->shadow_len = len;
+	}
+    }
+
+  qsort (bps, count, sizeof (struct batch_breakpoint),
+	 batch_breakpoint_compare);
+
+  for (start = 0; start < count; start = end)
+    {
+      CORE_ADDR span_start = bps[start].bp_tgt->placed_address;
+      CORE_ADDR span_end = span_start + bps[start].bp_tgt->placed_size;
+      int ok;
+
+      for (end = start + 1; end < count; end++)
+	{
+	  struct bp_target_info *bp_tgt = bps[end].bp_tgt;
+
+	  if (bp_tgt->placed_address > span_end + BREAKPOINT_BATCH_GAP)
+	    break;
+	  if (bp_tgt->placed_address + bp_tgt->placed_size > span_end)
+	    span_end = bp_tgt->placed_address + bp_tgt->placed_size;
+	}
+
+      buf = xrealloc (buf, span_end - span_start);
+      ok = linux_proc_mem_xfer (fd, buf, NULL, span_start,
+				span_end - span_start);
+
+      /* Patch the breakpoints in address order and restore their
+	 shadows in the reverse order, so that overlapping breakpoints
+	 come out as if handled one at a time.  */
+      for (i = start; ok && i < end; i++)
+	{
+	  struct batch_breakpoint *bp = &bps[insert ? i : start + end - 1 - i];
+	  struct bp_target_info *bp_tgt = bp->bp_tgt;
+	  gdb_byte *p = buf + (bp_tgt->placed_address - span_start);
+
+	  if (insert)
+	    {
+	      if (bp->insn == NULL)
+		ok = 0;
+	      else
+		{
+		  memcpy (bp_tgt->shadow_contents, p, bp_tgt->placed_size);
+		  memcpy (p, bp->insn, bp_tgt->placed_size);
+		}
+	    }
+	  else
+	    memcpy (p, bp_tgt->shadow_contents, bp_tgt->shadow_len);
+	}
+
+      if (ok)
+	ok = linux_proc_mem_xfer (fd, NULL, buf, span_start,
+				  span_end - span_start);
+
+      for (i = start; i < end; i++)
+	{
+	  struct bp_target_info *bp_tgt = bps[i].bp_tgt;
+
+	  if (ok)
+	    results[bps[i].index] = 0;
+	  else if (insert)
+	    results[bps[i].index] = memory_insert_breakpoint (gdbarch, bp_tgt);
+	  else
+	    results[bps[i].index] = memory_remove_breakpoint (gdbarch, bp_tgt);
+	}
+    }
+
+  close (fd);
+  do_cleanups (old_chain);
+}
+
+static void
+linux_nat_insert_breakpoints (struct gdbarch *gdbarch, int count,
+			      struct bp_target_info **bp_tgts, int *results)
+{
+  linux_nat_breakpoints (gdbarch, count, bp_tgts, results, 1);
+}
+
+/* A software breakpoint inserted with an ignore count.  While the
+   process has a single LWP, linux_nat_filter_event steps over the
+   breakpoint's first hits instead of reporting them.  */
+
+struct ignored_breakpoint
+{
+  struct ignored_breakpoint *next;
+
+  /* The process the breakpoint is inserted in.  */
+  int pid;
+
+  /* The breakpoint's architecture, address, and the original contents
+     of the memory it replaced.  */
+  struct gdbarch *gdbarch;
+  CORE_ADDR addr;
+  gdb_byte shadow[BREAKPOINT_MAX];
+  int shadow_len;
+
+  /* The number of hits left to skip, and the number skipped since
+     GDB last asked.  */
+  int ignore_count;
+  int ignored;
+};
+
+static struct ignored_breakpoint *ignored_breakpoints;
+
+/* Return the breakpoint with an ignore count at ADDR in process PID,
+   or NULL.  */
+
+static struct ignored_breakpoint *
+find_ignored_breakpoint (int pid, CORE_ADDR addr)
+{
+  struct ignored_breakpoint *ib;
+
+  for (ib = ignored_breakpoints; ib != NULL; ib = ib->next)
+    if (ib->pid == pid && ib->addr == addr)
+      return ib;
+  return NULL;
+}
+
+/* Forget the breakpoint with an ignore count at ADDR in process PID,
+   if any.  */
+
+static void
+forget_ignored_breakpoint (int pid, CORE_ADDR addr)
+{
+  struct ignored_breakpoint **ibp;
+
+  for (ibp = &ignored_breakpoints; *ibp != NULL; ibp = &(*ibp)->next)
+    if ((*ibp)->pid == pid && (*ibp)->addr == addr)
+      {
+	struct ignored_breakpoint *ib = *ibp;
+
+	*ibp = ib->next;
+	xfree (ib);
+	return;
+      }
+}
+
+/* Forget the breakpoints with an ignore count of process PID, which
+   has exited or exec'd.  */
+
+static void
+forget_ignored_breakpoints (int pid)
+{
+  struct ignored_breakpoint **ibp = &ignored_breakpoints;
+
+  while (*ibp != NULL)
+    if ((*ibp)->pid == pid)
+      {
+	struct ignored_breakpoint *ib = *ibp;
+
+	*ibp = ib->next;
+	xfree (ib);
+      }
+    else
+      ibp = &(*ibp)->next;
+}
+
+static void
+linux_nat_remove_breakpoints (struct gdbarch *gdbarch, int count,
+			      struct bp_target_info **bp_tgts, int *results)
+{
+  int i;
+
+  if (ignored_breakpoints != NULL && !ptid_equal (inferior_ptid, null_ptid))
+    for (i = 0; i < count; i++)
+      forget_ignored_breakpoint (ptid_get_pid (inferior_ptid),
+				 bp_tgts[i]->placed_address);
+
+  linux_nat_breakpoints (gdbarch, count, bp_tgts, results, 0);
+}
+
+/* Insert a software breakpoint, and remember it if it comes with an
+   ignore count, so that its first hits are skipped.  */
+
+static int
+linux_nat_insert_breakpoint (struct gdbarch *gdbarch,
+			     struct bp_target_info *bp_tgt)
+{
+  int pid = ptid_get_pid (inferior_ptid);
+  struct ignored_breakpoint *ib;
+  int ret;
+
+  ret = linux_ops->to_insert_breakpoint (gdbarch, bp_tgt);
+  if (ret != 0 || bp_tgt->ignore_count <= 0
+      || bp_tgt->shadow_len == 0 || pid == 0)
+    {
+      bp_tgt->ignore_count = 0;
+      return ret;
+    }
+
+  forget_ignored_breakpoint (pid, bp_tgt->placed_address);
+
+  ib = XZALLOC (struct ignored_breakpoint);
+  ib->pid = pid;
+  ib->gdbarch = gdbarch;
+  ib->addr = bp_tgt->placed_address;
+  memcpy (ib->shadow, bp_tgt->shadow_contents, bp_tgt->shadow_len);
+  ib->shadow_len = bp_tgt->shadow_len;
+  ib->ignore_count = bp_tgt->ignore_count;
+  ib->next = ignored_breakpoints;
+  ignored_breakpoints = ib;
+  return 0;
+}
+
+static int
+linux_nat_remove_breakpoint (struct gdbarch *gdbarch,
+			     struct bp_target_info *bp_tgt)
+{
+  if (ignored_breakpoints != NULL && !ptid_equal (inferior_ptid, null_ptid))
+    forget_ignored_breakpoint (ptid_get_pid (inferior_ptid),
+			       bp_tgt->placed_address);
+
+  return linux_ops->to_remove_breakpoint (gdbarch, bp_tgt);
+}
+
+static int
+linux_nat_can_ignore_breakpoint_hits (void)
+{
+  return 1;
+}
+
+static int
+linux_nat_breakpoint_ignored_hits (struct gdbarch *gdbarch,
+				   struct bp_target_info *bp_tgt)
+{
+  struct ignored_breakpoint *ib;
+  int ignored;
+
+  ib = find_ignored_breakpoint (ptid_get_pid (inferior_ptid),
+				bp_tgt->placed_address);
+  if (ib == NULL)
+    return -1;
+
+  ignored = ib->ignored;
+  ib->ignore_count = 0;
+  ib->ignored = 0;
+  return ignored;
+}
+
+/* If LP stopped at a breakpoint that has hits left to skip, count
+   the hit, and step LP over the breakpoint's original instruction.
+   Returns non-zero if so, in which case LP should be resumed without
+   reporting the event.  Hits are only skipped while LP is the only
+   LWP of its process, since other LWPs could run past the breakpoint
+   while it is lifted.  */
+
+static int
+skip_ignored_breakpoint_hit (struct lwp_info *lp)
+{
+  int pid = GET_PID (lp->ptid);
+  int lwpid = GET_LWP (lp->ptid);
+  struct ignored_breakpoint *ib;
+  struct regcache *regcache;
+  struct gdbarch *gdbarch;
+  const gdb_byte *insn;
+  CORE_ADDR pc, addr;
+  char filename[64];
+  int fd, len, stepped;
+
+  if (ignored_breakpoints == NULL
+      || lp->step
+      || lp->stopped_by_watchpoint
+      || num_lwps (pid) != 1)
+    return 0;
+
+  regcache = get_thread_regcache (lp->ptid);
+  gdbarch = get_regcache_arch (regcache);
+  pc = regcache_read_pc (regcache) - gdbarch_decr_pc_after_break (gdbarch);
+  ib = find_ignored_breakpoint (pid, pc);
+  if (ib == NULL || ib->ignore_count == 0)
+    return 0;
+
+  addr = ib->addr;
+  insn = gdbarch_breakpoint_from_pc (ib->gdbarch, &addr, &len);
+  if (insn == NULL || len != ib->shadow_len)
+    return 0;
+
+  sprintf (filename, "/proc/%d/mem", pid);
+  fd = open (filename, O_RDWR | O_LARGEFILE);
+  if (fd == -1)
+    return 0;
+
+  if (gdbarch_decr_pc_after_break (gdbarch))
+    regcache_write_pc (regcache, pc);
+
+  /* Lift the breakpoint while LP runs the instruction under it.  */
+  stepped = (linux_proc_mem_xfer (fd, NULL, ib->shadow, ib->addr, len)
+	     && linux_nat_step_lwp_insn (lwpid) == 0);
+  if (!linux_proc_mem_xfer (fd, NULL, insn, ib->addr, len))
+    warning (_("Could not reinsert the breakpoint at %s."),
+	     paddress (ib->gdbarch, ib->addr));
+  close (fd);
+
+  registers_changed ();
+
+  if (!stepped)
+    return 0;
+
+  ib->ignore_count--;
+  ib->ignored++;
+
+  if (debug_linux_nat)
+    fprintf_unfiltered (gdb_stdlog,
+			"LLW: %s skipped breakpoint hit at %s, %d left\n",
+			target_pid_to_str (lp->ptid),
+			paddress (ib->gdbarch, ib->addr), ib->ignore_count);
+  return 1;
+}
+
 /* Enumerate spufs IDs for process PID.  */
 
 static void
@@ -5770,16 +6953,20 @@ linux_nat_core_of_thread_1 (ptid_t ptid)
   return core;
 }
 
-/* Return the cached value of the processor core for thread PTID.  */
+/* Return the processor core for thread PTID, reading it the first
+   time it is asked for since the thread last stopped.  */
 
 int
 linux_nat_core_of_thread (struct target_ops *ops, ptid_t ptid)
 {
   struct lwp_info *info = find_lwp_pid (ptid);
 
-  if (info)
-    return info->core;
-  return -1;
+  if (info == NULL)
+    return -1;
+
+  if (info->core == -1)
+    info->core = linux_nat_core_of_thread_1 (info->ptid);
+  return info->core;
 }
 
 void
@@ -5847,6 +7034,45 @@ linux_nat_set_new_thread (struct target_ops *t, void (*new_thread) (ptid_t))
   linux_nat_new_thread = new_thread;
 }
 
+/* Register a method that makes an LWP call mprotect, and use it for
+   page-protection watchpoints.  */
+void
+linux_nat_set_inferior_mprotect (struct target_ops *t,
+				 int (*inferior_mprotect) (int, CORE_ADDR,
+							   ULONGEST, int))
+{
+  linux_nat_inferior_mprotect = inferior_mprotect;
+
+  /* linux_ops keeps the architecture's debug register methods.  */
+  t->to_can_use_hw_breakpoint = linux_nat_can_use_hw_breakpoint;
+  t->to_region_ok_for_hw_watchpoint = linux_nat_region_ok_for_hw_watchpoint;
+  t->to_insert_watchpoint = linux_nat_insert_watchpoint;
+  t->to_remove_watchpoint = linux_nat_remove_watchpoint;
+  t->to_debug_registers = linux_nat_debug_registers;
+}
+
+/* Make T insert and remove software breakpoints in batches, writing
+   directly to the inferior's memory.  Only for architectures that
+   use the default memory breakpoint methods.  */
+void
+linux_nat_set_batched_breakpoints (struct target_ops *t)
+{
+  t->to_insert_breakpoints = linux_nat_insert_breakpoints;
+  t->to_remove_breakpoints = linux_nat_remove_breakpoints;
+}
+
+/* Make T skip the first hits of software breakpoints inserted with an
+   ignore count itself, stepping over them.  Only for architectures
+   that use default_memory_insert_breakpoint and can single-step.  */
+void
+linux_nat_set_breakpoint_ignore_counts (struct target_ops *t)
+{
+  t->to_insert_breakpoint = linux_nat_insert_breakpoint;
+  t->to_remove_breakpoint = linux_nat_remove_breakpoint;
+  t->to_can_ignore_breakpoint_hits = linux_nat_can_ignore_breakpoint_hits;
+  t->to_breakpoint_ignored_hits = linux_nat_breakpoint_ignored_hits;
+}
+
 /* Register a method that converts a siginfo object between the layout
    that ptrace returns, and the layout in the architecture of the
    inferior.  */
@@ -5923,6 +7149,22 @@ Enables printf debugging output."),
 			    show_debug_linux_nat,
 			    &setdebuglist, &showdebuglist);
 
+  add_setshow_boolean_cmd ("page-protection-watchpoints", class_breakpoint,
+			   &page_protection_watchpoints, _("\
+Set whether to use page protection for watchpoints."), _("\
+Show whether to use page protection for watchpoints."), _("\
+When on, watchpoints the debug registers can't handle, such as those\n\
+on large buffers, are implemented by protecting the pages that hold\n\
+them, and only accesses to those pages stop the program.  When off,\n\
+they are software watchpoints, which single-step the program.\n\
+System calls that write to a protected page fail with EFAULT,\n\
+accesses by other threads while a thread is stepped over its access\n\
+are missed, and read and access watchpoints may also report reads of\n\
+up to 32 bytes just before the watched memory."),
+			   NULL,
+			   show_page_protection_watchpoints,
+			   &setlist, &showlist);
+
   /* Save this mask as the default.  */
   sigprocmask (SIG_SETMASK, NULL, &normal_mask);
 
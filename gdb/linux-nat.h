@@ -105,7 +105,8 @@ struct lwp_info
      - TARGET_WAITKIND_SYSCALL_RETURN */
   int syscall_state;
 
-  /* The processor core this LWP was last seen on.  */
+  /* The processor core this LWP was last seen on, or -1 if it hasn't
+     been read since the LWP last stopped.  */
   int core;
 
   /* Next LWP in list.  */
@@ -167,6 +168,29 @@ void linux_nat_add_target (struct target_ops *);
 /* Register a method to call whenever a new thread is attached.  */
 void linux_nat_set_new_thread (struct target_ops *, void (*) (ptid_t));
 
+/* Register a method that makes the stopped LWP LWPID call mprotect
+   (ADDR, LEN, PROT), and returns 0 on success or an errno value.  It
+   is used for page-protection watchpoints.  */
+void linux_nat_set_inferior_mprotect (struct target_ops *,
+				      int (*) (int lwpid, CORE_ADDR addr,
+					       ULONGEST len, int prot));
+
+/* Make the target insert and remove software breakpoints in batches,
+   reading and writing the memory of neighbouring breakpoints together.
+   Only for architectures that use default_memory_insert_breakpoint.  */
+void linux_nat_set_batched_breakpoints (struct target_ops *);
+
+/* Make the target skip the first hits of software breakpoints inserted
+   with an ignore count itself, while the process has a single LWP.
+   Only for architectures that use default_memory_insert_breakpoint
+   and can single-step.  */
+void linux_nat_set_breakpoint_ignore_counts (struct target_ops *);
+
+/* Single-step the stopped LWP LWPID over one instruction, behind the
+   core's back.  Returns 0 on success and -1 on failure, or the signal
+   the instruction raised, e.g. SIGSEGV, if it faulted.  */
+int linux_nat_step_lwp_insn (int lwpid);
+
 /* Register a method that converts a siginfo object between the layout
    that ptrace returns, and the layout in the architecture of the
    inferior.  */
@@ -1409,6 +1409,17 @@ thread_db_wait (struct target_ops *ops,
 
   if (have_threads (ptid))
     {
+      struct thread_info *tp = find_thread_ptid (ptid);
+
+      /* A thread we already know about that stopped at a breakpoint
+	 can't be dead, and needs no libthread_db lookup; that is
+	 left for the next refresh of the thread list.  Most such
+	 stops are resumed straight away.  */
+      if (tp != NULL && tp->private != NULL && !tp->private->dying
+	  && ourstatus->kind == TARGET_WAITKIND_STOPPED
+	  && ourstatus->value.sig == TARGET_SIGNAL_TRAP)
+	return ptid;
+
       /* Change ptids back into the higher level PID + TID format.  If
 	 the thread is dead and no longer on the thread list, we will
 	 get back a dead ptid.  This can occur if the thread death
@@ -176,6 +176,16 @@ maintenance_space_display (char *args, int from_tty)
     set_display_space (strtol (args, NULL, 10));
 }
 
+static void
+maintenance_stats_display (char *args, int from_tty)
+{
+  if (args == NULL || *args == '\0')
+    printf_unfiltered (_("\"maintenance stats\" takes "
+			 "a numeric argument.\n"));
+  else
+    set_display_stats (strtol (args, NULL, 10));
+}
+
 /* The "maintenance info" command is defined as a prefix, with
    allow_unknown 0.  Therefore, its own definition is called only for
    "maintenance info" with no args.  */
@@ -815,6 +825,14 @@ If nonzero, will cause the execution space for each command to be\n\
 displayed, following the command's output."),
 	   &maintenancelist);
 
+  add_cmd ("stats", class_maintenance, maintenance_stats_display, _("\
+Set the display of GDB's internal counters.\n\
+If nonzero, will cause the target transfers, register fetches, symtab\n\
+expansions and frame unwinds of each command, and how its wall time was\n\
+split between Python, symbol lookup, the target and the rest of GDB, to\n\
+be displayed, following the command's output."),
+	   &maintenancelist);
+
   add_cmd ("type", class_maintenance, maintenance_print_type, _("\
 Print a type chain for a given symbol.\n\
 For each node in a type chain, print the raw data for each member of\n\
@@ -0,0 +1,542 @@
+/* Searching memory for many patterns at once.
+
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+/* Patterns are compiled into an Aho-Corasick automaton, so that the
+   scan finds the matches of all of them in one pass, whatever their
+   number.  Unless it has too many states, the automaton is turned
+   into a table of transitions for every state and byte, and the scan
+   does one table lookup per byte of memory; otherwise the scan
+   follows the failure links of the trie of the patterns.  While the
+   automaton is in its start state, and all the patterns begin with
+   the same byte, the scan skips to the next occurrence of that byte
+   with memchr.
+
+   A single pattern is searched for with memmem instead, which needs
+   no table.  Only a match that straddles two calls to
+   search_patterns_scan is completed a byte at a time, using the
+   borders of the pattern, as in Knuth-Morris-Pratt.  */
+
+#include "defs.h"
+#include "memsearch.h"
+#include "gdb_string.h"
+#include "gdb_assert.h"
+
+/* A pattern of a set.  */
+
+struct search_pattern
+{
+  gdb_byte *bytes;
+  ULONGEST len;
+
+  /* The next pattern matched by the same state of the automaton, or
+     -1.  */
+  int next;
+};
+
+/* The largest number of states for which the transitions of the
+   automaton are laid out in a table, of 256 entries per state.  */
+
+#define SEARCH_TABLE_MAX_STATES 16384
+
+struct search_patterns
+{
+  struct search_pattern *patterns;
+  int npatterns;
+  int patterns_size;
+
+  /* Nonzero if the automaton below, or BORDER for a single pattern,
+     is up to date with PATTERNS.  */
+  int built;
+
+  /* The number of states of the automaton, and the number there is
+     room for.  State 0 is the start state.  */
+  int nstates;
+  int states_size;
+
+  /* The trie of the patterns.  The states reached from state S by one
+     byte are FIRST_CHILD[S], and the chain of their SIBLINGs; state T
+     is reached by byte LABEL[T].  Chains end with -1.  */
+  int *first_child;
+  int *sibling;
+  gdb_byte *label;
+
+  /* The transitions: the state after state S reads byte B is
+     DELTA[S * 256 + B].  NULL if there are too many states, in which
+     case the scan walks the trie and the FAIL links.  */
+  int *delta;
+
+  /* For each state, the first of the patterns that end at it, or
+     -1.  */
+  int *output;
+
+  /* For each state, the state for the longest proper suffix of its
+     input that is also a prefix of a pattern.  */
+  int *fail;
+
+  /* For each state, the nearest state along the FAIL links that ends
+     some patterns, or -1.  */
+  int *output_link;
+
+  /* For each state, nonzero if some pattern ends there.  */
+  gdb_byte *reports;
+
+  /* The byte all the patterns begin with, or -1 if they don't all
+     begin with the same one.  */
+  int first_byte;
+
+  /* For a single pattern, BORDER[K] is the length of the longest
+     proper prefix of the pattern's first K bytes that is also their
+     suffix.  */
+  int *border;
+};
+
+struct search_patterns *
+search_patterns_new (void)
+{
+  return XZALLOC (struct search_patterns);
+}
+
+/* Free the automaton of PATTERNS.  */
+
+static void
+search_patterns_free_automaton (struct search_patterns *patterns)
+{
+  xfree (patterns->first_child);
+  xfree (patterns->sibling);
+  xfree (patterns->label);
+  xfree (patterns->delta);
+  xfree (patterns->output);
+  xfree (patterns->fail);
+  xfree (patterns->output_link);
+  xfree (patterns->reports);
+  xfree (patterns->border);
+  patterns->first_child = NULL;
+  patterns->sibling = NULL;
+  patterns->label = NULL;
+  patterns->delta = NULL;
+  patterns->output = NULL;
+  patterns->fail = NULL;
+  patterns->output_link = NULL;
+  patterns->reports = NULL;
+  patterns->border = NULL;
+  patterns->nstates = 0;
+  patterns->states_size = 0;
+  patterns->built = 0;
+}
+
+void
+search_patterns_free (struct search_patterns *patterns)
+{
+  int i;
+
+  if (patterns == NULL)
+    return;
+
+  for (i = 0; i < patterns->npatterns; i++)
+    xfree (patterns->patterns[i].bytes);
+  xfree (patterns->patterns);
+  search_patterns_free_automaton (patterns);
+  xfree (patterns);
+}
+
+static void
+do_search_patterns_free (void *patterns)
+{
+  search_patterns_free (patterns);
+}
+
+struct cleanup *
+make_cleanup_search_patterns_free (struct search_patterns *patterns)
+{
+  return make_cleanup (do_search_patterns_free, patterns);
+}
+
+int
+search_patterns_add (struct search_patterns *patterns,
+		     const gdb_byte *pattern, ULONGEST len)
+{
+  struct search_pattern *p;
+
+  gdb_assert (len > 0);
+
+  if (patterns->npatterns == patterns->patterns_size)
+    {
+      patterns->patterns_size = patterns->patterns_size * 2 + 4;
+      patterns->patterns
+	= xrealloc (patterns->patterns,
+		    patterns->patterns_size * sizeof (struct search_pattern));
+    }
+
+  p = &patterns->patterns[patterns->npatterns];
+  p->bytes = xmalloc (len);
+  memcpy (p->bytes, pattern, len);
+  p->len = len;
+  p->next = -1;
+
+  patterns->built = 0;
+  return patterns->npatterns++;
+}
+
+int
+search_patterns_count (struct search_patterns *patterns)
+{
+  return patterns->npatterns;
+}
+
+const gdb_byte *
+search_patterns_get (struct search_patterns *patterns, int i,
+		     ULONGEST *lenp)
+{
+  gdb_assert (i >= 0 && i < patterns->npatterns);
+
+  *lenp = patterns->patterns[i].len;
+  return patterns->patterns[i].bytes;
+}
+
+/* Add a state to the automaton of PATTERNS, with no transitions, and
+   return it.  */
+
+static int
+new_search_state (struct search_patterns *patterns)
+{
+  int s;
+
+  if (patterns->nstates == patterns->states_size)
+    {
+      int size = patterns->states_size * 2 + 64;
+
+      patterns->first_child = xrealloc (patterns->first_child,
+					size * sizeof (int));
+      patterns->sibling = xrealloc (patterns->sibling, size * sizeof (int));
+      patterns->label = xrealloc (patterns->label, size);
+      patterns->output = xrealloc (patterns->output, size * sizeof (int));
+      patterns->fail = xrealloc (patterns->fail, size * sizeof (int));
+      patterns->output_link = xrealloc (patterns->output_link,
+					size * sizeof (int));
+      patterns->reports = xrealloc (patterns->reports, size);
+      patterns->states_size = size;
+    }
+
+  s = patterns->nstates++;
+  patterns->first_child[s] = -1;
+  patterns->sibling[s] = -1;
+  patterns->label[s] = 0;
+  patterns->output[s] = -1;
+  patterns->fail[s] = 0;
+  patterns->output_link[s] = -1;
+  patterns->reports[s] = 0;
+
+  return s;
+}
+
+/* Return the state of the trie of PATTERNS reached from state S by
+   byte B, or -1.  */
+
+static int
+search_trie_child (struct search_patterns *patterns, int s, int b)
+{
+  int t;
+
+  for (t = patterns->first_child[s]; t >= 0; t = patterns->sibling[t])
+    if (patterns->label[t] == b)
+      return t;
+  return -1;
+}
+
+/* Return the state of the automaton of PATTERNS after state S reads
+   byte B.  */
+
+static int
+search_automaton_step (struct search_patterns *patterns, int s, int b)
+{
+  if (patterns->delta != NULL)
+    return patterns->delta[(size_t) s * 256 + b];
+
+  for (;;)
+    {
+      int t = search_trie_child (patterns, s, b);
+
+      if (t >= 0)
+	return t;
+      if (s == 0)
+	return 0;
+      s = patterns->fail[s];
+    }
+}
+
+/* Build the automaton of PATTERNS.  */
+
+static void
+build_search_automaton (struct search_patterns *patterns)
+{
+  int *queue;
+  int head, tail;
+  int i, t;
+
+  search_patterns_free_automaton (patterns);
+  new_search_state (patterns);
+
+  /* First the trie of the patterns.  */
+  for (i = 0; i < patterns->npatterns; i++)
+    {
+      struct search_pattern *p = &patterns->patterns[i];
+      ULONGEST k;
+      int s = 0;
+
+      for (k = 0; k < p->len; k++)
+	{
+	  t = search_trie_child (patterns, s, p->bytes[k]);
+	  if (t < 0)
+	    {
+	      t = new_search_state (patterns);
+	      patterns->label[t] = p->bytes[k];
+	      patterns->sibling[t] = patterns->first_child[s];
+	      patterns->first_child[s] = t;
+	    }
+	  s = t;
+	}
+
+      p->next = patterns->output[s];
+      patterns->output[s] = i;
+      patterns->reports[s] = 1;
+    }
+
+  /* Then the failure links, a level of the trie at a time, so that
+     the links of shallower states are known.  QUEUE ends up holding
+     the states in that order.  */
+  queue = xmalloc (patterns->nstates * sizeof (int));
+  head = tail = 0;
+  queue[tail++] = 0;
+
+  t = patterns->first_child[0];
+  patterns->first_byte = (t >= 0 && patterns->sibling[t] < 0
+			  ? patterns->label[t] : -1);
+
+  while (head < tail)
+    {
+      int r = queue[head++];
+      int u;
+
+      for (u = patterns->first_child[r]; u >= 0; u = patterns->sibling[u])
+	{
+	  int f = 0;
+
+	  if (r != 0)
+	    {
+	      f = patterns->fail[r];
+	      while ((t = search_trie_child (patterns, f,
+					     patterns->label[u])) < 0
+		     && f != 0)
+		f = patterns->fail[f];
+	      f = t >= 0 ? t : 0;
+	    }
+
+	  patterns->fail[u] = f;
+	  patterns->output_link[u] = (patterns->output[f] >= 0
+				      ? f : patterns->output_link[f]);
+	  if (patterns->output_link[u] >= 0)
+	    patterns->reports[u] = 1;
+	  queue[tail++] = u;
+	}
+    }
+
+  /* Lay out the transitions in a table if it isn't too large.  A
+     state has its children's transitions, and borrows the rest from
+     the state its failure link leads to, which comes before it in
+     QUEUE.  */
+  if (patterns->nstates <= SEARCH_TABLE_MAX_STATES)
+    {
+      patterns->delta = xmalloc ((size_t) patterns->nstates * 256
+				 * sizeof (int));
+      for (i = 0; i < patterns->nstates; i++)
+	{
+	  int r = queue[i];
+	  int *row = &patterns->delta[(size_t) r * 256];
+	  int u;
+
+	  if (r == 0)
+	    memset (row, 0, 256 * sizeof (int));
+	  else
+	    memcpy (row, &patterns->delta[(size_t) patterns->fail[r] * 256],
+		    256 * sizeof (int));
+	  for (u = patterns->first_child[r]; u >= 0;
+	       u = patterns->sibling[u])
+	    row[patterns->label[u]] = u;
+	}
+    }
+
+  xfree (queue);
+  patterns->built = 1;
+}
+
+/* Compute the borders of the single pattern of PATTERNS.  */
+
+static void
+build_search_borders (struct search_patterns *patterns)
+{
+  const struct search_pattern *p = &patterns->patterns[0];
+  ULONGEST i;
+  int k = 0;
+
+  search_patterns_free_automaton (patterns);
+  patterns->border = xmalloc ((p->len + 1) * sizeof (int));
+  patterns->border[0] = 0;
+  if (p->len > 0)
+    patterns->border[1] = 0;
+  for (i = 1; i < p->len; i++)
+    {
+      while (k > 0 && p->bytes[i] != p->bytes[k])
+	k = patterns->border[k];
+      if (p->bytes[i] == p->bytes[k])
+	k++;
+      patterns->border[i + 1] = k;
+    }
+  patterns->built = 1;
+}
+
+/* Scan for the single pattern of PATTERNS, as search_patterns_scan
+   does.  The state of the scan is the length of the longest prefix of
+   the pattern the bytes scanned so far end with.  */
+
+static int
+search_single_pattern_scan (struct search_patterns *patterns,
+			    const gdb_byte *buf, ULONGEST len,
+			    CORE_ADDR addr, int *statep,
+			    search_match_ftype *func, void *data)
+{
+  const struct search_pattern *p = &patterns->patterns[0];
+  const int *border = patterns->border;
+  ULONGEST pos = 0, tail;
+  int k = *statep;
+
+  /* Complete, or rule out, a match the previous bytes began.  */
+  while (pos < len && k > 0)
+    {
+      while (k > 0 && p->bytes[k] != buf[pos])
+	k = border[k];
+      if (p->bytes[k] == buf[pos])
+	k++;
+      pos++;
+
+      if (k == p->len)
+	{
+	  if (func (addr + pos - p->len, 0, data))
+	    {
+	      *statep = border[k];
+	      return 1;
+	    }
+	  k = border[k];
+	}
+    }
+
+  if (k > 0)
+    {
+      *statep = k;
+      return 0;
+    }
+
+  /* The rest of the matches begin in BUF.  */
+  while (pos + p->len <= len)
+    {
+      const gdb_byte *found = memmem (buf + pos, len - pos,
+				      p->bytes, p->len);
+
+      if (found == NULL)
+	break;
+
+      if (func (addr + (found - buf), 0, data))
+	{
+	  *statep = 0;
+	  return 1;
+	}
+      pos = found - buf + 1;
+    }
+
+  /* Only a match that begins in the last LEN - 1 bytes can be
+     completed by the next bytes.  */
+  tail = max (pos, len >= p->len ? len - p->len + 1 : 0);
+  for (k = 0; tail < len; tail++)
+    {
+      while (k > 0 && p->bytes[k] != buf[tail])
+	k = border[k];
+      if (p->bytes[k] == buf[tail])
+	k++;
+      if (k == p->len)
+	k = border[k];
+    }
+
+  *statep = k;
+  return 0;
+}
+
+int
+search_patterns_scan (struct search_patterns *patterns,
+		      const gdb_byte *buf, ULONGEST len,
+		      CORE_ADDR addr, int *statep,
+		      search_match_ftype *func, void *data)
+{
+  const gdb_byte *p = buf;
+  const gdb_byte *end = buf + len;
+  int state = *statep;
+
+  if (patterns->npatterns == 0)
+    return 0;
+
+  if (patterns->npatterns == 1)
+    {
+      if (!patterns->built)
+	build_search_borders (patterns);
+      return search_single_pattern_scan (patterns, buf, len, addr, statep,
+					 func, data);
+    }
+
+  if (!patterns->built)
+    build_search_automaton (patterns);
+
+  while (p < end)
+    {
+      if (state == 0 && patterns->first_byte >= 0)
+	{
+	  p = memchr (p, patterns->first_byte, end - p);
+	  if (p == NULL)
+	    break;
+	}
+
+      state = search_automaton_step (patterns, state, *p++);
+      if (patterns->reports[state])
+	{
+	  CORE_ADDR match_end = addr + (p - buf);
+	  int t, i;
+
+	  t = (patterns->output[state] >= 0
+	       ? state : patterns->output_link[state]);
+	  for (; t >= 0; t = patterns->output_link[t])
+	    for (i = patterns->output[t]; i >= 0;
+		 i = patterns->patterns[i].next)
+	      if (func (match_end - patterns->patterns[i].len, i, data))
+		{
+		  *statep = state;
+		  return 1;
+		}
+	}
+    }
+
+  *statep = state;
+  return 0;
+}
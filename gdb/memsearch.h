@@ -0,0 +1,77 @@
+/* Searching memory for many patterns at once.
+
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef MEMSEARCH_H
+#define MEMSEARCH_H
+
+struct cleanup;
+
+/* A set of byte patterns, searched for together.  */
+
+struct search_patterns;
+
+/* Return a new, empty, set of patterns.  */
+
+extern struct search_patterns *search_patterns_new (void);
+
+/* Free PATTERNS.  */
+
+extern void search_patterns_free (struct search_patterns *patterns);
+
+/* Make a cleanup that frees PATTERNS.  */
+
+extern struct cleanup *
+  make_cleanup_search_patterns_free (struct search_patterns *patterns);
+
+/* Add the LEN bytes at PATTERN to PATTERNS, and return the index of
+   the new pattern.  The first pattern added has index 0.  LEN must
+   not be zero.  */
+
+extern int search_patterns_add (struct search_patterns *patterns,
+				const gdb_byte *pattern, ULONGEST len);
+
+/* Return the number of patterns in PATTERNS.  */
+
+extern int search_patterns_count (struct search_patterns *patterns);
+
+/* Return the pattern of PATTERNS with index I, and set *LENP to its
+   length.  */
+
+extern const gdb_byte *search_patterns_get (struct search_patterns *patterns,
+					    int i, ULONGEST *lenp);
+
+/* Called for each match of a search: ADDR is the address of the start
+   of the match, and PATTERN the index of the pattern matched.  Return
+   nonzero to stop the search.  */
+
+typedef int (search_match_ftype) (CORE_ADDR addr, int pattern, void *data);
+
+/* Scan the LEN bytes at BUF, which were read from ADDR, for the
+   patterns of PATTERNS, and call FUNC with DATA for each match.
+   *STATEP holds the state of the scan, which lets matches span
+   consecutive calls: set it to zero before scanning the first bytes
+   of a region.  Matches are reported in the order in which they end.
+   Returns nonzero if FUNC stopped the scan.  */
+
+extern int search_patterns_scan (struct search_patterns *patterns,
+				 const gdb_byte *buf, ULONGEST len,
+				 CORE_ADDR addr, int *statep,
+				 search_match_ftype *func, void *data);
+
+#endif /* MEMSEARCH_H */
@@ -1960,6 +1960,7 @@ mi_execute_command (char *cmd, int from_tty)
     {
       volatile struct gdb_exception result;
       ptid_t previous_ptid = inferior_ptid;
+      struct cleanup *stat_chain;
 
       command->token = token;
 
@@ -1970,6 +1971,8 @@ mi_execute_command (char *cmd, int from_tty)
 	  timestamp (command->cmd_start);
 	}
 
+      stat_chain = make_command_stats_cleanup (1);
+
       TRY_CATCH (result, RETURN_MASK_ALL)
 	{
 	  captured_mi_execute_command (current_uiout, command);
@@ -1984,6 +1987,8 @@ mi_execute_command (char *cmd, int from_tty)
 
       bpstat_do_actions ();
 
+      do_cleanups (stat_chain);
+
       if (/* The notifications are only output when the top-level
 	     interpreter (specified on the command line) is MI.  */      
 	  ui_out_is_mi_like_p (interp_ui_out (top_level_interpreter ()))
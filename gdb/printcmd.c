@@ -49,18 +49,12 @@
 #include "charset.h"
 #include "arch-utils.h"
 #include "cli/cli-utils.h"
+#include "format.h"
 
 #ifdef TUI
 #include "tui/tui.h"		/* For tui_active et al.   */
 #endif
 
-#if defined(__MINGW32__) && !defined(PRINTF_HAS_LONG_LONG)
-# define USE_PRINTF_I64 1
-# define PRINTF_HAS_LONG_LONG
-#else
-# define USE_PRINTF_I64 0
-#endif
-
 struct format_data
   {
     int count;
@@ -1981,23 +1975,18 @@ print_variable_and_value (const char *name, struct symbol *var,
   fprintf_filtered (stream, "\n");
 }
 
-/* printf "printf format string" ARG to STREAM.  */
+/* Parse the double-quoted printf format string at the start of *ARG,
+   processing its escape sequences, and return it in a malloc'd
+   buffer.  *ARG is advanced past the string and the comma
+   separating it from the arguments, if any.  */
 
-static void
-ui_printf (char *arg, struct ui_file *stream)
+char *
+extract_printf_format (char **arg)
 {
-  char *f = NULL;
-  char *s = arg;
-  char *string = NULL;
-  struct value **val_args;
-  char *substrings;
-  char *current_substring;
-  int nargs = 0;
-  int allocated_args = 20;
-  struct cleanup *old_cleanups;
-
-  val_args = xmalloc (allocated_args * sizeof (struct value *));
-  old_cleanups = make_cleanup (free_current_contents, &val_args);
+  char *f;
+  char *s = *arg;
+  char *string;
+  struct cleanup *old_chain;
 
   if (s == 0)
     error_no_arg (_("format-control string and values to print"));
@@ -2011,7 +2000,8 @@ ui_printf (char *arg, struct ui_file *stream)
   /* Parse the format-control string and copy it into the string STRING,
      processing some kinds of escape sequence.  */
 
-  f = string = (char *) alloca (strlen (s) + 1);
+  f = string = xmalloc (strlen (s) + 1);
+  old_chain = make_cleanup (xfree, string);
 
   while (*s != '"')
     {
@@ -2075,240 +2065,47 @@ ui_printf (char *arg, struct ui_file *stream)
     s++;
   s = skip_spaces (s);
 
-  /* Need extra space for the '\0's.  Doubling the size is sufficient.  */
-  substrings = alloca (strlen (string) * 2);
-  current_substring = substrings;
-
-  {
-    /* Now scan the string for %-specs and see what kinds of args they want.
-       argclass[I] classifies the %-specs so we can give printf_filtered
-       something of the right size.  */
-
-    enum argclass
-      {
-	int_arg, long_arg, long_long_arg, ptr_arg,
-	string_arg, wide_string_arg, wide_char_arg,
-	double_arg, long_double_arg, decfloat_arg
-      };
-    enum argclass *argclass;
-    enum argclass this_argclass;
-    char *last_arg;
-    int nargs_wanted;
-    int i;
-
-    argclass = (enum argclass *) alloca (strlen (s) * sizeof *argclass);
-    nargs_wanted = 0;
-    f = string;
-    last_arg = string;
-    while (*f)
-      if (*f++ == '%')
-	{
-	  int seen_hash = 0, seen_zero = 0, lcount = 0, seen_prec = 0;
-	  int seen_space = 0, seen_plus = 0;
-	  int seen_big_l = 0, seen_h = 0, seen_big_h = 0;
-	  int seen_big_d = 0, seen_double_big_d = 0;
-	  int bad = 0;
-
-	  /* Check the validity of the format specifier, and work
-	     out what argument it expects.  We only accept C89
-	     format strings, with the exception of long long (which
-	     we autoconf for).  */
-
-	  /* Skip over "%%".  */
-	  if (*f == '%')
-	    {
-	      f++;
-	      continue;
-	    }
-
-	  /* The first part of a format specifier is a set of flag
-	     characters.  */
-	  while (strchr ("0-+ #", *f))
-	    {
-	      if (*f == '#')
-		seen_hash = 1;
-	      else if (*f == '0')
-		seen_zero = 1;
-	      else if (*f == ' ')
-		seen_space = 1;
-	      else if (*f == '+')
-		seen_plus = 1;
-	      f++;
-	    }
-
-	  /* The next part of a format specifier is a width.  */
-	  while (strchr ("0123456789", *f))
-	    f++;
-
-	  /* The next part of a format specifier is a precision.  */
-	  if (*f == '.')
-	    {
-	      seen_prec = 1;
-	      f++;
-	      while (strchr ("0123456789", *f))
-		f++;
-	    }
-
-	  /* The next part of a format specifier is a length modifier.  */
-	  if (*f == 'h')
-	    {
-	      seen_h = 1;
-	      f++;
-	    }
-	  else if (*f == 'l')
-	    {
-	      f++;
-	      lcount++;
-	      if (*f == 'l')
-		{
-		  f++;
-		  lcount++;
-		}
-	    }
-	  else if (*f == 'L')
-	    {
-	      seen_big_l = 1;
-	      f++;
-	    }
-	  /* Decimal32 modifier.  */
-	  else if (*f == 'H')
-	    {
-	      seen_big_h = 1;
-	      f++;
-	    }
-	  /* Decimal64 and Decimal128 modifiers.  */
-	  else if (*f == 'D')
-	    {
-	      f++;
-
-	      /* Check for a Decimal128.  */
-	      if (*f == 'D')
-		{
-		  f++;
-		  seen_double_big_d = 1;
-		}
-	      else
-		seen_big_d = 1;
-	    }
-
-	  switch (*f)
-	    {
-	    case 'u':
-	      if (seen_hash)
-		bad = 1;
-	      /* FALLTHROUGH */
-
-	    case 'o':
-	    case 'x':
-	    case 'X':
-	      if (seen_space || seen_plus)
-		bad = 1;
-	      /* FALLTHROUGH */
-
-	    case 'd':
-	    case 'i':
-	      if (lcount == 0)
-		this_argclass = int_arg;
-	      else if (lcount == 1)
-		this_argclass = long_arg;
-	      else
-		this_argclass = long_long_arg;
-
-	      if (seen_big_l)
-		bad = 1;
-	      break;
-
-	    case 'c':
-	      this_argclass = lcount == 0 ? int_arg : wide_char_arg;
-	      if (lcount > 1 || seen_h || seen_big_l)
-		bad = 1;
-	      if (seen_prec || seen_zero || seen_space || seen_plus)
-		bad = 1;
-	      break;
-
-	    case 'p':
-	      this_argclass = ptr_arg;
-	      if (lcount || seen_h || seen_big_l)
-		bad = 1;
-	      if (seen_prec || seen_zero || seen_space || seen_plus)
-		bad = 1;
-	      break;
-
-	    case 's':
-	      this_argclass = lcount == 0 ? string_arg : wide_string_arg;
-	      if (lcount > 1 || seen_h || seen_big_l)
-		bad = 1;
-	      if (seen_zero || seen_space || seen_plus)
-		bad = 1;
-	      break;
-
-	    case 'e':
-	    case 'f':
-	    case 'g':
-	    case 'E':
-	    case 'G':
-	      if (seen_big_h || seen_big_d || seen_double_big_d)
-		this_argclass = decfloat_arg;
-	      else if (seen_big_l)
-		this_argclass = long_double_arg;
-	      else
-		this_argclass = double_arg;
-
-	      if (lcount || seen_h)
-		bad = 1;
-	      break;
-
-	    case '*':
-	      error (_("`*' not supported for precision or width in printf"));
+  discard_cleanups (old_chain);
+  *arg = s;
+  return string;
+}
 
-	    case 'n':
-	      error (_("Format specifier `n' not supported in printf"));
+/* printf "printf format string" ARG to STREAM.  */
 
-	    case '\0':
-	      error (_("Incomplete format specifier at end of format string"));
+void
+ui_printf (char *arg, struct ui_file *stream)
+{
+  char *s = arg;
+  char *string;
+  struct value **val_args;
+  int nargs = 0;
+  int allocated_args = 20;
+  struct cleanup *old_cleanups;
 
-	    default:
-	      error (_("Unrecognized format specifier '%c' in printf"), *f);
-	    }
+  val_args = xmalloc (allocated_args * sizeof (struct value *));
+  old_cleanups = make_cleanup (free_current_contents, &val_args);
 
-	  if (bad)
-	    error (_("Inappropriate modifiers to "
-		     "format specifier '%c' in printf"),
-		   *f);
+  string = extract_printf_format (&s);
+  make_cleanup (xfree, string);
 
-	  f++;
+  {
+    struct format_piece *fpieces;
+    const char *format_error;
+    int nargs_wanted;
+    int i, fr;
 
-	  if (lcount > 1 && USE_PRINTF_I64)
-	    {
-	      /* Windows' printf does support long long, but not the usual way.
-		 Convert %lld to %I64d.  */
-	      int length_before_ll = f - last_arg - 1 - lcount;
-
-	      strncpy (current_substring, last_arg, length_before_ll);
-	      strcpy (current_substring + length_before_ll, "I64");
-	      current_substring[length_before_ll + 3] =
-		last_arg[length_before_ll + lcount];
-	      current_substring += length_before_ll + 4;
-	    }
-	  else if (this_argclass == wide_string_arg
-		   || this_argclass == wide_char_arg)
-	    {
-	      /* Convert %ls or %lc to %s.  */
-	      int length_before_ls = f - last_arg - 2;
+    /* Now scan the string for %-specs and see what kinds of args they
+       want.  The argclass of each piece lets us give printf_filtered
+       something of the right size.  */
+    fpieces = parse_format_string (string, &format_error);
+    if (fpieces == NULL)
+      error ("%s", format_error);
+    make_cleanup (free_format_pieces_cleanup, fpieces);
 
-	      strncpy (current_substring, last_arg, length_before_ls);
-	      strcpy (current_substring + length_before_ls, "s");
-	      current_substring += length_before_ls + 2;
-	    }
-	  else
-	    {
-	      strncpy (current_substring, last_arg, f - last_arg);
-	      current_substring += f - last_arg;
-	    }
-	  *current_substring++ = '\0';
-	  last_arg = f;
-	  argclass[nargs_wanted++] = this_argclass;
-	}
+    nargs_wanted = 0;
+    for (fr = 0; fpieces[fr].string != NULL; fr++)
+      if (fpieces[fr].argclass != literal_piece)
+	++nargs_wanted;
 
     /* Now, parse all arguments and evaluate them.
        Store the VALUEs in VAL_ARGS.  */
@@ -2334,10 +2131,12 @@ ui_printf (char *arg, struct ui_file *stream)
       error (_("Wrong number of arguments for specified format-string"));
 
     /* Now actually print them.  */
-    current_substring = substrings;
-    for (i = 0; i < nargs; i++)
+    i = 0;
+    for (fr = 0; fpieces[fr].string != NULL; fr++)
       {
-	switch (argclass[i])
+	char *current_substring = fpieces[fr].string;
+
+	switch (fpieces[fr].argclass)
 	  {
 	  case string_arg:
 	    {
@@ -2525,7 +2324,6 @@ ui_printf (char *arg, struct ui_file *stream)
 	       the %s format specifier.  */
 
 	      char *eos, *sos;
-	      int nnull_chars = 0;
 
 	      /* Parameter data.  */
 	      struct type *param_type = value_type (val_args[i]);
@@ -2575,19 +2373,10 @@ ui_printf (char *arg, struct ui_file *stream)
 		    }
 		}
 
-	      /* Replace %Hf, %Df and %DDf with %s's.  */
+	      /* Replace %Hf, %Df and %DDf with %s's.  The specifier
+		 ends its piece.  */
 	      *++sos = 's';
-
-	      /* Go through the whole format string and pull the correct
-		 number of chars back to compensate for the change in the
-		 format specifier.  */
-	      while (nnull_chars < nargs - i)
-		{
-		  if (*eos == '\0')
-		    nnull_chars++;
-
-		  *++sos = *++eos;
-		}
+	      *++sos = '\0';
 
 	      /* Conversion between different DFP types.  */
 	      if (TYPE_CODE (param_type) == TYPE_CODE_DECFLOAT)
@@ -2672,20 +2461,24 @@ ui_printf (char *arg, struct ui_file *stream)
 
 	      break;
 	    }
+	  case literal_piece:
+	    /* Print the portion of the format string after the last
+	       argument.  Note that this will not include any ordinary
+	       %-specs, but it might include "%%".  That is why we use
+	       printf_filtered and not puts_filtered here.  Also, we
+	       pass a dummy argument because some platforms have
+	       modified GCC to include -Wformat-security by default,
+	       which will warn here if there is no argument.  */
+	    fprintf_filtered (stream, current_substring, 0);
+	    break;
 	  default:
 	    internal_error (__FILE__, __LINE__,
 			    _("failed internal consistency check"));
 	  }
-	/* Skip to the next substring.  */
-	current_substring += strlen (current_substring) + 1;
+	/* Maybe advance to the next argument.  */
+	if (fpieces[fr].argclass != literal_piece)
+	  ++i;
       }
-    /* Print the portion of the format string after the last argument.
-       Note that this will not include any ordinary %-specs, but it
-       might include "%%".  That is why we use printf_filtered and not
-       puts_filtered here.  Also, we pass a dummy argument because
-       some platforms have modified GCC to include -Wformat-security
-       by default, which will warn here if there is no argument.  */
-    fprintf_filtered (stream, last_arg, 0);
   }
   do_cleanups (old_cleanups);
 }
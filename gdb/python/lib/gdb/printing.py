@@ -142,6 +142,7 @@ def register_pretty_printer(obj, printer, replace=False):
             i = i + 1
 
     obj.pretty_printers.insert(0, printer)
+    gdb.invalidate_cached_pretty_printers()
 
 
 class RegexpCollectionPrettyPrinter(PrettyPrinter):
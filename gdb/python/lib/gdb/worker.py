@@ -0,0 +1,124 @@
+# Worker threads for Python scripts.
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+"""Run pure-Python analysis on worker threads.
+
+GDB is not thread-safe: only GDB's own thread may use the gdb module,
+except for gdb.post_event.  The functions that use GDB, such as
+gdb.execute, gdb.parse_and_eval and the methods of gdb.Inferior and
+gdb.Value, raise RuntimeError when called from another thread.  A job runs a function that doesn't use the
+gdb module, such as one parsing memory already read, on a thread of
+its own.  The job's thread runs while GDB waits for input or for the
+program, and while it runs a command, reads memory, searches memory
+or looks up a symbol for Python.
+
+When the function returns, the job's callback is called with the
+result from GDB's thread, where it may use the gdb module again.
+
+Memory read with Inferior.read_memory can be handed to a job, as the
+buffer holds all of it.  A gdb.LazyMembuf, which reads memory when it
+is first accessed, can't: reading from a job's thread raises
+RuntimeError.
+
+Example:
+
+    data = gdb.selected_inferior().read_memory(addr, size)
+    gdb.worker.start(parse_dump, (data,), on_done=report)
+    gdb.execute("continue")
+"""
+
+import gdb
+import sys
+import threading
+
+class Job(object):
+    """A function running on a worker thread.
+
+    Attributes:
+        on_done: A function called, from GDB's thread, with the result
+                 of the job's function once it returns, or None.
+        on_error: A function called, from GDB's thread, with the
+                  exception the job's function raised, or None.
+    """
+
+    def __init__(self, function, args, kwargs, on_done, on_error):
+        self.on_done = on_done
+        self.on_error = on_error
+        self._function = function
+        self._args = args
+        self._kwargs = kwargs
+        self._result = None
+        self._exc_info = None
+        self._finished = threading.Event()
+        self._thread = threading.Thread(target=self._run)
+        self._thread.daemon = True
+
+    def _run(self):
+        """The body of the worker thread."""
+        try:
+            self._result = self._function(*self._args, **self._kwargs)
+        except:
+            self._exc_info = sys.exc_info()
+        # Post the callback first, so that it is pending once the job
+        # is done.
+        gdb.post_event(self._complete)
+        self._finished.set()
+
+    def _complete(self):
+        """Call the job's callback, from GDB's thread."""
+        if self._exc_info is None:
+            if self.on_done is not None:
+                self.on_done(self._result)
+        elif self.on_error is not None:
+            self.on_error(self._exc_info[1])
+
+    def done(self):
+        """Return whether the job's function has returned."""
+        return self._finished.is_set()
+
+    def wait(self, timeout=None):
+        """Wait for the job's function to return, for at most TIMEOUT
+        seconds if TIMEOUT is not None.  Return whether it has."""
+        self._finished.wait(timeout)
+        return self._finished.is_set()
+
+    def result(self):
+        """Wait for the job's function to return, and return its result.
+        If the function raised an exception, raise it again."""
+        self.wait()
+        if self._exc_info is not None:
+            raise self._exc_info[0], self._exc_info[1], self._exc_info[2]
+        return self._result
+
+def start(function, args=(), kwargs={}, on_done=None, on_error=None):
+    """Call FUNCTION with ARGS and KWARGS on a new worker thread.
+
+    Arguments:
+        function: The function to call.  It must not use the gdb module,
+                  nor a gdb.LazyMembuf.
+        args: A sequence of the function's positional arguments.
+        kwargs: A dictionary of the function's keyword arguments.
+        on_done: A function to call, from GDB's thread, with the result
+                 of FUNCTION once it returns.
+        on_error: A function to call, from GDB's thread, with the
+                  exception FUNCTION raised, if it raised one.
+
+    Returns:
+        The gdb.worker.Job running FUNCTION.
+    """
+    job = Job(function, tuple(args), dict(kwargs), on_done, on_error)
+    job._thread.start()
+    return job
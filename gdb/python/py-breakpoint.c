@@ -21,6 +21,7 @@
 #include "value.h"
 #include "exceptions.h"
 #include "python-internal.h"
+#include "stats.h"
 #include "charset.h"
 #include "breakpoint.h"
 #include "gdbcmd.h"
@@ -30,6 +31,8 @@
 #include "ada-lang.h"
 #include "arch-utils.h"
 #include "language.h"
+#include "regcache.h"
+#include <structmember.h>
 
 /* Number of live breakpoints.  */
 static int bppy_live;
@@ -41,6 +44,31 @@ breakpoint_object *bppy_pending_object;
 /* Function that is called when a Python condition is evaluated.  */
 static char * const stop_func = "stop";
 
+/* Function that is called when a breakpoint is hit, before GDB looks
+   at any frame, and the attribute naming the registers it is passed.  */
+static char * const fast_stop_func = "fast_stop";
+static char * const stop_registers_attr = "stop_registers";
+
+/* The context passed to a breakpoint's "fast_stop" method.  It holds
+   only what can be had from the thread's registers.  */
+
+typedef struct
+{
+  PyObject_HEAD
+
+  /* The address the thread stopped at.  */
+  PyObject *pc;
+
+  /* GDB's number of the thread that hit the breakpoint.  */
+  PyObject *thread;
+
+  /* A dictionary from the names in the breakpoint's "stop_registers"
+     to the values of those registers.  */
+  PyObject *registers;
+} breakpoint_hit_object;
+
+static PyTypeObject breakpoint_hit_object_type;
+
 /* This is used to initialize various gdb.bp_* constants.  */
 struct pybp_code
 {
@@ -616,6 +644,7 @@ bppy_init (PyObject *self, PyObject *args, PyObject *kwargs)
       char *copy = xstrdup (spec);
       struct cleanup *cleanup = make_cleanup (xfree, copy);
 
+      make_cleanup_stats_timer (STATS_TIME_GDB);
       switch (type)
 	{
 	case bp_breakpoint:
@@ -759,6 +788,156 @@ gdbpy_should_stop (struct breakpoint_object *bp_obj)
   return stop;
 }
 
+/* Return a new gdb.BreakpointHit for thread PTID stopped at breakpoint
+   PY_BP, filled from REGCACHE.  Returns NULL on error, with a Python
+   exception set.  */
+
+static PyObject *
+make_breakpoint_hit (PyObject *py_bp, struct regcache *regcache,
+		     ptid_t ptid)
+{
+  struct gdbarch *gdbarch = get_regcache_arch (regcache);
+  breakpoint_hit_object *hit;
+  PyObject *names, *seq = NULL;
+  volatile struct gdb_exception except;
+  CORE_ADDR pc = 0;
+  Py_ssize_t i;
+
+  hit = PyObject_New (breakpoint_hit_object, &breakpoint_hit_object_type);
+  if (hit == NULL)
+    return NULL;
+  hit->pc = NULL;
+  hit->thread = NULL;
+  hit->registers = PyDict_New ();
+  if (hit->registers == NULL)
+    goto fail;
+
+  if (PyObject_HasAttrString (py_bp, stop_registers_attr))
+    {
+      names = PyObject_GetAttrString (py_bp, stop_registers_attr);
+      if (names == NULL)
+	goto fail;
+      seq = PySequence_Fast (names,
+			     _("The stop_registers attribute must be "
+			       "a sequence of register names."));
+      Py_DECREF (names);
+      if (seq == NULL)
+	goto fail;
+    }
+
+  /* Read the PC and the registers in one go, so that a hit costs a
+     single setjmp.  The names were all resolved first.  */
+  for (i = 0; seq != NULL && i < PySequence_Fast_GET_SIZE (seq); i++)
+    {
+      PyObject *name = PySequence_Fast_GET_ITEM (seq, i);
+      int regnum = gdbpy_register_number (gdbarch, name);
+      PyObject *num;
+
+      if (regnum < 0)
+	goto fail;
+
+      /* Keep the number in the dictionary until it is read.  */
+      num = PyInt_FromLong (regnum);
+      if (num == NULL || PyDict_SetItem (hit->registers, name, num) < 0)
+	{
+	  Py_XDECREF (num);
+	  goto fail;
+	}
+      Py_DECREF (num);
+    }
+
+  TRY_CATCH (except, RETURN_MASK_ALL)
+    {
+      PyObject *name, *regnum;
+      Py_ssize_t pos = 0;
+
+      pc = regcache_read_pc (regcache);
+      while (PyDict_Next (hit->registers, &pos, &name, &regnum))
+	{
+	  PyObject *value
+	    = gdbpy_register_to_python (regcache, PyInt_AsLong (regnum));
+
+	  if (value == NULL)
+	    break;
+	  /* Replacing the value of an existing key does not disturb
+	     the iteration.  */
+	  PyDict_SetItem (hit->registers, name, value);
+	  Py_DECREF (value);
+	}
+    }
+  if (except.reason < 0)
+    {
+      gdbpy_convert_exception (except);
+      goto fail;
+    }
+  if (PyErr_Occurred ())
+    goto fail;
+
+  Py_XDECREF (seq);
+  hit->pc = gdb_py_long_from_ulongest (pc);
+  hit->thread = PyInt_FromLong (pid_to_thread_id (ptid));
+  if (hit->pc == NULL || hit->thread == NULL)
+    {
+      Py_DECREF (hit);
+      return NULL;
+    }
+
+  return (PyObject *) hit;
+
+ fail:
+  Py_XDECREF (seq);
+  Py_DECREF (hit);
+  return NULL;
+}
+
+/* Call the "fast_stop" method (if implemented) in the breakpoint
+   class, with a gdb.BreakpointHit for thread PTID.  This happens
+   before GDB builds any frame for the stop, so the method only sees
+   the thread's registers.  If the method returns False, the inferior
+   will be allowed to continue without the rest of the breakpoint's
+   conditions being checked.  */
+
+int
+gdbpy_fast_stop (struct breakpoint_object *bp_obj, ptid_t ptid)
+{
+  int stop = 1;
+  PyObject *py_bp = (PyObject *) bp_obj;
+  struct regcache *regcache = get_thread_regcache (ptid);
+  struct cleanup *cleanup
+    = ensure_python_env (get_regcache_arch (regcache), current_language);
+
+  if (PyObject_HasAttrString (py_bp, fast_stop_func))
+    {
+      PyObject *hit, *result = NULL;
+
+      hit = make_breakpoint_hit (py_bp, regcache, ptid);
+      if (hit != NULL)
+	{
+	  result = PyObject_CallMethod (py_bp, fast_stop_func, "O", hit);
+	  Py_DECREF (hit);
+	}
+
+      if (result)
+	{
+	  int evaluate = PyObject_IsTrue (result);
+
+	  if (evaluate == -1)
+	    gdbpy_print_stack ();
+
+	  if (! evaluate)
+	    stop = 0;
+
+	  Py_DECREF (result);
+	}
+      else
+	gdbpy_print_stack ();
+    }
+
+  do_cleanups (cleanup);
+
+  return stop;
+}
+
 /* Checks if the  "stop" method exists in this breakpoint.
    Used by condition_command to ensure mutual exclusion of breakpoint
    conditions.  */
@@ -780,6 +959,26 @@ gdbpy_breakpoint_has_py_cond (struct breakpoint_object *bp_obj)
   return has_func;
 }
 
+/* Checks if the "fast_stop" method exists in this breakpoint.  Used
+   to keep the target from skipping hits the method should see.  */
+
+int
+gdbpy_breakpoint_has_fast_stop (struct breakpoint_object *bp_obj)
+{
+  int has_func = 0;
+  PyObject *py_bp = (PyObject *) bp_obj;
+  struct gdbarch *garch = bp_obj->bp->gdbarch ? bp_obj->bp->gdbarch :
+    get_current_arch ();
+  struct cleanup *cleanup = ensure_python_env (garch, current_language);
+
+  if (py_bp != NULL)
+    has_func = PyObject_HasAttrString (py_bp, fast_stop_func);
+
+  do_cleanups (cleanup);
+
+  return has_func;
+}
+
 
 
 /* Event callback functions.  */
@@ -871,6 +1070,13 @@ gdbpy_initialize_breakpoints (void)
   PyModule_AddObject (gdb_module, "Breakpoint",
 		      (PyObject *) &breakpoint_object_type);
 
+  if (PyType_Ready (&breakpoint_hit_object_type) < 0)
+    return;
+
+  Py_INCREF (&breakpoint_hit_object_type);
+  PyModule_AddObject (gdb_module, "BreakpointHit",
+		      (PyObject *) &breakpoint_hit_object_type);
+
   observer_attach_breakpoint_created (gdbpy_breakpoint_created);
   observer_attach_breakpoint_deleted (gdbpy_breakpoint_deleted);
 
@@ -1019,3 +1225,63 @@ PyTypeObject breakpoint_object_type =
   bppy_init,			  /* tp_init */
   0,				  /* tp_alloc */
 };
+
+
+
+static void
+bphit_dealloc (PyObject *self)
+{
+  breakpoint_hit_object *hit = (breakpoint_hit_object *) self;
+
+  Py_XDECREF (hit->pc);
+  Py_XDECREF (hit->thread);
+  Py_XDECREF (hit->registers);
+  self->ob_type->tp_free (self);
+}
+
+static PyMemberDef breakpoint_hit_object_members[] =
+{
+  { "pc", T_OBJECT, offsetof (breakpoint_hit_object, pc), READONLY,
+    "The address the thread stopped at." },
+  { "thread", T_OBJECT, offsetof (breakpoint_hit_object, thread), READONLY,
+    "The number of the thread that hit the breakpoint." },
+  { "registers", T_OBJECT, offsetof (breakpoint_hit_object, registers),
+    READONLY,
+    "Dictionary of the values of the breakpoint's stop_registers." },
+  { NULL } /* Sentinel.  */
+};
+
+static PyTypeObject breakpoint_hit_object_type =
+{
+  PyObject_HEAD_INIT (NULL)
+  0,				  /*ob_size*/
+  "gdb.BreakpointHit",		  /*tp_name*/
+  sizeof (breakpoint_hit_object), /*tp_basicsize*/
+  0,				  /*tp_itemsize*/
+  bphit_dealloc,		  /*tp_dealloc*/
+  0,				  /*tp_print*/
+  0,				  /*tp_getattr*/
+  0,				  /*tp_setattr*/
+  0,				  /*tp_compare*/
+  0,				  /*tp_repr*/
+  0,				  /*tp_as_number*/
+  0,				  /*tp_as_sequence*/
+  0,				  /*tp_as_mapping*/
+  0,				  /*tp_hash */
+  0,				  /*tp_call*/
+  0,				  /*tp_str*/
+  0,				  /*tp_getattro*/
+  0,				  /*tp_setattro */
+  0,				  /*tp_as_buffer*/
+  Py_TPFLAGS_DEFAULT,		  /*tp_flags*/
+  "GDB breakpoint hit, as passed to a breakpoint's fast_stop method",
+				  /* tp_doc */
+  0,				  /* tp_traverse */
+  0,				  /* tp_clear */
+  0,				  /* tp_richcompare */
+  0,				  /* tp_weaklistoffset */
+  0,				  /* tp_iter */
+  0,				  /* tp_iternext */
+  0,				  /* tp_methods */
+  breakpoint_hit_object_members,  /* tp_members */
+};
@@ -19,8 +19,6 @@
 
 #include "py-event.h"
 
-static PyTypeObject continue_event_object_type;
-
 PyObject *
 create_continue_event_object (void)
 {
@@ -50,4 +48,4 @@ GDBPY_NEW_EVENT_TYPE (continue,
                       "ContinueEvent",
                       "GDB continue event object",
                       thread_event_object_type,
-                      static);
+                      /*no qual*/);
@@ -18,6 +18,22 @@
    along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
 
 #include "py-event.h"
+#include "event-loop.h"
+#include "language.h"
+
+/* Events emitted while gdb.events.batch has listeners are also
+   collected, in the order they happened, and delivered to those
+   listeners as a list: when the list holds "python event-batch-size"
+   events, "python event-batch-interval" milliseconds after its first
+   event, or when gdb.events.flush is called.  Listeners of the other
+   registries still get their events one at a time, as they happen.  */
+
+/* The events waiting for the listeners of gdb.events.batch, or
+   NULL.  */
+static PyObject *pending_events;
+
+/* The event-loop timer that delivers PENDING_EVENTS, or 0.  */
+static int pending_events_timer;
 
 void
 evpy_dealloc (PyObject *self)
@@ -88,6 +104,144 @@ gdbpy_initialize_event_generic (PyTypeObject *type,
 }
 
 
+/* Return the thread attribute of EVENT, Py_None for an event of the
+   whole process, or NULL if EVENT is not a thread event.  */
+
+static PyObject *
+event_thread (PyObject *event)
+{
+  if (!PyObject_TypeCheck (event, &thread_event_object_type))
+    return NULL;
+
+  return PyDict_GetItemString (((event_object *) event)->dict,
+			       "inferior_thread");
+}
+
+/* Leave out of PENDING_EVENTS the continue events that EVENT makes
+   redundant: a continue event of a thread whose last event waiting is
+   already a continue event is dropped, and a stop event replaces the
+   continue event of its thread just before it.  Returns non-zero if
+   EVENT itself is to be dropped.  */
+
+static int
+coalesce_event (PyObject *event)
+{
+  int is_stop = PyObject_TypeCheck (event, &stop_event_object_type);
+  int is_cont = PyObject_TypeCheck (event, &continue_event_object_type);
+  PyObject *thread = event_thread (event);
+  Py_ssize_t i;
+
+  if ((!is_stop && !is_cont) || thread == NULL || pending_events == NULL)
+    return 0;
+
+  /* Look back past the events of the other threads.  */
+  for (i = PyList_GET_SIZE (pending_events) - 1; i >= 0; i--)
+    {
+      PyObject *item = PyList_GET_ITEM (pending_events, i);
+      PyObject *item_thread = event_thread (item);
+
+      if (item_thread == NULL)
+	break;
+      if (item_thread != thread)
+	continue;
+
+      if (PyObject_TypeCheck (item, &continue_event_object_type))
+	{
+	  if (is_cont)
+	    return 1;
+	  if (PySequence_DelItem (pending_events, i) < 0)
+	    PyErr_Clear ();
+	}
+      break;
+    }
+
+  return 0;
+}
+
+/* Deliver the pending events when the timer set for them expires.  */
+
+static void
+pending_events_timer_handler (gdb_client_data unused)
+{
+  struct cleanup *cleanup;
+
+  pending_events_timer = 0;
+
+  cleanup = ensure_python_env (target_gdbarch, current_language);
+
+  if (evpy_deliver_pending_events () < 0)
+    gdbpy_print_stack ();
+
+  do_cleanups (cleanup);
+}
+
+/* Add EVENT to the events waiting for the listeners of
+   gdb.events.batch, and deliver them if there are enough of them.
+   Returns 0 on success, -1 on error.  */
+
+static int
+queue_event (PyObject *event)
+{
+  if (gdbpy_coalesce_events && coalesce_event (event))
+    return 0;
+
+  if (pending_events == NULL)
+    {
+      pending_events = PyList_New (0);
+      if (pending_events == NULL)
+	return -1;
+    }
+
+  if (PyList_Append (pending_events, event) < 0)
+    return -1;
+
+  if (PyList_GET_SIZE (pending_events) >= gdbpy_event_batch_size)
+    return evpy_deliver_pending_events ();
+
+  if (pending_events_timer == 0 && gdbpy_event_batch_interval != UINT_MAX)
+    pending_events_timer = create_timer (gdbpy_event_batch_interval,
+					 pending_events_timer_handler, NULL);
+  return 0;
+}
+
+/* Deliver the events waiting for the listeners of gdb.events.batch,
+   as a list.  Returns 0 if the delivery is successful, -1
+   otherwise.  */
+
+int
+evpy_deliver_pending_events (void)
+{
+  PyObject *events = pending_events;
+
+  if (pending_events_timer != 0)
+    {
+      delete_timer (pending_events_timer);
+      pending_events_timer = 0;
+    }
+
+  if (events == NULL)
+    return 0;
+
+  /* The listeners may cause new events, which start a new list.  */
+  pending_events = NULL;
+  return evpy_emit_event (events, gdb_py_events.batch);
+}
+
+/* Implementation of gdb.events.flush () -> None.  */
+
+PyObject *
+evpy_flush_events (PyObject *self, PyObject *args)
+{
+  if (evpy_deliver_pending_events () < 0)
+    {
+      PyErr_SetString (PyExc_RuntimeError,
+		       _("Failed to deliver the pending events."));
+      return NULL;
+    }
+
+  Py_RETURN_NONE;
+}
+
 /* Notify the list of listens that the given EVENT has occurred.
    returns 0 if emit is successful -1 otherwise.  */
 
@@ -122,6 +276,16 @@ evpy_emit_event (PyObject *event,
     }
 
   Py_XDECREF (callback_list_copy);
+
+  if (registry != gdb_py_events.batch
+      && !evregpy_no_listeners_p (gdb_py_events.batch)
+      && queue_event (event) < 0)
+    {
+      gdbpy_print_stack ();
+      Py_XDECREF (event);
+      return -1;
+    }
+
   Py_XDECREF (event);
   return 0;
 
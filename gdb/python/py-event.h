@@ -103,11 +103,15 @@ typedef struct
   PyObject *dict;
 } event_object;
 
+extern PyTypeObject continue_event_object_type;
+
 extern int emit_continue_event (ptid_t ptid);
 extern int emit_exited_event (const LONGEST *exit_code, struct inferior *inf);
 
 extern int evpy_emit_event (PyObject *event,
                             eventregistry_object *registry);
+extern int evpy_deliver_pending_events (void);
+extern PyObject *evpy_flush_events (PyObject *self, PyObject *args);
 
 extern PyObject *create_event_object (PyTypeObject *py_type);
 extern PyObject *create_thread_event_object (PyTypeObject *py_type);
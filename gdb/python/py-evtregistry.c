@@ -113,13 +113,18 @@ gdbpy_initialize_eventregistry (void)
                       (PyObject *) &eventregistry_object_type);
 }
 
-/* Retern the number of listeners currently connected to this
-   registry.  */
+/* Return non-zero if no listener would see an event emitted on
+   REGISTRY: it has no listeners of its own, and no listeners of
+   gdb.events.batch are collecting the events of all the registries.  */
 
 int
 evregpy_no_listeners_p (eventregistry_object *registry)
 {
-  return PyList_Size (registry->callbacks) == 0;
+  if (PyList_Size (registry->callbacks) != 0)
+    return 0;
+
+  return (registry == gdb_py_events.batch
+	  || PyList_Size (gdb_py_events.batch->callbacks) == 0);
 }
 
 static PyMethodDef eventregistry_object_methods[] =
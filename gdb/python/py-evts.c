@@ -17,7 +17,15 @@
    You should have received a copy of the GNU General Public License
    along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
 
-#include "py-events.h"
+#include "py-event.h"
+
+static PyMethodDef events_methods[] =
+{
+  { "flush", evpy_flush_events, METH_NOARGS,
+    "flush () -> None\n\
+Deliver the events waiting for the listeners of gdb.events.batch now." },
+  { NULL, NULL, 0, NULL }
+};
 
 /* Initialize python events.  */
 
@@ -44,7 +52,7 @@ add_new_registry (eventregistry_object **registryp, char *name)
 void
 gdbpy_initialize_py_events (void)
 {
-  gdb_py_events.module = Py_InitModule ("events", NULL);
+  gdb_py_events.module = Py_InitModule ("events", events_methods);
 
   if (!gdb_py_events.module)
     goto fail;
@@ -61,6 +69,9 @@ gdbpy_initialize_py_events (void)
   if (add_new_registry (&gdb_py_events.new_objfile, "new_objfile") < 0)
     goto fail;
 
+  if (add_new_registry (&gdb_py_events.batch, "batch") < 0)
+    goto fail;
+
   Py_INCREF (gdb_py_events.module);
   if (PyModule_AddObject (gdb_module,
                           "events",
@@ -28,6 +28,7 @@
 #include "python-internal.h"
 #include "symfile.h"
 #include "objfiles.h"
+#include "stats.h"
 
 typedef struct {
   PyObject_HEAD
@@ -43,6 +44,13 @@ typedef struct {
      ID as the  previous frame).  Whenever get_prev_frame returns NULL, we
      record the frame_id of the next frame and set FRAME_ID_IS_NEXT to 1.  */
   int frame_id_is_next;
+
+  /* The frame_info found for FRAME_ID, and the frame cache generation
+     it was found in.  While the frame cache isn't invalidated, this
+     saves searching for the frame by its ID, which unwinds the stack
+     from the newest frame, each time the object is used.  */
+  struct frame_info *frame;
+  unsigned int frame_gen;
 } frame_object;
 
 /* Require a valid frame.  This must be called inside a TRY_CATCH, or
@@ -66,6 +74,10 @@ frame_object_to_frame_info (PyObject *obj)
   frame_object *frame_obj = (frame_object *) obj;  
   struct frame_info *frame;
 
+  if (frame_obj->frame != NULL
+      && frame_obj->frame_gen == frame_cache_generation ())
+    return frame_obj->frame;
+
   frame = frame_find_by_id (frame_obj->frame_id);
   if (frame == NULL)
     return NULL;
@@ -73,6 +85,8 @@ frame_object_to_frame_info (PyObject *obj)
   if (frame_obj->frame_id_is_next)
     frame = get_prev_frame (frame);
 
+  frame_obj->frame = frame;
+  frame_obj->frame_gen = frame_cache_generation ();
   return frame;
 }
 
@@ -312,6 +326,8 @@ frame_info_to_frame_object (struct frame_info *frame)
 	  frame_obj->frame_id_is_next = 0;
 	}
       frame_obj->gdbarch = get_frame_arch (frame);
+      frame_obj->frame = frame;
+      frame_obj->frame_gen = frame_cache_generation ();
     }
   GDB_PY_HANDLE_EXCEPTION (except);
 
@@ -473,9 +489,12 @@ frapy_read_var (PyObject *self, PyObject *args)
 
   TRY_CATCH (except, RETURN_MASK_ALL)
     {
+      struct cleanup *cleanup = make_cleanup_stats_timer (STATS_TIME_GDB);
+
       FRAPY_REQUIRE_VALID (self, frame);
 
       val = read_var_value (var, frame);
+      do_cleanups (cleanup);
     }
   GDB_PY_HANDLE_EXCEPTION (except);
 
@@ -541,6 +560,338 @@ gdbpy_selected_frame (PyObject *self, PyObject *args)
   return frame_obj;
 }
 
+/* The fields gdb.backtrace can return for each frame.  */
+
+enum backtrace_field
+  {
+    BT_LEVEL,
+    BT_PC,
+    BT_NAME,
+    BT_FILENAME,
+    BT_LINE,
+    BT_FRAME
+  };
+
+static const char *const backtrace_field_names[] =
+  {
+    "level",
+    "pc",
+    "name",
+    "filename",
+    "line",
+    "frame",
+    NULL
+  };
+
+/* The fields gdb.backtrace returns if none are given.  */
+
+static const enum backtrace_field default_backtrace_fields[] =
+  {
+    BT_LEVEL, BT_PC, BT_NAME, BT_FILENAME, BT_LINE
+  };
+
+/* Return the value of the local variable or argument NAME in FRAME,
+   or NULL if FRAME's function has no such variable.  */
+
+static struct value *
+read_frame_local (struct frame_info *frame, const char *name)
+{
+  struct block *block = get_frame_block (frame, NULL);
+
+  for (; block != NULL; block = BLOCK_SUPERBLOCK (block))
+    {
+      struct symbol *sym = lookup_block_symbol (block, name, VAR_DOMAIN);
+
+      if (sym != NULL)
+	return read_var_value (sym, frame);
+
+      /* Don't look beyond the function, into the file's globals.  */
+      if (BLOCK_FUNCTION (block) != NULL)
+	break;
+    }
+
+  return NULL;
+}
+
+/* Return a new tuple with the NFIELDS FIELDS of FRAME, followed by
+   the values of the NLOCALS local variables named in LOCALS.  A
+   local that FRAME doesn't have, or whose value can't be read, is
+   None.  Sets a Python exception and returns NULL on error.  */
+
+static PyObject *
+frame_to_backtrace_tuple (struct frame_info *frame,
+			  const enum backtrace_field *fields, int nfields,
+			  char **locals, int nlocals)
+{
+  PyObject *tuple;
+  CORE_ADDR pc = 0;
+  char *name = NULL;
+  enum language lang;
+  struct symtab_and_line sal;
+  int have_sal = 0;
+  struct cleanup *cleanup;
+  volatile struct gdb_exception except;
+  int i;
+
+  init_sal (&sal);
+  cleanup = make_cleanup (null_cleanup, NULL);
+
+  /* Only compute what was asked for; looking up the line table is
+     the costly part.  */
+  TRY_CATCH (except, RETURN_MASK_ALL)
+    {
+      for (i = 0; i < nfields; i++)
+	if (fields[i] == BT_PC)
+	  pc = get_frame_pc (frame);
+	else if (fields[i] == BT_NAME)
+	  find_frame_funname (frame, &name, &lang, NULL);
+	else if ((fields[i] == BT_FILENAME || fields[i] == BT_LINE)
+		 && !have_sal)
+	  {
+	    find_frame_sal (frame, &sal);
+	    have_sal = 1;
+	  }
+    }
+  if (except.reason < 0)
+    {
+      do_cleanups (cleanup);
+      return gdbpy_convert_exception (except);
+    }
+
+  tuple = PyTuple_New (nfields + nlocals);
+  if (tuple == NULL)
+    {
+      do_cleanups (cleanup);
+      return NULL;
+    }
+
+  for (i = 0; i < nfields + nlocals; i++)
+    {
+      PyObject *item = Py_None;
+
+      if (i >= nfields)
+	{
+	  struct value *val = NULL;
+
+	  TRY_CATCH (except, RETURN_MASK_ALL)
+	    {
+	      val = read_frame_local (frame, locals[i - nfields]);
+	    }
+	  if (except.reason == 0 && val != NULL)
+	    item = value_to_value_object (val);
+	}
+      else
+	switch (fields[i])
+	  {
+	  case BT_LEVEL:
+	    item = PyInt_FromLong (frame_relative_level (frame));
+	    break;
+	  case BT_PC:
+	    item = gdb_py_long_from_ulongest (pc);
+	    break;
+	  case BT_NAME:
+	    if (name != NULL)
+	      item = PyUnicode_Decode (name, strlen (name),
+				       host_charset (), NULL);
+	    break;
+	  case BT_FILENAME:
+	    if (sal.symtab != NULL)
+	      item = PyString_Decode (sal.symtab->filename,
+				      strlen (sal.symtab->filename),
+				      host_charset (), NULL);
+	    break;
+	  case BT_LINE:
+	    if (sal.symtab != NULL)
+	      item = PyInt_FromLong (sal.line);
+	    break;
+	  case BT_FRAME:
+	    item = frame_info_to_frame_object (frame);
+	    break;
+	  }
+
+      if (item == NULL)
+	{
+	  Py_DECREF (tuple);
+	  do_cleanups (cleanup);
+	  return NULL;
+	}
+      if (item == Py_None)
+	Py_INCREF (Py_None);
+      PyTuple_SET_ITEM (tuple, i, item);
+    }
+
+  do_cleanups (cleanup);
+  return tuple;
+}
+
+/* Implementation of gdb.backtrace ([limit], [fields], [locals],
+   [frame]) -> List.
+   Unwinds the stack once, from FRAME or the newest frame, and returns
+   a tuple for each of the LIMIT frames found (all if LIMIT is
+   negative).  Each tuple holds the FIELDS named in a sequence, by
+   default the frame's level, pc, function name, file name and line,
+   followed by the values of the local variables named in the LOCALS
+   sequence.  This is much faster than walking the frames one
+   gdb.Frame at a time.  */
+
+PyObject *
+gdbpy_backtrace (PyObject *self, PyObject *args, PyObject *kw)
+{
+  static char *keywords[] = { "limit", "fields", "locals", "frame", NULL };
+  int limit = -1;
+  PyObject *fields_obj = NULL, *locals_obj = NULL, *start_obj = NULL;
+  enum backtrace_field *fields;
+  int nfields, nlocals = 0;
+  char **locals = NULL;
+  PyObject *result = NULL;
+  struct frame_info *frame = NULL;
+  struct cleanup *cleanup;
+  volatile struct gdb_exception except;
+  int i;
+
+  GDB_PY_REQUIRE_MAIN_THREAD ();
+
+  if (!PyArg_ParseTupleAndKeywords (args, kw, "|iOOO", keywords, &limit,
+				    &fields_obj, &locals_obj, &start_obj))
+    return NULL;
+
+  if (start_obj != NULL && start_obj != Py_None
+      && !PyObject_TypeCheck (start_obj, &frame_object_type))
+    {
+      PyErr_SetString (PyExc_TypeError, _("Frame must be a gdb.Frame."));
+      return NULL;
+    }
+
+  cleanup = make_cleanup (null_cleanup, NULL);
+
+  /* Unwinding is GDB's work; building the result is cheap next to
+     it, so it is all charged to GDB.  */
+  make_cleanup_stats_timer (STATS_TIME_GDB);
+
+  if (fields_obj == NULL || fields_obj == Py_None)
+    {
+      nfields = ARRAY_SIZE (default_backtrace_fields);
+      fields = xmalloc (nfields * sizeof (enum backtrace_field));
+      make_cleanup (xfree, fields);
+      memcpy (fields, default_backtrace_fields,
+	      nfields * sizeof (enum backtrace_field));
+    }
+  else
+    {
+      if (!PySequence_Check (fields_obj) || gdbpy_is_string (fields_obj))
+	{
+	  PyErr_SetString (PyExc_TypeError,
+			   _("Fields must be a sequence of strings."));
+	  goto fail;
+	}
+      nfields = PySequence_Size (fields_obj);
+      fields = xmalloc ((nfields + 1) * sizeof (enum backtrace_field));
+      make_cleanup (xfree, fields);
+
+      for (i = 0; i < nfields; i++)
+	{
+	  PyObject *item = PySequence_GetItem (fields_obj, i);
+	  char *name;
+	  int f;
+
+	  if (item == NULL)
+	    goto fail;
+	  name = python_string_to_host_string (item);
+	  Py_DECREF (item);
+	  if (name == NULL)
+	    goto fail;
+
+	  for (f = 0; backtrace_field_names[f] != NULL; f++)
+	    if (strcmp (name, backtrace_field_names[f]) == 0)
+	      break;
+	  if (backtrace_field_names[f] == NULL)
+	    {
+	      PyErr_Format (PyExc_ValueError,
+			    _("Unknown backtrace field '%s'."), name);
+	      xfree (name);
+	      goto fail;
+	    }
+	  xfree (name);
+	  fields[i] = f;
+	}
+    }
+
+  if (locals_obj != NULL && locals_obj != Py_None)
+    {
+      if (!PySequence_Check (locals_obj) || gdbpy_is_string (locals_obj))
+	{
+	  PyErr_SetString (PyExc_TypeError,
+			   _("Locals must be a sequence of strings."));
+	  goto fail;
+	}
+      nlocals = PySequence_Size (locals_obj);
+      locals = xcalloc (nlocals + 1, sizeof (char *));
+      make_cleanup_freeargv (locals);
+
+      for (i = 0; i < nlocals; i++)
+	{
+	  PyObject *item = PySequence_GetItem (locals_obj, i);
+
+	  if (item == NULL)
+	    goto fail;
+	  locals[i] = python_string_to_host_string (item);
+	  Py_DECREF (item);
+	  if (locals[i] == NULL)
+	    goto fail;
+	}
+    }
+
+  result = PyList_New (0);
+  if (result == NULL)
+    goto fail;
+
+  TRY_CATCH (except, RETURN_MASK_ALL)
+    {
+      if (start_obj != NULL && start_obj != Py_None)
+	FRAPY_REQUIRE_VALID (start_obj, frame);
+      else
+	frame = get_current_frame ();
+    }
+  if (except.reason < 0)
+    {
+      gdbpy_convert_exception (except);
+      goto fail;
+    }
+
+  for (i = 0; frame != NULL && (limit < 0 || i < limit); i++)
+    {
+      PyObject *tuple = frame_to_backtrace_tuple (frame, fields, nfields,
+						  locals, nlocals);
+
+      if (tuple == NULL)
+	goto fail;
+      if (PyList_Append (result, tuple) < 0)
+	{
+	  Py_DECREF (tuple);
+	  goto fail;
+	}
+      Py_DECREF (tuple);
+
+      TRY_CATCH (except, RETURN_MASK_ALL)
+	{
+	  frame = get_prev_frame (frame);
+	}
+      if (except.reason < 0)
+	{
+	  gdbpy_convert_exception (except);
+	  goto fail;
+	}
+    }
+
+  do_cleanups (cleanup);
+  return result;
+
+ fail:
+  Py_XDECREF (result);
+  do_cleanups (cleanup);
+  return NULL;
+}
+
 /* Implementation of gdb.stop_reason_string (Integer) -> String.
    Return a string explaining the unwind stop reason.  */
 
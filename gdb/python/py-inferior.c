@@ -24,12 +24,14 @@
 #include "inferior.h"
 #include "objfiles.h"
 #include "observer.h"
+#include "regcache.h"
 #include "python-internal.h"
 #include "arch-utils.h"
 #include "language.h"
 #include "gdb_signals.h"
 #include "py-event.h"
 #include "py-stopevent.h"
+#include "hashtab.h"
 
 struct threadlist_entry {
   thread_object *thread_obj;
@@ -66,6 +68,54 @@ typedef struct {
 
 static PyTypeObject membuf_object_type;
 
+/* The number of bytes a LazyMembuf object reads at a time.  Pages are
+   aligned to this size in the inferior's address space.  */
+#define LAZY_MEMBUF_PAGE_SIZE 4096
+
+/* A page read by a LazyMembuf object.  */
+
+struct lazy_membuf_page
+{
+  /* The page holds the bytes at addresses from the page boundary at
+     or below the object's address plus INDEX * LAZY_MEMBUF_PAGE_SIZE,
+     clipped to the memory the object covers.  */
+  ULONGEST index;
+
+  gdb_byte contents[LAZY_MEMBUF_PAGE_SIZE];
+};
+
+typedef struct {
+  PyObject_HEAD
+
+  /* The memory the object covers.  */
+  CORE_ADDR addr;
+  CORE_ADDR length;
+
+  /* The pages read so far, a hash table of struct lazy_membuf_page
+     keyed by their index.  Only the pages read are allocated, so the
+     object may cover the whole address space.  */
+  htab_t pages;
+
+  /* The inferior_object of the inferior whose memory the object
+     covers.  */
+  PyObject *inferior;
+
+  /* The value of lazy_membuf_resume_count when the object was
+     created.  The object holds the memory as it was at that stop:
+     once the inferior has resumed, the pages not read yet can no
+     longer be read.  */
+  ULONGEST resume_count;
+} lazy_membuf_object;
+
+/* The number of times an inferior resumed, which tells LazyMembuf
+   objects whether the memory they cover may have changed.  */
+static ULONGEST lazy_membuf_resume_count;
+
+static PyTypeObject lazy_membuf_object_type;
+
+static PyObject *make_lazy_membuf (PyObject *inferior, CORE_ADDR addr,
+				   CORE_ADDR length);
+
 /* Require that INFERIOR be a valid inferior ID.  */
 #define INFPY_REQUIRE_VALID(Inferior)				\
   do {								\
@@ -101,6 +151,8 @@ python_on_resume (ptid_t ptid)
 {
   struct cleanup *cleanup;
 
+  lazy_membuf_resume_count++;
+
   cleanup = ensure_python_env (target_gdbarch, current_language);
 
   if (emit_continue_event (ptid) < 0)
@@ -303,6 +355,8 @@ infpy_threads (PyObject *self, PyObject *args)
   inferior_object *inf_obj = (inferior_object *) self;
   PyObject *tuple;
 
+  GDB_PY_REQUIRE_MAIN_THREAD ();
+
   INFPY_REQUIRE_VALID (inf_obj);
 
   tuple = PyTuple_New (inf_obj->nthreads);
@@ -324,6 +378,8 @@ infpy_get_num (PyObject *self, void *closure)
 {
   inferior_object *inf = (inferior_object *) self;
 
+  GDB_PY_REQUIRE_MAIN_THREAD ();
+
   INFPY_REQUIRE_VALID (inf);
 
   return PyLong_FromLong (inf->inferior->num);
@@ -334,6 +390,8 @@ infpy_get_pid (PyObject *self, void *closure)
 {
   inferior_object *inf = (inferior_object *) self;
 
+  GDB_PY_REQUIRE_MAIN_THREAD ();
+
   INFPY_REQUIRE_VALID (inf);
 
   return PyLong_FromLong (inf->inferior->pid);
@@ -344,6 +402,8 @@ infpy_get_was_attached (PyObject *self, void *closure)
 {
   inferior_object *inf = (inferior_object *) self;
 
+  GDB_PY_REQUIRE_MAIN_THREAD ();
+
   INFPY_REQUIRE_VALID (inf);
   if (inf->inferior->attach_flag)
     Py_RETURN_TRUE;
@@ -376,6 +436,8 @@ gdbpy_inferiors (PyObject *unused, PyObject *unused2)
 {
   PyObject *list, *tuple;
 
+  GDB_PY_REQUIRE_MAIN_THREAD ();
+
   list = PyList_New (0);
   if (!list)
     return NULL;
@@ -394,71 +456,357 @@ gdbpy_inferiors (PyObject *unused, PyObject *unused2)
 
 /* Membuf and memory manipulation.  */
 
-/* Implementation of gdb.read_memory (address, length).
+/* Return a new Membuf object owning BUFFER, which holds the LENGTH
+   bytes of the inferior's memory at ADDR.  Frees BUFFER and returns
+   NULL, with a Python exception set, on error.  */
+static PyObject *
+make_membuf (void *buffer, CORE_ADDR addr, CORE_ADDR length)
+{
+  membuf_object *membuf_obj;
+
+  membuf_obj = PyObject_New (membuf_object, &membuf_object_type);
+  if (membuf_obj == NULL)
+    {
+      xfree (buffer);
+      PyErr_SetString (PyExc_MemoryError,
+		       _("Could not allocate memory buffer object."));
+      return NULL;
+    }
+
+  membuf_obj->buffer = buffer;
+  membuf_obj->addr = addr;
+  membuf_obj->length = length;
+
+  return (PyObject *) membuf_obj;
+}
+
+/* Read the LENGTH bytes of the inferior's memory at ADDR into a new
+   Membuf object.  If UNREADABLE is not NULL and the memory can't be
+   read, set *UNREADABLE and return NULL without a Python exception
+   set.  Otherwise returns NULL on error, with a Python exception
+   set.  Other Python threads may run while the memory is read.  */
+static PyObject *
+read_membuf (CORE_ADDR addr, CORE_ADDR length, int *unreadable)
+{
+  void *buffer;
+  volatile struct gdb_exception except;
+
+  if (unreadable != NULL)
+    *unreadable = 0;
+
+  buffer = xmalloc (length);
+  Py_BEGIN_ALLOW_THREADS
+  TRY_CATCH (except, RETURN_MASK_ALL)
+    {
+      read_memory (addr, buffer, length);
+    }
+  Py_END_ALLOW_THREADS
+  if (except.reason < 0)
+    {
+      xfree (buffer);
+      if (unreadable != NULL && except.error == MEMORY_ERROR)
+	{
+	  *unreadable = 1;
+	  return NULL;
+	}
+      GDB_PY_HANDLE_EXCEPTION (except);
+    }
+
+  return make_membuf (buffer, addr, length);
+}
+
+/* Implementation of gdb.read_memory (address, length [, buffer, lazy]).
    Returns a Python buffer object with LENGTH bytes of the inferior's
-   memory at ADDRESS.  Both arguments are integers.  Returns NULL on error,
-   with a python exception set.  */
+   memory at ADDRESS.  Both arguments are integers.  If BUFFER, an
+   object supporting the writable buffer protocol, is given, the bytes
+   are read into it instead, and their number is returned.  If LAZY is
+   true, returns a LazyMembuf object, which reads the memory a page at
+   a time when it is first accessed: it is a snapshot of the memory at
+   the current stop, and once the inferior resumes, the pages it has
+   not read yet can't be read.  Returns NULL on error, with a python
+   exception set.  */
 static PyObject *
 infpy_read_memory (PyObject *self, PyObject *args, PyObject *kw)
 {
   int error = 0;
   CORE_ADDR addr, length;
-  void *buffer = NULL;
-  membuf_object *membuf_obj;
-  PyObject *addr_obj, *length_obj;
-  struct cleanup *cleanups;
+  PyObject *addr_obj, *length_obj, *result;
+  PyObject *buffer_obj = NULL, *lazy_obj = NULL;
+  int lazy = 0;
   volatile struct gdb_exception except;
-  static char *keywords[] = { "address", "length", NULL };
+  static char *keywords[] = { "address", "length", "buffer", "lazy", NULL };
+
+  GDB_PY_REQUIRE_MAIN_THREAD ();
 
-  if (! PyArg_ParseTupleAndKeywords (args, kw, "OO", keywords,
-				     &addr_obj, &length_obj))
+  if (! PyArg_ParseTupleAndKeywords (args, kw, "OO|OO", keywords,
+				     &addr_obj, &length_obj,
+				     &buffer_obj, &lazy_obj))
     return NULL;
 
-  cleanups = make_cleanup (null_cleanup, NULL);
+  if (buffer_obj == Py_None)
+    buffer_obj = NULL;
+  if (lazy_obj != NULL)
+    {
+      lazy = PyObject_IsTrue (lazy_obj);
+      if (lazy < 0)
+	return NULL;
+    }
+  if (lazy && buffer_obj != NULL)
+    {
+      PyErr_SetString (PyExc_ValueError,
+		       _("Cannot read lazily into a buffer."));
+      return NULL;
+    }
 
   TRY_CATCH (except, RETURN_MASK_ALL)
     {
       if (!get_addr_from_python (addr_obj, &addr)
 	  || !get_addr_from_python (length_obj, &length))
+	error = 1;
+    }
+  GDB_PY_HANDLE_EXCEPTION (except);
+
+  if (error)
+    return NULL;
+
+  if (buffer_obj != NULL)
+    {
+      Py_buffer view;
+      void *dest;
+      Py_ssize_t dest_len;
+      int exported = PyObject_CheckBuffer (buffer_obj);
+
+      /* An exported buffer can't be resized or freed until it is
+	 released, so other threads may run while we read into it.
+	 Objects with only the old buffer protocol give no such
+	 guarantee, and are read into with the GIL held.  */
+      if (exported)
 	{
-	  error = 1;
-	  break;
+	  if (PyObject_GetBuffer (buffer_obj, &view, PyBUF_WRITABLE) < 0)
+	    return NULL;
+	  dest = view.buf;
+	  dest_len = view.len;
 	}
+      else if (PyObject_AsWriteBuffer (buffer_obj, &dest, &dest_len) < 0)
+	return NULL;
 
-      buffer = xmalloc (length);
-      make_cleanup (xfree, buffer);
+      if (length > dest_len)
+	{
+	  if (exported)
+	    PyBuffer_Release (&view);
+	  PyErr_SetString (PyExc_ValueError,
+			   _("The buffer is too small for the memory read."));
+	  return NULL;
+	}
 
-      read_memory (addr, buffer, length);
-    }
-  if (except.reason < 0)
-    {
-      do_cleanups (cleanups);
+      if (exported)
+	{
+	  Py_BEGIN_ALLOW_THREADS
+	  TRY_CATCH (except, RETURN_MASK_ALL)
+	    {
+	      read_memory (addr, dest, length);
+	    }
+	  Py_END_ALLOW_THREADS
+	  PyBuffer_Release (&view);
+	}
+      else
+	{
+	  TRY_CATCH (except, RETURN_MASK_ALL)
+	    {
+	      read_memory (addr, dest, length);
+	    }
+	}
       GDB_PY_HANDLE_EXCEPTION (except);
+
+      return PyLong_FromUnsignedLongLong (length);
     }
 
-  if (error)
+  if (lazy)
+    return make_lazy_membuf (self, addr, length);
+
+  result = read_membuf (addr, length, NULL);
+  if (result == NULL)
+    return NULL;
+
+  return PyBuffer_FromReadWriteObject (result, 0, Py_END_OF_BUFFER);
+}
+
+/* A range of memory to read for read_memory_ranges, and the index of
+   its buffer in the result.  */
+
+struct memory_range
+{
+  CORE_ADDR addr;
+  CORE_ADDR length;
+  Py_ssize_t index;
+};
+
+/* qsort comparison function for memory ranges, by address.  */
+
+static int
+compare_memory_ranges (const void *ap, const void *bp)
+{
+  const struct memory_range *a = ap;
+  const struct memory_range *b = bp;
+
+  if (a->addr != b->addr)
+    return a->addr < b->addr ? -1 : 1;
+  return a->index < b->index ? -1 : a->index > b->index;
+}
+
+/* Set element RANGE->INDEX of the list RESULT to a buffer over the
+   bytes of RANGE within MEMBUF, or to None if MEMBUF is NULL.
+   Returns 0 on success, -1 on error with a Python exception set.  */
+
+static int
+set_range_buffer (PyObject *result, const struct memory_range *range,
+		  PyObject *membuf)
+{
+  PyObject *item;
+
+  if (membuf == NULL)
     {
-      do_cleanups (cleanups);
-      return NULL;
+      Py_INCREF (Py_None);
+      item = Py_None;
     }
+  else
+    {
+      membuf_object *membuf_obj = (membuf_object *) membuf;
 
-  membuf_obj = PyObject_New (membuf_object, &membuf_object_type);
-  if (membuf_obj == NULL)
+      item = PyBuffer_FromReadWriteObject (membuf,
+					   range->addr - membuf_obj->addr,
+					   range->length);
+      if (item == NULL)
+	return -1;
+    }
+
+  PyList_SET_ITEM (result, range->index, item);
+  return 0;
+}
+
+/* Implementation of gdb.read_memory_ranges (ranges).  RANGES is a
+   sequence of (address, length) pairs.  Returns a list holding, for
+   each pair, a buffer object with the memory read, or None if it
+   could not be read.  Overlapping and adjacent ranges are read
+   together, and their buffers share the memory read.  Returns NULL on
+   error, with a python exception set.  */
+static PyObject *
+infpy_read_memory_ranges (PyObject *self, PyObject *args, PyObject *kw)
+{
+  PyObject *ranges_obj, *seq, *result = NULL;
+  struct memory_range *ranges;
+  Py_ssize_t i, j, n;
+  int error = 0;
+  volatile struct gdb_exception except;
+  static char *keywords[] = { "ranges", NULL };
+
+  GDB_PY_REQUIRE_MAIN_THREAD ();
+
+  if (! PyArg_ParseTupleAndKeywords (args, kw, "O", keywords, &ranges_obj))
+    return NULL;
+
+  seq = PySequence_Fast (ranges_obj, _("The ranges must be a sequence."));
+  if (seq == NULL)
+    return NULL;
+
+  n = PySequence_Fast_GET_SIZE (seq);
+  ranges = xmalloc ((n > 0 ? n : 1) * sizeof (struct memory_range));
+
+  for (i = 0; i < n; i++)
     {
-      PyErr_SetString (PyExc_MemoryError,
-		       _("Could not allocate memory buffer object."));
-      do_cleanups (cleanups);
-      return NULL;
+      PyObject *item = PySequence_Fast_GET_ITEM (seq, i);
+      PyObject *addr_obj, *length_obj;
+
+      if (!PyTuple_Check (item) || PyTuple_GET_SIZE (item) != 2)
+	{
+	  PyErr_SetString (PyExc_TypeError,
+			   _("Each range must be an (address, length) pair."));
+	  goto fail;
+	}
+      addr_obj = PyTuple_GET_ITEM (item, 0);
+      length_obj = PyTuple_GET_ITEM (item, 1);
+
+      TRY_CATCH (except, RETURN_MASK_ALL)
+	{
+	  if (!get_addr_from_python (addr_obj, &ranges[i].addr)
+	      || !get_addr_from_python (length_obj, &ranges[i].length))
+	    error = 1;
+	}
+      if (except.reason < 0)
+	{
+	  gdbpy_convert_exception (except);
+	  goto fail;
+	}
+      if (error)
+	goto fail;
+      ranges[i].index = i;
     }
 
-  discard_cleanups (cleanups);
+  result = PyList_New (n);
+  if (result == NULL)
+    goto fail;
 
-  membuf_obj->buffer = buffer;
-  membuf_obj->addr = addr;
-  membuf_obj->length = length;
+  qsort (ranges, n, sizeof (struct memory_range), compare_memory_ranges);
+
+  /* Read each run of overlapping or adjacent ranges at once.  If a
+     run can't be read as a whole, read its ranges one by one, so that
+     only the ranges that can't be read get None.  */
+  for (i = 0; i < n; i = j)
+    {
+      CORE_ADDR start = ranges[i].addr;
+      CORE_ADDR end = ranges[i].addr + ranges[i].length;
+      PyObject *membuf;
+      Py_ssize_t k;
+      int unreadable;
+
+      for (j = i + 1; j < n && ranges[j].addr <= end; j++)
+	if (ranges[j].addr + ranges[j].length > end)
+	  end = ranges[j].addr + ranges[j].length;
+
+      membuf = read_membuf (start, end - start, &unreadable);
+      if (membuf == NULL && !unreadable)
+	goto fail;
+
+      if (membuf != NULL)
+	{
+	  for (k = i; k < j; k++)
+	    if (set_range_buffer (result, &ranges[k], membuf) < 0)
+	      {
+		Py_DECREF (membuf);
+		goto fail;
+	      }
+	  Py_DECREF (membuf);
+	  continue;
+	}
+
+      for (k = i; k < j; k++)
+	{
+	  membuf = NULL;
+	  if (j - i > 1)
+	    {
+	      membuf = read_membuf (ranges[k].addr, ranges[k].length,
+				    &unreadable);
+	      if (membuf == NULL && !unreadable)
+		goto fail;
+	    }
+	  if (set_range_buffer (result, &ranges[k], membuf) < 0)
+	    {
+	      Py_XDECREF (membuf);
+	      goto fail;
+	    }
+	  Py_XDECREF (membuf);
+	}
+    }
+
+  xfree (ranges);
+  Py_DECREF (seq);
+  return result;
 
-  return PyBuffer_FromReadWriteObject ((PyObject *) membuf_obj, 0,
-				       Py_END_OF_BUFFER);
+ fail:
+  Py_XDECREF (result);
+  xfree (ranges);
+  Py_DECREF (seq);
+  return NULL;
 }
 
 /* Implementation of gdb.write_memory (address, buffer [, length]).
@@ -478,6 +826,8 @@ infpy_write_memory (PyObject *self, PyObject *args, PyObject *kw)
   volatile struct gdb_exception except;
   static char *keywords[] = { "address", "buffer", "length", NULL };
 
+  GDB_PY_REQUIRE_MAIN_THREAD ();
+
 
   if (! PyArg_ParseTupleAndKeywords (args, kw, "Os#|O", keywords,
 				     &addr_obj, &buffer, &buf_len,
@@ -573,6 +923,378 @@ get_char_buffer (PyObject *self, Py_ssize_t segment, char **ptrptr)
   return ret;
 }
 
+/* Hash function of the pages of a LazyMembuf object, by index.  */
+static hashval_t
+hash_lazy_membuf_page_index (ULONGEST index)
+{
+  return (hashval_t) (index ^ (index >> 31));
+}
+
+static hashval_t
+hash_lazy_membuf_page (const void *p)
+{
+  const struct lazy_membuf_page *page = p;
+
+  return hash_lazy_membuf_page_index (page->index);
+}
+
+/* Equality function of the pages of a LazyMembuf object.  The key is
+   a pointer to a page index.  */
+static int
+eq_lazy_membuf_page (const void *p, const void *key)
+{
+  const struct lazy_membuf_page *page = p;
+
+  return page->index == *(const ULONGEST *) key;
+}
+
+/* Return a new LazyMembuf object covering the LENGTH bytes of memory
+   at ADDR in the inferior of the inferior_object INFERIOR, none of
+   which is read yet.  Returns NULL on error, with a Python exception
+   set.  */
+static PyObject *
+make_lazy_membuf (PyObject *inferior, CORE_ADDR addr, CORE_ADDR length)
+{
+  lazy_membuf_object *obj;
+
+  /* The length must fit in the sequence protocol.  */
+  if (length > PY_SSIZE_T_MAX)
+    {
+      PyErr_SetString (PyExc_ValueError,
+		       _("The length is too large for a LazyMembuf."));
+      return NULL;
+    }
+  if (length > 0 && addr + length - 1 < addr)
+    {
+      PyErr_SetString (PyExc_ValueError,
+		       _("The memory wraps around the address space."));
+      return NULL;
+    }
+
+  obj = PyObject_New (lazy_membuf_object, &lazy_membuf_object_type);
+  if (obj == NULL)
+    return NULL;
+
+  obj->addr = addr;
+  obj->length = length;
+  obj->pages = htab_create_alloc (1, hash_lazy_membuf_page,
+				  eq_lazy_membuf_page, xfree,
+				  xcalloc, xfree);
+  Py_INCREF (inferior);
+  obj->inferior = inferior;
+  obj->resume_count = lazy_membuf_resume_count;
+
+  return (PyObject *) obj;
+}
+
+/* Destructor of LazyMembuf objects.  */
+static void
+lmpy_dealloc (PyObject *self)
+{
+  lazy_membuf_object *obj = (lazy_membuf_object *) self;
+
+  htab_delete (obj->pages);
+  Py_DECREF (obj->inferior);
+  self->ob_type->tp_free (self);
+}
+
+/* Return a description of the LazyMembuf object.  */
+static PyObject *
+lmpy_str (PyObject *self)
+{
+  lazy_membuf_object *obj = (lazy_membuf_object *) self;
+
+  return PyString_FromFormat (_("Lazy memory buffer for address %s, \
+which is %s bytes long."),
+			      paddress (python_gdbarch, obj->addr),
+			      pulongest (obj->length));
+}
+
+/* Copy LEN bytes at OFFSET within the memory OBJ covers to DEST,
+   reading the pages not read yet.  Only GDB's thread can read them,
+   from the object's inferior when it is the current one, and only
+   while the inferior is still stopped where the object was created.
+   Returns 0 on success, -1 on error with a Python exception set.  */
+static int
+lmpy_copy (lazy_membuf_object *obj, ULONGEST offset, ULONGEST len,
+	   gdb_byte *dest)
+{
+  CORE_ADDR first_page = obj->addr / LAZY_MEMBUF_PAGE_SIZE;
+  volatile struct gdb_exception except;
+
+  while (len > 0)
+    {
+      CORE_ADDR addr = obj->addr + offset;
+      ULONGEST index = addr / LAZY_MEMBUF_PAGE_SIZE - first_page;
+      hashval_t hash = hash_lazy_membuf_page_index (index);
+      ULONGEST in_page = addr % LAZY_MEMBUF_PAGE_SIZE;
+      ULONGEST chunk = LAZY_MEMBUF_PAGE_SIZE - in_page;
+      struct lazy_membuf_page *page;
+
+      if (chunk > len)
+	chunk = len;
+
+      page = htab_find_with_hash (obj->pages, &index, hash);
+      if (page == NULL)
+	{
+	  CORE_ADDR start = addr - in_page;
+	  CORE_ADDR end = start + LAZY_MEMBUF_PAGE_SIZE;
+	  struct inferior *inf;
+
+	  if (!gdbpy_main_thread_p ())
+	    {
+	      PyErr_SetString (PyExc_RuntimeError,
+			       _("A LazyMembuf can only read memory from "
+				 "GDB's thread."));
+	      return -1;
+	    }
+
+	  inf = ((inferior_object *) obj->inferior)->inferior;
+	  if (inf == NULL)
+	    {
+	      PyErr_SetString (PyExc_RuntimeError,
+			       _("Inferior no longer exists."));
+	      return -1;
+	    }
+	  if (inf != current_inferior ())
+	    {
+	      PyErr_SetString (PyExc_RuntimeError,
+			       _("A LazyMembuf can only read memory while "
+				 "its inferior is the current one."));
+	      return -1;
+	    }
+	  if (obj->resume_count != lazy_membuf_resume_count)
+	    {
+	      PyErr_SetString (PyExc_RuntimeError,
+			       _("The inferior has resumed since the "
+				 "LazyMembuf was created."));
+	      return -1;
+	    }
+
+	  page = xmalloc (sizeof (struct lazy_membuf_page));
+	  page->index = index;
+
+	  if (start < obj->addr)
+	    start = obj->addr;
+	  if (end - obj->addr > obj->length)
+	    end = obj->addr + obj->length;
+
+	  Py_BEGIN_ALLOW_THREADS
+	  TRY_CATCH (except, RETURN_MASK_ALL)
+	    {
+	      read_memory (start,
+			   page->contents + start % LAZY_MEMBUF_PAGE_SIZE,
+			   end - start);
+	    }
+	  Py_END_ALLOW_THREADS
+	  if (except.reason < 0)
+	    {
+	      xfree (page);
+	      gdbpy_convert_exception (except);
+	      return -1;
+	    }
+
+	  *htab_find_slot_with_hash (obj->pages, &index, hash, INSERT) = page;
+	}
+
+      memcpy (dest, page->contents + in_page, chunk);
+      dest += chunk;
+      offset += chunk;
+      len -= chunk;
+    }
+
+  return 0;
+}
+
+/* Return the length of the object, which make_lazy_membuf checked
+   fits.  */
+static Py_ssize_t
+lmpy_length (PyObject *self)
+{
+  return ((lazy_membuf_object *) self)->length;
+}
+
+/* Return the byte at index I, as a string of length one.  */
+static PyObject *
+lmpy_item (PyObject *self, Py_ssize_t i)
+{
+  lazy_membuf_object *obj = (lazy_membuf_object *) self;
+  gdb_byte byte;
+
+  if (i < 0 || i >= obj->length)
+    {
+      PyErr_SetString (PyExc_IndexError, _("Index out of range."));
+      return NULL;
+    }
+
+  if (lmpy_copy (obj, i, 1, &byte) < 0)
+    return NULL;
+
+  return PyString_FromStringAndSize ((char *) &byte, 1);
+}
+
+/* Return the bytes from index LOW to index HIGH, as a string.  */
+static PyObject *
+lmpy_slice (PyObject *self, Py_ssize_t low, Py_ssize_t high)
+{
+  lazy_membuf_object *obj = (lazy_membuf_object *) self;
+  PyObject *result;
+
+  if (low < 0)
+    low = 0;
+  if (high > obj->length)
+    high = obj->length;
+  if (high < low)
+    high = low;
+
+  result = PyString_FromStringAndSize (NULL, high - low);
+  if (result == NULL)
+    return NULL;
+
+  if (lmpy_copy (obj, low, high - low,
+		 (gdb_byte *) PyString_AS_STRING (result)) < 0)
+    {
+      Py_DECREF (result);
+      return NULL;
+    }
+
+  return result;
+}
+
+/* A match of gdb.search_memory with a list of patterns.  */
+
+typedef struct search_memory_match
+{
+  CORE_ADDR addr;
+  int pattern;
+} search_memory_match_s;
+
+DEF_VEC_O (search_memory_match_s);
+
+/* The search_match_ftype callback of gdb.search_memory with a list of
+   patterns.  DATA is the vector of the matches.  This runs without
+   the GIL, so it mustn't touch Python objects.  */
+
+static int
+search_memory_match (CORE_ADDR addr, int pattern, void *data)
+{
+  VEC (search_memory_match_s) **matches = data;
+  search_memory_match_s *match;
+
+  match = VEC_safe_push (search_memory_match_s, *matches, NULL);
+  match->addr = addr;
+  match->pattern = pattern;
+  return 0;
+}
+
+/* qsort comparison function for the matches of gdb.search_memory,
+   by address and then pattern.  */
+
+static int
+compare_search_matches (const void *ap, const void *bp)
+{
+  const search_memory_match_s *a = ap;
+  const search_memory_match_s *b = bp;
+
+  if (a->addr != b->addr)
+    return a->addr < b->addr ? -1 : 1;
+  return a->pattern - b->pattern;
+}
+
+/* Subroutine of infpy_search_memory.  Search LENGTH bytes at
+   START_ADDR for all the matches of the patterns in the sequence
+   PATTERN_SEQ, and return a list of (address, index) tuples, by
+   address.  Returns NULL on error, with a python exception set.  */
+
+static PyObject *
+search_memory_patterns (CORE_ADDR start_addr, CORE_ADDR length,
+			PyObject *pattern_seq)
+{
+  struct search_patterns *patterns;
+  VEC (search_memory_match_s) *matches = NULL;
+  search_memory_match_s *match;
+  struct cleanup *cleanups;
+  PyObject *seq, *result;
+  volatile struct gdb_exception except;
+  Py_ssize_t i, n;
+
+  seq = PySequence_Fast (pattern_seq, _("The patterns must be a sequence."));
+  if (seq == NULL)
+    return NULL;
+
+  patterns = search_patterns_new ();
+  cleanups = make_cleanup_search_patterns_free (patterns);
+  make_cleanup_py_decref (seq);
+
+  n = PySequence_Fast_GET_SIZE (seq);
+  for (i = 0; i < n; i++)
+    {
+      const void *buffer;
+      Py_ssize_t pattern_size;
+
+      if (PyObject_AsReadBuffer (PySequence_Fast_GET_ITEM (seq, i),
+				 &buffer, &pattern_size) == -1)
+	{
+	  do_cleanups (cleanups);
+	  return NULL;
+	}
+      if (pattern_size == 0)
+	{
+	  PyErr_SetString (PyExc_ValueError, _("A pattern is empty."));
+	  do_cleanups (cleanups);
+	  return NULL;
+	}
+      search_patterns_add (patterns, buffer, pattern_size);
+    }
+
+  make_cleanup (VEC_cleanup (search_memory_match_s), &matches);
+
+  /* The patterns were copied, so other Python threads may run during
+     the search.  */
+  Py_BEGIN_ALLOW_THREADS
+  TRY_CATCH (except, RETURN_MASK_ALL)
+    {
+      target_search_memory_all (start_addr, length, patterns,
+				search_memory_match, &matches);
+    }
+  Py_END_ALLOW_THREADS
+  if (except.reason < 0)
+    {
+      do_cleanups (cleanups);
+      GDB_PY_HANDLE_EXCEPTION (except);
+    }
+
+  if (!VEC_empty (search_memory_match_s, matches))
+    qsort (VEC_address (search_memory_match_s, matches),
+	   VEC_length (search_memory_match_s, matches),
+	   sizeof (search_memory_match_s), compare_search_matches);
+
+  result = PyList_New (VEC_length (search_memory_match_s, matches));
+  if (result == NULL)
+    {
+      do_cleanups (cleanups);
+      return NULL;
+    }
+
+  for (i = 0; VEC_iterate (search_memory_match_s, matches, i, match); i++)
+    {
+      PyObject *item = Py_BuildValue ("(Ki)",
+				      (unsigned PY_LONG_LONG) match->addr,
+				      match->pattern);
+
+      if (item == NULL)
+	{
+	  Py_DECREF (result);
+	  do_cleanups (cleanups);
+	  return NULL;
+	}
+      PyList_SET_ITEM (result, i, item);
+    }
+
+  do_cleanups (cleanups);
+  return result;
+}
+
 /* Implementation of
    gdb.search_memory (address, length, pattern).  ADDRESS is the
    address to start the search.  LENGTH specifies the scope of the
@@ -580,7 +1302,11 @@ get_char_buffer (PyObject *self, Py_ssize_t segment, char **ptrptr)
    must be a Python object supporting the buffer protocol).
    Returns a Python Long object holding the address where the pattern
    was located, or if the pattern was not found, returns None.  Returns NULL
-   on error, with a python exception set.  */
+   on error, with a python exception set.
+
+   If PATTERN is a list or tuple of patterns instead, they are all
+   searched for at once, and the result is a list of an (address,
+   index) tuple for every match, ordered by address.  */
 static PyObject *
 infpy_search_memory (PyObject *self, PyObject *args, PyObject *kw)
 {
@@ -593,6 +1319,8 @@ infpy_search_memory (PyObject *self, PyObject *args, PyObject *kw)
   CORE_ADDR found_addr;
   int found = 0;
 
+  GDB_PY_REQUIRE_MAIN_THREAD ();
+
   if (! PyArg_ParseTupleAndKeywords (args, kw, "OOO", keywords,
 				     &start_addr_obj, &length_obj,
 				     &pattern))
@@ -620,6 +1348,9 @@ infpy_search_memory (PyObject *self, PyObject *args, PyObject *kw)
   else
     return NULL;
 
+  if (PyList_Check (pattern) || PyTuple_Check (pattern))
+    return search_memory_patterns (start_addr, length, pattern);
+
   if (!PyObject_CheckReadBuffer (pattern))
     {
       PyErr_SetString (PyExc_RuntimeError,
@@ -631,12 +1362,14 @@ infpy_search_memory (PyObject *self, PyObject *args, PyObject *kw)
   if (PyObject_AsReadBuffer (pattern, &buffer, &pattern_size) == -1)
     return NULL;
 
+  Py_BEGIN_ALLOW_THREADS
   TRY_CATCH (except, RETURN_MASK_ALL)
     {
       found = target_search_memory (start_addr, length,
 				    buffer, pattern_size,
 				    &found_addr);
     }
+  Py_END_ALLOW_THREADS
   GDB_PY_HANDLE_EXCEPTION (except);
 
   if (found)
@@ -645,6 +1378,251 @@ infpy_search_memory (PyObject *self, PyObject *args, PyObject *kw)
     Py_RETURN_NONE;
 }
 
+/* Return the thread of INF_OBJ that ITEM, an element of the threads
+   argument of Inferior.read_registers, stands for.  Returns NULL, with
+   a python exception set, if ITEM is not a live thread of INF_OBJ, or
+   if the thread is running.  */
+
+static struct thread_info *
+read_registers_thread (inferior_object *inf_obj, PyObject *item)
+{
+  struct threadlist_entry *entry;
+
+  for (entry = inf_obj->threads; entry != NULL; entry = entry->next)
+    if ((PyObject *) entry->thread_obj == item)
+      break;
+
+  if (entry == NULL || entry->thread_obj->thread == NULL)
+    {
+      PyErr_SetString (PyExc_ValueError,
+		       _("The threads must be live threads of this inferior."));
+      return NULL;
+    }
+
+  if (is_executing (entry->thread_obj->thread->ptid))
+    {
+      PyErr_Format (PyExc_RuntimeError, _("Thread %d is running."),
+		    entry->thread_obj->thread->num);
+      return NULL;
+    }
+
+  return entry->thread_obj->thread;
+}
+
+/* Return a dictionary mapping the names of the registers REGNUMS, of
+   which there are NREGS, to their values in REGCACHE.  NAMES, if not
+   NULL, holds the names as given by the user.  Returns NULL on error,
+   with a python exception set.  */
+
+static PyObject *
+read_registers_dict (struct regcache *regcache, int *regnums, int nregs,
+		     PyObject *names)
+{
+  struct gdbarch *gdbarch = get_regcache_arch (regcache);
+  PyObject *dict = PyDict_New ();
+  volatile struct gdb_exception except;
+  int i;
+
+  if (dict == NULL)
+    return NULL;
+
+  for (i = 0; i < nregs; i++)
+    {
+      PyObject *name, *value = NULL;
+      int ok;
+
+      if (names != NULL)
+	{
+	  name = PySequence_Fast_GET_ITEM (names, i);
+	  Py_INCREF (name);
+	}
+      else
+	name = PyString_FromString (gdbarch_register_name (gdbarch,
+							   regnums[i]));
+      if (name == NULL)
+	{
+	  Py_DECREF (dict);
+	  return NULL;
+	}
+
+      TRY_CATCH (except, RETURN_MASK_ALL)
+	{
+	  value = gdbpy_register_to_python (regcache, regnums[i]);
+	}
+      if (except.reason < 0)
+	gdbpy_convert_exception (except);
+      ok = value != NULL && PyDict_SetItem (dict, name, value) == 0;
+      Py_DECREF (name);
+      Py_XDECREF (value);
+      if (!ok)
+	{
+	  Py_DECREF (dict);
+	  return NULL;
+	}
+    }
+
+  return dict;
+}
+
+/* Implementation of Inferior.read_registers ([threads, registers]).
+   Returns a dictionary mapping the number of each thread of THREADS,
+   by default all the threads of the inferior, to a dictionary of the
+   values of the registers named in REGISTERS, by default all the raw
+   registers.  The registers of all the threads are fetched before
+   any is read, so that the target can fetch them together.  The
+   selected thread does not change.  Returns NULL on error, with a
+   python exception set.  */
+
+static PyObject *
+infpy_read_registers (PyObject *self, PyObject *args, PyObject *kw)
+{
+  inferior_object *inf_obj = (inferior_object *) self;
+  PyObject *threads_obj = NULL, *regs_obj = NULL;
+  PyObject *threads_seq = NULL, *regs_seq = NULL, *result = NULL;
+  struct regcache **regcaches = NULL, **to_fetch = NULL;
+  struct gdbarch *gdbarch = NULL;
+  int *regnums = NULL;
+  Py_ssize_t nthreads, nregs = 0, nfetch = 0, i, j;
+  int error = 0;
+  volatile struct gdb_exception except;
+  static char *keywords[] = { "threads", "registers", NULL };
+
+  GDB_PY_REQUIRE_MAIN_THREAD ();
+
+  if (! PyArg_ParseTupleAndKeywords (args, kw, "|OO", keywords,
+				     &threads_obj, &regs_obj))
+    return NULL;
+
+  INFPY_REQUIRE_VALID (inf_obj);
+
+  if (threads_obj == NULL || threads_obj == Py_None)
+    threads_seq = infpy_threads (self, NULL);
+  else
+    threads_seq = PySequence_Fast (threads_obj,
+				   _("The threads must be a sequence."));
+  if (threads_seq == NULL)
+    return NULL;
+
+  if (regs_obj != NULL && regs_obj != Py_None)
+    {
+      regs_seq = PySequence_Fast (regs_obj,
+				  _("The registers must be a sequence."));
+      if (regs_seq == NULL)
+	goto fail;
+    }
+
+  nthreads = PySequence_Fast_GET_SIZE (threads_seq);
+  regcaches = xmalloc ((nthreads > 0 ? nthreads : 1)
+		       * sizeof (struct regcache *));
+  to_fetch = xmalloc ((nthreads > 0 ? nthreads : 1)
+		      * sizeof (struct regcache *));
+
+  /* Find the regcaches, and those with registers left to fetch.  */
+  for (i = 0; i < nthreads; i++)
+    {
+      PyObject *item = PySequence_Fast_GET_ITEM (threads_seq, i);
+      struct thread_info *tp = read_registers_thread (inf_obj, item);
+
+      if (tp == NULL)
+	goto fail;
+
+      TRY_CATCH (except, RETURN_MASK_ALL)
+	{
+	  regcaches[i] = get_thread_regcache (tp->ptid);
+	  if (regcache_register_status (regcaches[i], 0) == REG_UNKNOWN)
+	    to_fetch[nfetch++] = regcaches[i];
+	}
+      if (except.reason < 0)
+	{
+	  gdbpy_convert_exception (except);
+	  goto fail;
+	}
+    }
+
+  result = PyDict_New ();
+  if (result == NULL)
+    goto fail;
+
+  Py_BEGIN_ALLOW_THREADS
+  TRY_CATCH (except, RETURN_MASK_ALL)
+    {
+      if (nfetch > 0)
+	target_prefetch_registers (nfetch, to_fetch);
+    }
+  Py_END_ALLOW_THREADS
+  if (except.reason < 0)
+    {
+      gdbpy_convert_exception (except);
+      goto fail;
+    }
+
+  for (i = 0; i < nthreads; i++)
+    {
+      PyObject *item = PySequence_Fast_GET_ITEM (threads_seq, i);
+      PyObject *num, *regs;
+
+      /* The register numbers depend on the thread's architecture;
+	 only look them up again when it changes.  */
+      if (get_regcache_arch (regcaches[i]) != gdbarch)
+	{
+	  gdbarch = get_regcache_arch (regcaches[i]);
+	  if (regs_seq != NULL)
+	    {
+	      nregs = PySequence_Fast_GET_SIZE (regs_seq);
+	      regnums = xrealloc (regnums, (nregs > 0 ? nregs : 1)
+					   * sizeof (int));
+	      for (j = 0; j < nregs; j++)
+		{
+		  regnums[j] = gdbpy_register_number
+		    (gdbarch, PySequence_Fast_GET_ITEM (regs_seq, j));
+		  if (regnums[j] < 0)
+		    break;
+		}
+	      if (j < nregs)
+		goto fail;
+	    }
+	  else
+	    {
+	      int num_regs = gdbarch_num_regs (gdbarch);
+
+	      regnums = xrealloc (regnums, num_regs * sizeof (int));
+	      for (nregs = 0, j = 0; j < num_regs; j++)
+		{
+		  const char *name = gdbarch_register_name (gdbarch, j);
+
+		  if (name != NULL && *name != '\0')
+		    regnums[nregs++] = j;
+		}
+	    }
+	}
+
+      regs = read_registers_dict (regcaches[i], regnums, nregs, regs_seq);
+      num = PyInt_FromLong (((thread_object *) item)->thread->num);
+      error = (regs == NULL || num == NULL
+	       || PyDict_SetItem (result, num, regs) < 0);
+      Py_XDECREF (regs);
+      Py_XDECREF (num);
+      if (error)
+	goto fail;
+    }
+
+  xfree (regnums);
+  xfree (to_fetch);
+  xfree (regcaches);
+  Py_XDECREF (regs_seq);
+  Py_DECREF (threads_seq);
+  return result;
+
+ fail:
+  Py_XDECREF (result);
+  xfree (regnums);
+  xfree (to_fetch);
+  xfree (regcaches);
+  Py_XDECREF (regs_seq);
+  Py_DECREF (threads_seq);
+  return NULL;
+}
+
 /* Implementation of gdb.Inferior.is_valid (self) -> Boolean.
    Returns True if this inferior object still exists in GDB.  */
 
@@ -653,6 +1631,8 @@ infpy_is_valid (PyObject *self, PyObject *args)
 {
   inferior_object *inf = (inferior_object *) self;
 
+  GDB_PY_REQUIRE_MAIN_THREAD ();
+
   if (! inf->inferior)
     Py_RETURN_FALSE;
 
@@ -709,6 +1689,8 @@ gdbpy_selected_inferior (PyObject *self, PyObject *args)
 {
   PyObject *inf_obj;
 
+  GDB_PY_REQUIRE_MAIN_THREAD ();
+
   inf_obj = inferior_to_inferior_object (current_inferior ());
   Py_INCREF (inf_obj);
 
@@ -742,6 +1724,13 @@ gdbpy_initialize_inferior (void)
   Py_INCREF (&membuf_object_type);
   PyModule_AddObject (gdb_module, "Membuf", (PyObject *)
 		      &membuf_object_type);
+
+  if (PyType_Ready (&lazy_membuf_object_type) < 0)
+    return;
+
+  Py_INCREF (&lazy_membuf_object_type);
+  PyModule_AddObject (gdb_module, "LazyMembuf", (PyObject *)
+		      &lazy_membuf_object_type);
 }
 
 static PyGetSetDef inferior_object_getset[] =
@@ -763,8 +1752,18 @@ Return true if this inferior is valid, false if not." },
     "Return all the threads of this inferior." },
   { "read_memory", (PyCFunction) infpy_read_memory,
     METH_VARARGS | METH_KEYWORDS,
-    "read_memory (address, length) -> buffer\n\
-Return a buffer object for reading from the inferior's memory." },
+    "read_memory (address, length [, buffer, lazy]) -> buffer\n\
+Return a buffer object for reading from the inferior's memory.\n\
+With BUFFER, read the memory into that writable buffer instead, and\n\
+return the number of bytes read.  With LAZY true, return a LazyMembuf\n\
+object, which reads the memory a page at a time as it is accessed, as\n\
+long as the inferior stays stopped." },
+  { "read_memory_ranges", (PyCFunction) infpy_read_memory_ranges,
+    METH_VARARGS | METH_KEYWORDS,
+    "read_memory_ranges (ranges) -> list\n\
+Read each (address, length) pair of RANGES from the inferior's memory.\n\
+Return a list of buffer objects, with None for the ranges that could\n\
+not be read." },
   { "write_memory", (PyCFunction) infpy_write_memory,
     METH_VARARGS | METH_KEYWORDS,
     "write_memory (address, buffer [, length])\n\
@@ -772,7 +1771,16 @@ Write the given buffer object to the inferior's memory." },
   { "search_memory", (PyCFunction) infpy_search_memory,
     METH_VARARGS | METH_KEYWORDS,
     "search_memory (address, length, pattern) -> long\n\
-Return a long with the address of a match, or None." },
+Return a long with the address of a match, or None.\n\
+If PATTERN is a list or tuple of patterns, return a list of an\n\
+(address, index) tuple for each match of any of them." },
+  { "read_registers", (PyCFunction) infpy_read_registers,
+    METH_VARARGS | METH_KEYWORDS,
+    "read_registers ([threads, registers]) -> dict\n\
+Return a dictionary mapping the number of each of THREADS, by default\n\
+all the threads of this inferior, to a dictionary of the values of the\n\
+named REGISTERS, by default all the raw registers.  The registers of\n\
+all the threads are fetched together where the target can do so." },
   { NULL }
 };
 
@@ -874,3 +1882,55 @@ static PyTypeObject membuf_object_type = {
   0,				  /* tp_init */
   0,				  /* tp_alloc */
 };
+
+static PySequenceMethods lazy_membuf_sequence_methods = {
+  lmpy_length,			  /*sq_length*/
+  0,				  /*sq_concat*/
+  0,				  /*sq_repeat*/
+  lmpy_item,			  /*sq_item*/
+  lmpy_slice,			  /*sq_slice*/
+  0,				  /*sq_ass_item*/
+  0,				  /*sq_ass_slice*/
+  0,				  /*sq_contains*/
+};
+
+static PyTypeObject lazy_membuf_object_type = {
+  PyObject_HEAD_INIT (NULL)
+  0,				  /*ob_size*/
+  "gdb.LazyMembuf",		  /*tp_name*/
+  sizeof (lazy_membuf_object),	  /*tp_basicsize*/
+  0,				  /*tp_itemsize*/
+  lmpy_dealloc,			  /*tp_dealloc*/
+  0,				  /*tp_print*/
+  0,				  /*tp_getattr*/
+  0,				  /*tp_setattr*/
+  0,				  /*tp_compare*/
+  0,				  /*tp_repr*/
+  0,				  /*tp_as_number*/
+  &lazy_membuf_sequence_methods,  /*tp_as_sequence*/
+  0,				  /*tp_as_mapping*/
+  0,				  /*tp_hash */
+  0,				  /*tp_call*/
+  lmpy_str,			  /*tp_str*/
+  0,				  /*tp_getattro*/
+  0,				  /*tp_setattro*/
+  0,				  /*tp_as_buffer*/
+  Py_TPFLAGS_DEFAULT,		  /*tp_flags*/
+  "GDB lazily read memory buffer object", /*tp_doc*/
+  0,				  /* tp_traverse */
+  0,				  /* tp_clear */
+  0,				  /* tp_richcompare */
+  0,				  /* tp_weaklistoffset */
+  0,				  /* tp_iter */
+  0,				  /* tp_iternext */
+  0,				  /* tp_methods */
+  0,				  /* tp_members */
+  0,				  /* tp_getset */
+  0,				  /* tp_base */
+  0,				  /* tp_dict */
+  0,				  /* tp_descr_get */
+  0,				  /* tp_descr_set */
+  0,				  /* tp_dictoffset */
+  0,				  /* tp_init */
+  0,				  /* tp_alloc */
+};
@@ -114,6 +114,7 @@ objfpy_set_printers (PyObject *o, PyObject *value, void *ignore)
   Py_INCREF (value);
   self->printers = value;
   Py_XDECREF (tmp);
+  gdbpy_clear_pretty_printer_cache ();
 
   return 0;
 }
@@ -143,6 +144,9 @@ py_free_objfile (struct objfile *objfile, void *datum)
   objfile_object *object = datum;
 
   cleanup = ensure_python_env (get_objfile_arch (objfile), current_language);
+  /* The types of the objfile are going away, and their addresses may
+     be reused.  */
+  gdbpy_clear_pretty_printer_cache ();
   object->objfile = NULL;
   Py_DECREF ((PyObject *) object);
   do_cleanups (cleanup);
@@ -23,6 +23,8 @@
 #include "symtab.h"
 #include "language.h"
 #include "valprint.h"
+#include "gdb_regex.h"
+#include "hashtab.h"
 
 #include "python.h"
 
@@ -41,14 +43,369 @@ enum string_repr_result
     string_repr_ok
   };
 
+/* Return 1 if the pretty-printer or subprinter PRINTER is enabled, 0
+   if it isn't, and -1, with the Python error set, on error.  Printers
+   without an "enabled" attribute are enabled.  */
+
+static int
+printer_enabled_p (PyObject *printer)
+{
+  PyObject *attr;
+  int cmp;
+
+  if (! PyObject_HasAttr (printer, gdbpy_enabled_cst))
+    return 1;
+
+  attr = PyObject_GetAttr (printer, gdbpy_enabled_cst);
+  if (!attr)
+    return -1;
+  cmp = PyObject_IsTrue (attr);
+  Py_DECREF (attr);
+  return cmp;
+}
+
+/* gdb.printing.RegexpCollectionPrettyPrinter, and the function of its
+   __call__ method, once gdb.printing has been imported.  */
+
+static PyObject *regexp_collection_class;
+static PyObject *regexp_collection_call;
+
+/* Return a new reference to the function of the __call__ method of
+   the class CLS, or NULL, with no Python error set, if it has none.  */
+
+static PyObject *
+class_call_function (PyObject *cls)
+{
+  PyObject *call, *function;
+
+  call = PyObject_GetAttrString (cls, "__call__");
+  if (call == NULL)
+    {
+      PyErr_Clear ();
+      return NULL;
+    }
+  if (! PyMethod_Check (call))
+    return call;
+
+  function = PyMethod_GET_FUNCTION (call);
+  Py_INCREF (function);
+  Py_DECREF (call);
+  return function;
+}
+
+/* Return nonzero if FUNCTION is a gdb.printing.RegexpCollectionPrettyPrinter
+   whose class doesn't override the way it looks values up, so that
+   the lookup can be done here instead.  */
+
+static int
+plain_regexp_collection_p (PyObject *function)
+{
+  PyObject *call;
+  int result;
+
+  if (regexp_collection_class == NULL)
+    {
+      PyObject *module;
+
+      /* No printer of the class can exist before its module is
+	 loaded.  */
+      module = PyDict_GetItemString (PyImport_GetModuleDict (),
+				     "gdb.printing");
+      if (module == NULL)
+	return 0;
+
+      regexp_collection_class
+	= PyObject_GetAttrString (module, "RegexpCollectionPrettyPrinter");
+      if (regexp_collection_class == NULL)
+	{
+	  PyErr_Clear ();
+	  return 0;
+	}
+      regexp_collection_call = class_call_function (regexp_collection_class);
+    }
+
+  result = PyObject_IsInstance (function, regexp_collection_class);
+  if (result <= 0)
+    {
+      PyErr_Clear ();
+      return 0;
+    }
+
+  call = class_call_function ((PyObject *) function->ob_type);
+  result = call != NULL && call == regexp_collection_call;
+  Py_XDECREF (call);
+  return result;
+}
+
+/* A regular expression of a RegexpCollectionPrettyPrinter, compiled
+   for regexec.  */
+
+struct pp_regexp
+{
+  char *pattern;
+
+  /* The compiled expression, or NULL if PATTERN uses Python syntax
+     regexec doesn't share, and must be matched by Python.  */
+  regex_t *compiled;
+};
+
+/* The regular expressions compiled so far, by pattern.  */
+
+static htab_t pp_regexps;
+
+static hashval_t
+hash_pp_regexp (const void *p)
+{
+  return htab_hash_string (((const struct pp_regexp *) p)->pattern);
+}
+
+static int
+eq_pp_regexp (const void *a, const void *b)
+{
+  return strcmp (((const struct pp_regexp *) a)->pattern,
+		 ((const struct pp_regexp *) b)->pattern) == 0;
+}
+
+/* The characters a backslash makes literal both in Python regular
+   expressions and to regexec, among those re.escape escapes.  */
+
+static const char posix_literal_escapes[] = ".^$*+?()[]{}|\\/-:_,;!\"#%&=~@ ";
+
+/* Return nonzero if the Python regular expression PATTERN means the
+   same to regexec, as an extended regular expression.  This accepts a
+   conservative subset of the syntax, which covers the type name
+   patterns printers use.  */
+
+static int
+posix_compatible_regexp_p (const char *pattern)
+{
+  const char *p;
+
+  for (p = pattern; *p != '\0'; p++)
+    {
+      switch (*p)
+	{
+	case '\\':
+	  /* Python's escapes such as \d and \b are letters or digits,
+	     and GNU regex gives \<, \>, \` and \' meanings too; only
+	     the escapes in POSIX_LITERAL_ESCAPES are the escaped
+	     character itself in both.  */
+	  if (p[1] == '\0' || strchr (posix_literal_escapes, p[1]) == NULL)
+	    return 0;
+	  p++;
+	  break;
+
+	case '[':
+	  /* Bracket expressions, without backslashes or nested
+	     brackets, which differ.  */
+	  p++;
+	  if (*p == '^')
+	    p++;
+	  if (*p == ']')
+	    p++;
+	  while (*p != ']')
+	    {
+	      if (*p == '\0' || *p == '\\' || *p == '[')
+		return 0;
+	      p++;
+	    }
+	  break;
+
+	case '(':
+	  /* Python's extensions, such as non-capturing groups.  */
+	  if (p[1] == '?')
+	    return 0;
+	  break;
+
+	case '*':
+	case '+':
+	case '?':
+	  /* Python's non-greedy repetitions.  */
+	  if (p[1] == '?')
+	    return 0;
+	  break;
+
+	case '{':
+	  /* Python takes a brace that doesn't start a repetition
+	     literally.  */
+	  return 0;
+	}
+    }
+
+  return 1;
+}
+
+/* Return the compiled form of the regular expression PATTERN.  */
+
+static struct pp_regexp *
+lookup_pp_regexp (const char *pattern)
+{
+  struct pp_regexp key, *re;
+  void **slot;
+
+  if (pp_regexps == NULL)
+    pp_regexps = htab_create_alloc (16, hash_pp_regexp, eq_pp_regexp,
+				    NULL, xcalloc, xfree);
+
+  key.pattern = (char *) pattern;
+  slot = htab_find_slot (pp_regexps, &key, INSERT);
+  if (*slot != NULL)
+    return *slot;
+
+  re = XZALLOC (struct pp_regexp);
+  re->pattern = xstrdup (pattern);
+  if (posix_compatible_regexp_p (pattern))
+    {
+      re->compiled = XNEW (regex_t);
+      if (regcomp (re->compiled, pattern, REG_EXTENDED | REG_NOSUB) != 0)
+	{
+	  xfree (re->compiled);
+	  re->compiled = NULL;
+	}
+    }
+
+  *slot = re;
+  return re;
+}
+
+/* Return 1 if the regular expression of SUBPRINTER, a subprinter of a
+   RegexpCollectionPrettyPrinter, matches TYPENAME, 0 if it doesn't,
+   and -1, with the Python error set, on error.  */
+
+static int
+subprinter_matches_p (PyObject *subprinter, const char *typename)
+{
+  PyObject *regexp, *compiled_re, *match;
+  struct pp_regexp *re = NULL;
+  int result;
+
+  regexp = PyObject_GetAttrString (subprinter, "regexp");
+  if (regexp == NULL)
+    return -1;
+  if (PyString_Check (regexp))
+    re = lookup_pp_regexp (PyString_AsString (regexp));
+  Py_DECREF (regexp);
+
+  if (re != NULL && re->compiled != NULL)
+    return regexec (re->compiled, typename, 0, NULL, 0) == 0;
+
+  compiled_re = PyObject_GetAttrString (subprinter, "compiled_re");
+  if (compiled_re == NULL)
+    return -1;
+  match = PyObject_CallMethod (compiled_re, "search", "s", typename);
+  Py_DECREF (compiled_re);
+  if (match == NULL)
+    return -1;
+  result = match != Py_None;
+  Py_DECREF (match);
+  return result;
+}
+
+/* Look VALUE up in the RegexpCollectionPrettyPrinter COLLECTION, as
+   its __call__ method would.  Set *SUBPRINTERP to a new reference to
+   the subprinter for VALUE, or to NULL if there is none.  Return 0 on
+   success, -1, with the Python error set, on error.  */
+
+static int
+regexp_collection_lookup (PyObject *collection, PyObject *value,
+			  PyObject **subprinterp)
+{
+  struct type *type = value_type (value_object_to_value (value));
+  PyObject *subprinters, *seq;
+  volatile struct gdb_exception except;
+  const char *typename = NULL;
+  Py_ssize_t i;
+
+  *subprinterp = NULL;
+
+  /* The tag of the value's type, as gdb.types.get_basic_type
+     finds it.  */
+  TRY_CATCH (except, RETURN_MASK_ALL)
+    {
+      while (TYPE_CODE (type) == TYPE_CODE_REF
+	     || TYPE_CODE (type) == TYPE_CODE_TYPEDEF)
+	{
+	  if (TYPE_CODE (type) == TYPE_CODE_REF)
+	    type = TYPE_TARGET_TYPE (type);
+	  else
+	    type = check_typedef (type);
+	}
+      typename = TYPE_TAG_NAME (type);
+    }
+  if (except.reason < 0)
+    {
+      gdbpy_convert_exception (except);
+      return -1;
+    }
+  if (typename == NULL)
+    return 0;
+
+  subprinters = PyObject_GetAttrString (collection, "subprinters");
+  if (subprinters == NULL)
+    return -1;
+  seq = PySequence_Fast (subprinters, _("Subprinters must be a sequence."));
+  Py_DECREF (subprinters);
+  if (seq == NULL)
+    return -1;
+
+  for (i = 0; i < PySequence_Fast_GET_SIZE (seq); i++)
+    {
+      PyObject *subprinter = PySequence_Fast_GET_ITEM (seq, i);
+      int enabled, match;
+
+      enabled = printer_enabled_p (subprinter);
+      if (enabled < 0)
+	goto fail;
+      if (!enabled)
+	continue;
+
+      match = subprinter_matches_p (subprinter, typename);
+      if (match < 0)
+	goto fail;
+      if (match)
+	{
+	  Py_INCREF (subprinter);
+	  *subprinterp = subprinter;
+	  break;
+	}
+    }
+
+  Py_DECREF (seq);
+  return 0;
+
+ fail:
+  Py_DECREF (seq);
+  return -1;
+}
+
+/* Return the printer SUBPRINTER, a subprinter of a
+   RegexpCollectionPrettyPrinter, makes for VALUE.  */
+
+static PyObject *
+call_subprinter (PyObject *subprinter, PyObject *value)
+{
+  PyObject *gen_printer, *printer;
+
+  gen_printer = PyObject_GetAttrString (subprinter, "gen_printer");
+  if (gen_printer == NULL)
+    return NULL;
+  printer = PyObject_CallFunctionObjArgs (gen_printer, value, NULL);
+  Py_DECREF (gen_printer);
+  return printer;
+}
+
 /* Helper function for find_pretty_printer which iterates over a list,
    calls each function and inspects output.  This will return a
    printer object if one recognizes VALUE.  If no printer is found, it
    will return None.  On error, it will set the Python error and
-   return NULL.  */
+   return NULL.  When a printer is found, *FUNCTIONP is set to a new
+   reference to the function that made it, and if that function is a
+   RegexpCollectionPrettyPrinter, *SUBPRINTERP to a new reference to
+   its subprinter that did.  */
 
 static PyObject *
-search_pp_list (PyObject *list, PyObject *value)
+search_pp_list (PyObject *list, PyObject *value,
+		PyObject **functionp, PyObject **subprinterp)
 {
   Py_ssize_t pp_list_size, list_index;
   PyObject *function, *printer = NULL;
@@ -56,32 +413,45 @@ search_pp_list (PyObject *list, PyObject *value)
   pp_list_size = PyList_Size (list);
   for (list_index = 0; list_index < pp_list_size; list_index++)
     {
+      PyObject *subprinter = NULL;
+      int enabled;
+
       function = PyList_GetItem (list, list_index);
       if (! function)
 	return NULL;
 
       /* Skip if disabled.  */
-      if (PyObject_HasAttr (function, gdbpy_enabled_cst))
-	{
-	  PyObject *attr = PyObject_GetAttr (function, gdbpy_enabled_cst);
-	  int cmp;
+      enabled = printer_enabled_p (function);
+      if (enabled < 0)
+	return NULL;
+      if (!enabled)
+	continue;
 
-	  if (!attr)
-	    return NULL;
-	  cmp = PyObject_IsTrue (attr);
-	  if (cmp == -1)
+      if (plain_regexp_collection_p (function))
+	{
+	  if (regexp_collection_lookup (function, value, &subprinter) < 0)
 	    return NULL;
-
-	  if (!cmp)
+	  if (subprinter == NULL)
 	    continue;
+	  printer = call_subprinter (subprinter, value);
 	}
+      else
+	printer = PyObject_CallFunctionObjArgs (function, value, NULL);
 
-      printer = PyObject_CallFunctionObjArgs (function, value, NULL);
       if (! printer)
-	return NULL;
+	{
+	  Py_XDECREF (subprinter);
+	  return NULL;
+	}
       else if (printer != Py_None)
-	return printer;
+	{
+	  Py_INCREF (function);
+	  *functionp = function;
+	  *subprinterp = subprinter;
+	  return printer;
+	}
 
+      Py_XDECREF (subprinter);
       Py_DECREF (printer);
     }
 
@@ -95,7 +465,8 @@ search_pp_list (PyObject *list, PyObject *value)
    Otherwise the result is the pretty-printer function, suitably inc-ref'd.  */
 
 static PyObject *
-find_pretty_printer_from_objfiles (PyObject *value)
+find_pretty_printer_from_objfiles (PyObject *value, PyObject **functionp,
+				   PyObject **subprinterp)
 {
   PyObject *pp_list;
   PyObject *function;
@@ -112,7 +483,7 @@ find_pretty_printer_from_objfiles (PyObject *value)
       }
 
     pp_list = objfpy_get_printers (objf, NULL);
-    function = search_pp_list (pp_list, value);
+    function = search_pp_list (pp_list, value, functionp, subprinterp);
     Py_XDECREF (pp_list);
 
     /* If there is an error in any objfile list, abort the search and exit.  */
@@ -135,7 +506,8 @@ find_pretty_printer_from_objfiles (PyObject *value)
    Otherwise the result is the pretty-printer function, suitably inc-ref'd.  */
 
 static PyObject *
-find_pretty_printer_from_progspace (PyObject *value)
+find_pretty_printer_from_progspace (PyObject *value, PyObject **functionp,
+				    PyObject **subprinterp)
 {
   PyObject *pp_list;
   PyObject *function;
@@ -144,11 +516,32 @@ find_pretty_printer_from_progspace (PyObject *value)
   if (!obj)
     return NULL;
   pp_list = pspy_get_printers (obj, NULL);
-  function = search_pp_list (pp_list, value);
+  function = search_pp_list (pp_list, value, functionp, subprinterp);
   Py_XDECREF (pp_list);
   return function;
 }
 
+/* Return a new reference to the global pretty-printer list, or NULL,
+   with no Python error set, if there is none.  */
+
+static PyObject *
+gdb_pretty_printers (void)
+{
+  PyObject *pp_list;
+
+  if (! PyObject_HasAttrString (gdb_module, "pretty_printers"))
+    return NULL;
+  pp_list = PyObject_GetAttrString (gdb_module, "pretty_printers");
+  if (pp_list == NULL || ! PyList_Check (pp_list))
+    {
+      PyErr_Clear ();
+      Py_XDECREF (pp_list);
+      return NULL;
+    }
+
+  return pp_list;
+}
+
 /* Subroutine of find_pretty_printer to simplify it.
    Look for a pretty-printer to print VALUE in the gdb module.
    The result is NULL if there's an error and the search should be terminated.
@@ -156,53 +549,193 @@ find_pretty_printer_from_progspace (PyObject *value)
    Otherwise the result is the pretty-printer function, suitably inc-ref'd.  */
 
 static PyObject *
-find_pretty_printer_from_gdb (PyObject *value)
+find_pretty_printer_from_gdb (PyObject *value, PyObject **functionp,
+			      PyObject **subprinterp)
 {
   PyObject *pp_list;
   PyObject *function;
 
   /* Fetch the global pretty printer list.  */
-  if (! PyObject_HasAttrString (gdb_module, "pretty_printers"))
+  pp_list = gdb_pretty_printers ();
+  if (pp_list == NULL)
     Py_RETURN_NONE;
-  pp_list = PyObject_GetAttrString (gdb_module, "pretty_printers");
-  if (pp_list == NULL || ! PyList_Check (pp_list))
-    {
-      Py_XDECREF (pp_list);
-      Py_RETURN_NONE;
-    }
 
-  function = search_pp_list (pp_list, value);
+  function = search_pp_list (pp_list, value, functionp, subprinterp);
   Py_XDECREF (pp_list);
   return function;
 }
 
-/* Find the pretty-printing constructor function for VALUE.  If no
-   pretty-printer exists, return None.  If one exists, return a new
-   reference.  On error, set the Python error and return NULL.  */
+/* Look through all the pretty-printer lists for a printer for VALUE,
+   as find_pretty_printer does.  When one is found, set *FUNCTIONP and
+   *SUBPRINTERP as search_pp_list does.  */
 
 static PyObject *
-find_pretty_printer (PyObject *value)
+search_pretty_printers (PyObject *value, PyObject **functionp,
+			PyObject **subprinterp)
 {
   PyObject *function;
 
   /* Look at the pretty-printer list for each objfile
      in the current program-space.  */
-  function = find_pretty_printer_from_objfiles (value);
+  function = find_pretty_printer_from_objfiles (value, functionp,
+						subprinterp);
   if (function == NULL || function != Py_None)
     return function;
   Py_DECREF (function);
 
   /* Look at the pretty-printer list for the current program-space.  */
-  function = find_pretty_printer_from_progspace (value);
+  function = find_pretty_printer_from_progspace (value, functionp,
+						 subprinterp);
   if (function == NULL || function != Py_None)
     return function;
   Py_DECREF (function);
 
   /* Look at the pretty-printer list in the gdb module.  */
-  function = find_pretty_printer_from_gdb (value);
+  function = find_pretty_printer_from_gdb (value, functionp, subprinterp);
   return function;
 }
 
+/* The pretty-printer lookup cache.
+
+   Finding the printer of a value calls the lookup functions in turn
+   until one recognizes the value, which is slow when printing many
+   values of the same type, such as the elements of an array.  So the
+   first lookup for a type records which function recognized it, or
+   that none did, and later lookups for the type only call that
+   function, or none.  This assumes that whether a lookup function
+   recognizes a value depends only on the value's type, as it does
+   for the printers of gdb.printing; "set python pretty-printer-cache
+   off" turns the cache off for lookup functions that don't.
+
+   Rather than check the printer lists at each lookup, the cache is
+   flushed on the events that change them: when Python code run from
+   the CLI or a script returns, when a printer list is replaced, when
+   gdb.printing registers a printer, when the "enable pretty-printer"
+   and "disable pretty-printer" commands run, and by
+   gdb.invalidate_cached_pretty_printers, which code that changes the
+   lists at other times must call.  It is also flushed when an
+   objfile, and so the types it knows about, is freed.  */
+
+struct pp_cache_entry
+{
+  struct type *type;
+
+  /* The lookup function that recognized values of TYPE, or NULL if
+     none did.  */
+  PyObject *function;
+
+  /* If FUNCTION is a RegexpCollectionPrettyPrinter, its subprinter
+     for TYPE.  */
+  PyObject *subprinter;
+};
+
+static htab_t pp_cache;
+
+static hashval_t
+hash_pp_cache_entry (const void *p)
+{
+  return htab_hash_pointer (((const struct pp_cache_entry *) p)->type);
+}
+
+static int
+eq_pp_cache_entry (const void *a, const void *b)
+{
+  return (((const struct pp_cache_entry *) a)->type
+	  == ((const struct pp_cache_entry *) b)->type);
+}
+
+static void
+free_pp_cache_entry (void *p)
+{
+  struct pp_cache_entry *entry = p;
+
+  Py_XDECREF (entry->function);
+  Py_XDECREF (entry->subprinter);
+  xfree (entry);
+}
+
+void
+gdbpy_clear_pretty_printer_cache (void)
+{
+  if (pp_cache != NULL)
+    htab_empty (pp_cache);
+}
+
+/* Find the pretty-printing constructor function for VALUE.  If no
+   pretty-printer exists, return None.  If one exists, return a new
+   reference.  On error, set the Python error and return NULL.  */
+
+static PyObject *
+find_pretty_printer (PyObject *value)
+{
+  struct pp_cache_entry key, *entry;
+  PyObject *function = NULL, *subprinter = NULL, *printer;
+  void **slot;
+
+  if (!gdbpy_cache_pretty_printers)
+    {
+      gdbpy_clear_pretty_printer_cache ();
+      printer = search_pretty_printers (value, &function, &subprinter);
+      Py_XDECREF (function);
+      Py_XDECREF (subprinter);
+      return printer;
+    }
+
+  if (pp_cache == NULL)
+    pp_cache = htab_create_alloc (64, hash_pp_cache_entry,
+				  eq_pp_cache_entry, free_pp_cache_entry,
+				  xcalloc, xfree);
+
+  key.type = value_type (value_object_to_value (value));
+  entry = htab_find (pp_cache, &key);
+  if (entry != NULL)
+    {
+      if (entry->function == NULL)
+	Py_RETURN_NONE;
+
+      /* Use the cached printer, unless it has changed its mind about
+	 the type.  */
+      if (entry->subprinter != NULL)
+	printer = call_subprinter (entry->subprinter, value);
+      else
+	printer = PyObject_CallFunctionObjArgs (entry->function, value, NULL);
+      if (printer == NULL || printer != Py_None)
+	return printer;
+      Py_DECREF (printer);
+    }
+
+  printer = search_pretty_printers (value, &function, &subprinter);
+  if (printer == NULL)
+    return NULL;
+
+  slot = htab_find_slot (pp_cache, &key, INSERT);
+  if (*slot == NULL)
+    {
+      entry = XZALLOC (struct pp_cache_entry);
+      entry->type = key.type;
+      *slot = entry;
+    }
+  else
+    {
+      entry = *slot;
+      Py_XDECREF (entry->function);
+      Py_XDECREF (entry->subprinter);
+    }
+  entry->function = function;
+  entry->subprinter = subprinter;
+
+  return printer;
+}
+
+/* Implementation of gdb.invalidate_cached_pretty_printers.  */
+
+PyObject *
+gdbpy_invalidate_cached_pretty_printers (PyObject *self, PyObject *args)
+{
+  gdbpy_clear_pretty_printer_cache ();
+  Py_RETURN_NONE;
+}
+
 /* Pretty-print a single value, via the printer object PRINTER.
    If the function returns a string, a PyObject containing the string
    is returned.  If the function returns Py_NONE that means the pretty
@@ -122,6 +122,7 @@ pspy_set_printers (PyObject *o, PyObject *value, void *ignore)
   Py_INCREF (value);
   self->printers = value;
   Py_XDECREF (tmp);
+  gdbpy_clear_pretty_printer_cache ();
 
   return 0;
 }
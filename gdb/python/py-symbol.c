@@ -279,6 +279,8 @@ gdbpy_lookup_symbol (PyObject *self, PyObject *args, PyObject *kw)
   const struct block *block = NULL;
   volatile struct gdb_exception except;
 
+  GDB_PY_REQUIRE_MAIN_THREAD ();
+
   if (! PyArg_ParseTupleAndKeywords (args, kw, "s|O!i", keywords, &name,
 				     &block_object_type, &block_obj, &domain))
     return NULL;
@@ -298,10 +300,14 @@ gdbpy_lookup_symbol (PyObject *self, PyObject *args, PyObject *kw)
       GDB_PY_HANDLE_EXCEPTION (except);
     }
 
+  /* Other Python threads may run while the symbol tables are
+     read.  */
+  Py_BEGIN_ALLOW_THREADS
   TRY_CATCH (except, RETURN_MASK_ALL)
     {
       symbol = lookup_symbol (name, block, domain, &is_a_field_of_this);
     }
+  Py_END_ALLOW_THREADS
   GDB_PY_HANDLE_EXCEPTION (except);
 
   ret_tuple = PyTuple_New (2);
@@ -344,14 +350,18 @@ gdbpy_lookup_global_symbol (PyObject *self, PyObject *args, PyObject *kw)
   PyObject *sym_obj;
   volatile struct gdb_exception except;
 
+  GDB_PY_REQUIRE_MAIN_THREAD ();
+
   if (! PyArg_ParseTupleAndKeywords (args, kw, "s|i", keywords, &name,
 				     &domain))
     return NULL;
 
+  Py_BEGIN_ALLOW_THREADS
   TRY_CATCH (except, RETURN_MASK_ALL)
     {
       symbol = lookup_symbol_global (name, NULL, domain);
     }
+  Py_END_ALLOW_THREADS
   GDB_PY_HANDLE_EXCEPTION (except);
 
   if (symbol)
@@ -1469,6 +1469,8 @@ gdbpy_lookup_type (PyObject *self, PyObject *args, PyObject *kw)
   PyObject *block_obj = NULL;
   const struct block *block = NULL;
 
+  GDB_PY_REQUIRE_MAIN_THREAD ();
+
   if (! PyArg_ParseTupleAndKeywords (args, kw, "s|O", keywords,
 				     &type_name, &block_obj))
     return NULL;
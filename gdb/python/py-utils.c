@@ -21,6 +21,8 @@
 #include "charset.h"
 #include "value.h"
 #include "python-internal.h"
+#include "regcache.h"
+#include "user-regs.h"
 
 
 /* This is a cleanup function which decrements the refcount on a
@@ -373,3 +375,77 @@ gdb_py_int_as_long (PyObject *obj, long *result)
   *result = PyInt_AsLong (obj);
   return ! (*result == -1 && PyErr_Occurred ());
 }
+
+/* Return the number of the register of GDBARCH named by the Python
+   string NAME.  Returns -1, with a Python exception set, if there is
+   no such register, or if the register can only be read through a
+   frame.  */
+
+int
+gdbpy_register_number (struct gdbarch *gdbarch, PyObject *name)
+{
+  int nregs = gdbarch_num_regs (gdbarch) + gdbarch_num_pseudo_regs (gdbarch);
+  char *s = python_string_to_host_string (name);
+  int regnum;
+
+  if (s == NULL)
+    return -1;
+
+  regnum = user_reg_map_name_to_regnum (gdbarch, s, strlen (s));
+  if (regnum < 0 || regnum >= nregs)
+    {
+      PyErr_Format (PyExc_ValueError,
+		    regnum < 0 ? _("Unknown register `%s'.")
+		    : _("Register `%s' needs a frame."), s);
+      regnum = -1;
+    }
+
+  xfree (s);
+  return regnum;
+}
+
+/* Return a Python object for the value of register REGNUM in
+   REGCACHE: an integer for an integer, pointer or flags register of
+   at most the size of a LONGEST, a float for a floating point
+   register, the raw bytes for anything else, and None if the register
+   is unavailable.  Throws a GDB exception if the register can not be
+   read.  */
+
+PyObject *
+gdbpy_register_to_python (struct regcache *regcache, int regnum)
+{
+  struct type *type = register_type (get_regcache_arch (regcache), regnum);
+  gdb_byte buf[MAX_REGISTER_SIZE];
+
+  if (regcache_cooked_read (regcache, regnum, buf) != REG_VALID)
+    Py_RETURN_NONE;
+
+  type = check_typedef (type);
+  switch (TYPE_CODE (type))
+    {
+    case TYPE_CODE_INT:
+    case TYPE_CODE_CHAR:
+    case TYPE_CODE_ENUM:
+    case TYPE_CODE_BOOL:
+    case TYPE_CODE_FLAGS:
+    case TYPE_CODE_PTR:
+      if (TYPE_LENGTH (type) > sizeof (LONGEST))
+	break;
+      if (TYPE_UNSIGNED (type) || TYPE_CODE (type) == TYPE_CODE_PTR
+	  || TYPE_CODE (type) == TYPE_CODE_FLAGS)
+	return gdb_py_object_from_ulongest (unpack_long (type, buf));
+      return gdb_py_object_from_longest (unpack_long (type, buf));
+
+    case TYPE_CODE_FLT:
+      {
+	int invalid;
+	DOUBLEST d = unpack_double (type, buf, &invalid);
+
+	if (!invalid)
+	  return PyFloat_FromDouble (d);
+      }
+      break;
+    }
+
+  return PyString_FromStringAndSize ((char *) buf, TYPE_LENGTH (type));
+}
@@ -28,10 +28,12 @@
 #include "infcall.h"
 #include "expression.h"
 #include "cp-abi.h"
+#include "gdb_obstack.h"
 
 #ifdef HAVE_PYTHON
 
 #include "python-internal.h"
+#include "stats.h"
 
 /* Even though Python scalar types directly map to host types, we use
    target types here to remain consistent with the values system in
@@ -127,6 +129,8 @@ valpy_new (PyTypeObject *subtype, PyObject *args, PyObject *keywords)
   struct value *value = NULL;   /* Initialize to appease gcc warning.  */
   value_object *value_obj;
 
+  GDB_PY_REQUIRE_MAIN_THREAD ();
+
   if (PyTuple_Size (args) != 1)
     {
       PyErr_SetString (PyExc_TypeError, _("Value object creation takes only "
@@ -177,6 +181,8 @@ valpy_dereference (PyObject *self, PyObject *args)
   struct value *res_val = NULL;	  /* Initialize to appease gcc warning.  */
   volatile struct gdb_exception except;
 
+  GDB_PY_REQUIRE_MAIN_THREAD ();
+
   TRY_CATCH (except, RETURN_MASK_ALL)
     {
       res_val = value_ind (((value_object *) self)->value);
@@ -194,6 +200,8 @@ valpy_get_address (PyObject *self, void *closure)
   value_object *val_obj = (value_object *) self;
   volatile struct gdb_exception except;
 
+  GDB_PY_REQUIRE_MAIN_THREAD ();
+
   if (!val_obj->address)
     {
       TRY_CATCH (except, RETURN_MASK_ALL)
@@ -220,6 +228,8 @@ valpy_get_type (PyObject *self, void *closure)
 {
   value_object *obj = (value_object *) self;
 
+  GDB_PY_REQUIRE_MAIN_THREAD ();
+
   if (!obj->type)
     {
       obj->type = type_to_type_object (value_type (obj->value));
@@ -239,6 +249,8 @@ valpy_get_dynamic_type (PyObject *self, void *closure)
   volatile struct gdb_exception except;
   struct type *type = NULL;
 
+  GDB_PY_REQUIRE_MAIN_THREAD ();
+
   if (obj->dynamic_type != NULL)
     {
       Py_INCREF (obj->dynamic_type);
@@ -314,6 +326,8 @@ valpy_lazy_string (PyObject *self, PyObject *args, PyObject *kw)
   PyObject *str_obj;
   volatile struct gdb_exception except;
 
+  GDB_PY_REQUIRE_MAIN_THREAD ();
+
   if (!PyArg_ParseTupleAndKeywords (args, kw, "|s" GDB_PY_LL_ARG, keywords,
 				    &user_encoding, &length))
     return NULL;
@@ -353,6 +367,8 @@ valpy_string (PyObject *self, PyObject *args, PyObject *kw)
   struct type *char_type;
   static char *keywords[] = { "encoding", "errors", "length", NULL };
 
+  GDB_PY_REQUIRE_MAIN_THREAD ();
+
   if (!PyArg_ParseTupleAndKeywords (args, kw, "|ssi", keywords,
 				    &user_encoding, &errors, &length))
     return NULL;
@@ -381,6 +397,8 @@ valpy_do_cast (PyObject *self, PyObject *args, enum exp_opcode op)
   struct value *res_val = NULL;	  /* Initialize to appease gcc warning.  */
   volatile struct gdb_exception except;
 
+  GDB_PY_REQUIRE_MAIN_THREAD ();
+
   if (! PyArg_ParseTuple (args, "O", &type_obj))
     return NULL;
 
@@ -454,6 +472,8 @@ valpy_getitem (PyObject *self, PyObject *key)
   struct value *res_val = NULL;
   volatile struct gdb_exception except;
 
+  GDB_PY_REQUIRE_MAIN_THREAD ();
+
   if (gdbpy_is_string (key))
     {  
       field = python_string_to_host_string (key);
@@ -517,6 +537,8 @@ valpy_call (PyObject *self, PyObject *args, PyObject *keywords)
   struct value **vargs = NULL;
   struct type *ftype = NULL;
 
+  GDB_PY_REQUIRE_MAIN_THREAD ();
+
   TRY_CATCH (except, RETURN_MASK_ALL)
     {
       ftype = check_typedef (value_type (function));
@@ -575,6 +597,8 @@ valpy_str (PyObject *self)
   struct value_print_options opts;
   volatile struct gdb_exception except;
 
+  GDB_PY_REQUIRE_MAIN_THREAD ();
+
   get_user_print_options (&opts);
   opts.deref_ref = 0;
 
@@ -583,6 +607,7 @@ valpy_str (PyObject *self)
       struct ui_file *stb = mem_fileopen ();
       struct cleanup *old_chain = make_cleanup_ui_file_delete (stb);
 
+      make_cleanup_stats_timer (STATS_TIME_GDB);
       common_val_print (((value_object *) self)->value, stb, 0,
 			&opts, python_language);
       s = ui_file_xstrdup (stb, NULL);
@@ -605,6 +630,8 @@ valpy_get_is_optimized_out (PyObject *self, void *closure)
   int opt = 0;
   volatile struct gdb_exception except;
 
+  GDB_PY_REQUIRE_MAIN_THREAD ();
+
   TRY_CATCH (except, RETURN_MASK_ALL)
     {
       opt = value_optimized_out (value);
@@ -625,6 +652,8 @@ valpy_get_is_lazy (PyObject *self, void *closure)
   int opt = 0;
   volatile struct gdb_exception except;
 
+  GDB_PY_REQUIRE_MAIN_THREAD ();
+
   TRY_CATCH (except, RETURN_MASK_ALL)
     {
       opt = value_lazy (value);
@@ -644,6 +673,8 @@ valpy_fetch_lazy (PyObject *self, PyObject *args)
   struct value *value = ((value_object *) self)->value;
   volatile struct gdb_exception except;
 
+  GDB_PY_REQUIRE_MAIN_THREAD ();
+
   TRY_CATCH (except, RETURN_MASK_ALL)
     {
       if (value_lazy (value))
@@ -654,6 +685,457 @@ valpy_fetch_lazy (PyObject *self, PyObject *args)
   Py_RETURN_NONE;
 }
 
+/* Return the contents of VALUE, fetched if lazy, after following
+   references, and set *TYPEP to its type, with typedefs stripped.
+   Returns NULL on error, with a Python exception set.  */
+
+static const gdb_byte *
+value_contents_for_python (struct value *value, struct type **typep)
+{
+  const gdb_byte *contents = NULL;
+  volatile struct gdb_exception except;
+
+  TRY_CATCH (except, RETURN_MASK_ALL)
+    {
+      value = coerce_ref (value);
+      *typep = check_typedef (value_type (value));
+      contents = value_contents (value);
+    }
+  if (except.reason < 0)
+    {
+      gdbpy_convert_exception (except);
+      return NULL;
+    }
+
+  return contents;
+}
+
+/* Implements gdb.Value.to_bytes () -> String.  Returns the contents
+   of the value, read from the inferior at once if lazy.  */
+
+static PyObject *
+valpy_to_bytes (PyObject *self, PyObject *args)
+{
+  struct type *type;
+  const gdb_byte *contents;
+
+  GDB_PY_REQUIRE_MAIN_THREAD ();
+
+  contents = value_contents_for_python (((value_object *) self)->value,
+					&type);
+  if (contents == NULL)
+    return NULL;
+
+  return PyString_FromStringAndSize ((const char *) contents,
+				     TYPE_LENGTH (type));
+}
+
+/* Check that objects of type TYPE can be converted by
+   convert_contents_to_python, resolving the typedefs it refers to
+   along the way, so that the conversion can't throw an error.
+   Returns NULL if they can, and the reason if they can't.  Throws an
+   error if a type can't be resolved.  */
+
+static const char *
+check_convertible_type (struct type *type)
+{
+  int i;
+
+  type = check_typedef (type);
+  switch (TYPE_CODE (type))
+    {
+    case TYPE_CODE_INT:
+    case TYPE_CODE_CHAR:
+    case TYPE_CODE_ENUM:
+    case TYPE_CODE_BOOL:
+    case TYPE_CODE_RANGE:
+    case TYPE_CODE_PTR:
+    case TYPE_CODE_REF:
+      if (TYPE_LENGTH (type) > sizeof (LONGEST))
+	return _("Cannot convert integers wider than a LONGEST.");
+      return NULL;
+
+    case TYPE_CODE_FLT:
+      /* Make sure the format is known.  */
+      floatformat_from_type (type);
+      return NULL;
+
+    case TYPE_CODE_STRUCT:
+    case TYPE_CODE_UNION:
+      for (i = 0; i < TYPE_NFIELDS (type); i++)
+	{
+	  const char *reason;
+
+	  if (field_is_static (&TYPE_FIELD (type, i)))
+	    continue;
+	  if (i < TYPE_N_BASECLASSES (type) && BASETYPE_VIA_VIRTUAL (type, i))
+	    return _("Cannot convert a class with virtual base classes.");
+	  reason = check_convertible_type (TYPE_FIELD_TYPE (type, i));
+	  if (reason != NULL)
+	    return reason;
+	}
+      return NULL;
+
+    case TYPE_CODE_ARRAY:
+      /* Packed arrays don't have whole bytes for each element.  */
+      if (TYPE_FIELD_BITSIZE (type, 0) != 0)
+	return _("Cannot convert a packed array.");
+      return check_convertible_type (TYPE_TARGET_TYPE (type));
+
+    default:
+      return _("Cannot convert values of this type.");
+    }
+}
+
+static PyObject *convert_contents_to_python (struct type *type,
+					     const gdb_byte *valaddr);
+
+/* Subroutine of convert_contents_to_python.  Return a tuple of the
+   non-static fields of the struct or union of type TYPE at
+   VALADDR.  */
+
+static PyObject *
+convert_fields_to_python (struct type *type, const gdb_byte *valaddr)
+{
+  PyObject *result;
+  int i, n = 0;
+
+  for (i = 0; i < TYPE_NFIELDS (type); i++)
+    if (!field_is_static (&TYPE_FIELD (type, i)))
+      n++;
+
+  result = PyTuple_New (n);
+  if (result == NULL)
+    return NULL;
+
+  for (i = 0, n = 0; i < TYPE_NFIELDS (type); i++)
+    {
+      PyObject *item;
+
+      if (field_is_static (&TYPE_FIELD (type, i)))
+	continue;
+
+      if (TYPE_FIELD_BITSIZE (type, i) != 0)
+	item = gdb_py_object_from_longest (unpack_field_as_long (type, valaddr,
+								 i));
+      else
+	item = convert_contents_to_python (TYPE_FIELD_TYPE (type, i),
+					   valaddr
+					   + TYPE_FIELD_BITPOS (type, i) / 8);
+      if (item == NULL)
+	{
+	  Py_DECREF (result);
+	  return NULL;
+	}
+      PyTuple_SET_ITEM (result, n++, item);
+    }
+
+  return result;
+}
+
+/* Subroutine of convert_contents_to_python.  Return a tuple of the
+   elements of the array of type TYPE at VALADDR.  */
+
+static PyObject *
+convert_elements_to_python (struct type *type, const gdb_byte *valaddr)
+{
+  struct type *elt_type = check_typedef (TYPE_TARGET_TYPE (type));
+  LONGEST low, high, i;
+  PyObject *result;
+
+  if (get_array_bounds (type, &low, &high) < 0 || high < low)
+    return PyTuple_New (0);
+
+  result = PyTuple_New (high - low + 1);
+  if (result == NULL)
+    return NULL;
+
+  for (i = 0; i <= high - low; i++)
+    {
+      PyObject *item;
+
+      item = convert_contents_to_python (elt_type,
+					 valaddr + i * TYPE_LENGTH (elt_type));
+      if (item == NULL)
+	{
+	  Py_DECREF (result);
+	  return NULL;
+	}
+      PyTuple_SET_ITEM (result, i, item);
+    }
+
+  return result;
+}
+
+/* Return a new Python object for the object of type TYPE at VALADDR,
+   decoded without making a gdb.Value: an integer for an integer,
+   enum, boolean, character or pointer, a float for a floating point
+   number, and a tuple of the fields of a struct or union, or of the
+   elements of an array.  TYPE must have passed check_convertible_type.
+   Returns NULL on error, with a Python exception set.  */
+
+static PyObject *
+convert_contents_to_python (struct type *type, const gdb_byte *valaddr)
+{
+  type = check_typedef (type);
+  switch (TYPE_CODE (type))
+    {
+    case TYPE_CODE_INT:
+    case TYPE_CODE_CHAR:
+    case TYPE_CODE_ENUM:
+    case TYPE_CODE_BOOL:
+    case TYPE_CODE_RANGE:
+      if (TYPE_UNSIGNED (type))
+	return gdb_py_object_from_ulongest (unpack_long (type, valaddr));
+      return gdb_py_object_from_longest (unpack_long (type, valaddr));
+
+    case TYPE_CODE_PTR:
+    case TYPE_CODE_REF:
+      return gdb_py_object_from_ulongest (unpack_long (type, valaddr));
+
+    case TYPE_CODE_FLT:
+      {
+	int invalid;
+	DOUBLEST d = unpack_double (type, valaddr, &invalid);
+
+	if (invalid)
+	  {
+	    PyErr_SetString (PyExc_ValueError,
+			     _("Invalid floating value found in program."));
+	    return NULL;
+	  }
+	return PyFloat_FromDouble (d);
+      }
+
+    case TYPE_CODE_STRUCT:
+    case TYPE_CODE_UNION:
+      return convert_fields_to_python (type, valaddr);
+
+    case TYPE_CODE_ARRAY:
+      return convert_elements_to_python (type, valaddr);
+
+    default:
+      gdb_assert_not_reached ("type not checked by check_convertible_type");
+    }
+}
+
+/* Implements gdb.Value.fields_as_tuple () -> Tuple.  Returns the
+   fields of a struct or union, or the elements of an array, decoded
+   from the value's contents, which are read from the inferior at
+   once if lazy.  See convert_contents_to_python.  */
+
+static PyObject *
+valpy_fields_as_tuple (PyObject *self, PyObject *args)
+{
+  volatile struct gdb_exception except;
+  const char *reason = NULL;
+  struct type *type;
+  const gdb_byte *contents;
+
+  GDB_PY_REQUIRE_MAIN_THREAD ();
+
+  contents = value_contents_for_python (((value_object *) self)->value,
+					&type);
+  if (contents == NULL)
+    return NULL;
+
+  if (TYPE_CODE (type) != TYPE_CODE_STRUCT
+      && TYPE_CODE (type) != TYPE_CODE_UNION
+      && TYPE_CODE (type) != TYPE_CODE_ARRAY)
+    {
+      PyErr_SetString (PyExc_TypeError,
+		       _("The value is not a struct, union or array."));
+      return NULL;
+    }
+
+  TRY_CATCH (except, RETURN_MASK_ALL)
+    {
+      reason = check_convertible_type (type);
+    }
+  GDB_PY_HANDLE_EXCEPTION (except);
+
+  if (reason != NULL)
+    {
+      PyErr_SetString (PyExc_TypeError, reason);
+      return NULL;
+    }
+
+  return convert_contents_to_python (type, contents);
+}
+
+/* Return the code of Python's struct module for the scalar type TYPE,
+   or 0 if it has none.  */
+
+static char
+scalar_struct_format (struct type *type)
+{
+  static const char signed_codes[] = "bh?i???q";
+  static const char unsigned_codes[] = "BH?I???Q";
+  int length = TYPE_LENGTH (type);
+
+  switch (TYPE_CODE (type))
+    {
+    case TYPE_CODE_BOOL:
+      if (length == 1)
+	return '?';
+      /* Fall through.  */
+    case TYPE_CODE_INT:
+    case TYPE_CODE_CHAR:
+    case TYPE_CODE_ENUM:
+    case TYPE_CODE_RANGE:
+      if (length < 1 || length > 8 || signed_codes[length - 1] == '?')
+	return 0;
+      if (TYPE_UNSIGNED (type))
+	return unsigned_codes[length - 1];
+      return signed_codes[length - 1];
+
+    case TYPE_CODE_PTR:
+    case TYPE_CODE_REF:
+      if (length < 1 || length > 8 || unsigned_codes[length - 1] == '?')
+	return 0;
+      return unsigned_codes[length - 1];
+
+    case TYPE_CODE_FLT:
+      if (length == 4)
+	return 'f';
+      if (length == 8)
+	return 'd';
+      return 0;
+
+    default:
+      return 0;
+    }
+}
+
+/* Append to OB the format of Python's struct module for TYPE, without
+   a byte order, flattening structs and arrays.  Throws an error if
+   the type has no format.  */
+
+static void
+append_struct_format (struct obstack *ob, struct type *type)
+{
+  char code;
+
+  type = check_typedef (type);
+  code = scalar_struct_format (type);
+  if (code != 0)
+    {
+      obstack_1grow (ob, code);
+      return;
+    }
+
+  if (TYPE_CODE (type) == TYPE_CODE_ARRAY)
+    {
+      struct type *elt_type = check_typedef (TYPE_TARGET_TYPE (type));
+      LONGEST low, high, i;
+
+      if (get_array_bounds (type, &low, &high) < 0 || high < low)
+	return;
+      if (TYPE_FIELD_BITSIZE (type, 0) != 0)
+	error (_("Packed arrays have no struct format."));
+
+      code = scalar_struct_format (elt_type);
+      if (code != 0)
+	{
+	  char buf[32];
+
+	  xsnprintf (buf, sizeof (buf), "%s%c",
+		     plongest (high - low + 1), code);
+	  obstack_grow_str (ob, buf);
+	}
+      else
+	for (i = low; i <= high; i++)
+	  append_struct_format (ob, elt_type);
+      return;
+    }
+
+  if (TYPE_CODE (type) == TYPE_CODE_STRUCT)
+    {
+      ULONGEST offset = 0;
+      int i;
+
+      for (i = 0; i < TYPE_NFIELDS (type); i++)
+	{
+	  struct type *field_type;
+	  ULONGEST pos;
+
+	  if (field_is_static (&TYPE_FIELD (type, i)))
+	    continue;
+	  if (i < TYPE_N_BASECLASSES (type) && BASETYPE_VIA_VIRTUAL (type, i))
+	    error (_("Classes with virtual base classes have no struct "
+		     "format."));
+	  if (TYPE_FIELD_BITSIZE (type, i) != 0)
+	    error (_("Bitfields have no struct format."));
+
+	  pos = TYPE_FIELD_BITPOS (type, i) / 8;
+	  if (pos < offset)
+	    error (_("Overlapping fields have no struct format."));
+	  if (pos > offset)
+	    {
+	      obstack_grow_str (ob, pulongest (pos - offset));
+	      obstack_1grow (ob, 'x');
+	    }
+
+	  field_type = check_typedef (TYPE_FIELD_TYPE (type, i));
+	  append_struct_format (ob, field_type);
+	  offset = pos + TYPE_LENGTH (field_type);
+	}
+
+      if (TYPE_LENGTH (type) > offset)
+	{
+	  obstack_grow_str (ob, pulongest (TYPE_LENGTH (type) - offset));
+	  obstack_1grow (ob, 'x');
+	}
+      return;
+    }
+
+  error (_("Values of this type have no struct format."));
+}
+
+/* Implements gdb.Value.struct_format () -> String.  Returns the format
+   of Python's struct module for the value's type, with its byte
+   order, such that struct.unpack of it and the value's to_bytes
+   gives the value's scalars, with structs and arrays flattened.  */
+
+static PyObject *
+valpy_struct_format (PyObject *self, PyObject *args)
+{
+  struct value *value = ((value_object *) self)->value;
+  volatile struct gdb_exception except;
+  char *format = NULL;
+  PyObject *result;
+
+  GDB_PY_REQUIRE_MAIN_THREAD ();
+
+  TRY_CATCH (except, RETURN_MASK_ALL)
+    {
+      struct type *type = check_typedef (value_type (value));
+      struct obstack ob;
+      struct cleanup *cleanup;
+
+      if (TYPE_CODE (type) == TYPE_CODE_REF)
+	type = check_typedef (TYPE_TARGET_TYPE (type));
+
+      obstack_init (&ob);
+      cleanup = make_cleanup_obstack_free (&ob);
+
+      if (gdbarch_byte_order (get_type_arch (type)) == BFD_ENDIAN_BIG)
+	obstack_1grow (&ob, '>');
+      else
+	obstack_1grow (&ob, '<');
+      append_struct_format (&ob, type);
+      obstack_1grow (&ob, '\0');
+
+      format = xstrdup (obstack_base (&ob));
+      do_cleanups (cleanup);
+    }
+  GDB_PY_HANDLE_EXCEPTION (except);
+
+  result = PyString_FromString (format);
+  xfree (format);
+  return result;
+}
+
 /* Calculate and return the address of the PyObject as the value of
    the builtin __hash__ call.  */
 static long 
@@ -690,6 +1172,8 @@ valpy_binop (enum valpy_opcode opcode, PyObject *self, PyObject *other)
   struct value *res_val = NULL;	  /* Initialize to appease gcc warning.  */
   volatile struct gdb_exception except;
 
+  GDB_PY_REQUIRE_MAIN_THREAD ();
+
   TRY_CATCH (except, RETURN_MASK_ALL)
     {
       struct value *arg1, *arg2;
@@ -836,6 +1320,8 @@ valpy_negative (PyObject *self)
   struct value *val = NULL;
   volatile struct gdb_exception except;
 
+  GDB_PY_REQUIRE_MAIN_THREAD ();
+
   TRY_CATCH (except, RETURN_MASK_ALL)
     {
       val = value_neg (((value_object *) self)->value);
@@ -848,6 +1334,8 @@ valpy_negative (PyObject *self)
 static PyObject *
 valpy_positive (PyObject *self)
 {
+  GDB_PY_REQUIRE_MAIN_THREAD ();
+
   return value_to_value_object (((value_object *) self)->value);
 }
 
@@ -858,6 +1346,8 @@ valpy_absolute (PyObject *self)
   volatile struct gdb_exception except;
   int isabs = 1;
 
+  GDB_PY_REQUIRE_MAIN_THREAD ();
+
   TRY_CATCH (except, RETURN_MASK_ALL)
     {
       if (value_less (value, value_zero (value_type (value), not_lval)))
@@ -880,6 +1370,8 @@ valpy_nonzero (PyObject *self)
   struct type *type;
   int nonzero = 0; /* Appease GCC warning.  */
 
+  GDB_PY_SET_REQUIRE_MAIN_THREAD ();
+
   TRY_CATCH (except, RETURN_MASK_ALL)
     {
       type = check_typedef (value_type (self_value->value));
@@ -911,6 +1403,8 @@ valpy_invert (PyObject *self)
   struct value *val = NULL;
   volatile struct gdb_exception except;
 
+  GDB_PY_REQUIRE_MAIN_THREAD ();
+
   TRY_CATCH (except, RETURN_MASK_ALL)
     {
       val = value_complement (((value_object *) self)->value);
@@ -964,6 +1458,8 @@ valpy_richcompare (PyObject *self, PyObject *other, int op)
   struct value *value_other;
   volatile struct gdb_exception except;
 
+  GDB_PY_REQUIRE_MAIN_THREAD ();
+
   if (other == Py_None)
     /* Comparing with None is special.  From what I can tell, in Python
        None is smaller than anything else.  */
@@ -1053,6 +1549,8 @@ valpy_int (PyObject *self)
   LONGEST l = 0;
   volatile struct gdb_exception except;
 
+  GDB_PY_REQUIRE_MAIN_THREAD ();
+
   TRY_CATCH (except, RETURN_MASK_ALL)
     {
       CHECK_TYPEDEF (type);
@@ -1075,6 +1573,8 @@ valpy_long (PyObject *self)
   LONGEST l = 0;
   volatile struct gdb_exception except;
 
+  GDB_PY_REQUIRE_MAIN_THREAD ();
+
   TRY_CATCH (except, RETURN_MASK_ALL)
     {
       CHECK_TYPEDEF (type);
@@ -1098,6 +1598,8 @@ valpy_float (PyObject *self)
   double d = 0;
   volatile struct gdb_exception except;
 
+  GDB_PY_REQUIRE_MAIN_THREAD ();
+
   TRY_CATCH (except, RETURN_MASK_ALL)
     {
       CHECK_TYPEDEF (type);
@@ -1261,6 +1763,8 @@ gdbpy_history (PyObject *self, PyObject *args)
   struct value *res_val = NULL;	  /* Initialize to appease gcc warning.  */
   volatile struct gdb_exception except;
 
+  GDB_PY_REQUIRE_MAIN_THREAD ();
+
   if (!PyArg_ParseTuple (args, "i", &i))
     return NULL;
 
@@ -1333,6 +1837,16 @@ Return a lazy string representation of the value." },
 Return Unicode string representation of the value." },
   { "fetch_lazy", valpy_fetch_lazy, METH_NOARGS, 
     "Fetches the value from the inferior, if it was lazy." },
+  { "to_bytes", valpy_to_bytes, METH_NOARGS,
+    "to_bytes () -> String.\n\
+Return the contents of the value, fetched from the inferior at once." },
+  { "fields_as_tuple", valpy_fields_as_tuple, METH_NOARGS,
+    "fields_as_tuple () -> Tuple.\n\
+Return the fields of a struct or union, or the elements of an array,\n\
+converted to Python numbers and tuples." },
+  { "struct_format", valpy_struct_format, METH_NOARGS,
+    "struct_format () -> String.\n\
+Return the format of Python's struct module for the value's type." },
   {NULL}  /* Sentinel */
 };
 
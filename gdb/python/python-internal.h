@@ -187,6 +187,7 @@ PyObject *gdbpy_lookup_global_symbol (PyObject *self, PyObject *args,
 				      PyObject *kw);
 PyObject *gdbpy_newest_frame (PyObject *self, PyObject *args);
 PyObject *gdbpy_selected_frame (PyObject *self, PyObject *args);
+PyObject *gdbpy_backtrace (PyObject *self, PyObject *args, PyObject *kw);
 PyObject *gdbpy_block_for_pc (PyObject *self, PyObject *args);
 PyObject *gdbpy_lookup_type (PyObject *self, PyObject *args, PyObject *kw);
 PyObject *gdbpy_create_lazy_string_object (CORE_ADDR address, long length,
@@ -288,6 +289,30 @@ extern const struct language_defn *python_language;
     } while (0)
 
 void gdbpy_print_stack (void);
+int gdbpy_main_thread_p (void);
+void gdbpy_set_main_thread_error (void);
+
+/* Use this at the start of a function that uses GDB, to raise
+   RuntimeError and return NULL when it is called from a thread other
+   than GDB's own.  */
+#define GDB_PY_REQUIRE_MAIN_THREAD()					\
+    do {								\
+      if (!gdbpy_main_thread_p ())					\
+	{								\
+	  gdbpy_set_main_thread_error ();				\
+	  return NULL;							\
+	}								\
+    } while (0)
+
+/* Likewise, but return -1, for functions returning an int.  */
+#define GDB_PY_SET_REQUIRE_MAIN_THREAD()				\
+    do {								\
+      if (!gdbpy_main_thread_p ())					\
+	{								\
+	  gdbpy_set_main_thread_error ();				\
+	  return -1;							\
+	}								\
+    } while (0)
 
 void source_python_script_for_objfile (struct objfile *objfile,
 				       const char *file);
@@ -317,6 +342,13 @@ PyObject *apply_varobj_pretty_printer (PyObject *print_obj,
 PyObject *gdbpy_get_varobj_pretty_printer (struct value *value);
 char *gdbpy_get_display_hint (PyObject *printer);
 PyObject *gdbpy_default_visualizer (PyObject *self, PyObject *args);
+PyObject *gdbpy_invalidate_cached_pretty_printers (PyObject *self,
+						  PyObject *args);
+void gdbpy_clear_pretty_printer_cache (void);
+extern int gdbpy_cache_pretty_printers;
+extern unsigned int gdbpy_event_batch_size;
+extern unsigned int gdbpy_event_batch_interval;
+extern int gdbpy_coalesce_events;
 
 void bpfinishpy_pre_stop_hook (struct breakpoint_object *bp_obj);
 void bpfinishpy_post_stop_hook (struct breakpoint_object *bp_obj);
@@ -341,4 +373,7 @@ PyObject *gdb_py_object_from_longest (LONGEST l);
 PyObject *gdb_py_object_from_ulongest (ULONGEST l);
 int gdb_py_int_as_long (PyObject *, long *);
 
+int gdbpy_register_number (struct gdbarch *gdbarch, PyObject *name);
+PyObject *gdbpy_register_to_python (struct regcache *regcache, int regnum);
+
 #endif /* GDB_PYTHON_INTERNAL_H */
@@ -55,6 +55,18 @@ static const char *python_excp_enums[] =
    the default.  */
 static const char *gdbpy_should_print_stack = python_excp_message;
 
+/* Nonzero if pretty-printer lookups are cached by type.  */
+int gdbpy_cache_pretty_printers = 1;
+
+/* The most events, and the longest time in milliseconds, that events
+   wait for the listeners of gdb.events.batch; UINT_MAX means
+   unlimited.  */
+unsigned int gdbpy_event_batch_size = 1000;
+unsigned int gdbpy_event_batch_interval = 100;
+
+/* Nonzero if redundant continue events are left out of batches.  */
+int gdbpy_coalesce_events = 1;
+
 #ifdef HAVE_PYTHON
 
 #include "libiberty.h"
@@ -70,6 +82,10 @@ static const char *gdbpy_should_print_stack = python_excp_message;
 #include "gdbthread.h"
 #include "observer.h"
 #include "interps.h"
+#include "remote.h"
+#include "coverage.h"
+#include "stats.h"
+#include "pythread.h"
 
 static PyMethodDef GdbMethods[];
 
@@ -92,6 +108,9 @@ PyObject *gdbpy_gdb_error;
 /* The `gdb.MemoryError' exception.  */
 PyObject *gdbpy_gdb_memory_error;
 
+/* The Python identifier of GDB's own thread.  */
+static long gdbpy_main_thread;
+
 /* Architecture and language to be used in callbacks from
    the Python interpreter.  */
 struct gdbarch *python_gdbarch;
@@ -106,6 +125,7 @@ struct python_env
   struct gdbarch *gdbarch;
   const struct language_defn *language;
   PyObject *error_type, *error_value, *error_traceback;
+  enum stats_timer previous_timer;
 };
 
 static void
@@ -126,6 +146,7 @@ restore_python_env (void *p)
   PyGILState_Release (env->state);
   python_gdbarch = env->gdbarch;
   python_language = env->language;
+  stats_timer_leave (env->previous_timer);
   xfree (env);
 }
 
@@ -138,6 +159,7 @@ ensure_python_env (struct gdbarch *gdbarch,
 {
   struct python_env *env = xmalloc (sizeof *env);
 
+  env->previous_timer = stats_timer_enter (STATS_TIME_PYTHON);
   env->state = PyGILState_Ensure ();
   env->gdbarch = python_gdbarch;
   env->language = python_language;
@@ -197,9 +219,29 @@ python_run_simple_file (const char *filename)
  
   make_cleanup_py_decref (python_file);
   PyRun_SimpleFile (PyFile_AsFile (python_file), filename);
+  gdbpy_clear_pretty_printer_cache ();
   do_cleanups (cleanup);
 }
 
+/* Return nonzero if the calling Python thread is GDB's own, which is
+   the only one that may use GDB.  */
+
+int
+gdbpy_main_thread_p (void)
+{
+  return PyThread_get_thread_ident () == gdbpy_main_thread;
+}
+
+/* Set the Python exception raised when a thread other than GDB's
+   calls into GDB.  */
+
+void
+gdbpy_set_main_thread_error (void)
+{
+  PyErr_SetString (PyExc_RuntimeError,
+		   _("GDB can only be used from GDB's thread."));
+}
+
 /* Given a command_line, return a command string suitable for passing
    to Python.  Lines in the string are separated by newlines.  The
    return value is allocated using xmalloc and the caller is
@@ -248,6 +290,7 @@ eval_python_from_control_command (struct command_line *cmd)
   script = compute_python_string (cmd->body_list[0]);
   ret = PyRun_SimpleString (script);
   xfree (script);
+  gdbpy_clear_pretty_printer_cache ();
   if (ret)
     error (_("Error while executing Python code."));
 
@@ -270,7 +313,10 @@ python_command (char *arg, int from_tty)
     ++arg;
   if (arg && *arg)
     {
-      if (PyRun_SimpleString (arg))
+      int ret = PyRun_SimpleString (arg);
+
+      gdbpy_clear_pretty_printer_cache ();
+      if (ret)
 	error (_("Error while executing Python code."));
     }
   else
@@ -413,6 +459,8 @@ execute_gdb_command (PyObject *self, PyObject *args, PyObject *kw)
   static char *keywords[] = {"command", "from_tty", "to_string", NULL };
   char *result = NULL;
 
+  GDB_PY_REQUIRE_MAIN_THREAD ();
+
   if (! PyArg_ParseTupleAndKeywords (args, kw, "s|O!O!", keywords, &arg,
 				     &PyBool_Type, &from_tty_obj,
 				     &PyBool_Type, &to_string_obj))
@@ -436,12 +484,18 @@ execute_gdb_command (PyObject *self, PyObject *args, PyObject *kw)
       to_string = cmp;
     }
 
+  /* Let other Python threads run while the command does, as they do
+     while GDB waits at its prompt.  Whatever the command calls back
+     into Python for takes the GIL again.  */
+  Py_BEGIN_ALLOW_THREADS
   TRY_CATCH (except, RETURN_MASK_ALL)
     {
       /* Copy the argument text in case the command modifies it.  */
       char *copy = xstrdup (arg);
       struct cleanup *cleanup = make_cleanup (xfree, copy);
 
+      /* The command is GDB's work, not Python's.  */
+      make_cleanup_stats_timer (STATS_TIME_GDB);
       make_cleanup_restore_integer (&interpreter_async);
       interpreter_async = 0;
 
@@ -456,6 +510,7 @@ execute_gdb_command (PyObject *self, PyObject *args, PyObject *kw)
 
       do_cleanups (cleanup);
     }
+  Py_END_ALLOW_THREADS
   GDB_PY_HANDLE_EXCEPTION (except);
 
   /* Do any commands attached to breakpoint we stopped at.  */
@@ -495,6 +550,312 @@ gdbpy_solib_name (PyObject *self, PyObject *args)
   return str_obj;
 }
 
+/* Set KEY of dictionary DICT to the Python integer for VAL.  Return
+   -1 on error, 0 otherwise.  */
+
+static int
+remote_stats_dict_set (PyObject *dict, const char *key, ULONGEST val)
+{
+  PyObject *obj = gdb_py_long_from_ulongest (val);
+  int result;
+
+  if (obj == NULL)
+    return -1;
+  result = PyDict_SetItemString (dict, key, obj);
+  Py_DECREF (obj);
+  return result;
+}
+
+/* Return a new dictionary describing the packet statistics PS.  */
+
+static PyObject *
+remote_packet_stats_to_dict (const struct remote_packet_stats *ps)
+{
+  PyObject *dict, *histogram;
+  int i;
+
+  dict = PyDict_New ();
+  if (dict == NULL)
+    return NULL;
+
+  if (remote_stats_dict_set (dict, "count", ps->count) < 0
+      || remote_stats_dict_set (dict, "retransmits", ps->retransmits) < 0
+      || remote_stats_dict_set (dict, "bytes_sent", ps->bytes_sent) < 0
+      || remote_stats_dict_set (dict, "bytes_received",
+				ps->bytes_received) < 0
+      || remote_stats_dict_set (dict, "replies", ps->replies) < 0
+      || remote_stats_dict_set (dict, "total_rtt", ps->total_rtt) < 0
+      || remote_stats_dict_set (dict, "max_rtt", ps->max_rtt) < 0)
+    goto fail;
+
+  histogram = PyTuple_New (REMOTE_STATS_RTT_BUCKETS);
+  if (histogram == NULL)
+    goto fail;
+  for (i = 0; i < REMOTE_STATS_RTT_BUCKETS; i++)
+    {
+      PyObject *obj = gdb_py_long_from_ulongest (ps->rtt_histogram[i]);
+
+      if (obj == NULL)
+	{
+	  Py_DECREF (histogram);
+	  goto fail;
+	}
+      PyTuple_SET_ITEM (histogram, i, obj);
+    }
+  if (PyDict_SetItemString (dict, "rtt_histogram", histogram) < 0)
+    {
+      Py_DECREF (histogram);
+      goto fail;
+    }
+  Py_DECREF (histogram);
+
+  return dict;
+
+ fail:
+  Py_DECREF (dict);
+  return NULL;
+}
+
+/* Implementation of gdb.remote_stats ([reset]) -> Dictionary.
+   Return the remote protocol statistics, and reset them if RESET is
+   true.  */
+
+static PyObject *
+gdbpy_remote_stats (PyObject *self, PyObject *args, PyObject *kw)
+{
+  static char *keywords[] = { "reset", NULL };
+  const struct remote_stats *stats = get_remote_stats ();
+  const struct remote_packet_stats *ps;
+  PyObject *reset_obj = NULL, *result, *packets;
+  int reset = 0;
+
+  if (!PyArg_ParseTupleAndKeywords (args, kw, "|O!", keywords,
+				    &PyBool_Type, &reset_obj))
+    return NULL;
+  if (reset_obj != NULL)
+    reset = PyObject_IsTrue (reset_obj);
+
+  result = PyDict_New ();
+  if (result == NULL)
+    return NULL;
+
+  if (remote_stats_dict_set (result, "naks_received",
+			     stats->naks_received) < 0
+      || remote_stats_dict_set (result, "naks_sent", stats->naks_sent) < 0
+      || remote_stats_dict_set (result, "timeouts", stats->timeouts) < 0
+      || remote_stats_dict_set (result, "bad_frames", stats->bad_frames) < 0
+      || remote_stats_dict_set (result, "notifications",
+				stats->notifications) < 0)
+    goto fail;
+
+  packets = PyDict_New ();
+  if (packets == NULL)
+    goto fail;
+  if (PyDict_SetItemString (result, "packets", packets) < 0)
+    {
+      Py_DECREF (packets);
+      goto fail;
+    }
+  Py_DECREF (packets);
+
+  for (ps = stats->packets; ps != NULL; ps = ps->next)
+    {
+      PyObject *dict = remote_packet_stats_to_dict (ps);
+
+      if (dict == NULL)
+	goto fail;
+      if (PyDict_SetItemString (packets, ps->name, dict) < 0)
+	{
+	  Py_DECREF (dict);
+	  goto fail;
+	}
+      Py_DECREF (dict);
+    }
+
+  if (reset)
+    reset_remote_stats ();
+
+  return result;
+
+ fail:
+  Py_DECREF (result);
+  return NULL;
+}
+
+/* Set KEY of dictionary DICT to the Python float for USEC
+   microseconds, in seconds.  Return -1 on error, 0 otherwise.  */
+
+static int
+stats_dict_set_seconds (PyObject *dict, const char *key, ULONGEST usec)
+{
+  PyObject *obj = PyFloat_FromDouble (usec / 1000000.0);
+  int result;
+
+  if (obj == NULL)
+    return -1;
+  result = PyDict_SetItemString (dict, key, obj);
+  Py_DECREF (obj);
+  return result;
+}
+
+/* Implementation of gdb.stats ([reset]) -> Dictionary.  Return GDB's
+   internal counters, and where its time went, and reset them if
+   RESET is true.  */
+
+static PyObject *
+gdbpy_stats (PyObject *self, PyObject *args, PyObject *kw)
+{
+  static char *keywords[] = { "reset", NULL };
+  PyObject *reset_obj = NULL, *result, *time;
+  struct gdb_stats stats;
+  int i;
+
+  if (!PyArg_ParseTupleAndKeywords (args, kw, "|O!", keywords,
+				    &PyBool_Type, &reset_obj))
+    return NULL;
+
+  get_stats (&stats);
+
+  result = PyDict_New ();
+  if (result == NULL)
+    return NULL;
+
+  for (i = 0; i < NR_STATS_COUNTERS; i++)
+    if (remote_stats_dict_set (result, stats_counter_name (i),
+			       stats.counters[i]) < 0)
+      goto fail;
+
+  if (stats_dict_set_seconds (result, "cpu_time", get_run_time ()) < 0
+      || stats_dict_set_seconds (result, "command_cpu_time",
+				 stats.command_cpu) < 0
+      || stats_dict_set_seconds (result, "command_wall_time",
+				 stats.command_wall) < 0
+      || stats_dict_set_seconds (result, "last_command_cpu_time",
+				 stats.last_command_cpu) < 0
+      || stats_dict_set_seconds (result, "last_command_wall_time",
+				 stats.last_command_wall) < 0)
+    goto fail;
+
+  time = PyDict_New ();
+  if (time == NULL)
+    goto fail;
+  if (PyDict_SetItemString (result, "time", time) < 0)
+    {
+      Py_DECREF (time);
+      goto fail;
+    }
+  Py_DECREF (time);
+
+  for (i = 0; i < NR_STATS_TIMERS; i++)
+    if (stats_dict_set_seconds (time, stats_timer_name (i),
+				stats.timers[i]) < 0)
+      goto fail;
+
+  if (reset_obj != NULL && PyObject_IsTrue (reset_obj))
+    reset_stats ();
+
+  return result;
+
+ fail:
+  Py_DECREF (result);
+  return NULL;
+}
+
+/* Implementation of gdb.coverage_add (addresses) -> Integer.  Plant
+   coverage points at each address of the ADDRESSES sequence, and
+   return the number planted.  */
+
+static PyObject *
+gdbpy_coverage_add (PyObject *self, PyObject *args)
+{
+  PyObject *seq, *fast;
+  CORE_ADDR *addrs;
+  Py_ssize_t i, count;
+  int planted = 0;
+  volatile struct gdb_exception except;
+
+  if (!PyArg_ParseTuple (args, "O", &seq))
+    return NULL;
+
+  fast = PySequence_Fast (seq, _("Argument must be a sequence of addresses."));
+  if (fast == NULL)
+    return NULL;
+
+  count = PySequence_Fast_GET_SIZE (fast);
+  addrs = xmalloc ((count + 1) * sizeof (CORE_ADDR));
+  for (i = 0; i < count; i++)
+    if (!get_addr_from_python (PySequence_Fast_GET_ITEM (fast, i), &addrs[i]))
+      {
+	xfree (addrs);
+	Py_DECREF (fast);
+	return NULL;
+      }
+  Py_DECREF (fast);
+
+  TRY_CATCH (except, RETURN_MASK_ALL)
+    {
+      planted = coverage_insert (count, addrs);
+    }
+  xfree (addrs);
+  GDB_PY_HANDLE_EXCEPTION (except);
+
+  return PyInt_FromLong (planted);
+}
+
+/* Implementation of gdb.coverage_hits () -> List.  Return the
+   addresses of the coverage points hit so far, in the order they were
+   planted.  */
+
+static PyObject *
+gdbpy_coverage_hits (PyObject *self, PyObject *args)
+{
+  VEC(CORE_ADDR) *hits = NULL;
+  PyObject *result;
+  CORE_ADDR addr;
+  int i;
+  volatile struct gdb_exception except;
+
+  TRY_CATCH (except, RETURN_MASK_ALL)
+    {
+      hits = coverage_hits ();
+    }
+  GDB_PY_HANDLE_EXCEPTION (except);
+
+  result = PyList_New (VEC_length (CORE_ADDR, hits));
+  if (result != NULL)
+    for (i = 0; VEC_iterate (CORE_ADDR, hits, i, addr); i++)
+      {
+	PyObject *obj = gdb_py_long_from_ulongest (addr);
+
+	if (obj == NULL)
+	  {
+	    Py_DECREF (result);
+	    result = NULL;
+	    break;
+	  }
+	PyList_SET_ITEM (result, i, obj);
+      }
+
+  VEC_free (CORE_ADDR, hits);
+  return result;
+}
+
+/* Implementation of gdb.coverage_clear () -> None.  */
+
+static PyObject *
+gdbpy_coverage_clear (PyObject *self, PyObject *args)
+{
+  volatile struct gdb_exception except;
+
+  TRY_CATCH (except, RETURN_MASK_ALL)
+    {
+      coverage_clear ();
+    }
+  GDB_PY_HANDLE_EXCEPTION (except);
+
+  Py_RETURN_NONE;
+}
+
 /* A Python function which is a wrapper for decode_line_1.  */
 
 static PyObject *
@@ -603,6 +964,8 @@ gdbpy_parse_and_eval (PyObject *self, PyObject *args)
   struct value *result = NULL;
   volatile struct gdb_exception except;
 
+  GDB_PY_REQUIRE_MAIN_THREAD ();
+
   if (!PyArg_ParseTuple (args, "s", &expr_str))
     return NULL;
 
@@ -611,6 +974,7 @@ gdbpy_parse_and_eval (PyObject *self, PyObject *args)
       char *copy = xstrdup (expr_str);
       struct cleanup *cleanup = make_cleanup (xfree, copy);
 
+      make_cleanup_stats_timer (STATS_TIME_GDB);
       result = parse_and_eval (copy);
       do_cleanups (cleanup);
     }
@@ -1101,6 +1465,22 @@ gdbpy_breakpoint_has_py_cond (struct breakpoint_object *bp_obj)
 		    "scripting is not supported."));
 }
 
+int
+gdbpy_fast_stop (struct breakpoint_object *bp_obj, ptid_t ptid)
+{
+  internal_error (__FILE__, __LINE__,
+		  _("gdbpy_fast_stop called when Python scripting is " \
+		    "not supported."));
+}
+
+int
+gdbpy_breakpoint_has_fast_stop (struct breakpoint_object *bp_obj)
+{
+  internal_error (__FILE__, __LINE__,
+		  _("gdbpy_breakpoint_has_fast_stop called when Python " \
+		    "scripting is not supported."));
+}
+
 #endif /* HAVE_PYTHON */
 
 
@@ -1155,6 +1535,31 @@ show_maint_python_print_stack (struct ui_file *file, int from_tty,
 		    ? "on" : "off");
 }
 
+static void
+show_event_batch_size (struct ui_file *file, int from_tty,
+		       struct cmd_list_element *c, const char *value)
+{
+  fprintf_filtered (file,
+		    _("The most events delivered to gdb.events.batch at once"
+		      " is %s.\n"),
+		    value);
+}
+
+static void
+show_event_batch_interval (struct ui_file *file, int from_tty,
+			   struct cmd_list_element *c, const char *value)
+{
+  if (gdbpy_event_batch_interval == UINT_MAX)
+    fprintf_filtered (file,
+		      _("Events wait for gdb.events.batch until the batch"
+			" is full.\n"));
+  else
+    fprintf_filtered (file,
+		      _("Events wait for gdb.events.batch for at most %s"
+			" milliseconds.\n"),
+		      value);
+}
+
 
 
 /* Lists for 'set python' commands.  */
@@ -1261,6 +1666,50 @@ message == an error message without a stack will be printed."),
 			&user_set_python_list,
 			&user_show_python_list);
 
+  add_setshow_boolean_cmd ("pretty-printer-cache", no_class,
+			   &gdbpy_cache_pretty_printers, _("\
+Set whether pretty-printer lookups are cached."), _("\
+Show whether pretty-printer lookups are cached."), _("\
+When on, the pretty-printer found for a value is remembered for the\n\
+value's type, and later values of the type are looked up only there.\n\
+Turn this off if a lookup function decides on more than the type."),
+			   NULL, NULL,
+			   &user_set_python_list,
+			   &user_show_python_list);
+
+  add_setshow_uinteger_cmd ("event-batch-size", no_class,
+			    &gdbpy_event_batch_size, _("\
+Set the most events delivered to gdb.events.batch at once."), _("\
+Show the most events delivered to gdb.events.batch at once."), _("\
+When this many events are waiting for the listeners of gdb.events.batch,\n\
+they are delivered at once.  Zero means unlimited."),
+			    NULL, show_event_batch_size,
+			    &user_set_python_list,
+			    &user_show_python_list);
+
+  add_setshow_uinteger_cmd ("event-batch-interval", no_class,
+			    &gdbpy_event_batch_interval, _("\
+Set how long events wait for gdb.events.batch, in milliseconds."), _("\
+Show how long events wait for gdb.events.batch, in milliseconds."), _("\
+Events for the listeners of gdb.events.batch are delivered this long\n\
+after the first of them, when GDB next waits for input or the target.\n\
+Zero means unlimited: the events wait until the batch is full, or\n\
+gdb.events.flush is called."),
+			    NULL, show_event_batch_interval,
+			    &user_set_python_list,
+			    &user_show_python_list);
+
+  add_setshow_boolean_cmd ("event-batch-coalesce", no_class,
+			   &gdbpy_coalesce_events, _("\
+Set whether redundant continue events are left out of event batches."), _("\
+Show whether redundant continue events are left out of event batches."), _("\
+When on, a continue event of a thread is left out of a batch of events\n\
+for gdb.events.batch if the thread had already been reported continued\n\
+in the batch, or if the batch also reports it stopping again."),
+			   NULL, NULL,
+			   &user_set_python_list,
+			   &user_show_python_list);
+
 #ifdef HAVE_PYTHON
 #ifdef WITH_PYTHON_PATH
   /* Work around problem where python gets confused about where it is,
@@ -1275,6 +1724,7 @@ message == an error message without a stack will be printed."),
 
   Py_Initialize ();
   PyEval_InitThreads ();
+  gdbpy_main_thread = PyThread_get_thread_ident ();
 
   gdb_module = Py_InitModule ("gdb", GdbMethods);
 
@@ -1471,6 +1921,10 @@ static PyMethodDef GdbMethods[] =
 
   { "default_visualizer", gdbpy_default_visualizer, METH_VARARGS,
     "Find the default visualizer for a Value." },
+  { "invalidate_cached_pretty_printers",
+    gdbpy_invalidate_cached_pretty_printers, METH_NOARGS,
+    "invalidate_cached_pretty_printers () -> None.\n\
+Forget which pretty-printers were found for which types." },
 
   { "current_progspace", gdbpy_get_current_progspace, METH_NOARGS,
     "Return the current Progspace." },
@@ -1488,6 +1942,12 @@ Return the newest frame object." },
   { "selected_frame", gdbpy_selected_frame, METH_NOARGS,
     "selected_frame () -> gdb.Frame.\n\
 Return the selected frame object." },
+  { "backtrace", (PyCFunction) gdbpy_backtrace,
+    METH_VARARGS | METH_KEYWORDS,
+    "backtrace ([limit] [, fields] [, locals] [, frame]) -> List.\n\
+Unwind the stack once, and return a tuple for each frame, holding the\n\
+named FIELDS (\"level\", \"pc\", \"name\", \"filename\", \"line\" or \"frame\")\n\
+followed by the values of the LOCALS named, or None where missing." },
   { "frame_stop_reason_string", gdbpy_frame_stop_reason_string, METH_VARARGS,
     "stop_reason_string (Integer) -> String.\n\
 Return a string explaining unwind stop reason." },
@@ -1511,6 +1971,24 @@ Return the symbol corresponding to the given name (or None)." },
   { "solib_name", gdbpy_solib_name, METH_VARARGS,
     "solib_name (Long) -> String.\n\
 Return the name of the shared library holding a given address, or None." },
+  { "remote_stats", (PyCFunction) gdbpy_remote_stats,
+    METH_VARARGS | METH_KEYWORDS,
+    "remote_stats ([reset]) -> Dictionary.\n\
+Return the remote protocol statistics, and reset them if RESET is True." },
+  { "stats", (PyCFunction) gdbpy_stats, METH_VARARGS | METH_KEYWORDS,
+    "stats ([reset]) -> Dictionary.\n\
+Return GDB's internal counters, and the wall time spent in Python, symbol\n\
+lookup, the target and the rest of GDB, and reset them if RESET is True." },
+  { "coverage_add", gdbpy_coverage_add, METH_VARARGS,
+    "coverage_add (Sequence) -> Integer.\n\
+Plant one-shot coverage points at a sequence of addresses.\n\
+Return the number of points planted." },
+  { "coverage_hits", gdbpy_coverage_hits, METH_NOARGS,
+    "coverage_hits () -> List.\n\
+Return the addresses of the coverage points hit so far." },
+  { "coverage_clear", gdbpy_coverage_clear, METH_NOARGS,
+    "coverage_clear () -> None.\n\
+Remove all coverage points, and forget their hits." },
   { "decode_line", gdbpy_decode_line, METH_VARARGS,
     "decode_line (String) -> Tuple.  Decode a string argument the way\n\
 that 'break' or 'edit' does.  Return a tuple containing two elements.\n\
@@ -47,4 +47,8 @@ int gdbpy_should_stop (struct breakpoint_object *bp_obj);
 
 int gdbpy_breakpoint_has_py_cond (struct breakpoint_object *bp_obj);
 
+int gdbpy_fast_stop (struct breakpoint_object *bp_obj, ptid_t ptid);
+
+int gdbpy_breakpoint_has_fast_stop (struct breakpoint_object *bp_obj);
+
 #endif /* GDB_PYTHON_H */
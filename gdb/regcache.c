@@ -282,6 +282,12 @@ get_regcache_aspace (const struct regcache *regcache)
   return regcache->aspace;
 }
 
+ptid_t
+regcache_get_ptid (const struct regcache *regcache)
+{
+  return regcache->ptid;
+}
+
 /* Return  a pointer to register REGNUM's buffer cache.  */
 
 static gdb_byte *
@@ -45,6 +45,10 @@ extern struct gdbarch *get_regcache_arch (const struct regcache *regcache);
 
 extern struct address_space *get_regcache_aspace (const struct regcache *);
 
+/* Return the thread REGCACHE holds the registers of.  */
+
+extern ptid_t regcache_get_ptid (const struct regcache *regcache);
+
 enum register_status
   {
     /* The register value is not in the cache, and we don't know yet
@@ -45,6 +45,7 @@
 
 #include <ctype.h>
 #include <sys/time.h>
+#include "timeval-utils.h"
 
 #include "event-loop.h"
 #include "event-top.h"
@@ -1275,6 +1276,12 @@ enum {
   PACKET_QAllow,
   PACKET_qXfer_fdpic,
   PACKET_QDisableRandomization,
+  PACKET_ConditionalBreakpoints,
+  PACKET_BreakpointCommands,
+  PACKET_vZ0,
+  PACKET_qXfer_coverage,
+  PACKET_BreakpointIgnoreCounts,
+  PACKET_qThreadRegs,
   PACKET_MAX
 };
 
@@ -3813,6 +3820,16 @@ static struct protocol_feature remote_protocol_features[] = {
     PACKET_QDisableRandomization },
   { "tracenz", PACKET_DISABLE,
     remote_string_tracing_feature, -1 },
+  { "ConditionalBreakpoints", PACKET_DISABLE, remote_supported_packet,
+    PACKET_ConditionalBreakpoints },
+  { "BreakpointCommands", PACKET_DISABLE, remote_supported_packet,
+    PACKET_BreakpointCommands },
+  { "qXfer:coverage:read", PACKET_DISABLE, remote_supported_packet,
+    PACKET_qXfer_coverage },
+  { "BreakpointIgnoreCounts", PACKET_DISABLE, remote_supported_packet,
+    PACKET_BreakpointIgnoreCounts },
+  { "qThreadRegs", PACKET_DISABLE, remote_supported_packet,
+    PACKET_qThreadRegs },
 };
 
 static char *remote_support_xml;
@@ -5774,21 +5791,23 @@ send_g_packet (void)
   return buf_len / 2;
 }
 
+/* Supply to REGCACHE the registers in BUF, a reply to a 'g'
+   packet.  */
+
 static void
-process_g_packet (struct regcache *regcache)
+process_g_packet (struct regcache *regcache, char *buf)
 {
   struct gdbarch *gdbarch = get_regcache_arch (regcache);
-  struct remote_state *rs = get_remote_state ();
   struct remote_arch_state *rsa = get_remote_arch_state ();
   int i, buf_len;
   char *p;
   char *regs;
 
-  buf_len = strlen (rs->buf);
+  buf_len = strlen (buf);
 
   /* Further sanity checks, with knowledge of the architecture.  */
   if (buf_len > 2 * rsa->sizeof_g_packet)
-    error (_("Remote 'g' packet reply is too long: %s"), rs->buf);
+    error (_("Remote 'g' packet reply is too long: %s"), buf);
 
   /* Save the size of the packet sent to us by the target.  It is used
      as a heuristic when determining the max size of packets that the
@@ -5825,7 +5844,7 @@ process_g_packet (struct regcache *regcache)
      hex characters.  Suck them all up, then supply them to the
      register cacheing/storage mechanism.  */
 
-  p = rs->buf;
+  p = buf;
   for (i = 0; i < rsa->sizeof_g_packet; i++)
     {
       if (p[0] == 0 || p[1] == 0)
@@ -5846,13 +5865,13 @@ process_g_packet (struct regcache *regcache)
 
       if (r->in_g_packet)
 	{
-	  if (r->offset * 2 >= strlen (rs->buf))
+	  if (r->offset * 2 >= strlen (buf))
 	    /* This shouldn't happen - we adjusted in_g_packet above.  */
 	    internal_error (__FILE__, __LINE__,
 			    _("unexpected end of 'g' packet reply"));
-	  else if (rs->buf[r->offset * 2] == 'x')
+	  else if (buf[r->offset * 2] == 'x')
 	    {
-	      gdb_assert (r->offset * 2 < strlen (rs->buf));
+	      gdb_assert (r->offset * 2 < strlen (buf));
 	      /* The register isn't available, mark it as such (at
 		 the same time setting the value to zero).  */
 	      regcache_raw_supply (regcache, r->regnum, NULL);
@@ -5867,8 +5886,10 @@ process_g_packet (struct regcache *regcache)
 static void
 fetch_registers_using_g (struct regcache *regcache)
 {
+  struct remote_state *rs = get_remote_state ();
+
   send_g_packet ();
-  process_g_packet (regcache);
+  process_g_packet (regcache, rs->buf);
 }
 
 /* Make the remote selected traceframe match GDB's selected
@@ -5940,6 +5961,66 @@ remote_fetch_registers (struct target_ops *ops,
 	}
 }
 
+/* Fetch the registers of several threads with qThreadRegs packets,
+   as many threads per packet as the reply can hold, instead of an Hg
+   and a 'g' packet per thread.  */
+
+static void
+remote_prefetch_registers (int count, struct regcache **regcaches)
+{
+  struct remote_state *rs = get_remote_state ();
+  struct remote_arch_state *rsa = get_remote_arch_state ();
+  char *buf_end = rs->buf + get_remote_packet_size ();
+  int per_packet, i = 0;
+
+  if (remote_protocol_packets[PACKET_qThreadRegs].support == PACKET_DISABLE
+      || get_traceframe_number () != -1)
+    return;
+
+  /* Each thread takes a 'g' reply and a separator.  */
+  per_packet = get_remote_packet_size () / (2 * rsa->sizeof_g_packet + 1);
+  if (per_packet < 1)
+    return;
+
+  while (i < count)
+    {
+      char *p = rs->buf;
+      char *reply;
+      int first = i;
+
+      p += xsnprintf (p, buf_end - p, "qThreadRegs:");
+      for (; i < count && i - first < per_packet; i++)
+	{
+	  /* Leave room for a separator and the longest thread id.  */
+	  if (i > first && p + 1 + 40 > buf_end)
+	    break;
+
+	  if (i > first)
+	    *p++ = ';';
+	  p = write_ptid (p, buf_end, regcache_get_ptid (regcaches[i]));
+	}
+
+      putpkt (rs->buf);
+      getpkt (&rs->buf, &rs->buf_size, 0);
+
+      /* On an error, leave the registers to be fetched on demand.  */
+      if (packet_ok (rs->buf, &remote_protocol_packets[PACKET_qThreadRegs])
+	  != PACKET_OK)
+	return;
+
+      for (reply = rs->buf; first < i && reply != NULL; first++)
+	{
+	  char *next = strchr (reply, ';');
+
+	  if (next != NULL)
+	    *next++ = '\0';
+	  if (reply[0] != 'E' && reply[0] != '\0')
+	    process_g_packet (regcaches[first], reply);
+	  reply = next;
+	}
+    }
+}
+
 /* Prepare to store registers.  Since we may send them all (using a
    'G' request), we have to read out the ones we don't want to change
    first.  */
@@ -6751,6 +6832,246 @@ remote_files_info (struct target_ops *ignore)
   puts_filtered ("Debugging a target over a serial line.\n");
 }
 
+/* Remote protocol statistics.  See get_remote_stats.  */
+
+static struct remote_stats remote_stats;
+
+/* The number of bytes read from the remote end so far.  */
+static ULONGEST remote_bytes_read;
+
+/* The statistics of the last packet sent, while we wait for its
+   reply, and when it was sent.  */
+static struct remote_packet_stats *remote_stats_pending;
+static struct timeval remote_stats_pending_time;
+
+/* If nonzero, reset the statistics before each command, and display
+   them after it.  */
+static int remote_stats_per_command;
+
+/* Whether remote_stats_per_command was set when the current command
+   started.  */
+static int remote_stats_command_active;
+
+/* Return the statistics entry for the packet whose CNT bytes of data
+   are in BUF, creating it if needed.  Queries and v packets are named
+   by their first word, other packets by their first letter.  */
+
+static struct remote_packet_stats *
+remote_packet_stats (const char *buf, int cnt)
+{
+  struct remote_packet_stats *ps, **link;
+  char name[sizeof (ps->name)];
+  int len = 0;
+
+  if (cnt > 0 && strchr ("qQv", buf[0]) != NULL)
+    while (len < cnt && len < sizeof (name) - 1
+	   && strchr (":;,?", buf[len]) == NULL)
+      {
+	name[len] = buf[len];
+	len++;
+      }
+  else if (cnt > 0)
+    name[len++] = buf[0];
+  name[len] = '\0';
+
+  for (link = &remote_stats.packets; *link != NULL; link = &(*link)->next)
+    if (strcmp ((*link)->name, name) == 0)
+      {
+	/* Move the entry to the front, since the same few packets
+	   tend to be sent over and over.  */
+	ps = *link;
+	*link = ps->next;
+	ps->next = remote_stats.packets;
+	remote_stats.packets = ps;
+	return ps;
+      }
+
+  ps = XZALLOC (struct remote_packet_stats);
+  strcpy (ps->name, name);
+  ps->next = remote_stats.packets;
+  remote_stats.packets = ps;
+  return ps;
+}
+
+/* Account for the reply to the pending packet, if any.  The reply
+   took LEN bytes on the wire.  */
+
+static void
+remote_stats_reply (ULONGEST len)
+{
+  struct remote_packet_stats *ps = remote_stats_pending;
+  struct timeval now, delta;
+  ULONGEST rtt;
+  int bucket;
+
+  if (ps == NULL)
+    return;
+  remote_stats_pending = NULL;
+
+  gettimeofday (&now, NULL);
+  timeval_sub (&delta, &now, &remote_stats_pending_time);
+  rtt = (ULONGEST) delta.tv_sec * 1000000 + delta.tv_usec;
+
+  ps->replies++;
+  ps->bytes_received += len;
+  ps->total_rtt += rtt;
+  if (rtt > ps->max_rtt)
+    ps->max_rtt = rtt;
+
+  for (bucket = 0; rtt >= 2 && bucket < REMOTE_STATS_RTT_BUCKETS - 1;
+       bucket++)
+    rtt >>= 1;
+  ps->rtt_histogram[bucket]++;
+}
+
+/* See remote.h.  */
+
+const struct remote_stats *
+get_remote_stats (void)
+{
+  return &remote_stats;
+}
+
+/* See remote.h.  */
+
+void
+reset_remote_stats (void)
+{
+  struct remote_packet_stats *ps, *next;
+
+  for (ps = remote_stats.packets; ps != NULL; ps = next)
+    {
+      next = ps->next;
+      xfree (ps);
+    }
+
+  memset (&remote_stats, 0, sizeof (remote_stats));
+  remote_stats_pending = NULL;
+}
+
+/* Print the RTT histogram of PS.  */
+
+static void
+print_remote_rtt_histogram (const struct remote_packet_stats *ps)
+{
+  int i;
+
+  for (i = 0; i < REMOTE_STATS_RTT_BUCKETS; i++)
+    {
+      if (ps->rtt_histogram[i] == 0)
+	continue;
+
+      if (i == 0)
+	printf_filtered ("    < 2us");
+      else if (i == REMOTE_STATS_RTT_BUCKETS - 1)
+	printf_filtered ("    >= %luus", 1UL << i);
+      else
+	printf_filtered ("    [%lu, %lu)us", 1UL << i, 1UL << (i + 1));
+      printf_filtered (": %s\n", pulongest (ps->rtt_histogram[i]));
+    }
+}
+
+/* qsort comparison function to sort remote_packet_stats pointers by
+   decreasing count.  */
+
+static int
+compare_remote_packet_stats (const void *ap, const void *bp)
+{
+  const struct remote_packet_stats *a
+    = *(const struct remote_packet_stats **) ap;
+  const struct remote_packet_stats *b
+    = *(const struct remote_packet_stats **) bp;
+
+  if (a->count != b->count)
+    return a->count > b->count ? -1 : 1;
+  return strcmp (a->name, b->name);
+}
+
+/* Print the remote protocol statistics, the most frequently sent
+   packets first.  */
+
+static void
+print_remote_stats (void)
+{
+  struct remote_packet_stats *ps, **sorted;
+  ULONGEST count = 0, sent = 0, received = 0;
+  struct cleanup *cleanup;
+  int i, n = 0;
+
+  for (ps = remote_stats.packets; ps != NULL; ps = ps->next)
+    {
+      count += ps->count;
+      sent += ps->bytes_sent;
+      received += ps->bytes_received;
+      n++;
+    }
+
+  printf_filtered (_("Packets sent: %s, bytes sent: %s, "
+		     "reply bytes: %s\n"),
+		   pulongest (count), pulongest (sent),
+		   pulongest (received));
+  printf_filtered (_("Naks received: %s, naks sent: %s, "
+		     "timeouts: %s, bad frames: %s, notifications: %s\n"),
+		   pulongest (remote_stats.naks_received),
+		   pulongest (remote_stats.naks_sent),
+		   pulongest (remote_stats.timeouts),
+		   pulongest (remote_stats.bad_frames),
+		   pulongest (remote_stats.notifications));
+
+  if (n == 0)
+    return;
+
+  sorted = xmalloc (n * sizeof (sorted[0]));
+  cleanup = make_cleanup (xfree, sorted);
+  for (i = 0, ps = remote_stats.packets; ps != NULL; ps = ps->next)
+    sorted[i++] = ps;
+  qsort (sorted, n, sizeof (sorted[0]), compare_remote_packet_stats);
+
+  printf_filtered ("\n%-20s %8s %10s %10s %8s %8s %10s %10s\n",
+		   "Packet", "Count", "Sent", "Received", "Replies",
+		   "Resent", "Avg RTT", "Max RTT");
+  for (i = 0; i < n; i++)
+    {
+      ps = sorted[i];
+      printf_filtered ("%-20s %8s %10s %10s %8s %8s %8sus %8sus\n",
+		       ps->name[0] != '\0' ? ps->name : "(empty)",
+		       pulongest (ps->count), pulongest (ps->bytes_sent),
+		       pulongest (ps->bytes_received),
+		       pulongest (ps->replies), pulongest (ps->retransmits),
+		       pulongest (ps->replies
+				  ? ps->total_rtt / ps->replies : 0),
+		       pulongest (ps->max_rtt));
+      print_remote_rtt_histogram (ps);
+    }
+
+  do_cleanups (cleanup);
+}
+
+static void
+maintenance_info_remote_stats (char *args, int from_tty)
+{
+  print_remote_stats ();
+}
+
+/* See remote.h.  */
+
+void
+remote_stats_command_start (void)
+{
+  remote_stats_command_active = remote_stats_per_command;
+  if (remote_stats_command_active)
+    reset_remote_stats ();
+}
+
+/* See remote.h.  */
+
+void
+remote_stats_command_end (void)
+{
+  if (remote_stats_command_active && remote_stats.packets != NULL)
+    print_remote_stats ();
+}
+
 /* Stuff for dealing with the packets which are part of this protocol.
    See comment at top of file for details.  */
 
@@ -6764,7 +7085,10 @@ readchar (int timeout)
   ch = serial_readchar (remote_desc, timeout);
 
   if (ch >= 0)
-    return ch;
+    {
+      remote_bytes_read++;
+      return ch;
+    }
 
   switch ((enum serial_rc) ch)
     {
@@ -6854,6 +7178,7 @@ putpkt_binary (char *buf, int cnt)
   int ch;
   int tcount = 0;
   char *p;
+  struct remote_packet_stats *stats;
 
   /* Catch cases like trying to read memory or listing threads while
      we're waiting for a stop reply.  The remote server wouldn't be
@@ -6884,6 +7209,11 @@ putpkt_binary (char *buf, int cnt)
   *p++ = tohex ((csum >> 4) & 0xf);
   *p++ = tohex (csum & 0xf);
 
+  stats = remote_packet_stats (buf, cnt);
+  stats->count++;
+  remote_stats_pending = stats;
+  gettimeofday (&remote_stats_pending_time, NULL);
+
   /* Send it over and over until we get a positive ack.  */
 
   while (1)
@@ -6904,6 +7234,7 @@ putpkt_binary (char *buf, int cnt)
 	}
       if (serial_write (remote_desc, buf2, p - buf2))
 	perror_with_name (_("putpkt: write failed"));
+      stats->bytes_sent += p - buf2;
 
       /* If this is a no acks version of the remote protocol, send the
 	 packet and move on.  */
@@ -6942,11 +7273,15 @@ putpkt_binary (char *buf, int cnt)
 	    case '-':
 	      if (remote_debug)
 		fprintf_unfiltered (gdb_stdlog, "Nak\n");
+	      remote_stats.naks_received++;
 	      /* FALLTHROUGH */
 	    case SERIAL_TIMEOUT:
+	      if (ch == SERIAL_TIMEOUT)
+		remote_stats.timeouts++;
 	      tcount++;
 	      if (tcount > 3)
 		return 0;
+	      stats->retransmits++;
 	      break;		/* Retransmit buffer.  */
 	    case '$':
 	      {
@@ -6985,6 +7320,7 @@ putpkt_binary (char *buf, int cnt)
 					    str);
 			do_cleanups (old_chain);
 		      }
+		    remote_stats.notifications++;
 		    handle_notification (rs->buf, val);
 		    /* We're in sync now, rewait for the ack.  */
 		    tcount = 0;
@@ -7247,6 +7583,7 @@ getpkt_or_notif_sane_1 (char **buf, long *sizeof_buf, int forever,
   int tries;
   int timeout;
   int val = -1;
+  ULONGEST frame_start = 0;
 
   /* We're reading a new response.  Make sure we don't look at a
      previously cached response.  */
@@ -7291,6 +7628,8 @@ getpkt_or_notif_sane_1 (char **buf, long *sizeof_buf, int forever,
 		return -1; /* Don't complain, it's normal to not get
 			      anything in this case.  */
 
+	      remote_stats.timeouts++;
+
 	      if (forever)	/* Watchdog went off?  Kill the target.  */
 		{
 		  QUIT;
@@ -7304,12 +7643,15 @@ getpkt_or_notif_sane_1 (char **buf, long *sizeof_buf, int forever,
 	    {
 	      /* We've found the start of a packet or notification.
 		 Now collect the data.  */
+	      frame_start = remote_bytes_read - 1;
 	      val = read_frame (buf, sizeof_buf);
 	      if (val >= 0)
 		break;
+	      remote_stats.bad_frames++;
 	    }
 
 	  serial_write (remote_desc, "-", 1);
+	  remote_stats.naks_sent++;
 	}
 
       if (tries > MAX_TRIES)
@@ -7338,6 +7680,8 @@ getpkt_or_notif_sane_1 (char **buf, long *sizeof_buf, int forever,
 	     do_cleanups (old_chain);
 	    }
 
+	  remote_stats_reply (remote_bytes_read - frame_start);
+
 	  /* Skip the ack char if we're in no-ack mode.  */
 	  if (!rs->noack_mode)
 	    serial_write (remote_desc, "+", 1);
@@ -7363,6 +7707,7 @@ getpkt_or_notif_sane_1 (char **buf, long *sizeof_buf, int forever,
 	      do_cleanups (old_chain);
 	    }
 
+	  remote_stats.notifications++;
 	  handle_notification (*buf, val);
 
 	  /* Notifications require no acknowledgement.  */
@@ -7690,6 +8035,130 @@ extended_remote_create_inferior (struct target_ops *ops,
 }
 
 
+static int
+remote_supports_cond_breakpoints (void)
+{
+  return (remote_protocol_packets[PACKET_ConditionalBreakpoints].support
+	  == PACKET_ENABLE);
+}
+
+static int
+remote_can_run_breakpoint_commands (void)
+{
+  return (remote_protocol_packets[PACKET_BreakpointCommands].support
+	  == PACKET_ENABLE);
+}
+
+static int
+remote_can_ignore_breakpoint_hits (void)
+{
+  return (remote_protocol_packets[PACKET_BreakpointIgnoreCounts].support
+	  == PACKET_ENABLE);
+}
+
+/* Ask the stub how many hits of the breakpoint BP_TGT it skipped
+   because of the ignore count sent along with its Z0 packet, with a
+   qIgnoredHits packet.  The stub reports all further hits.  */
+
+static int
+remote_breakpoint_ignored_hits (struct gdbarch *gdbarch,
+				struct bp_target_info *bp_tgt)
+{
+  struct remote_state *rs = get_remote_state ();
+  ULONGEST hits;
+  char *p;
+
+  if (!remote_can_ignore_breakpoint_hits ())
+    return -1;
+
+  p = rs->buf;
+  p += sprintf (p, "qIgnoredHits:");
+  hexnumstr (p, (ULONGEST) remote_address_masked (bp_tgt->placed_address));
+  putpkt (rs->buf);
+  getpkt (&rs->buf, &rs->buf_size, 0);
+
+  if (rs->buf[0] == '\0' || rs->buf[0] == 'E')
+    return -1;
+
+  unpack_varlen_hex (rs->buf, &hits);
+  return hits;
+}
+
+/* Append the target-side conditions of the breakpoint described by
+   BP_TGT, if any, to the Z0 packet being built at BUF.  BUF_END is
+   the end of the packet buffer; if the conditions don't all fit,
+   none are sent, GDB evaluates them itself, and zero is returned.  */
+
+static int
+remote_add_target_side_condition (struct gdbarch *gdbarch,
+				  struct bp_target_info *bp_tgt,
+				  char *buf, char *buf_end)
+{
+  struct agent_expr *aexpr;
+  char *p = buf;
+  int ix;
+
+  for (ix = 0;
+       VEC_iterate (agent_expr_p, bp_tgt->conditions, ix, aexpr);
+       ix++)
+    {
+      char len[20];
+      int len_size = sprintf (len, "%X", aexpr->len);
+
+      /* ";X<len>," plus the expression and the terminating NUL.  */
+      if (buf_end - p < 3 + len_size + aexpr->len * 2 + 1)
+	{
+	  *buf = '\0';
+	  return 0;
+	}
+
+      p += sprintf (p, ";X%s,", len);
+      bin2hex (aexpr->buf, p, aexpr->len);
+      p += aexpr->len * 2;
+      *p = '\0';
+    }
+
+  return 1;
+}
+
+/* Append the target-side commands of the breakpoint described by
+   BP_TGT to the Z0 packet being built at BUF, as the conditions
+   were.  If they don't all fit, none are sent, and BP_TGT's command
+   list is emptied to tell the caller that GDB must run them.  */
+
+static void
+remote_add_target_side_commands (struct gdbarch *gdbarch,
+				 struct bp_target_info *bp_tgt,
+				 char *buf, char *buf_end)
+{
+  struct agent_expr *aexpr;
+  char *p = buf;
+  int ix;
+
+  for (ix = 0;
+       VEC_iterate (agent_expr_p, bp_tgt->tcommands, ix, aexpr);
+       ix++)
+    {
+      char len[20];
+      int len_size = sprintf (len, "%X", aexpr->len);
+
+      /* ";cmds:0,X<len>," plus the expression and the terminating
+	 NUL.  */
+      if (buf_end - p < 10 + len_size + aexpr->len * 2 + 1)
+	{
+	  *buf = '\0';
+	  VEC_free (agent_expr_p, bp_tgt->tcommands);
+	  return;
+	}
+
+      /* GDB doesn't ask for commands to outlive the connection.  */
+      p += sprintf (p, ";cmds:0,X%s,", len);
+      bin2hex (aexpr->buf, p, aexpr->len);
+      p += aexpr->len * 2;
+      *p = '\0';
+    }
+}
+
 /* Insert a breakpoint.  On targets that have software breakpoint
    support, we ask the remote target to do the work; on targets
    which don't, we insert a traditional memory breakpoint.  */
@@ -7709,6 +8178,7 @@ remote_insert_breakpoint (struct gdbarch *gdbarch,
       struct remote_state *rs;
       char *p;
       int bpsize;
+      int conds_sent;
 
       gdbarch_remote_breakpoint_from_pc (gdbarch, &addr, &bpsize);
 
@@ -7720,7 +8190,37 @@ remote_insert_breakpoint (struct gdbarch *gdbarch,
       *(p++) = ',';
       addr = (ULONGEST) remote_address_masked (addr);
       p += hexnumstr (p, addr);
-      sprintf (p, ",%d", bpsize);
+      p += sprintf (p, ",%d", bpsize);
+
+      conds_sent = VEC_empty (agent_expr_p, bp_tgt->conditions);
+      if (remote_supports_cond_breakpoints ())
+	conds_sent
+	  = remote_add_target_side_condition (gdbarch, bp_tgt, p,
+					      rs->buf
+					      + get_remote_packet_size ());
+
+      /* The target runs the commands whenever it reports a hit to
+	 itself, so they can only go along with the conditions.  */
+      if (conds_sent && remote_can_run_breakpoint_commands ())
+	{
+	  p += strlen (p);
+	  remote_add_target_side_commands (gdbarch, bp_tgt, p,
+					   rs->buf
+					   + get_remote_packet_size ());
+	}
+      else
+	VEC_free (agent_expr_p, bp_tgt->tcommands);
+
+      /* The stub skips the hits it would otherwise report, so the
+	 ignore count needs the conditions too.  */
+      p += strlen (p);
+      if (bp_tgt->ignore_count > 0
+	  && conds_sent
+	  && remote_can_ignore_breakpoint_hits ()
+	  && p + 8 + 8 + 1 <= rs->buf + get_remote_packet_size ())
+	p += sprintf (p, ";ignore:%x", bp_tgt->ignore_count);
+      else
+	bp_tgt->ignore_count = 0;
 
       putpkt (rs->buf);
       getpkt (&rs->buf, &rs->buf_size, 0);
@@ -7738,6 +8238,9 @@ remote_insert_breakpoint (struct gdbarch *gdbarch,
 	}
     }
 
+  /* A memory breakpoint can't run commands, or skip hits.  */
+  VEC_free (agent_expr_p, bp_tgt->tcommands);
+  bp_tgt->ignore_count = 0;
   return memory_insert_breakpoint (gdbarch, bp_tgt);
 }
 
@@ -7769,6 +8272,225 @@ remote_remove_breakpoint (struct gdbarch *gdbarch,
   return memory_remove_breakpoint (gdbarch, bp_tgt);
 }
 
+/* Insert or remove (according to INSERT) the COUNT software
+   breakpoints whose indexes in BP_TGTS are listed in ITEMS, with as
+   few vZ0 or vz0 packets as fit in the packet size:
+
+     vZ0:ADDR,KIND[;ADDR,KIND]...
+
+   The stub replies with one character per breakpoint, '0' if it was
+   inserted (or removed) and '1' if not.  Returns the number of
+   breakpoints handled before finding out that the stub doesn't
+   support the packet, or COUNT.  */
+
+static int
+remote_breakpoints_packet (struct gdbarch *gdbarch, int count, int *items,
+			   struct bp_target_info **bp_tgts, int *results,
+			   int insert)
+{
+  struct remote_state *rs = get_remote_state ();
+  char *buf_end = rs->buf + get_remote_packet_size ();
+  int i = 0;
+
+  while (i < count)
+    {
+      char *p = rs->buf;
+      int first = i;
+
+      p += sprintf (p, insert ? "vZ0:" : "vz0:");
+      for (; i < count; i++)
+	{
+	  struct bp_target_info *bp_tgt = bp_tgts[items[i]];
+	  CORE_ADDR addr = bp_tgt->placed_address;
+	  int bpsize = bp_tgt->placed_size;
+	  char item[64];
+	  int len;
+
+	  if (insert)
+	    gdbarch_remote_breakpoint_from_pc (gdbarch, &addr, &bpsize);
+	  addr = (ULONGEST) remote_address_masked (addr);
+
+	  len = hexnumstr (item, addr);
+	  len += sprintf (item + len, ",%d", bpsize);
+	  if (i > first && p + 1 + len + 1 > buf_end)
+	    break;
+
+	  if (i > first)
+	    *p++ = ';';
+	  strcpy (p, item);
+	  p += len;
+
+	  if (insert)
+	    {
+	      /* The caller retries the ones that fail from scratch.  */
+	      bp_tgt->placed_address = addr;
+	      bp_tgt->placed_size = bpsize;
+	    }
+	}
+
+      putpkt (rs->buf);
+      getpkt (&rs->buf, &rs->buf_size, 0);
+
+      switch (packet_ok (rs->buf, &remote_protocol_packets[PACKET_vZ0]))
+	{
+	case PACKET_UNKNOWN:
+	  return first;
+	case PACKET_ERROR:
+	  for (; first < i; first++)
+	    results[items[first]] = 1;
+	  break;
+	case PACKET_OK:
+	  if (strlen (rs->buf) != i - first)
+	    {
+	      warning (_("Remote failure reply: %s"), rs->buf);
+	      for (; first < i; first++)
+		results[items[first]] = 1;
+	    }
+	  else
+	    for (p = rs->buf; first < i; first++, p++)
+	      results[items[first]] = (*p != '0');
+	  break;
+	}
+    }
+
+  return count;
+}
+
+/* Insert or remove several software breakpoints at once, with the
+   vZ0 and vz0 packets if the stub supports them.  Breakpoints with
+   conditions or commands for the target go in their own Z0
+   packets.  */
+
+static void
+remote_breakpoints (struct gdbarch *gdbarch, int count,
+		    struct bp_target_info **bp_tgts, int *results,
+		    int insert)
+{
+  int *items;
+  int nitems = 0;
+  int i, done;
+  struct cleanup *old_chain;
+
+  items = xmalloc (count * sizeof (int));
+  old_chain = make_cleanup (xfree, items);
+
+  for (i = 0; i < count; i++)
+    {
+      struct bp_target_info *bp_tgt = bp_tgts[i];
+
+      if (remote_protocol_packets[PACKET_Z0].support == PACKET_DISABLE
+	  || remote_protocol_packets[PACKET_vZ0].support == PACKET_DISABLE
+	  || (insert
+	      && (!VEC_empty (agent_expr_p, bp_tgt->conditions)
+		  || !VEC_empty (agent_expr_p, bp_tgt->tcommands))))
+	results[i] = (insert
+		      ? remote_insert_breakpoint (gdbarch, bp_tgt)
+		      : remote_remove_breakpoint (gdbarch, bp_tgt));
+      else
+	items[nitems++] = i;
+    }
+
+  done = remote_breakpoints_packet (gdbarch, nitems, items,
+				    bp_tgts, results, insert);
+
+  for (i = done; i < nitems; i++)
+    results[items[i]] = (insert
+			 ? remote_insert_breakpoint (gdbarch, bp_tgts[items[i]])
+			 : remote_remove_breakpoint (gdbarch,
+						     bp_tgts[items[i]]));
+
+  do_cleanups (old_chain);
+}
+
+static void
+remote_insert_breakpoints (struct gdbarch *gdbarch, int count,
+			   struct bp_target_info **bp_tgts, int *results)
+{
+  remote_breakpoints (gdbarch, count, bp_tgts, results, 1);
+}
+
+static void
+remote_remove_breakpoints (struct gdbarch *gdbarch, int count,
+			   struct bp_target_info **bp_tgts, int *results)
+{
+  remote_breakpoints (gdbarch, count, bp_tgts, results, 0);
+}
+
+/* Complain unless the stub can plant coverage points.  The vCoverage
+   packets go along with qXfer:coverage:read, which the stub reports
+   in its qSupported reply.  */
+
+static void
+remote_check_coverage_points (void)
+{
+  if (remote_protocol_packets[PACKET_qXfer_coverage].support != PACKET_ENABLE)
+    error (_("Remote target does not support coverage points."));
+}
+
+/* Plant coverage points with vCoverage:insert packets, as many points
+   per packet as fit.  */
+
+static void
+remote_insert_coverage_points (int count, const CORE_ADDR *addrs,
+			       int *results)
+{
+  struct remote_state *rs = get_remote_state ();
+  char *buf_end = rs->buf + get_remote_packet_size ();
+  int i = 0;
+
+  remote_check_coverage_points ();
+
+  while (i < count)
+    {
+      char *p = rs->buf;
+      int first = i;
+
+      p += sprintf (p, "vCoverage:insert:");
+      for (; i < count; i++)
+	{
+	  char item[64];
+	  int len;
+
+	  len = hexnumstr (item, (ULONGEST) remote_address_masked (addrs[i]));
+	  if (i > first && p + 1 + len + 1 > buf_end)
+	    break;
+
+	  if (i > first)
+	    *p++ = ';';
+	  strcpy (p, item);
+	  p += len;
+	}
+
+      putpkt (rs->buf);
+      getpkt (&rs->buf, &rs->buf_size, 0);
+
+      if (rs->buf[0] == '\0')
+	error (_("Remote target does not support coverage points."));
+      else if (rs->buf[0] == 'E' || strlen (rs->buf) != i - first)
+	{
+	  warning (_("Remote failure reply: %s"), rs->buf);
+	  for (; first < i; first++)
+	    results[first] = 1;
+	}
+      else
+	for (p = rs->buf; first < i; first++, p++)
+	  results[first] = (*p != '0');
+    }
+}
+
+static void
+remote_clear_coverage_points (void)
+{
+  struct remote_state *rs = get_remote_state ();
+
+  remote_check_coverage_points ();
+
+  putpkt ("vCoverage:clear");
+  getpkt (&rs->buf, &rs->buf_size, 0);
+  if (strcmp (rs->buf, "OK") != 0)
+    error (_("Remote failure reply: %s"), rs->buf);
+}
+
 static int
 watchpoint_to_Z_packet (int type)
 {
@@ -8404,6 +9126,12 @@ remote_xfer_partial (struct target_ops *ops, enum target_object object,
     case TARGET_OBJECT_FDPIC:
       return remote_read_qxfer (ops, "fdpic", annex, readbuf, offset, len,
 				&remote_protocol_packets[PACKET_qXfer_fdpic]);
+
+    case TARGET_OBJECT_COVERAGE:
+      gdb_assert (annex == NULL);
+      return remote_read_qxfer
+	(ops, "coverage", annex, readbuf, offset, len,
+	 &remote_protocol_packets[PACKET_qXfer_coverage]);
     default:
       return -1;
     }
@@ -10625,10 +11353,13 @@ Specify the serial device it is connected to\n\
   remote_ops.to_fetch_registers = remote_fetch_registers;
   remote_ops.to_store_registers = remote_store_registers;
   remote_ops.to_prepare_to_store = remote_prepare_to_store;
+  remote_ops.to_prefetch_registers = remote_prefetch_registers;
   remote_ops.deprecated_xfer_memory = remote_xfer_memory;
   remote_ops.to_files_info = remote_files_info;
   remote_ops.to_insert_breakpoint = remote_insert_breakpoint;
   remote_ops.to_remove_breakpoint = remote_remove_breakpoint;
+  remote_ops.to_insert_breakpoints = remote_insert_breakpoints;
+  remote_ops.to_remove_breakpoints = remote_remove_breakpoints;
   remote_ops.to_stopped_by_watchpoint = remote_stopped_by_watchpoint;
   remote_ops.to_stopped_data_address = remote_stopped_data_address;
   remote_ops.to_can_use_hw_breakpoint = remote_check_watch_resources;
@@ -10677,6 +11408,13 @@ Specify the serial device it is connected to\n\
     = remote_supports_disable_randomization;
   remote_ops.to_supports_enable_disable_tracepoint = remote_supports_enable_disable_tracepoint;
   remote_ops.to_supports_string_tracing = remote_supports_string_tracing;
+  remote_ops.to_supports_evaluation_of_breakpoint_conditions
+    = remote_supports_cond_breakpoints;
+  remote_ops.to_can_run_breakpoint_commands
+    = remote_can_run_breakpoint_commands;
+  remote_ops.to_can_ignore_breakpoint_hits
+    = remote_can_ignore_breakpoint_hits;
+  remote_ops.to_breakpoint_ignored_hits = remote_breakpoint_ignored_hits;
   remote_ops.to_trace_init = remote_trace_init;
   remote_ops.to_download_tracepoint = remote_download_tracepoint;
   remote_ops.to_can_download_tracepoint = remote_can_download_tracepoint;
@@ -10710,6 +11448,8 @@ Specify the serial device it is connected to\n\
   remote_ops.to_static_tracepoint_markers_by_strid
     = remote_static_tracepoint_markers_by_strid;
   remote_ops.to_traceframe_info = remote_traceframe_info;
+  remote_ops.to_insert_coverage_points = remote_insert_coverage_points;
+  remote_ops.to_clear_coverage_points = remote_clear_coverage_points;
 }
 
 /* Set up the extended remote vector by making a copy of the standard
@@ -10968,6 +11708,24 @@ response packet.  GDB supplies the initial `$' character, and the\n\
 terminating `#' character and checksum."),
 	   &maintenancelist);
 
+  add_cmd ("remote-stats", class_maintenance, maintenance_info_remote_stats,
+	   _("\
+Display remote protocol statistics.\n\
+For each type of packet sent to the remote target, show how many were\n\
+sent and resent, how many bytes they and their replies took, and a\n\
+histogram of the time it took to get a reply."),
+	   &maintenanceinfolist);
+
+  add_setshow_boolean_cmd ("remote-stats-per-command", class_maintenance,
+			   &remote_stats_per_command, _("\
+Set whether to display remote protocol statistics for each command."), _("\
+Show whether to display remote protocol statistics for each command."), _("\
+If set, remote protocol statistics are reset before each command, and\n\
+displayed after it, as with \"maintenance info remote-stats\"."),
+			   NULL, NULL,
+			   &maintenance_set_cmdlist,
+			   &maintenance_show_cmdlist);
+
   add_setshow_boolean_cmd ("remotebreak", no_class, &remote_break, _("\
 Set whether to send break if interrupted."), _("\
 Show whether to send break if interrupted."), _("\
@@ -11215,6 +11973,27 @@ Show the maximum size of the address (in bits) in a memory packet."), NULL,
   add_packet_config_cmd (&remote_protocol_packets[PACKET_QDisableRandomization],
 			 "QDisableRandomization", "disable-randomization", 0);
 
+  add_packet_config_cmd (&remote_protocol_packets[PACKET_ConditionalBreakpoints],
+			 "ConditionalBreakpoints",
+			 "conditional-breakpoints", 0);
+
+  add_packet_config_cmd (&remote_protocol_packets[PACKET_BreakpointCommands],
+			 "BreakpointCommands",
+			 "breakpoint-commands", 0);
+
+  add_packet_config_cmd (&remote_protocol_packets[PACKET_vZ0],
+			 "vZ0", "multi-breakpoint", 0);
+
+  add_packet_config_cmd (&remote_protocol_packets[PACKET_qXfer_coverage],
+			 "qXfer:coverage:read", "read-coverage-hits", 0);
+
+  add_packet_config_cmd (&remote_protocol_packets[PACKET_BreakpointIgnoreCounts],
+			 "BreakpointIgnoreCounts",
+			 "breakpoint-ignore-counts", 0);
+
+  add_packet_config_cmd (&remote_protocol_packets[PACKET_qThreadRegs],
+			 "qThreadRegs", "thread-registers", 0);
+
   /* Keep the old ``set remote Z-packet ...'' working.  Each individual
      Z sub-packet has its own set and show commands, but users may
      have sets to this variable in their .gdbinit files (or in their
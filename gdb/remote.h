@@ -59,4 +59,72 @@ extern int remote_register_number_and_offset (struct gdbarch *gdbarch,
 					      int regnum, int *pnum,
 					      int *poffset);
 
+/* The number of buckets of the round-trip time histograms in struct
+   remote_packet_stats.  Bucket 0 counts times under 2 microseconds,
+   bucket N > 0 times in [2^N, 2^(N+1)) microseconds, and the last
+   bucket all longer times.  */
+#define REMOTE_STATS_RTT_BUCKETS 24
+
+/* Statistics about one type of packet GDB sent to the remote
+   target.  */
+
+struct remote_packet_stats
+{
+  struct remote_packet_stats *next;
+
+  /* The packet name.  Queries and v packets are named by their first
+     word ("qXfer", "vCont"), other packets by their first letter.  */
+  char name[32];
+
+  /* How many of these packets were sent, and how many of them had to
+     be sent again because the target sent a nak or didn't answer.  */
+  ULONGEST count;
+  ULONGEST retransmits;
+
+  /* The bytes these packets, including retransmissions, and their
+     replies took on the wire.  */
+  ULONGEST bytes_sent;
+  ULONGEST bytes_received;
+
+  /* How many of these packets got a reply, and how long it took, in
+     microseconds.  */
+  ULONGEST replies;
+  ULONGEST total_rtt;
+  ULONGEST max_rtt;
+  ULONGEST rtt_histogram[REMOTE_STATS_RTT_BUCKETS];
+};
+
+/* Remote protocol statistics, accumulated over all connections since
+   GDB started or the statistics were last reset.  */
+
+struct remote_stats
+{
+  /* Per-packet statistics, most recently sent first.  */
+  struct remote_packet_stats *packets;
+
+  /* Naks received from and sent to the target, timeouts waiting for
+     the target, and packets received with errors.  */
+  ULONGEST naks_received;
+  ULONGEST naks_sent;
+  ULONGEST timeouts;
+  ULONGEST bad_frames;
+
+  /* Notifications received from the target.  */
+  ULONGEST notifications;
+};
+
+/* Return the remote protocol statistics.  */
+
+extern const struct remote_stats *get_remote_stats (void);
+
+/* Reset the remote protocol statistics.  */
+
+extern void reset_remote_stats (void);
+
+/* Called before and after each command, to implement "maint set
+   remote-stats-per-command".  */
+
+extern void remote_stats_command_start (void);
+extern void remote_stats_command_end (void);
+
 #endif
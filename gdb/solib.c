@@ -892,6 +892,16 @@ solib_add (char *pattern, int from_tty,
     int loaded_any_symbols = 0;
     const int flags =
         SYMFILE_DEFER_BP_RESET | (from_tty ? SYMFILE_VERBOSE : 0);
+    /* The objfiles of the libraries whose symbols get loaded, or NULL
+       if reading some failed.  */
+    struct objfile **new_objfiles;
+    int new_count = 0, so_count = 0;
+    struct cleanup *old_chain;
+
+    for (gdb = so_list_head; gdb; gdb = gdb->next)
+      so_count++;
+    new_objfiles = xmalloc ((so_count + 1) * sizeof (struct objfile *));
+    old_chain = make_cleanup (free_current_contents, &new_objfiles);
 
     for (gdb = so_list_head; gdb; gdb = gdb->next)
       if (! pattern || re_exec (gdb->so_name))
@@ -916,12 +926,29 @@ solib_add (char *pattern, int from_tty,
 				       gdb->so_name);
 		}
 	      else if (solib_read_symbols (gdb, flags))
-		loaded_any_symbols = 1;
+		{
+		  loaded_any_symbols = 1;
+		  if (gdb->symbols_loaded && gdb->objfile != NULL)
+		    {
+		      if (new_objfiles != NULL)
+			new_objfiles[new_count++] = gdb->objfile;
+		    }
+		  else
+		    {
+		      xfree (new_objfiles);
+		      new_objfiles = NULL;
+		    }
+		}
 	    }
 	}
 
-    if (loaded_any_symbols)
+    /* Only the breakpoints that may be in the new libraries need
+       re-setting, unless we don't know what those are.  */
+    if (loaded_any_symbols && new_objfiles != NULL)
+      breakpoint_re_set_objfiles (new_objfiles, new_count);
+    else if (loaded_any_symbols)
       breakpoint_re_set ();
+    do_cleanups (old_chain);
 
     if (from_tty && pattern && ! any_matches)
       printf_unfiltered
@@ -0,0 +1,252 @@
+/* Counters of GDB's work, and of where its time goes.
+
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+/* The counters are bumped where the work is done, and are cheap
+   enough to always be on.  The wall time of GDB is split between a
+   few parts, by switching the timer being charged as GDB enters and
+   leaves them.  Parts that can throw are left by a cleanup, so that
+   an error thrown out of one goes back to the part that called it.
+   The timer is also set back to STATS_TIME_GDB at the start of each
+   top-level command.  */
+
+#include "defs.h"
+#include "stats.h"
+#include "gdbcmd.h"
+#include "gdb_string.h"
+#include "gdb_assert.h"
+#include <sys/time.h>
+
+struct gdb_stats gdb_stats;
+
+/* The timer being charged, and when it last changed.  */
+
+static enum stats_timer current_timer;
+static ULONGEST current_timer_start;
+
+static const char *const stats_counter_names[NR_STATS_COUNTERS] =
+{
+  "target_xfers",
+  "target_xfer_bytes",
+  "register_fetches",
+  "symtab_expansions",
+  "frame_unwinds",
+  "commands"
+};
+
+static const char *const stats_timer_names[NR_STATS_TIMERS] =
+{
+  "gdb",
+  "python",
+  "symtab",
+  "target"
+};
+
+/* Return the wall clock, in microseconds.  */
+
+static ULONGEST
+stats_now (void)
+{
+  struct timeval tv;
+
+  gettimeofday (&tv, NULL);
+  return (ULONGEST) tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+/* Charge the time since the last switch to the current timer, and
+   make NEXT the current timer.  */
+
+static void
+stats_switch_timer (enum stats_timer next)
+{
+  ULONGEST now = stats_now ();
+
+  /* The clock may not have been read yet, or have been set back.  */
+  if (current_timer_start != 0 && now > current_timer_start)
+    gdb_stats.timers[current_timer] += now - current_timer_start;
+  current_timer_start = now;
+  current_timer = next;
+}
+
+/* See stats.h.  */
+
+enum stats_timer
+stats_timer_enter (enum stats_timer timer)
+{
+  enum stats_timer previous = current_timer;
+
+  stats_switch_timer (timer);
+  return previous;
+}
+
+/* See stats.h.  */
+
+void
+stats_timer_leave (enum stats_timer previous)
+{
+  stats_switch_timer (previous);
+}
+
+/* The cleanup of make_cleanup_stats_timer.  */
+
+static void
+do_stats_timer_leave (void *previous)
+{
+  stats_timer_leave ((enum stats_timer) (uintptr_t) previous);
+}
+
+/* See stats.h.  */
+
+struct cleanup *
+make_cleanup_stats_timer (enum stats_timer timer)
+{
+  enum stats_timer previous = stats_timer_enter (timer);
+
+  return make_cleanup (do_stats_timer_leave, (void *) (uintptr_t) previous);
+}
+
+/* See stats.h.  */
+
+void
+stats_command_start (void)
+{
+  stats_switch_timer (STATS_TIME_GDB);
+}
+
+/* See stats.h.  */
+
+void
+stats_command_end (ULONGEST cpu_usec, ULONGEST wall_usec)
+{
+  stats_count (STATS_COMMANDS, 1);
+  gdb_stats.last_command_cpu = cpu_usec;
+  gdb_stats.last_command_wall = wall_usec;
+  gdb_stats.command_cpu += cpu_usec;
+  gdb_stats.command_wall += wall_usec;
+}
+
+/* See stats.h.  */
+
+void
+get_stats (struct gdb_stats *stats)
+{
+  stats_switch_timer (current_timer);
+  *stats = gdb_stats;
+}
+
+/* See stats.h.  */
+
+void
+reset_stats (void)
+{
+  memset (&gdb_stats, 0, sizeof (gdb_stats));
+  current_timer_start = stats_now ();
+}
+
+/* See stats.h.  */
+
+const char *
+stats_counter_name (enum stats_counter counter)
+{
+  gdb_assert (counter >= 0 && counter < NR_STATS_COUNTERS);
+  return stats_counter_names[counter];
+}
+
+/* See stats.h.  */
+
+const char *
+stats_timer_name (enum stats_timer timer)
+{
+  gdb_assert (timer >= 0 && timer < NR_STATS_TIMERS);
+  return stats_timer_names[timer];
+}
+
+/* Return NOW less START, or NOW if the statistics were reset since
+   START was taken.  */
+
+static ULONGEST
+stats_delta (ULONGEST now, const ULONGEST *start)
+{
+  if (start == NULL || now < *start)
+    return now;
+  return now - *start;
+}
+
+/* See stats.h.  */
+
+void
+print_stats (const char *what, const struct gdb_stats *stats,
+	     const struct gdb_stats *start)
+{
+  int i;
+
+  printf_unfiltered (_("%s counters:"), what);
+  for (i = 0; i < NR_STATS_COUNTERS; i++)
+    printf_unfiltered ("%s %s %s", i > 0 ? "," : "", stats_counter_names[i],
+		       pulongest (stats_delta (stats->counters[i],
+					       start ? &start->counters[i]
+					       : NULL)));
+  printf_unfiltered ("\n");
+
+  printf_unfiltered (_("%s wall time:"), what);
+  for (i = 0; i < NR_STATS_TIMERS; i++)
+    {
+      ULONGEST usec = stats_delta (stats->timers[i],
+				   start ? &start->timers[i] : NULL);
+
+      printf_unfiltered ("%s %s %s.%06ld", i > 0 ? "," : "",
+			 stats_timer_names[i], pulongest (usec / 1000000),
+			 (long) (usec % 1000000));
+    }
+  printf_unfiltered ("\n");
+}
+
+/* The "maintenance info stats" command.  */
+
+static void
+maintenance_info_stats (char *args, int from_tty)
+{
+  struct gdb_stats stats;
+
+  get_stats (&stats);
+  print_stats (_("Total"), &stats, NULL);
+  printf_unfiltered (_("Command time: %s.%06ld (cpu), %s.%06ld (wall); "
+		       "last command: %s.%06ld (cpu), %s.%06ld (wall)\n"),
+		     pulongest (stats.command_cpu / 1000000),
+		     (long) (stats.command_cpu % 1000000),
+		     pulongest (stats.command_wall / 1000000),
+		     (long) (stats.command_wall % 1000000),
+		     pulongest (stats.last_command_cpu / 1000000),
+		     (long) (stats.last_command_cpu % 1000000),
+		     pulongest (stats.last_command_wall / 1000000),
+		     (long) (stats.last_command_wall % 1000000));
+}
+
+/* Provide a prototype to silence -Wmissing-prototypes.  */
+extern initialize_file_ftype _initialize_stats;
+
+void
+_initialize_stats (void)
+{
+  add_cmd ("stats", class_maintenance, maintenance_info_stats, _("\
+Display GDB's internal counters, and where its time went.\n\
+Show how many target transfers, register fetches, symtab expansions,\n\
+frame unwinds and commands GDB did, and how its wall time was split\n\
+between Python, symbol lookup, the target and the rest of GDB."),
+	   &maintenanceinfolist);
+}
@@ -0,0 +1,132 @@
+/* Counters of GDB's work, and of where its time goes.
+
+   Copyright (C) 2026 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef STATS_H
+#define STATS_H
+
+/* The things GDB counts.  */
+
+enum stats_counter
+{
+  /* Calls to target_xfer_partial, and the bytes they transferred.  */
+  STATS_TARGET_XFERS,
+  STATS_TARGET_XFER_BYTES,
+
+  /* Calls to target_fetch_registers.  */
+  STATS_REGISTER_FETCHES,
+
+  /* Symtabs read in from partial symtabs or an index.  */
+  STATS_SYMTAB_EXPANSIONS,
+
+  /* Frames unwound from a younger frame.  */
+  STATS_FRAME_UNWINDS,
+
+  /* Top-level CLI and MI commands run.  */
+  STATS_COMMANDS,
+
+  NR_STATS_COUNTERS
+};
+
+/* The parts of GDB that wall time is charged to.  Time is charged to
+   the innermost part running, so that Python code reading memory
+   charges the time of the reads to the target, not to Python.  */
+
+enum stats_timer
+{
+  /* Anything not charged to another part.  */
+  STATS_TIME_GDB,
+
+  /* Running Python code.  */
+  STATS_TIME_PYTHON,
+
+  /* Looking up symbols, and reading in symtabs.  */
+  STATS_TIME_SYMTAB,
+
+  /* Waiting for the target: transfers, register fetches, resuming the
+     inferior and waiting for its events.  */
+  STATS_TIME_TARGET,
+
+  NR_STATS_TIMERS
+};
+
+struct gdb_stats
+{
+  ULONGEST counters[NR_STATS_COUNTERS];
+
+  /* The wall time charged to each part of GDB, in microseconds.  */
+  ULONGEST timers[NR_STATS_TIMERS];
+
+  /* The CPU and wall time of the last top-level command, and of all
+     of them, in microseconds.  */
+  ULONGEST last_command_cpu, last_command_wall;
+  ULONGEST command_cpu, command_wall;
+};
+
+/* The counters since GDB started or they were last reset.  The
+   timers are only up to date as of the last switch from one part of
+   GDB to another; use get_stats for a snapshot.  */
+
+extern struct gdb_stats gdb_stats;
+
+/* Add N to COUNTER.  */
+
+#define stats_count(COUNTER, N) (gdb_stats.counters[COUNTER] += (N))
+
+/* Start charging time to TIMER, and return the timer that was being
+   charged, to be passed to stats_timer_leave.  Use this pair only
+   around code that can't throw.  */
+
+extern enum stats_timer stats_timer_enter (enum stats_timer timer);
+
+/* Stop charging time to the current timer, and go back to PREVIOUS.  */
+
+extern void stats_timer_leave (enum stats_timer previous);
+
+/* Start charging time to TIMER, and return a cleanup that goes back
+   to the timer that was being charged.  */
+
+extern struct cleanup *make_cleanup_stats_timer (enum stats_timer timer);
+
+/* Note the start and the end of a top-level command, which took
+   CPU_USEC microseconds of CPU time and WALL_USEC of wall time.  */
+
+extern void stats_command_start (void);
+extern void stats_command_end (ULONGEST cpu_usec, ULONGEST wall_usec);
+
+/* Store a snapshot of the statistics in STATS.  */
+
+extern void get_stats (struct gdb_stats *stats);
+
+/* Reset all the statistics to zero.  */
+
+extern void reset_stats (void);
+
+/* Return the names of COUNTER and TIMER, as used by "maintenance info
+   stats" and gdb.stats.  */
+
+extern const char *stats_counter_name (enum stats_counter counter);
+extern const char *stats_timer_name (enum stats_timer timer);
+
+/* Print the counters and timers of STATS, less those of START if it
+   is not NULL, prefixing the lines with WHAT.  */
+
+extern void print_stats (const char *what, const struct gdb_stats *stats,
+			 const struct gdb_stats *start);
+
+#endif /* STATS_H */
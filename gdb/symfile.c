@@ -65,6 +65,7 @@
 #include <sys/time.h>
 
 #include "psymtab.h"
+#include "stats.h"
 
 int (*deprecated_ui_load_progress_hook) (const char *section,
 					 unsigned long num);
@@ -238,12 +239,17 @@ decrement_reading_symtab (void *dummy)
 }
 
 /* Increment currently_reading_symtab and return a cleanup that can be
-   used to decrement it.  */
+   used to decrement it.  Reading in the symtab is counted, and its
+   time charged to symbol lookup, until then.  */
 struct cleanup *
 increment_reading_symtab (void)
 {
+  struct cleanup *cleanup = make_cleanup_stats_timer (STATS_TIME_SYMTAB);
+
   ++currently_reading_symtab;
-  return make_cleanup (decrement_reading_symtab, NULL);
+  stats_count (STATS_SYMTAB_EXPANSIONS, 1);
+  make_cleanup (decrement_reading_symtab, NULL);
+  return cleanup;
 }
 
 /* Remember the lowest-addressed loadable section we've seen.
@@ -1042,7 +1048,7 @@ new_symfile_objfile (struct objfile *objfile, int add_flags)
     }
   else if ((add_flags & SYMFILE_DEFER_BP_RESET) == 0)
     {
-      breakpoint_re_set ();
+      breakpoint_re_set_objfiles (&objfile, 1);
     }
 
   /* We're done reading the symbol file; finish off complaints.  */
@@ -62,6 +62,7 @@
 #include "macroscope.h"
 
 #include "psymtab.h"
+#include "stats.h"
 
 /* Prototypes for local functions */
 
@@ -1150,8 +1151,9 @@ lookup_symbol_in_language (const char *name, const struct block *block,
 {
   const char *modified_name;
   struct symbol *returnval;
-  struct cleanup *cleanup = demangle_for_lookup (name, lang, &modified_name);
+  struct cleanup *cleanup = make_cleanup_stats_timer (STATS_TIME_SYMTAB);
 
+  demangle_for_lookup (name, lang, &modified_name);
   returnval = lookup_symbol_aux (modified_name, block, domain, lang,
 				 is_a_field_of_this);
   do_cleanups (cleanup);
@@ -42,6 +42,7 @@
 #include "exec.h"
 #include "inline-frame.h"
 #include "tracepoint.h"
+#include "stats.h"
 
 static void target_info (char *, int);
 
@@ -89,6 +90,14 @@ static LONGEST target_xfer_partial (struct target_ops *ops,
 static struct gdbarch *default_thread_architecture (struct target_ops *ops,
 						    ptid_t ptid);
 
+static void default_insert_breakpoints (struct gdbarch *gdbarch, int count,
+					struct bp_target_info **bp_tgts,
+					int *results);
+
+static void default_remove_breakpoints (struct gdbarch *gdbarch, int count,
+					struct bp_target_info **bp_tgts,
+					int *results);
+
 static void init_dummy_target (void);
 
 static struct target_ops debug_target;
@@ -105,6 +114,12 @@ static int debug_to_insert_breakpoint (struct gdbarch *,
 static int debug_to_remove_breakpoint (struct gdbarch *,
 				       struct bp_target_info *);
 
+static void debug_to_insert_breakpoints (struct gdbarch *, int,
+					 struct bp_target_info **, int *);
+
+static void debug_to_remove_breakpoints (struct gdbarch *, int,
+					 struct bp_target_info **, int *);
+
 static int debug_to_can_use_hw_breakpoint (int, int, int);
 
 static int debug_to_insert_hw_breakpoint (struct gdbarch *,
@@ -595,8 +610,19 @@ update_current_target (void)
       /* Do not inherit to_fetch_registers.  */
       /* Do not inherit to_store_registers.  */
       INHERIT (to_prepare_to_store, t);
+      INHERIT (to_prefetch_registers, t);
       INHERIT (deprecated_xfer_memory, t);
       INHERIT (to_files_info, t);
+      /* Take the vectored breakpoint methods from the topmost target
+	 that handles breakpoints, so that a target which intercepts
+	 breakpoint insertion (e.g., record) isn't bypassed by a batch
+	 implementation beneath it.  */
+      if (!current_target.to_insert_breakpoint
+	  && !current_target.to_insert_breakpoints)
+	{
+	  current_target.to_insert_breakpoints = t->to_insert_breakpoints;
+	  current_target.to_remove_breakpoints = t->to_remove_breakpoints;
+	}
       INHERIT (to_insert_breakpoint, t);
       INHERIT (to_remove_breakpoint, t);
       INHERIT (to_can_use_hw_breakpoint, t);
@@ -671,6 +697,10 @@ update_current_target (void)
       INHERIT (to_supports_multi_process, t);
       INHERIT (to_supports_enable_disable_tracepoint, t);
       INHERIT (to_supports_string_tracing, t);
+      INHERIT (to_supports_evaluation_of_breakpoint_conditions, t);
+      INHERIT (to_can_run_breakpoint_commands, t);
+      INHERIT (to_can_ignore_breakpoint_hits, t);
+      INHERIT (to_breakpoint_ignored_hits, t);
       INHERIT (to_trace_init, t);
       INHERIT (to_download_tracepoint, t);
       INHERIT (to_can_download_tracepoint, t);
@@ -697,6 +727,9 @@ update_current_target (void)
       INHERIT (to_static_tracepoint_marker_at, t);
       INHERIT (to_static_tracepoint_markers_by_strid, t);
       INHERIT (to_traceframe_info, t);
+      INHERIT (to_insert_coverage_points, t);
+      INHERIT (to_clear_coverage_points, t);
+      INHERIT (to_debug_registers, t);
       INHERIT (to_magic, t);
       /* Do not inherit to_memory_map.  */
       /* Do not inherit to_flash_erase.  */
@@ -724,6 +757,9 @@ update_current_target (void)
   de_fault (to_prepare_to_store,
 	    (void (*) (struct regcache *))
 	    noprocess);
+  de_fault (to_prefetch_registers,
+	    (void (*) (int, struct regcache **))
+	    target_ignore);
   de_fault (deprecated_xfer_memory,
 	    (int (*) (CORE_ADDR, gdb_byte *, int, int,
 		      struct mem_attrib *, struct target_ops *))
@@ -735,6 +771,10 @@ update_current_target (void)
 	    memory_insert_breakpoint);
   de_fault (to_remove_breakpoint,
 	    memory_remove_breakpoint);
+  de_fault (to_insert_breakpoints,
+	    default_insert_breakpoints);
+  de_fault (to_remove_breakpoints,
+	    default_remove_breakpoints);
   de_fault (to_can_use_hw_breakpoint,
 	    (int (*) (int, int, int))
 	    return_zero);
@@ -846,6 +886,18 @@ update_current_target (void)
   de_fault (to_supports_string_tracing,
 	    (int (*) (void))
 	    return_zero);
+  de_fault (to_supports_evaluation_of_breakpoint_conditions,
+	    (int (*) (void))
+	    return_zero);
+  de_fault (to_can_run_breakpoint_commands,
+	    (int (*) (void))
+	    return_zero);
+  de_fault (to_can_ignore_breakpoint_hits,
+	    (int (*) (void))
+	    return_zero);
+  de_fault (to_breakpoint_ignored_hits,
+	    (int (*) (struct gdbarch *, struct bp_target_info *))
+	    return_minus_one);
   de_fault (to_trace_init,
 	    (void (*) (void))
 	    tcomplain);
@@ -924,6 +976,16 @@ update_current_target (void)
   de_fault (to_traceframe_info,
 	    (struct traceframe_info * (*) (void))
 	    tcomplain);
+  de_fault (to_insert_coverage_points,
+	    (void (*) (int, const CORE_ADDR *, int *))
+	    tcomplain);
+  de_fault (to_clear_coverage_points,
+	    (void (*) (void))
+	    tcomplain);
+  de_fault (to_debug_registers,
+	    (int (*) (const struct watch_region *, int,
+		      struct watch_region *, int))
+	    return_zero);
   de_fault (to_execution_direction, default_execution_direction);
 
 #undef de_fault
@@ -1660,6 +1722,7 @@ target_xfer_partial (struct target_ops *ops,
 		     ULONGEST offset, LONGEST len)
 {
   LONGEST retval;
+  struct cleanup *timer_cleanup;
 
   gdb_assert (ops->to_xfer_partial != NULL);
 
@@ -1667,6 +1730,8 @@ target_xfer_partial (struct target_ops *ops,
     error (_("Writing to memory is not allowed (addr %s, len %s)"),
 	   core_addr_to_string_nz (offset), plongest (len));
 
+  timer_cleanup = make_cleanup_stats_timer (STATS_TIME_TARGET);
+
   /* If this is a memory transfer, let the memory-specific code
      have a look at it instead.  Memory transfers are more
      complicated.  */
@@ -1686,6 +1751,11 @@ target_xfer_partial (struct target_ops *ops,
 				     writebuf, offset, len);
     }
 
+  do_cleanups (timer_cleanup);
+  stats_count (STATS_TARGET_XFERS, 1);
+  if (retval > 0)
+    stats_count (STATS_TARGET_XFER_BYTES, retval);
+
   if (targetdebug)
     {
       const unsigned char *myaddr = NULL;
@@ -2420,6 +2490,65 @@ target_remove_breakpoint (struct gdbarch *gdbarch,
   return (*current_target.to_remove_breakpoint) (gdbarch, bp_tgt);
 }
 
+/* The default vectored breakpoint methods: insert or remove the
+   breakpoints one at a time.  */
+
+static void
+default_insert_breakpoints (struct gdbarch *gdbarch, int count,
+			    struct bp_target_info **bp_tgts, int *results)
+{
+  int i;
+
+  for (i = 0; i < count; i++)
+    results[i] = (*current_target.to_insert_breakpoint) (gdbarch, bp_tgts[i]);
+}
+
+static void
+default_remove_breakpoints (struct gdbarch *gdbarch, int count,
+			    struct bp_target_info **bp_tgts, int *results)
+{
+  int i;
+
+  for (i = 0; i < count; i++)
+    results[i] = (*current_target.to_remove_breakpoint) (gdbarch, bp_tgts[i]);
+}
+
+void
+target_insert_breakpoints (struct gdbarch *gdbarch, int count,
+			   struct bp_target_info **bp_tgts, int *results)
+{
+  int i;
+
+  if (!may_insert_breakpoints)
+    {
+      warning (_("May not insert breakpoints"));
+      for (i = 0; i < count; i++)
+	results[i] = 1;
+      return;
+    }
+
+  (*current_target.to_insert_breakpoints) (gdbarch, count, bp_tgts, results);
+}
+
+void
+target_remove_breakpoints (struct gdbarch *gdbarch, int count,
+			   struct bp_target_info **bp_tgts, int *results)
+{
+  int i;
+
+  /* As in target_remove_breakpoint, leave breakpoints in place if
+     the permission was revoked after they were inserted.  */
+  if (!may_insert_breakpoints)
+    {
+      warning (_("May not remove breakpoints"));
+      for (i = 0; i < count; i++)
+	results[i] = 1;
+      return;
+    }
+
+  (*current_target.to_remove_breakpoints) (gdbarch, count, bp_tgts, results);
+}
+
 static void
 target_info (char *args, int from_tty)
 {
@@ -2599,8 +2728,12 @@ target_wait (ptid_t ptid, struct target_waitstatus *status, int options)
     {
       if (t->to_wait != NULL)
 	{
+	  struct cleanup *timer_cleanup
+	    = make_cleanup_stats_timer (STATS_TIME_TARGET);
 	  ptid_t retval = (*t->to_wait) (t, ptid, status, options);
 
+	  do_cleanups (timer_cleanup);
+
 	  if (targetdebug)
 	    {
 	      char *status_string;
@@ -2659,7 +2792,11 @@ target_resume (ptid_t ptid, int step, enum target_signal signal)
     {
       if (t->to_resume != NULL)
 	{
+	  struct cleanup *timer_cleanup
+	    = make_cleanup_stats_timer (STATS_TIME_TARGET);
+
 	  t->to_resume (t, ptid, step, signal);
+	  do_cleanups (timer_cleanup);
 	  if (targetdebug)
 	    fprintf_unfiltered (gdb_stdlog, "target_resume (%d, %s, %s)\n",
 				PIDGET (ptid),
@@ -2933,6 +3070,102 @@ target_search_memory (CORE_ADDR start_addr, ULONGEST search_space_len,
   return found;
 }
 
+/* The size of the pieces target_search_memory_all reads memory in.
+   Native targets read large pieces of the inferior's memory about as
+   cheaply as small ones.  */
+#define SEARCH_ALL_CHUNK_SIZE (1024 * 1024)
+
+int
+target_search_memory_all (CORE_ADDR start_addr, ULONGEST search_space_len,
+			  struct search_patterns *patterns,
+			  search_match_ftype *func, void *data)
+{
+  struct target_ops *t;
+  struct cleanup *old_cleanups;
+  gdb_byte *search_buf;
+  int state = 0;
+
+  if (targetdebug)
+    fprintf_unfiltered (gdb_stdlog, "target_search_memory_all (%s, ...)\n",
+			hex_string (start_addr));
+
+  for (t = current_target.beneath; t != NULL; t = t->beneath)
+    if (t->to_search_memory != NULL)
+      break;
+
+  /* A target that searches its memory itself, such as a remote stub,
+     is better asked for each match in turn than made to send all of
+     the memory over.  */
+  if (t != NULL)
+    {
+      int i;
+
+      for (i = 0; i < search_patterns_count (patterns); i++)
+	{
+	  CORE_ADDR addr = start_addr;
+	  ULONGEST len = search_space_len;
+	  ULONGEST pattern_len;
+	  const gdb_byte *pattern;
+
+	  pattern = search_patterns_get (patterns, i, &pattern_len);
+	  while (len >= pattern_len)
+	    {
+	      CORE_ADDR found_addr;
+	      ULONGEST incr;
+	      int found;
+
+	      found = target_search_memory (addr, len, pattern, pattern_len,
+					    &found_addr);
+	      if (found < 0)
+		return -1;
+	      if (found == 0)
+		break;
+	      if (func (found_addr, i, data))
+		return 0;
+
+	      /* Begin the next search at one byte past this match.  */
+	      incr = found_addr - addr + 1;
+	      len = (len >= incr ? len - incr : 0);
+	      addr += incr;
+	    }
+	}
+
+      return 0;
+    }
+
+  search_buf = xmalloc (min (search_space_len, SEARCH_ALL_CHUNK_SIZE));
+  old_cleanups = make_cleanup (xfree, search_buf);
+
+  /* The scan carries its state from one piece to the next, so unlike
+     simple_search_memory there are no bytes to keep between them.  */
+  while (search_space_len > 0)
+    {
+      ULONGEST nr_to_read = min (search_space_len, SEARCH_ALL_CHUNK_SIZE);
+      LONGEST nr_read;
+
+      nr_read = target_read (current_target.beneath, TARGET_OBJECT_MEMORY,
+			     NULL, search_buf, start_addr, nr_to_read);
+      if (nr_read > 0
+	  && search_patterns_scan (patterns, search_buf, nr_read,
+				   start_addr, &state, func, data))
+	break;
+
+      if (nr_read != nr_to_read)
+	{
+	  warning (_("Unable to access target memory at %s, halting search."),
+		   hex_string (start_addr + max (nr_read, 0)));
+	  do_cleanups (old_cleanups);
+	  return -1;
+	}
+
+      start_addr += nr_to_read;
+      search_space_len -= nr_to_read;
+    }
+
+  do_cleanups (old_cleanups);
+  return 0;
+}
+
 /* Look through the currently pushed targets.  If none of them will
    be able to restart the currently running process, issue an error
    message.  */
@@ -3560,7 +3793,12 @@ target_fetch_registers (struct regcache *regcache, int regno)
     {
       if (t->to_fetch_registers != NULL)
 	{
+	  struct cleanup *timer_cleanup
+	    = make_cleanup_stats_timer (STATS_TIME_TARGET);
+
 	  t->to_fetch_registers (t, regcache, regno);
+	  do_cleanups (timer_cleanup);
+	  stats_count (STATS_REGISTER_FETCHES, 1);
 	  if (targetdebug)
 	    debug_print_register ("target_fetch_registers", regcache, regno);
 	  return;
@@ -3809,6 +4047,36 @@ debug_to_remove_breakpoint (struct gdbarch *gdbarch,
   return retval;
 }
 
+static void
+debug_to_insert_breakpoints (struct gdbarch *gdbarch, int count,
+			     struct bp_target_info **bp_tgts, int *results)
+{
+  int i;
+
+  debug_target.to_insert_breakpoints (gdbarch, count, bp_tgts, results);
+
+  for (i = 0; i < count; i++)
+    fprintf_unfiltered (gdb_stdlog,
+			"target_insert_breakpoints (%s, xxx) = %ld\n",
+			core_addr_to_string (bp_tgts[i]->placed_address),
+			(unsigned long) results[i]);
+}
+
+static void
+debug_to_remove_breakpoints (struct gdbarch *gdbarch, int count,
+			     struct bp_target_info **bp_tgts, int *results)
+{
+  int i;
+
+  debug_target.to_remove_breakpoints (gdbarch, count, bp_tgts, results);
+
+  for (i = 0; i < count; i++)
+    fprintf_unfiltered (gdb_stdlog,
+			"target_remove_breakpoints (%s, xxx) = %ld\n",
+			core_addr_to_string (bp_tgts[i]->placed_address),
+			(unsigned long) results[i]);
+}
+
 static int
 debug_to_can_use_hw_breakpoint (int type, int cnt, int from_tty)
 {
@@ -4186,6 +4454,8 @@ setup_target_debug (void)
   current_target.to_files_info = debug_to_files_info;
   current_target.to_insert_breakpoint = debug_to_insert_breakpoint;
   current_target.to_remove_breakpoint = debug_to_remove_breakpoint;
+  current_target.to_insert_breakpoints = debug_to_insert_breakpoints;
+  current_target.to_remove_breakpoints = debug_to_remove_breakpoints;
   current_target.to_can_use_hw_breakpoint = debug_to_can_use_hw_breakpoint;
   current_target.to_insert_hw_breakpoint = debug_to_insert_hw_breakpoint;
   current_target.to_remove_hw_breakpoint = debug_to_remove_hw_breakpoint;
@@ -62,6 +62,7 @@ struct expression;
 #include "memattr.h"
 #include "vec.h"
 #include "gdb_signals.h"
+#include "memsearch.h"
 
 enum strata
   {
@@ -279,6 +280,11 @@ enum target_object
   TARGET_OBJECT_TRACEFRAME_INFO,
   /* Load maps for FDPIC systems.  */
   TARGET_OBJECT_FDPIC,
+  /* The hit set of the coverage points planted with
+     target_insert_coverage_points, as a bitmap: bit I (counting from
+     the least significant bit of the first byte) is set if the I'th
+     coverage point planted has been hit.  */
+  TARGET_OBJECT_COVERAGE,
   /* Darwin dynamic linker info data.  */
   TARGET_OBJECT_DARWIN_DYLD_INFO
   /* Possible future objects: TARGET_OBJECT_FILE, ...  */
@@ -299,6 +305,18 @@ enum trace_find_type
 typedef struct static_tracepoint_marker *static_tracepoint_marker_p;
 DEF_VEC_P(static_tracepoint_marker_p);
 
+/* A region of memory that a hardware watchpoint or breakpoint, or a
+   debug register, watches.  */
+
+struct watch_region
+{
+  CORE_ADDR addr;
+  int len;
+
+  /* The accesses watched, an enum target_hw_bp_type.  */
+  int type;
+};
+
 /* Request that OPS transfer up to LEN 8-bit bytes of the target's
    OBJECT.  The OFFSET, for a seekable object, specifies the
    starting point.  The ANNEX can be used to provide additional
@@ -424,6 +442,11 @@ struct target_ops
     void (*to_store_registers) (struct target_ops *, struct regcache *, int);
     void (*to_prepare_to_store) (struct regcache *);
 
+    /* Fetch the registers of the COUNT threads whose register caches
+       are in REGCACHES in as few round trips as the target can.  The
+       registers left unfetched are fetched on demand, as usual.  */
+    void (*to_prefetch_registers) (int count, struct regcache **regcaches);
+
     /* Transfer LEN bytes of memory between GDB address MYADDR and
        target address MEMADDR.  If WRITE, transfer them to the target, else
        transfer them from the target.  TARGET is the target from which we
@@ -453,6 +476,10 @@ struct target_ops
     void (*to_files_info) (struct target_ops *);
     int (*to_insert_breakpoint) (struct gdbarch *, struct bp_target_info *);
     int (*to_remove_breakpoint) (struct gdbarch *, struct bp_target_info *);
+    void (*to_insert_breakpoints) (struct gdbarch *, int,
+				   struct bp_target_info **, int *);
+    void (*to_remove_breakpoints) (struct gdbarch *, int,
+				   struct bp_target_info **, int *);
     int (*to_can_use_hw_breakpoint) (int, int, int);
     int (*to_ranged_break_num_registers) (struct target_ops *);
     int (*to_insert_hw_breakpoint) (struct gdbarch *, struct bp_target_info *);
@@ -662,6 +689,23 @@ struct target_ops
     /* Does this target support the tracenz bytecode for string collection?  */
     int (*to_supports_string_tracing) (void);
 
+    /* Does this target support evaluating breakpoint conditions on its
+       end?  */
+    int (*to_supports_evaluation_of_breakpoint_conditions) (void);
+
+    /* Can this target run the commands of breakpoints itself, instead
+       of reporting their hits?  */
+    int (*to_can_run_breakpoint_commands) (void);
+
+    /* Can this target skip hits of software breakpoints itself,
+       according to the ignore count passed when inserting them?  */
+    int (*to_can_ignore_breakpoint_hits) (void);
+
+    /* Return how many hits of the breakpoint BP_TGT, inserted with an
+       ignore count, the target skipped, and skip no more.  */
+    int (*to_breakpoint_ignored_hits) (struct gdbarch *,
+				       struct bp_target_info *);
+
     /* Determine current architecture of thread PTID.
 
        The target is supposed to determine the architecture of the code where
@@ -795,6 +839,28 @@ struct target_ops
        re-fetching when necessary.  */
     struct traceframe_info *(*to_traceframe_info) (void);
 
+    /* Plant one-shot coverage points at the COUNT addresses in ADDRS.
+       The target removes each point the first time it is hit, notes
+       the hit, and resumes the inferior without reporting a stop.
+       RESULTS[I] is set to zero if the I'th point was planted.  Hits
+       are read back through TARGET_OBJECT_COVERAGE, indexed in the
+       order the points were planted.  */
+    void (*to_insert_coverage_points) (int count, const CORE_ADDR *addrs,
+				       int *results);
+
+    /* Remove all the coverage points, and forget their hits.  */
+    void (*to_clear_coverage_points) (void);
+
+    /* Describe in REGS, which has room for MAX entries, how the
+       target would use its debug registers to watch the NWANTED
+       regions of WANTED; a register left vacant has a length of zero.
+       Return the number of debug registers, -1 if the regions don't
+       fit in them, or zero if the target doesn't watch with debug
+       registers.  */
+    int (*to_debug_registers) (const struct watch_region *wanted,
+			       int nwanted,
+			       struct watch_region *regs, int max);
+
     int to_magic;
     /* Need sub-structure for target machine related rather than comm related?
      */
@@ -904,6 +970,12 @@ extern void target_store_registers (struct regcache *regcache, int regs);
 #define	target_prepare_to_store(regcache)	\
      (*current_target.to_prepare_to_store) (regcache)
 
+/* Fetch the registers of several threads at once, without changing
+   inferior_ptid.  See to_prefetch_registers.  */
+
+#define target_prefetch_registers(count, regcaches)	\
+     (*current_target.to_prefetch_registers) (count, regcaches)
+
 /* Determine current address space of thread PTID.  */
 
 struct address_space *target_thread_address_space (ptid_t);
@@ -927,6 +999,34 @@ int target_supports_disable_randomization (void);
 #define target_supports_string_tracing() \
   (*current_target.to_supports_string_tracing) ()
 
+/* Returns true if this target can evaluate the conditions of
+   breakpoints, downloaded as agent expressions, before reporting a
+   hit.  */
+
+#define target_supports_evaluation_of_breakpoint_conditions() \
+  (*current_target.to_supports_evaluation_of_breakpoint_conditions) ()
+
+/* Returns true if this target can run commands of breakpoints,
+   downloaded as agent expressions, when they are hit, instead of
+   reporting the hits.  */
+
+#define target_can_run_breakpoint_commands() \
+  (*current_target.to_can_run_breakpoint_commands) ()
+
+/* Returns true if this target can skip the first hits of software
+   breakpoints without reporting them, when given an ignore count in
+   their bp_target_info.  */
+
+#define target_can_ignore_breakpoint_hits() \
+  (*current_target.to_can_ignore_breakpoint_hits) ()
+
+/* Return the number of hits of the breakpoint BP_TGT the target
+   skipped because of the ignore count it was inserted with, or -1 if
+   that is unknown, and have the target report all further hits.  */
+
+#define target_breakpoint_ignored_hits(gdbarch, bp_tgt) \
+  (*current_target.to_breakpoint_ignored_hits) (gdbarch, bp_tgt)
+
 /* Invalidate all target dcaches.  */
 extern void target_dcache_invalidate (void);
 
@@ -1023,6 +1123,22 @@ extern int target_insert_breakpoint (struct gdbarch *gdbarch,
 extern int target_remove_breakpoint (struct gdbarch *gdbarch,
 				     struct bp_target_info *bp_tgt);
 
+/* Insert the COUNT software breakpoints described by BP_TGTS, all
+   for GDBARCH, in as few target operations as possible.  RESULTS[I]
+   is set to 0 if BP_TGTS[I] was inserted, or to nonzero otherwise;
+   callers should retry the failed ones with target_insert_breakpoint
+   to find out why.  */
+
+extern void target_insert_breakpoints (struct gdbarch *gdbarch, int count,
+				       struct bp_target_info **bp_tgts,
+				       int *results);
+
+/* Likewise, but remove the breakpoints.  */
+
+extern void target_remove_breakpoints (struct gdbarch *gdbarch, int count,
+				       struct bp_target_info **bp_tgts,
+				       int *results);
+
 /* Initialize the terminal settings we record for the inferior,
    before we actually run the inferior.  */
 
@@ -1489,6 +1605,16 @@ extern int target_search_memory (CORE_ADDR start_addr,
                                  ULONGEST pattern_len,
                                  CORE_ADDR *found_addrp);
 
+/* Search SEARCH_SPACE_LEN bytes beginning at START_ADDR for all the
+   matches of the patterns in PATTERNS, and call FUNC with DATA for
+   each, until FUNC returns nonzero.  The matches of a pattern are
+   reported in address order.  Returns -1 if there was an error
+   requiring halting of the search, 0 otherwise.  */
+extern int target_search_memory_all (CORE_ADDR start_addr,
+				     ULONGEST search_space_len,
+				     struct search_patterns *patterns,
+				     search_match_ftype *func, void *data);
+
 /* Tracepoint-related operations.  */
 
 #define target_trace_init() \
@@ -1569,6 +1695,15 @@ extern int target_search_memory (CORE_ADDR start_addr,
 #define target_traceframe_info() \
   (*current_target.to_traceframe_info) ()
 
+#define target_insert_coverage_points(count, addrs, results) \
+  (*current_target.to_insert_coverage_points) (count, addrs, results)
+
+#define target_clear_coverage_points() \
+  (*current_target.to_clear_coverage_points) ()
+
+#define target_debug_registers(wanted, nwanted, regs, max) \
+  (*current_target.to_debug_registers) (wanted, nwanted, regs, max)
+
 /* Command logging facility.  */
 
 #define target_log_command(p)						\
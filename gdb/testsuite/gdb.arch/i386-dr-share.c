@@ -0,0 +1,43 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2026 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+/* WIDE.S takes six debug registers if watched exactly, but only two
+   (four on i386) once widened to aligned blocks.  */
+
+struct
+{
+  char pad;
+  char s[14];
+} wide __attribute__ ((aligned (8)));
+
+int pair[2] __attribute__ ((aligned (8)));
+
+int other;
+
+int
+main (void)
+{
+  other = 0;
+
+  wide.pad = 1;		/* pad write */
+  wide.s[13] = 1;	/* s write */
+
+  pair[0] = 1;		/* pair[0] write */
+  pair[1] = 2;		/* pair[1] write */
+
+  return 0;		/* done */
+}
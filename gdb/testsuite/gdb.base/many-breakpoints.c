@@ -0,0 +1,74 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2026 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+volatile int total;
+
+void func0 (void) { total += 0; }
+void func1 (void) { total += 1; }
+void func2 (void) { total += 2; }
+void func3 (void) { total += 3; }
+void func4 (void) { total += 4; }
+void func5 (void) { total += 5; }
+void func6 (void) { total += 6; }
+void func7 (void) { total += 7; }
+void func8 (void) { total += 8; }
+void func9 (void) { total += 9; }
+void func10 (void) { total += 10; }
+void func11 (void) { total += 11; }
+void func12 (void) { total += 12; }
+void func13 (void) { total += 13; }
+void func14 (void) { total += 14; }
+void func15 (void) { total += 15; }
+void func16 (void) { total += 16; }
+void func17 (void) { total += 17; }
+void func18 (void) { total += 18; }
+void func19 (void) { total += 19; }
+void func20 (void) { total += 20; }
+void func21 (void) { total += 21; }
+void func22 (void) { total += 22; }
+void func23 (void) { total += 23; }
+void func24 (void) { total += 24; }
+void func25 (void) { total += 25; }
+void func26 (void) { total += 26; }
+void func27 (void) { total += 27; }
+void func28 (void) { total += 28; }
+void func29 (void) { total += 29; }
+void func30 (void) { total += 30; }
+void func31 (void) { total += 31; }
+
+static void (*funcs[]) (void) =
+{
+  func0, func1, func2, func3,
+  func4, func5, func6, func7,
+  func8, func9, func10, func11,
+  func12, func13, func14, func15,
+  func16, func17, func18, func19,
+  func20, func21, func22, func23,
+  func24, func25, func26, func27,
+  func28, func29, func30, func31
+};
+
+int
+main (void)
+{
+  int i;
+
+  for (i = 0; i < sizeof (funcs) / sizeof (funcs[0]); i++)
+    funcs[i] ();
+
+  return 0; /* Done.  */
+}
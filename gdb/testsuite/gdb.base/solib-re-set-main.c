@@ -0,0 +1,51 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2026 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <dlfcn.h>
+
+int
+main_func (int x)
+{
+  return x + 1;
+}
+
+int
+main (void)
+{
+  int i, total = 0;
+
+  for (i = 0; i < 3; i++)
+    {
+      void *handle = dlopen (SHLIB_NAME, RTLD_LAZY);
+      int (*lib_func) (int);
+
+      if (handle == NULL)
+	{
+	  fprintf (stderr, "%s\n", dlerror ());
+	  exit (1);
+	}
+
+      lib_func = (int (*) (int)) dlsym (handle, "lib_func");
+      total += lib_func (i);
+      dlclose (handle);
+    }
+
+  total += main_func (total);
+  return 0; /* Done.  */
+}
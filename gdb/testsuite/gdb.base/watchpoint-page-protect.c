@@ -0,0 +1,73 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2026 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+/* BUF and NEIGHBOUR share a page.  */
+
+struct
+{
+  char buf[2048];
+  char neighbour[2048];
+} page __attribute__ ((aligned (4096)));
+
+/* Two pages, for an access that crosses from one into the other.  */
+
+struct
+{
+  char buf[8192];
+} pages __attribute__ ((aligned (4096)));
+
+/* Read-only pages, so that writing to them faults for real.  */
+
+const struct
+{
+  char buf[8192];
+} rodata __attribute__ ((aligned (4096))) = { { 1 } };
+
+volatile int sink;
+
+/* Set by the test to write to RODATA.  */
+volatile int write_rodata;
+
+int
+main (void)
+{
+  int i;
+
+  for (i = 0; i < 2048; i++)
+    page.neighbour[i] = i;
+
+  /* A software watchpoint would single-step through these loops.  */
+  for (i = 0; i < 1000000; i++)
+    sink += i;
+
+  page.buf[100] = 1; /* First write.  */
+
+  for (i = 0; i < 1000000; i++)
+    sink += i;
+
+  page.buf[2000] = 2; /* Second write.  */
+
+  sink = page.buf[500]; /* Read.  */
+
+  /* A single instruction writing to both pages.  */
+  *(volatile double *) &pages.buf[4096 - 4] = 3.0; /* Crossing write.  */
+
+  if (write_rodata)
+    *(volatile char *) &rodata.buf[10] = 1; /* Faulting write.  */
+
+  return 0; /* Done.  */
+}
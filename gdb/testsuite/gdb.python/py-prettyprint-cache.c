@@ -0,0 +1,58 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2026 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#define NR_POINTS 20000
+
+struct point
+{
+  int x;
+  int y;
+};
+
+typedef struct point point_t;
+
+struct other
+{
+  int a;
+};
+
+struct named
+{
+  int n;
+};
+
+struct point points[NR_POINTS];
+point_t *point_ref;
+struct other other;
+struct named named;
+
+int
+main (void)
+{
+  int i;
+
+  for (i = 0; i < NR_POINTS; i++)
+    {
+      points[i].x = i;
+      points[i].y = -i;
+    }
+  point_ref = &points[1];
+  other.a = 1;
+  named.n = 1;
+
+  return 0;		/* Break here.  */
+}
@@ -0,0 +1,62 @@
+# Copyright (C) 2026 Free Software Foundation, Inc.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+# This file is part of the GDB testsuite.  It tests the caching of
+# pretty-printer lookups.
+
+import gdb
+import gdb.printing
+
+class PointPrinter (object):
+    def __init__ (self, val):
+        self.val = val
+
+    def to_string (self):
+        return "(%d, %d)" % (int (self.val['x']), int (self.val['y']))
+
+class OtherPrinter (object):
+    def __init__ (self, val):
+        self.val = val
+
+    def to_string (self):
+        return "other"
+
+class NamedPrinter (object):
+    def __init__ (self, val):
+        self.val = val
+
+    def to_string (self):
+        return "named"
+
+def build_pretty_printer ():
+    pp = gdb.printing.RegexpCollectionPrettyPrinter ("cache-test")
+    # Printers that don't match, to give lookups some work.
+    for i in range (20):
+        pp.add_printer ("unused%d" % i, "^unused%d$" % i, PointPrinter)
+    pp.add_printer ("point", "^point$", PointPrinter)
+    # A regexp matched by Python, rather than by GDB.
+    pp.add_printer ("named", r"^n\w+d$", NamedPrinter)
+    # What re.escape makes of "other>"; to GNU regex, "\>" would
+    # match the end of the word instead of a '>'.
+    pp.add_printer ("other>", r"^other\>", NamedPrinter)
+    return pp
+
+def lookup_other (val):
+    if str (val.type.strip_typedefs ()) == "struct other":
+        return OtherPrinter (val)
+    return None
+
+gdb.printing.register_pretty_printer (gdb.current_objfile (),
+                                      build_pretty_printer ())
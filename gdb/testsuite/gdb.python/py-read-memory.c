@@ -0,0 +1,43 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2026 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+unsigned char data[3 * 4096];
+
+/* Two pages, the second of which is unmapped.  */
+unsigned char *mapped;
+long page_size;
+
+int
+main (void)
+{
+  int i;
+
+  for (i = 0; i < sizeof (data); i++)
+    data[i] = i % 251;
+
+  page_size = sysconf (_SC_PAGESIZE);
+  mapped = mmap (NULL, 2 * page_size, PROT_READ | PROT_WRITE,
+		 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  memset (mapped, 'x', page_size);
+  munmap (mapped + page_size, page_size);
+
+  return 0;			/* Break here.  */
+}
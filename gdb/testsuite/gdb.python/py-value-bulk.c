@@ -0,0 +1,78 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2026 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#define NR_RECORDS 100000
+
+enum color { RED, GREEN = -1 };
+
+struct inner
+{
+  short s;
+  unsigned char c;
+};
+
+typedef struct inner inner_t;
+
+struct record
+{
+  int id;
+  char tag;
+  double weight;
+  inner_t inner;
+  unsigned short counts[3];
+  struct record *next;
+  enum color color;
+};
+
+struct flags
+{
+  unsigned int low : 3;
+  int high : 5;
+};
+
+union either
+{
+  int i;
+  float f;
+};
+
+struct record records[NR_RECORDS];
+struct flags flags = { 5, -3 };
+union either either = { 1 };
+int numbers[4] = { 1, -2, 3, -4 };
+
+int
+main (void)
+{
+  int i;
+
+  for (i = 0; i < NR_RECORDS; i++)
+    {
+      records[i].id = i;
+      records[i].tag = 'a' + i % 26;
+      records[i].weight = i / 2.0;
+      records[i].inner.s = -i;
+      records[i].inner.c = i % 256;
+      records[i].counts[0] = 1;
+      records[i].counts[1] = 2;
+      records[i].counts[2] = i % 65536;
+      records[i].next = i + 1 < NR_RECORDS ? &records[i + 1] : 0;
+      records[i].color = i % 2 ? GREEN : RED;
+    }
+
+  return 0;		/* Break here.  */
+}
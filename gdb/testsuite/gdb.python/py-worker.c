@@ -0,0 +1,43 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2026 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <unistd.h>
+
+#define DATA_SIZE (1 << 20)
+
+unsigned char data[DATA_SIZE];
+
+void
+done (void)
+{
+}
+
+int
+main (void)
+{
+  int i;
+
+  for (i = 0; i < DATA_SIZE; i++)
+    data[i] = i % 251;
+
+  /* Keep the program running for a while, so that workers can run
+     meanwhile.  */
+  sleep (2);		/* Break here.  */
+  done ();
+
+  return 0;
+}
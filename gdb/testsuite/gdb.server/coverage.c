@@ -0,0 +1,51 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2026 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+volatile int counter;
+
+void
+covered_a (void)
+{
+  counter++;
+}
+
+void
+covered_b (void)
+{
+  counter += 2;
+}
+
+void
+never_called (void)
+{
+  counter = 0;
+}
+
+int
+main (void)
+{
+  int i;
+
+  for (i = 0; i < 1000; i++)
+    {
+      covered_a ();
+      if (i % 2)
+	covered_b ();
+    }
+
+  return 0; /* Done.  */
+}
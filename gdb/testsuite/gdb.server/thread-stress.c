@@ -0,0 +1,88 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2026 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#ifndef NR_THREADS
+#define NR_THREADS 20
+#endif
+
+static pthread_barrier_t barrier;
+
+volatile int ticks;
+
+void
+all_started (void)
+{
+}
+
+void
+tick (void)
+{
+  ticks++;
+}
+
+/* Called by GDB in each thread, to check that it is the thread GDB
+   thinks it is.  */
+
+long
+lwp_of_self (void)
+{
+  return syscall (SYS_gettid);
+}
+
+static void *
+thread_function (void *arg)
+{
+  pthread_barrier_wait (&barrier);
+
+  while (1)
+    usleep (1000);
+
+  return NULL;
+}
+
+int
+main (void)
+{
+  pthread_attr_t attr;
+  pthread_t thread;
+  int i;
+
+  pthread_attr_init (&attr);
+  pthread_attr_setstacksize (&attr, 64 * 1024);
+  pthread_barrier_init (&barrier, NULL, NR_THREADS + 1);
+
+  for (i = 0; i < NR_THREADS; i++)
+    if (pthread_create (&thread, &attr, thread_function, NULL) != 0)
+      abort ();
+
+  pthread_barrier_wait (&barrier);
+  all_started ();
+
+  while (1)
+    {
+      tick ();
+      usleep (1000);
+    }
+
+  return 0;
+}
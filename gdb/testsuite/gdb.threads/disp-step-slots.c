@@ -0,0 +1,54 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2026 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <pthread.h>
+#include <stdlib.h>
+
+#define NTHREADS 8
+#define ITERS 250
+
+volatile int counter;
+
+void
+hit (void)
+{
+  __sync_fetch_and_add (&counter, 1);
+}
+
+void *
+worker (void *arg)
+{
+  int i;
+
+  for (i = 0; i < ITERS; i++)
+    hit ();
+  return NULL;
+}
+
+int
+main (void)
+{
+  pthread_t threads[NTHREADS];
+  int i;
+
+  for (i = 0; i < NTHREADS; i++)
+    pthread_create (&threads[i], NULL, worker, NULL);
+  for (i = 0; i < NTHREADS; i++)
+    pthread_join (threads[i], NULL);
+
+  return 0; /* all done */
+}
@@ -60,6 +60,8 @@
 #include "top.h"
 #include "main.h"
 #include "solist.h"
+#include "remote.h"
+#include "stats.h"
 
 #include "inferior.h"		/* for signed_pointer_to_address */
 
@@ -653,6 +655,11 @@ static int display_time;
 
 static int display_space;
 
+/* If nonzero, display GDB's internal counters, and where its time went,
+   both at startup and for each command.  */
+
+static int display_stats;
+
 /* Records a run time and space usage to be used as a base for
    reporting elapsed time or change in space.  In addition,
    the msg_type field indicates whether the saved time is from the
@@ -664,6 +671,7 @@ struct cmd_stats
   long start_cpu_time;
   struct timeval start_wall_time;
   long start_space;
+  struct gdb_stats start_stats;
 };
 
 /* Set whether to display time statistics to NEW_VALUE (non-zero 
@@ -682,25 +690,38 @@ set_display_space (int new_value)
   display_space = new_value;
 }
 
+/* Set whether to display GDB's internal counters to NEW_VALUE
+   (non-zero means true).  */
+void
+set_display_stats (int new_value)
+{
+  display_stats = new_value;
+}
+
 /* As indicated by display_time and display_space, report GDB's elapsed time
    and space usage from the base time and space provided in ARG, which
-   must be a pointer to a struct cmd_stat.  This function is intended
-   to be called as a cleanup.  */
+   must be a pointer to a struct cmd_stat.  Also report GDB's internal
+   counters, and the remote protocol statistics of individual commands,
+   if requested.  This function is intended to be called as a cleanup.  */
 static void
 report_command_stats (void *arg)
 {
   struct cmd_stats *start_stats = (struct cmd_stats *) arg;
   int msg_type = start_stats->msg_type;
+  long cmd_time = get_run_time () - start_stats->start_cpu_time;
+  struct timeval now_wall_time, delta_wall_time;
 
-  if (display_time)
-    {
-      long cmd_time = get_run_time () - start_stats->start_cpu_time;
-      struct timeval now_wall_time, delta_wall_time;
+  gettimeofday (&now_wall_time, NULL);
+  timeval_sub (&delta_wall_time,
+	       &now_wall_time, &start_stats->start_wall_time);
 
-      gettimeofday (&now_wall_time, NULL);
-      timeval_sub (&delta_wall_time,
-		   &now_wall_time, &start_stats->start_wall_time);
+  if (msg_type == 1)
+    stats_command_end (cmd_time,
+		       (ULONGEST) delta_wall_time.tv_sec * 1000000
+		       + delta_wall_time.tv_usec);
 
+  if (display_time)
+    {
       printf_unfiltered (msg_type == 0
 			 ? _("Startup time: %ld.%06ld (cpu), %ld.%06ld (wall)\n")
 			 : _("Command execution time: %ld.%06ld (cpu), %ld.%06ld (wall)\n"),
@@ -725,6 +746,18 @@ report_command_stats (void *arg)
 			 space_diff);
 #endif
     }
+
+  if (display_stats)
+    {
+      struct gdb_stats now_stats;
+
+      get_stats (&now_stats);
+      print_stats (msg_type == 0 ? _("Startup") : _("Command"),
+		   &now_stats, &start_stats->start_stats);
+    }
+
+  if (msg_type == 1)
+    remote_stats_command_end ();
 }
 
 /* Create a cleanup that reports time and space used since its
@@ -745,6 +778,13 @@ make_command_stats_cleanup (int msg_type)
   new_stat->start_cpu_time = get_run_time ();
   gettimeofday (&new_stat->start_wall_time, NULL);
 
+  if (msg_type == 1)
+    {
+      stats_command_start ();
+      remote_stats_command_start ();
+    }
+  get_stats (&new_stat->start_stats);
+
   return make_cleanup_dtor (report_command_stats, new_stat, xfree);
 }
 